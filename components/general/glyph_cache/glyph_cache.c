@@ -0,0 +1,209 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "iot_glyph_cache.h"
+
+#define GLYPH_NONE          (-1)
+#define GLYPH_SLOT_NUM_MAX  (0x7fff)
+
+typedef struct {
+    const void *font;
+    uint32_t ch;
+    uint16_t fg;
+    uint16_t bg;
+    uint16_t w;
+    uint16_t h;
+    int16_t prev;           /*!< more recently used slot */
+    int16_t next;           /*!< less recently used slot */
+    int16_t hash_next;      /*!< next slot in the same bucket */
+    bool used;
+} glyph_slot_t;
+
+/**
+ * Slots are kept in an LRU list, head is the most recently used one.
+ * Free slots sit at the tail, so they are taken before any glyph is evicted.
+ */
+typedef struct {
+    glyph_slot_t *slot;
+    int16_t *bucket;
+    int bucket_mask;
+    int slot_num;
+    int slot_pixels;
+    int16_t head;
+    int16_t tail;
+    uint16_t *arena;        /*!< slot_num * slot_pixels pixels */
+    glyph_cache_stats_t stats;
+} glyph_cache_t;
+
+static const char* GLYPH_CACHE_TAG = "glyph_cache";
+#define GLYPH_CACHE_CHECK(a, str, ret)  if(!(a)) {                                         \
+    ESP_LOGE(GLYPH_CACHE_TAG,"%s:%d (%s):%s", __FILE__, __LINE__, __FUNCTION__, str);   \
+    return (ret);                                                                   \
+    }
+
+static inline int glyph_hash(const glyph_cache_t *cache, const void *font, uint32_t ch, uint16_t fg, uint16_t bg, uint16_t w, uint16_t h)
+{
+    uint32_t v = (uint32_t)(uintptr_t) font;
+    v ^= ch * 2654435761u;
+    v ^= ((uint32_t) fg << 16 | bg) * 40503u;
+    v ^= (uint32_t) w << 8 ^ h;
+    v ^= v >> 15;
+    return v & cache->bucket_mask;
+}
+
+static void glyph_lru_unlink(glyph_cache_t *cache, int idx)
+{
+    glyph_slot_t *s = &cache->slot[idx];
+    if (s->prev != GLYPH_NONE) {
+        cache->slot[s->prev].next = s->next;
+    } else {
+        cache->head = s->next;
+    }
+    if (s->next != GLYPH_NONE) {
+        cache->slot[s->next].prev = s->prev;
+    } else {
+        cache->tail = s->prev;
+    }
+}
+
+static void glyph_lru_push_head(glyph_cache_t *cache, int idx)
+{
+    glyph_slot_t *s = &cache->slot[idx];
+    s->prev = GLYPH_NONE;
+    s->next = cache->head;
+    if (cache->head != GLYPH_NONE) {
+        cache->slot[cache->head].prev = idx;
+    } else {
+        cache->tail = idx;
+    }
+    cache->head = idx;
+}
+
+static void glyph_hash_remove(glyph_cache_t *cache, int idx)
+{
+    glyph_slot_t *s = &cache->slot[idx];
+    int16_t *it = &cache->bucket[glyph_hash(cache, s->font, s->ch, s->fg, s->bg, s->w, s->h)];
+    while (*it != GLYPH_NONE) {
+        if (*it == idx) {
+            *it = s->hash_next;
+            return;
+        }
+        it = &cache->slot[*it].hash_next;
+    }
+}
+
+glyph_cache_handle_t iot_glyph_cache_create(int slot_num, int slot_pixels)
+{
+    GLYPH_CACHE_CHECK(slot_num > 0 && slot_num <= GLYPH_SLOT_NUM_MAX, "slot number error", NULL);
+    GLYPH_CACHE_CHECK(slot_pixels > 0, "slot size error", NULL);
+    glyph_cache_t *cache = (glyph_cache_t *) calloc(1, sizeof(glyph_cache_t));
+    GLYPH_CACHE_CHECK(cache != NULL, "memory error", NULL);
+    int bucket_num = 1;
+    while (bucket_num < slot_num) {
+        bucket_num <<= 1;
+    }
+    cache->slot = (glyph_slot_t *) calloc(slot_num, sizeof(glyph_slot_t));
+    cache->bucket = (int16_t *) malloc(bucket_num * sizeof(int16_t));
+    cache->arena = (uint16_t *) malloc((size_t) slot_num * slot_pixels * sizeof(uint16_t));
+    if (cache->slot == NULL || cache->bucket == NULL || cache->arena == NULL) {
+        ESP_LOGE(GLYPH_CACHE_TAG, "no mem for %d glyphs of %d pixels", slot_num, slot_pixels);
+        iot_glyph_cache_delete(cache);
+        return NULL;
+    }
+    cache->bucket_mask = bucket_num - 1;
+    cache->slot_num = slot_num;
+    cache->slot_pixels = slot_pixels;
+    iot_glyph_cache_clear(cache);
+    return (glyph_cache_handle_t) cache;
+}
+
+esp_err_t iot_glyph_cache_delete(glyph_cache_handle_t cache)
+{
+    GLYPH_CACHE_CHECK(cache != NULL, "handle error", ESP_FAIL);
+    glyph_cache_t *gc = (glyph_cache_t *) cache;
+    free(gc->arena);
+    free(gc->bucket);
+    free(gc->slot);
+    free(gc);
+    return ESP_OK;
+}
+
+void iot_glyph_cache_clear(glyph_cache_handle_t cache)
+{
+    glyph_cache_t *gc = (glyph_cache_t *) cache;
+    for (int i = 0; i <= gc->bucket_mask; i++) {
+        gc->bucket[i] = GLYPH_NONE;
+    }
+    for (int i = 0; i < gc->slot_num; i++) {
+        gc->slot[i].used = false;
+        gc->slot[i].hash_next = GLYPH_NONE;
+        gc->slot[i].prev = i - 1;
+        gc->slot[i].next = (i + 1 < gc->slot_num) ? i + 1 : GLYPH_NONE;
+    }
+    gc->head = 0;
+    gc->tail = gc->slot_num - 1;
+}
+
+const uint16_t *iot_glyph_cache_get(glyph_cache_handle_t cache, const void *font, uint32_t ch, uint16_t fg, uint16_t bg,
+                                    uint16_t w, uint16_t h, glyph_cache_render_cb_t render, void *arg)
+{
+    glyph_cache_t *gc = (glyph_cache_t *) cache;
+    if (gc == NULL || w == 0 || h == 0 || (int) w * h > gc->slot_pixels) {
+        return NULL;
+    }
+    int hash = glyph_hash(gc, font, ch, fg, bg, w, h);
+    for (int idx = gc->bucket[hash]; idx != GLYPH_NONE; idx = gc->slot[idx].hash_next) {
+        glyph_slot_t *s = &gc->slot[idx];
+        if (s->font == font && s->ch == ch && s->fg == fg && s->bg == bg && s->w == w && s->h == h) {
+            if (gc->head != idx) {
+                glyph_lru_unlink(gc, idx);
+                glyph_lru_push_head(gc, idx);
+            }
+            gc->stats.hit++;
+            return gc->arena + idx * gc->slot_pixels;
+        }
+    }
+
+    // Reuse the least recently used slot
+    int idx = gc->tail;
+    glyph_slot_t *s = &gc->slot[idx];
+    if (s->used) {
+        glyph_hash_remove(gc, idx);
+        gc->stats.evict++;
+    }
+    glyph_lru_unlink(gc, idx);
+    glyph_lru_push_head(gc, idx);
+    s->font = font;
+    s->ch = ch;
+    s->fg = fg;
+    s->bg = bg;
+    s->w = w;
+    s->h = h;
+    s->used = true;
+    s->hash_next = gc->bucket[hash];
+    gc->bucket[hash] = idx;
+    gc->stats.miss++;
+    uint16_t *buf = gc->arena + idx * gc->slot_pixels;
+    render(buf, w, h, arg);
+    return buf;
+}
+
+void iot_glyph_cache_get_stats(glyph_cache_handle_t cache, glyph_cache_stats_t *stats)
+{
+    *stats = ((glyph_cache_t *) cache)->stats;
+}
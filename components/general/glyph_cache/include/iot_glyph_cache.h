@@ -0,0 +1,110 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef _IOT_GLYPH_CACHE_H_
+#define _IOT_GLYPH_CACHE_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void* glyph_cache_handle_t;
+
+/**
+ * @brief Render a glyph into a cache slot
+ *
+ * @param buf w * h pixels to fill, row by row
+ * @param w glyph width
+ * @param h glyph height
+ * @param arg argument given to iot_glyph_cache_get
+ */
+typedef void (*glyph_cache_render_cb_t)(uint16_t *buf, uint16_t w, uint16_t h, void *arg);
+
+/**
+ * @brief Glyph cache statistics
+ */
+typedef struct {
+    uint32_t hit;       /*!< glyphs found in the cache */
+    uint32_t miss;      /*!< glyphs rendered into a slot */
+    uint32_t evict;     /*!< glyphs dropped to make room */
+} glyph_cache_stats_t;
+
+/**
+ * @brief Create a glyph cache
+ *
+ * @param slot_num number of glyphs the cache holds
+ * @param slot_pixels pixels per slot, larger glyphs are not cached
+ *
+ * @return
+ *     - NULL Fail
+ *     - Others Success
+ */
+glyph_cache_handle_t iot_glyph_cache_create(int slot_num, int slot_pixels);
+
+/**
+ * @brief Delete a glyph cache and free its slots
+ *
+ * @param cache glyph cache handle
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_glyph_cache_delete(glyph_cache_handle_t cache);
+
+/**
+ * @brief Get a glyph, rendering it on a miss
+ *
+ * On a miss the least recently used slot is handed to the render callback.
+ * The returned pixels stay valid until the next call on this cache.
+ *
+ * @param cache glyph cache handle
+ * @param font font identity, usually the address of the font data
+ * @param ch character code
+ * @param fg foreground color
+ * @param bg background color
+ * @param w glyph width
+ * @param h glyph height
+ * @param render callback that draws the glyph on a miss
+ * @param arg argument of the render callback
+ *
+ * @return
+ *     - NULL The glyph doesn't fit in a slot
+ *     - Others w * h pixels of the glyph
+ */
+const uint16_t *iot_glyph_cache_get(glyph_cache_handle_t cache, const void *font, uint32_t ch, uint16_t fg, uint16_t bg,
+                                    uint16_t w, uint16_t h, glyph_cache_render_cb_t render, void *arg);
+
+/**
+ * @brief Drop every cached glyph
+ *
+ * @param cache glyph cache handle
+ */
+void iot_glyph_cache_clear(glyph_cache_handle_t cache);
+
+/**
+ * @brief Get the statistics of a glyph cache
+ *
+ * @param cache glyph cache handle
+ * @param stats copy of the statistics
+ */
+void iot_glyph_cache_get_stats(glyph_cache_handle_t cache, glyph_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,84 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <stdio.h>
+#include "unity.h"
+#include "iot_glyph_cache.h"
+
+#define TEST_SLOT_NUM     (4)
+#define TEST_GLYPH_W      (8)
+#define TEST_GLYPH_H      (16)
+
+static const uint8_t test_font[1];
+static int render_cnt;
+
+static void test_glyph_render(uint16_t *buf, uint16_t w, uint16_t h, void *arg)
+{
+    uint32_t ch = *(uint32_t *) arg;
+    for (int i = 0; i < w * h; i++) {
+        buf[i] = ch + i;
+    }
+    render_cnt++;
+}
+
+static const uint16_t *test_glyph_get(glyph_cache_handle_t cache, uint32_t ch, uint16_t fg)
+{
+    const uint16_t *glyph = iot_glyph_cache_get(cache, test_font, ch, fg, 0, TEST_GLYPH_W, TEST_GLYPH_H, test_glyph_render, &ch);
+    TEST_ASSERT(glyph != NULL);
+    for (int i = 0; i < TEST_GLYPH_W * TEST_GLYPH_H; i++) {
+        TEST_ASSERT_EQUAL_UINT16(ch + i, glyph[i]);
+    }
+    return glyph;
+}
+
+TEST_CASE("Glyph cache LRU test", "[glyph_cache][iot]")
+{
+    glyph_cache_stats_t stats;
+    glyph_cache_handle_t cache = iot_glyph_cache_create(TEST_SLOT_NUM, TEST_GLYPH_W * TEST_GLYPH_H);
+    TEST_ASSERT(cache != NULL);
+    render_cnt = 0;
+
+    // Fill every slot, then hit them all
+    for (uint32_t ch = 'A'; ch < 'A' + TEST_SLOT_NUM; ch++) {
+        test_glyph_get(cache, ch, 0xffff);
+    }
+    for (uint32_t ch = 'A'; ch < 'A' + TEST_SLOT_NUM; ch++) {
+        test_glyph_get(cache, ch, 0xffff);
+    }
+    TEST_ASSERT_EQUAL(TEST_SLOT_NUM, render_cnt);
+
+    // The same character in another color is another glyph, it evicts 'A'
+    test_glyph_get(cache, 'B', 0xf800);
+    TEST_ASSERT_EQUAL(TEST_SLOT_NUM + 1, render_cnt);
+    test_glyph_get(cache, 'A', 0xffff);
+    TEST_ASSERT_EQUAL(TEST_SLOT_NUM + 2, render_cnt);
+    // 'B' in white was used longest ago and is gone now, 'D' is still there
+    test_glyph_get(cache, 'D', 0xffff);
+    TEST_ASSERT_EQUAL(TEST_SLOT_NUM + 2, render_cnt);
+    test_glyph_get(cache, 'B', 0xffff);
+    TEST_ASSERT_EQUAL(TEST_SLOT_NUM + 3, render_cnt);
+
+    // Glyphs larger than a slot are not cached
+    uint32_t ch = 'Z';
+    TEST_ASSERT(iot_glyph_cache_get(cache, test_font, ch, 0, 0, TEST_GLYPH_W * 2, TEST_GLYPH_H, test_glyph_render, &ch) == NULL);
+
+    iot_glyph_cache_get_stats(cache, &stats);
+    TEST_ASSERT_EQUAL(TEST_SLOT_NUM + 1, stats.hit);
+    TEST_ASSERT_EQUAL(TEST_SLOT_NUM + 3, stats.miss);
+    TEST_ASSERT_EQUAL(3, stats.evict);
+
+    iot_glyph_cache_clear(cache);
+    test_glyph_get(cache, 'D', 0xffff);
+    TEST_ASSERT_EQUAL(TEST_SLOT_NUM + 4, render_cnt);
+    TEST_ASSERT_EQUAL(ESP_OK, iot_glyph_cache_delete(cache));
+}
@@ -0,0 +1,238 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "iot_imu_fusion.h"
+
+/*
+ * The quaternion is kept in Q30, a gyro step at 1 kHz is only a few 1e-5,
+ * which Q16 would round away. Rates are widened to Q24 before they are
+ * multiplied with it so that every product fits in 64 bits.
+ */
+#define IMU_FUSION_RATE_SHIFT   (24)
+#define IMU_FUSION_Q29_ONE      (1 << 29)
+
+static const char* TAG = "imu_fusion";
+
+/* atan(2^-i) in degrees, Q16 */
+static const int32_t imu_fusion_atan_tab[] = {
+    2949120, 1740967, 919879, 466945, 234379, 117304, 58666, 29335,
+    14668, 7334, 3667, 1833, 917, 458, 229, 115,
+    57, 29, 14, 7, 4, 2, 1,
+};
+
+/* Bit by bit square root, always 32 rounds */
+static uint32_t imu_fusion_sqrt(uint64_t val)
+{
+    uint64_t res = 0;
+    uint64_t bit = 1ULL << 62;
+    for (int i = 0; i < 32; i++) {
+        if (val >= res + bit) {
+            val -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t) res;
+}
+
+/* Scale a 3 vector to unit length in Q30, false for the zero vector */
+static bool imu_fusion_normalize3(const int32_t in[3], int64_t out[3])
+{
+    uint64_t sum = (uint64_t) ((int64_t) in[0] * in[0]) + (uint64_t) ((int64_t) in[1] * in[1])
+                   + (uint64_t) ((int64_t) in[2] * in[2]);
+    uint32_t norm = imu_fusion_sqrt(sum);
+    if (norm == 0) {
+        return false;
+    }
+    for (int i = 0; i < 3; i++) {
+        out[i] = (int64_t) in[i] * IMU_FUSION_Q30_ONE / norm;
+    }
+    return true;
+}
+
+static void imu_fusion_normalize_quat(imu_fusion_quat_t *q, const int64_t v[4])
+{
+    // components stay close to Q30 between two normalizations, the sum fits in Q60
+    uint64_t sum = v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3];
+    uint32_t norm = imu_fusion_sqrt(sum);
+    if (norm == 0) {
+        q->w = IMU_FUSION_Q30_ONE;
+        q->x = q->y = q->z = 0;
+        return;
+    }
+    q->w = (int32_t) (v[0] * IMU_FUSION_Q30_ONE / norm);
+    q->x = (int32_t) (v[1] * IMU_FUSION_Q30_ONE / norm);
+    q->y = (int32_t) (v[2] * IMU_FUSION_Q30_ONE / norm);
+    q->z = (int32_t) (v[3] * IMU_FUSION_Q30_ONE / norm);
+}
+
+/* Start from the tilt the accelerometer sees, the shortest rotation of a onto the earth z axis */
+static void imu_fusion_align(imu_fusion_t *fusion, const int64_t a[3])
+{
+    int64_t v[4] = { IMU_FUSION_Q30_ONE + a[2], a[1], -a[0], 0 };
+    if (v[0] < (IMU_FUSION_Q30_ONE >> 10)) {
+        // upside down, any half turn around a horizontal axis
+        v[0] = 0;
+        v[1] = IMU_FUSION_Q30_ONE;
+        v[2] = 0;
+    }
+    imu_fusion_normalize_quat(&fusion->q, v);
+}
+
+esp_err_t iot_imu_fusion_init(imu_fusion_t *fusion, const imu_fusion_config_t *cfg)
+{
+    if (fusion == NULL || cfg == NULL || cfg->mode > IMU_FUSION_MADGWICK || cfg->sample_rate_hz == 0) {
+        ESP_LOGE(TAG, "invalid config");
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(fusion, 0, sizeof(imu_fusion_t));
+    fusion->cfg = *cfg;
+    fusion->q.w = IMU_FUSION_Q30_ONE;
+    return ESP_OK;
+}
+
+void iot_imu_fusion_update(imu_fusion_t *fusion, const int32_t gyro[3], const int32_t acce[3])
+{
+    const imu_fusion_quat_t *q = &fusion->q;
+    const imu_fusion_config_t *cfg = &fusion->cfg;
+    int64_t g[3], a[3];
+    int64_t corr[4] = { 0, 0, 0, 0 };   // Madgwick step, 2 * beta * s in Q30
+    bool valid = imu_fusion_normalize3(acce, a);
+
+    if (valid && !fusion->aligned) {
+        imu_fusion_align(fusion, a);
+        fusion->aligned = true;
+        return;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        g[i] = (int64_t) gyro[i] * (1 << (IMU_FUSION_RATE_SHIFT - 16));
+    }
+
+    if (valid && cfg->mode != IMU_FUSION_MADGWICK) {
+        // gravity as the current estimate sees it, Q30
+        int64_t vx = ((int64_t) q->x * q->z - (int64_t) q->w * q->y) >> 29;
+        int64_t vy = ((int64_t) q->w * q->x + (int64_t) q->y * q->z) >> 29;
+        int64_t vz = ((int64_t) q->w * q->w - (int64_t) q->x * q->x - (int64_t) q->y * q->y
+                      + (int64_t) q->z * q->z) >> 30;
+        // error is the cross product of measured and estimated gravity, Q30
+        int64_t e[3] = {
+            (a[1] * vz - a[2] * vy) >> 30,
+            (a[2] * vx - a[0] * vz) >> 30,
+            (a[0] * vy - a[1] * vx) >> 30,
+        };
+        for (int i = 0; i < 3; i++) {
+            if (cfg->mode == IMU_FUSION_MAHONY) {
+                fusion->bias[i] += (int32_t) (((e[i] * cfg->ki) >> 16) / (int32_t) cfg->sample_rate_hz);
+            }
+            g[i] += ((e[i] * cfg->kp) >> 16) >> (30 - IMU_FUSION_RATE_SHIFT);
+            g[i] += fusion->bias[i] >> (30 - IMU_FUSION_RATE_SHIFT);
+        }
+    } else if (valid) {
+        // objective function, estimated minus measured gravity, Q30
+        int64_t f1 = (((int64_t) q->x * q->z - (int64_t) q->w * q->y) >> 29) - a[0];
+        int64_t f2 = (((int64_t) q->w * q->x + (int64_t) q->y * q->z) >> 29) - a[1];
+        int64_t f3 = IMU_FUSION_Q30_ONE - (((int64_t) q->x * q->x + (int64_t) q->y * q->y) >> 29) - a[2];
+        // half the gradient, the transposed Jacobian times f, Q30
+        int64_t s[4] = {
+            ((-q->y * f1) >> 30) + ((q->x * f2) >> 30),
+            ((q->z * f1) >> 30) + ((q->w * f2) >> 30) - ((q->x * f3) >> 29),
+            ((-q->w * f1) >> 30) + ((q->z * f2) >> 30) - ((q->y * f3) >> 29),
+            ((q->x * f1) >> 30) + ((q->y * f2) >> 30),
+        };
+        uint64_t sum = 0;
+        for (int i = 0; i < 4; i++) {
+            s[i] >>= 4;     // only the direction is used, Q26 leaves room for the squares
+            sum += s[i] * s[i];
+        }
+        uint32_t norm = imu_fusion_sqrt(sum);
+        if (norm != 0) {
+            for (int i = 0; i < 4; i++) {
+                corr[i] = ((s[i] * IMU_FUSION_Q30_ONE / norm) * cfg->beta) >> 15;
+            }
+        }
+    }
+
+    // twice the quaternion rate, q * (0, g), Q30
+    int64_t dq[4] = {
+        (-q->x * g[0] - q->y * g[1] - q->z * g[2]) >> IMU_FUSION_RATE_SHIFT,
+        ( q->w * g[0] + q->y * g[2] - q->z * g[1]) >> IMU_FUSION_RATE_SHIFT,
+        ( q->w * g[1] - q->x * g[2] + q->z * g[0]) >> IMU_FUSION_RATE_SHIFT,
+        ( q->w * g[2] + q->x * g[1] - q->y * g[0]) >> IMU_FUSION_RATE_SHIFT,
+    };
+    int64_t v[4] = { q->w, q->x, q->y, q->z };
+    int32_t div = 2 * (int32_t) cfg->sample_rate_hz;
+    for (int i = 0; i < 4; i++) {
+        v[i] += (dq[i] - corr[i]) / div;
+    }
+    imu_fusion_normalize_quat(&fusion->q, v);
+}
+
+int32_t iot_imu_fusion_atan2(int32_t y, int32_t x)
+{
+    int64_t cx = x, cy = y, t;
+    int32_t angle = 0;
+    if (x == 0 && y == 0) {
+        return 0;
+    }
+    // turn into the right half plane, CORDIC converges within +/- 99 degrees
+    if (cx < 0) {
+        t = cx;
+        if (cy >= 0) {
+            cx = cy;
+            cy = -t;
+            angle = 90 * IMU_FUSION_Q16_ONE;
+        } else {
+            cx = -cy;
+            cy = t;
+            angle = -90 * IMU_FUSION_Q16_ONE;
+        }
+    }
+    for (int i = 0; i < sizeof(imu_fusion_atan_tab) / sizeof(imu_fusion_atan_tab[0]); i++) {
+        t = cx;
+        if (cy > 0) {
+            cx += cy >> i;
+            cy -= t >> i;
+            angle += imu_fusion_atan_tab[i];
+        } else {
+            cx -= cy >> i;
+            cy += t >> i;
+            angle -= imu_fusion_atan_tab[i];
+        }
+    }
+    return angle;
+}
+
+void iot_imu_fusion_get_euler(const imu_fusion_t *fusion, imu_fusion_euler_t *euler)
+{
+    const imu_fusion_quat_t *q = &fusion->q;
+    int64_t w = q->w, x = q->x, y = q->y, z = q->z;
+    // twice the products in Q29 is the products in Q30 shifted once more, values up to 2 fit in 32 bits
+    int32_t sinr = (int32_t) ((w * x + y * z) >> 30);
+    int32_t cosr = IMU_FUSION_Q29_ONE - (int32_t) ((x * x + y * y) >> 30);
+    int32_t sinp = (int32_t) ((w * y - z * x) >> 30);
+    int32_t siny = (int32_t) ((w * z + x * y) >> 30);
+    int32_t cosy = IMU_FUSION_Q29_ONE - (int32_t) ((y * y + z * z) >> 30);
+
+    sinp = sinp > IMU_FUSION_Q29_ONE ? IMU_FUSION_Q29_ONE : (sinp < -IMU_FUSION_Q29_ONE ? -IMU_FUSION_Q29_ONE : sinp);
+    int32_t cosp = imu_fusion_sqrt(((uint64_t) 1 << 58) - (int64_t) sinp * sinp);
+
+    euler->roll = iot_imu_fusion_atan2(sinr, cosr);
+    euler->pitch = iot_imu_fusion_atan2(sinp, cosp);
+    euler->yaw = iot_imu_fusion_atan2(siny, cosy);
+}
@@ -0,0 +1,150 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef _IOT_IMU_FUSION_H_
+#define _IOT_IMU_FUSION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_FUSION_Q16_ONE      (1 << 16)   /*!< 1.0 in Q16 */
+#define IMU_FUSION_Q30_ONE      (1 << 30)   /*!< 1.0 in Q30 */
+
+/**
+ * @brief Float constant to Q16, for gains and initializers
+ */
+#define IMU_FUSION_Q16(x)       ((int32_t) ((x) * IMU_FUSION_Q16_ONE + ((x) < 0 ? -0.5 : 0.5)))
+
+/**
+ * @brief Gyro scale for iot_imu_fusion_gyro_from_raw(), rad/s per LSB in Q32
+ *
+ * @param lsb_per_dps sensitivity of the gyro, 65.5 for a MPU6050 at +/- 500 dps
+ */
+#define IMU_FUSION_GYRO_SCALE(lsb_per_dps)  ((int32_t) (3.14159265358979 / 180 / (lsb_per_dps) * 4294967296.0 + 0.5))
+
+/**
+ * @brief Fusion algorithm
+ */
+typedef enum {
+    IMU_FUSION_COMPLEMENTARY = 0,   /*!< Mahony's complementary filter, proportional feedback only */
+    IMU_FUSION_MAHONY,              /*!< Mahony, proportional and integral feedback, also tracks gyro bias */
+    IMU_FUSION_MADGWICK,            /*!< Madgwick gradient descent */
+} imu_fusion_mode_t;
+
+/**
+ * @brief Fusion configuration, gains in Q16
+ */
+typedef struct {
+    imu_fusion_mode_t mode;
+    int32_t kp;                 /*!< proportional gain of complementary and Mahony, 1.0 is a good start */
+    int32_t ki;                 /*!< integral gain of Mahony, 0.01 ~ 0.1 */
+    int32_t beta;               /*!< gain of Madgwick, 0.033 ~ 0.1 */
+    uint32_t sample_rate_hz;    /*!< rate of iot_imu_fusion_update() calls */
+} imu_fusion_config_t;
+
+/**
+ * @brief Orientation quaternion in Q30, rotates the sensor frame to the earth frame
+ */
+typedef struct {
+    int32_t w;
+    int32_t x;
+    int32_t y;
+    int32_t z;
+} imu_fusion_quat_t;
+
+/**
+ * @brief Orientation as angles in degrees, Q16
+ */
+typedef struct {
+    int32_t roll;               /*!< around x, -180 ~ 180 */
+    int32_t pitch;              /*!< around y, -90 ~ 90 */
+    int32_t yaw;                /*!< around z, -180 ~ 180, drifts without a magnetometer */
+} imu_fusion_euler_t;
+
+/**
+ * @brief Fusion state
+ */
+typedef struct {
+    imu_fusion_config_t cfg;
+    imu_fusion_quat_t q;
+    int32_t bias[3];            /*!< integral feedback of Mahony, rad/s in Q30 */
+    bool aligned;               /*!< the first sample with acceleration sets the tilt */
+} imu_fusion_t;
+
+/**
+ * @brief Reset the fusion to the identity orientation
+ *
+ * @param fusion fusion state
+ * @param cfg configuration
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG bad mode or zero sample rate
+ */
+esp_err_t iot_imu_fusion_init(imu_fusion_t *fusion, const imu_fusion_config_t *cfg);
+
+/**
+ * @brief Feed one gyro and accelerometer sample
+ *
+ * Integer only, no data dependent loops, so each call takes the same time.
+ * The accelerometer correction is skipped for a zero acceleration vector.
+ *
+ * @param fusion fusion state
+ * @param gyro angular rate around x, y, z, rad/s in Q16
+ * @param acce acceleration along x, y, z in Q16, any unit, only the direction is used
+ */
+void iot_imu_fusion_update(imu_fusion_t *fusion, const int32_t gyro[3], const int32_t acce[3]);
+
+/**
+ * @brief Get the orientation as roll, pitch and yaw
+ *
+ * @param fusion fusion state
+ * @param euler angles in degrees, Q16
+ */
+void iot_imu_fusion_get_euler(const imu_fusion_t *fusion, imu_fusion_euler_t *euler);
+
+/**
+ * @brief Four quadrant arc tangent
+ *
+ * @param y y in any fixed point format, the same as x
+ * @param x x
+ *
+ * @return
+ *     - angle in degrees, Q16, -180 ~ 180
+ */
+int32_t iot_imu_fusion_atan2(int32_t y, int32_t x);
+
+/**
+ * @brief Convert a raw gyro reading to rad/s in Q16
+ *
+ * @param raw raw reading
+ * @param scale IMU_FUSION_GYRO_SCALE() of the gyro sensitivity
+ *
+ * @return
+ *     - rad/s in Q16
+ */
+static inline int32_t iot_imu_fusion_gyro_from_raw(int16_t raw, int32_t scale)
+{
+    return (int32_t) (((int64_t) raw * scale) >> 16);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
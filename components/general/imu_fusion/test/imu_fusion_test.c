@@ -0,0 +1,203 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "unity.h"
+#include "esp_timer.h"
+#include "iot_imu_fusion.h"
+
+#define FUSION_TEST_RATE_HZ     (1000)
+#define FUSION_TEST_TIME_S      (10)
+#define FUSION_TEST_CHUNK       (500)       /*!< log frames generated at a time */
+#define FUSION_TEST_SETTLE_S    (2)         /*!< errors are counted after this */
+#define FUSION_TEST_GYRO_LSB    (65.5)      /*!< MPU6050 at +/- 500 dps */
+#define FUSION_TEST_ACCE_LSB    (8192)      /*!< MPU6050 at +/- 4 g */
+#define FUSION_TEST_DEG         (3.14159265358979f / 180)
+
+/* One frame of the log, raw readings as the MPU6050 FIFO gives them */
+typedef struct {
+    int16_t acce[3];
+    int16_t gyro[3];
+    float truth[4];     /*!< reference quaternion w, x, y, z */
+} fusion_test_frame_t;
+
+static void quat_mul(const float a[4], const float b[4], float r[4])
+{
+    r[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    r[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    r[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    r[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+}
+
+/* Reference motion: swinging in roll, pitch and yaw at different rates */
+static void test_truth(float t, float q[4])
+{
+    float roll = 30 * FUSION_TEST_DEG * sinf(2 * 3.14159265f * 0.5f * t);
+    float pitch = 20 * FUSION_TEST_DEG * sinf(2 * 3.14159265f * 0.3f * t + 1);
+    float yaw = 45 * FUSION_TEST_DEG * sinf(2 * 3.14159265f * 0.2f * t);
+    float qx[4] = { cosf(roll / 2), sinf(roll / 2), 0, 0 };
+    float qy[4] = { cosf(pitch / 2), 0, sinf(pitch / 2), 0 };
+    float qz[4] = { cosf(yaw / 2), 0, 0, sinf(yaw / 2) };
+    float t1[4];
+    quat_mul(qz, qy, t1);
+    quat_mul(t1, qx, q);
+}
+
+/* Earth z axis in the sensor frame, what a resting accelerometer measures */
+static void test_gravity(const float q[4], float v[3])
+{
+    v[0] = 2 * (q[1] * q[3] - q[0] * q[2]);
+    v[1] = 2 * (q[0] * q[1] + q[2] * q[3]);
+    v[2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+}
+
+static float test_noise(uint32_t *seed)
+{
+    *seed = *seed * 1664525 + 1013904223;
+    return ((int32_t) (*seed >> 8) - (1 << 23)) / (float) (1 << 23);
+}
+
+/* Synthesize the log, body rates from the derivative of the reference, plus bias and noise */
+static void test_log(fusion_test_frame_t *frames, int start, int num, uint32_t *seed)
+{
+    const float dt = 1.0f / FUSION_TEST_RATE_HZ;
+    const float bias[3] = { 0.5f, -0.3f, 0.2f };    // dps
+    for (int i = 0; i < num; i++) {
+        float t = (start + i) * dt;
+        float q0[4], q1[4], conj[4], dq[4], w[4], v[3];
+        test_truth(t, frames[i].truth);
+        test_truth(t - dt / 2, q0);
+        test_truth(t + dt / 2, q1);
+        // omega = 2 * conj(q) * dq/dt
+        for (int k = 0; k < 4; k++) {
+            dq[k] = (q1[k] - q0[k]) / dt;
+            conj[k] = k ? -frames[i].truth[k] : frames[i].truth[k];
+        }
+        quat_mul(conj, dq, w);
+        test_gravity(frames[i].truth, v);
+        for (int k = 0; k < 3; k++) {
+            float dps = 2 * w[k + 1] / FUSION_TEST_DEG + bias[k] + 0.2f * test_noise(seed);
+            float g = v[k] + 0.01f * test_noise(seed);
+            frames[i].gyro[k] = (int16_t) lroundf(dps * FUSION_TEST_GYRO_LSB);
+            frames[i].acce[k] = (int16_t) lroundf(g * FUSION_TEST_ACCE_LSB);
+        }
+    }
+}
+
+/* Angle between the estimated and the reference gravity, in degrees */
+static float test_tilt_error(const imu_fusion_quat_t *q, const float truth[4])
+{
+    float qe[4] = { q->w / (float) IMU_FUSION_Q30_ONE, q->x / (float) IMU_FUSION_Q30_ONE,
+                    q->y / (float) IMU_FUSION_Q30_ONE, q->z / (float) IMU_FUSION_Q30_ONE };
+    float ve[3], vt[3];
+    test_gravity(qe, ve);
+    test_gravity(truth, vt);
+    float dot = ve[0] * vt[0] + ve[1] * vt[1] + ve[2] * vt[2];
+    dot = dot > 1 ? 1 : dot;
+    return acosf(dot) / FUSION_TEST_DEG;
+}
+
+TEST_CASE("IMU fusion log replay test", "[imu_fusion][iot]")
+{
+    static const char *names[] = { "complementary", "mahony", "madgwick" };
+    const int32_t scale = IMU_FUSION_GYRO_SCALE(FUSION_TEST_GYRO_LSB);
+    fusion_test_frame_t *frames = (fusion_test_frame_t *) malloc(FUSION_TEST_CHUNK * sizeof(fusion_test_frame_t));
+    TEST_ASSERT_NOT_NULL(frames);
+
+    for (imu_fusion_mode_t mode = IMU_FUSION_COMPLEMENTARY; mode <= IMU_FUSION_MADGWICK; mode++) {
+        imu_fusion_config_t cfg = {
+            .mode = mode,
+            .kp = IMU_FUSION_Q16(1.0),
+            .ki = IMU_FUSION_Q16(0.3),
+            .beta = IMU_FUSION_Q16(0.05),
+            .sample_rate_hz = FUSION_TEST_RATE_HZ,
+        };
+        imu_fusion_t fusion;
+        TEST_ASSERT_EQUAL(ESP_OK, iot_imu_fusion_init(&fusion, &cfg));
+
+        uint32_t seed = 1;
+        int64_t us = 0;
+        float max_err = 0, sum_err = 0;
+        int cnt = 0;
+        for (int start = 0; start < FUSION_TEST_RATE_HZ * FUSION_TEST_TIME_S; start += FUSION_TEST_CHUNK) {
+            test_log(frames, start, FUSION_TEST_CHUNK, &seed);
+            for (int i = 0; i < FUSION_TEST_CHUNK; i++) {
+                int32_t gyro[3], acce[3];
+                int64_t t0 = esp_timer_get_time();
+                for (int k = 0; k < 3; k++) {
+                    gyro[k] = iot_imu_fusion_gyro_from_raw(frames[i].gyro[k], scale);
+                    acce[k] = frames[i].acce[k];
+                }
+                iot_imu_fusion_update(&fusion, gyro, acce);
+                us += esp_timer_get_time() - t0;
+                if (start + i >= FUSION_TEST_RATE_HZ * FUSION_TEST_SETTLE_S) {
+                    float err = test_tilt_error(&fusion.q, frames[i].truth);
+                    max_err = fmaxf(max_err, err);
+                    sum_err += err;
+                    cnt++;
+                }
+            }
+        }
+        printf("%s: %.2f us per sample, tilt error mean %.3f max %.3f deg\n", names[mode],
+               (float) us / (FUSION_TEST_RATE_HZ * FUSION_TEST_TIME_S), sum_err / cnt, max_err);
+        TEST_ASSERT(max_err < 1.0f);
+    }
+    free(frames);
+}
+
+TEST_CASE("IMU fusion gyro integration test", "[imu_fusion][iot]")
+{
+    imu_fusion_config_t cfg = {
+        .mode = IMU_FUSION_MAHONY,
+        .kp = IMU_FUSION_Q16(1.0),
+        .ki = IMU_FUSION_Q16(0.05),
+        .beta = 0,
+        .sample_rate_hz = FUSION_TEST_RATE_HZ,
+    };
+    imu_fusion_t fusion;
+    imu_fusion_euler_t euler;
+    int32_t gyro[3] = { 0, 0, IMU_FUSION_Q16(90 * 3.14159265358979 / 180) };
+    int32_t acce[3] = { 0, 0, IMU_FUSION_Q16_ONE };
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, iot_imu_fusion_init(&fusion, &(imu_fusion_config_t) { .sample_rate_hz = 0 }));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_imu_fusion_init(&fusion, &cfg));
+    /* The first sample only aligns the tilt, then one second at 90 dps */
+    for (int i = 0; i <= FUSION_TEST_RATE_HZ; i++) {
+        iot_imu_fusion_update(&fusion, gyro, acce);
+    }
+    iot_imu_fusion_get_euler(&fusion, &euler);
+    printf("yaw after 1 s at 90 dps: %.4f deg\n", euler.yaw / (float) IMU_FUSION_Q16_ONE);
+    TEST_ASSERT_INT_WITHIN(IMU_FUSION_Q16(0.05), IMU_FUSION_Q16(90), euler.yaw);
+    TEST_ASSERT_INT_WITHIN(IMU_FUSION_Q16(0.01), 0, euler.roll);
+    TEST_ASSERT_INT_WITHIN(IMU_FUSION_Q16(0.01), 0, euler.pitch);
+
+    /* Aligned straight from a tilted accelerometer */
+    int32_t tilt[3] = { 0, IMU_FUSION_Q16(0.5), IMU_FUSION_Q16(0.8660254) };
+    int32_t still[3] = { 0, 0, 0 };
+    TEST_ASSERT_EQUAL(ESP_OK, iot_imu_fusion_init(&fusion, &cfg));
+    iot_imu_fusion_update(&fusion, still, tilt);
+    iot_imu_fusion_get_euler(&fusion, &euler);
+    TEST_ASSERT_INT_WITHIN(IMU_FUSION_Q16(0.01), IMU_FUSION_Q16(30), euler.roll);
+
+    /* Arc tangent in all four quadrants */
+    float max_err = 0;
+    for (int deg = -179; deg <= 180; deg++) {
+        int32_t y = (int32_t) lroundf(sinf(deg * FUSION_TEST_DEG) * (1 << 20));
+        int32_t x = (int32_t) lroundf(cosf(deg * FUSION_TEST_DEG) * (1 << 20));
+        max_err = fmaxf(max_err, fabsf(iot_imu_fusion_atan2(y, x) / (float) IMU_FUSION_Q16_ONE - deg));
+    }
+    printf("atan2 max error %.5f deg\n", max_err);
+    TEST_ASSERT(max_err < 0.001f);
+}
@@ -0,0 +1,199 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef _IOT_SENSOR_HUB_H_
+#define _IOT_SENSOR_HUB_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "iot_i2c_bus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SENSOR_HUB_SENSOR_MAX       (16)    /*!< sensors in one hub */
+#define SENSOR_HUB_OP_MAX           (4)     /*!< register accesses of one trigger or one read */
+#define SENSOR_HUB_VALUE_MAX        (4)     /*!< values in one sample */
+#define SENSOR_HUB_RING_LEN_DEFAULT (64)
+
+typedef void* sensor_hub_handle_t;
+
+/**
+ * @brief One timestamped result of a sensor
+ */
+typedef struct {
+    int64_t timestamp;                  /*!< end of the conversion, us */
+    uint8_t sensor;                     /*!< id from iot_sensor_hub_add() */
+    uint8_t num;                        /*!< valid entries of value */
+    float value[SENSOR_HUB_VALUE_MAX];
+} sensor_hub_sample_t;
+
+/**
+ * @brief How the hub drives one sensor
+ *
+ * A conversion is started with trigger_ops, or the trigger callback when there are none,
+ * and fetched conversion_us later with read_ops. The register accesses of every sensor
+ * that is due on the same bus go out in one iot_i2c_bus_batch() call. Sensors that need
+ * more than plain register accesses, like a BH1750 that is read without a register
+ * address, leave the ops empty and access the bus in the callbacks.
+ *
+ * Free running sensors have no trigger, they are read every period.
+ */
+typedef struct {
+    i2c_bus_handle_t bus;               /*!< bus of the sensor, or the one the callbacks use */
+    uint32_t period_us;                 /*!< desired output period */
+    uint32_t conversion_us;             /*!< from trigger to result, 0 for free running sensors */
+    i2c_bus_op_t trigger_ops[SENSOR_HUB_OP_MAX];    /*!< dev and buffers belong to the sensor driver */
+    uint8_t trigger_op_num;
+    i2c_bus_op_t read_ops[SENSOR_HUB_OP_MAX];
+    uint8_t read_op_num;
+    esp_err_t (*trigger)(void *ctx);    /*!< start a conversion, only called without trigger_ops, may be NULL */
+    /**
+     * @brief Fill in the sample, from the read_ops buffers or by reading the sensor itself
+     *
+     * The hub sets sensor and timestamp, an error drops the sample.
+     */
+    esp_err_t (*read)(void *ctx, sensor_hub_sample_t *sample);
+    void *ctx;
+} sensor_hub_sensor_config_t;
+
+/**
+ * @brief Hub configuration
+ */
+typedef struct {
+    int ring_len;                       /*!< samples the ring holds, 0 for SENSOR_HUB_RING_LEN_DEFAULT */
+    uint32_t merge_us;                  /*!< triggers due this soon join the current bus acquisition */
+    UBaseType_t task_priority;
+    uint32_t task_stack;
+    int64_t (*clock)(void);             /*!< time base in us, NULL for esp_timer_get_time() */
+    /**
+     * @brief Runs the grouped register accesses of one bus, NULL for iot_i2c_bus_batch()
+     *
+     * Returns ESP_OK, ESP_FAIL with the result of each op in ops[].ret, or another
+     * error when the batch did not run at all, then every op counts as failed.
+     */
+    esp_err_t (*batch)(i2c_bus_handle_t bus, i2c_bus_op_t *ops, int op_num, portBASE_TYPE ticks_to_wait);
+} sensor_hub_config_t;
+
+/**
+ * @brief Counters of the scheduler
+ */
+typedef struct {
+    uint32_t acquisitions;              /*!< bus batches run */
+    uint32_t samples;                   /*!< samples published */
+    uint32_t dropped;                   /*!< samples lost to a full ring */
+    uint32_t overruns;                  /*!< periods skipped because the hub fell behind */
+    uint32_t errors;                    /*!< failed triggers and reads */
+} sensor_hub_stats_t;
+
+/**
+ * @brief Create a sensor hub
+ *
+ * @param cfg configuration
+ *
+ * @return
+ *     - NULL Fail
+ *     - Others Success
+ */
+sensor_hub_handle_t iot_sensor_hub_create(const sensor_hub_config_t *cfg);
+
+/**
+ * @brief Stop the hub and free it, the sensors are not touched
+ *
+ * @param hub hub handle
+ *
+ * @return
+ *     - ESP_OK Success
+ */
+esp_err_t iot_sensor_hub_delete(sensor_hub_handle_t hub);
+
+/**
+ * @brief Register a sensor, the config is copied
+ *
+ * @param hub hub handle
+ * @param sensor how to drive the sensor
+ *
+ * @return
+ *     - sensor id, carried by its samples
+ *     - -1 bad config, hub full or already started
+ */
+int iot_sensor_hub_add(sensor_hub_handle_t hub, const sensor_hub_sensor_config_t *sensor);
+
+/**
+ * @brief Run the scheduler in its own task, woken by a one shot timer at each deadline
+ *
+ * @param hub hub handle
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_NO_MEM no memory for the task or the timer
+ */
+esp_err_t iot_sensor_hub_start(sensor_hub_handle_t hub);
+
+/**
+ * @brief Stop the scheduler task, conversions in flight are abandoned
+ *
+ * @param hub hub handle
+ *
+ * @return
+ *     - ESP_OK Success
+ */
+esp_err_t iot_sensor_hub_stop(sensor_hub_handle_t hub);
+
+/**
+ * @brief Do everything that is due now: read finished conversions and trigger new ones,
+ *        one bus acquisition per bus
+ *
+ * The task calls this, applications with their own loop can call it instead of
+ * iot_sensor_hub_start().
+ *
+ * @param hub hub handle
+ *
+ * @return
+ *     - time of the next deadline, in the clock of the hub
+ */
+int64_t iot_sensor_hub_poll(sensor_hub_handle_t hub);
+
+/**
+ * @brief Take samples from the ring, oldest first
+ *
+ * The ring is lock free with one writer, so only one task may read.
+ *
+ * @param hub hub handle
+ * @param samples where to copy them
+ * @param max_num size of samples
+ * @param ticks time to wait while the ring is empty
+ *
+ * @return
+ *     - number of samples copied
+ */
+int iot_sensor_hub_read(sensor_hub_handle_t hub, sensor_hub_sample_t *samples, int max_num, TickType_t ticks);
+
+/**
+ * @brief Get the scheduler counters
+ *
+ * @param hub hub handle
+ * @param stats counters
+ *
+ * @return
+ *     - ESP_OK Success
+ */
+esp_err_t iot_sensor_hub_get_stats(sensor_hub_handle_t hub, sensor_hub_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,120 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef _IOT_SENSOR_HUB_SIM_H_
+#define _IOT_SENSOR_HUB_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "iot_sensor_hub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Simulated sensors on simulated buses with a virtual clock, so that schedules can be
+ * measured without hardware and without waiting for the conversions. Pass
+ * iot_sensor_hub_sim_clock and iot_sensor_hub_sim_batch in sensor_hub_config_t and
+ * drive the hub with iot_sensor_hub_poll(), moving the clock to each deadline it returns.
+ */
+
+/**
+ * @brief Timing of a simulated bus, the clock moves on by the time each batch takes
+ */
+typedef struct {
+    uint32_t batch_us;                  /*!< cost of one acquisition: locking, command link setup */
+    uint32_t op_us;                     /*!< cost of one register access besides its data: start, address, register, stop */
+    uint32_t byte_us;                   /*!< per data byte, 90 at 100 kHz */
+    uint32_t acquisitions;              /*!< batches run */
+    int64_t busy_us;                    /*!< total time the bus was held */
+    esp_err_t error;                    /*!< ESP_OK, or what the batches return instead of running */
+} sensor_hub_sim_bus_t;
+
+/**
+ * @brief A simulated sensor
+ *
+ * A triggered sensor has its result conversion_us after the trigger write, a free running
+ * one produces a result every conversion_us. The result is a sequence number, so a read
+ * that comes too early or twice for one result shows up.
+ */
+typedef struct {
+    sensor_hub_sim_bus_t *bus;
+    uint32_t conversion_us;
+    uint8_t len;                        /*!< bytes of one result, at least 4 */
+    bool free_running;
+    bool triggered;
+    int64_t ready;                      /*!< end of the conversion in flight */
+    uint32_t results;                   /*!< conversions finished */
+    uint32_t early;                     /*!< reads before the result was ready */
+    uint8_t cmd;
+    uint8_t data[16];
+} sensor_hub_sim_sensor_t;
+
+/**
+ * @brief Read the virtual clock
+ *
+ * @return
+ *     - time in us
+ */
+int64_t iot_sensor_hub_sim_clock(void);
+
+/**
+ * @brief Set the virtual clock, it never goes backwards
+ *
+ * @param us time in us
+ */
+void iot_sensor_hub_sim_set_clock(int64_t us);
+
+/**
+ * @brief Run a batch on a simulated bus, for sensor_hub_config_t.batch
+ *
+ * @param bus a sensor_hub_sim_bus_t
+ * @param ops register accesses, dev is a sensor_hub_sim_sensor_t
+ * @param op_num number of ops
+ * @param ticks_to_wait unused
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL bus error set, every ops[].ret is ESP_FAIL
+ *     - Others bus error set, nothing ran and ops[].ret is left alone
+ */
+esp_err_t iot_sensor_hub_sim_batch(i2c_bus_handle_t bus, i2c_bus_op_t *ops, int op_num, portBASE_TYPE ticks_to_wait);
+
+/**
+ * @brief Set up a simulated sensor
+ *
+ * @param sim sensor
+ * @param bus bus it is on
+ * @param conversion_us conversion time, or output period of a free running sensor
+ * @param len bytes of one result, 4 ~ 16
+ * @param free_running true for a sensor that is never triggered
+ */
+void iot_sensor_hub_sim_sensor_init(sensor_hub_sim_sensor_t *sim, sensor_hub_sim_bus_t *bus,
+                                    uint32_t conversion_us, uint8_t len, bool free_running);
+
+/**
+ * @brief Fill in the hub config of a simulated sensor, with one trigger write and one burst read
+ *
+ * @param sim sensor
+ * @param period_us desired output period
+ * @param cfg config for iot_sensor_hub_add(), the sample value is the sequence number
+ */
+void iot_sensor_hub_sim_sensor_config(sensor_hub_sim_sensor_t *sim, uint32_t period_us,
+                                      sensor_hub_sensor_config_t *cfg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
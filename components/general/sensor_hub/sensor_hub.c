@@ -0,0 +1,433 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "iot_sensor_hub.h"
+
+#define IOT_CHECK(tag, a, ret)  if(!(a)) {                                 \
+        ESP_LOGE(tag,"%s:%d (%s)", __FILE__, __LINE__, __FUNCTION__);      \
+        return (ret);                                                      \
+        }
+
+#define SENSOR_HUB_TASK_PRIO        (configMAX_PRIORITIES - 5)
+#define SENSOR_HUB_TASK_STACK       (2048)
+#define SENSOR_HUB_IDLE_US          (1000000)   /* wake up period without sensors */
+#define SENSOR_HUB_BATCH_TICKS      (100 / portTICK_RATE_MS)
+#define SENSOR_HUB_BATCH_OP_MAX     (SENSOR_HUB_SENSOR_MAX * SENSOR_HUB_OP_MAX * 2)
+
+static const char* TAG = "sensor_hub";
+
+typedef struct {
+    sensor_hub_sensor_config_t cfg;
+    int64_t release;                    /* start of the next period */
+    int64_t ready;                      /* end of the conversion in flight */
+    bool busy;                          /* triggered, result not read yet */
+    bool read_due;                      /* scratch of one poll */
+    bool trigger_due;
+    uint8_t read_op;                    /* first op of this sensor in the batch */
+    uint8_t trigger_op;
+} sensor_hub_slot_t;
+
+typedef struct {
+    sensor_hub_config_t cfg;
+    sensor_hub_slot_t slot[SENSOR_HUB_SENSOR_MAX];
+    int num;
+    bool primed;                        /* periods start at the first poll */
+    sensor_hub_sample_t *ring;
+    uint32_t ring_len;                  /* power of two */
+    volatile uint32_t head;             /* only the scheduler writes it */
+    volatile uint32_t tail;             /* only the reader writes it */
+    xSemaphoreHandle data_sem;          /* given when samples are published */
+    xSemaphoreHandle wake_sem;
+    xSemaphoreHandle exit_sem;          /* given by the task right before it is deleted */
+    esp_timer_handle_t timer;
+    xTaskHandle task;
+    volatile bool run;
+    sensor_hub_stats_t stats;
+    i2c_bus_op_t ops[SENSOR_HUB_BATCH_OP_MAX];
+} sensor_hub_t;
+
+static bool sensor_hub_free_running(const sensor_hub_slot_t *slot)
+{
+    return slot->cfg.trigger_op_num == 0 && slot->cfg.trigger == NULL;
+}
+
+static bool sensor_hub_ops_ok(const i2c_bus_op_t *ops, int num)
+{
+    for (int i = 0; i < num; i++) {
+        if (ops[i].ret != ESP_OK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Move to the next period, a period that is already over is skipped rather than caught up */
+static void sensor_hub_advance(sensor_hub_t *hub, sensor_hub_slot_t *slot, int64_t now)
+{
+    slot->release += slot->cfg.period_us;
+    if (slot->release <= now) {
+        hub->stats.overruns += (now - slot->release) / slot->cfg.period_us + 1;
+        slot->release = now + slot->cfg.period_us - (now - slot->release) % slot->cfg.period_us;
+    }
+}
+
+static void sensor_hub_publish(sensor_hub_t *hub, const sensor_hub_sample_t *sample)
+{
+    uint32_t head = hub->head;
+    if (head - hub->tail >= hub->ring_len) {
+        // the oldest sample belongs to the reader, so the newest one is lost
+        hub->stats.dropped++;
+        return;
+    }
+    hub->ring[head & (hub->ring_len - 1)] = *sample;
+    // the sample has to land before the reader can see the new head
+    __sync_synchronize();
+    hub->head = head + 1;
+    hub->stats.samples++;
+}
+
+static void sensor_hub_read_slot(sensor_hub_t *hub, int id, int64_t now)
+{
+    sensor_hub_slot_t *slot = &hub->slot[id];
+    sensor_hub_sample_t sample = { 0 };
+    if (!sensor_hub_ops_ok(&hub->ops[slot->read_op], slot->cfg.read_op_num)
+            || slot->cfg.read(slot->cfg.ctx, &sample) != ESP_OK) {
+        hub->stats.errors++;
+    } else {
+        sample.sensor = id;
+        sample.timestamp = slot->busy ? slot->ready : now;
+        sample.num = sample.num > SENSOR_HUB_VALUE_MAX ? SENSOR_HUB_VALUE_MAX : sample.num;
+        sensor_hub_publish(hub, &sample);
+    }
+    if (sensor_hub_free_running(slot)) {
+        sensor_hub_advance(hub, slot, now);
+    }
+    slot->busy = false;
+}
+
+static void sensor_hub_trigger_slot(sensor_hub_t *hub, sensor_hub_slot_t *slot, int64_t now)
+{
+    esp_err_t ret = ESP_OK;
+    if (slot->cfg.trigger_op_num > 0) {
+        ret = sensor_hub_ops_ok(&hub->ops[slot->trigger_op], slot->cfg.trigger_op_num) ? ESP_OK : ESP_FAIL;
+    } else {
+        ret = slot->cfg.trigger(slot->cfg.ctx);
+        now = hub->cfg.clock();
+    }
+    if (ret != ESP_OK) {
+        // try again next period
+        hub->stats.errors++;
+    } else {
+        // the conversion started somewhere in the batch, counting from its end is safe
+        slot->busy = true;
+        slot->ready = now + slot->cfg.conversion_us;
+    }
+    sensor_hub_advance(hub, slot, now);
+}
+
+/* One bus acquisition for the reads and triggers that are due on the bus of the first slot */
+static void sensor_hub_run_bus(sensor_hub_t *hub, int first, int64_t now, bool *done)
+{
+    i2c_bus_handle_t bus = hub->slot[first].cfg.bus;
+    int op_num = 0;
+
+    // finished conversions first, a sensor read now can be triggered again in the same batch
+    for (int i = first; i < hub->num; i++) {
+        sensor_hub_slot_t *slot = &hub->slot[i];
+        if (done[i] || slot->cfg.bus != bus) {
+            continue;
+        }
+        done[i] = true;
+        slot->read_due = slot->busy ? slot->ready <= now
+                         : (sensor_hub_free_running(slot) && slot->release <= now);
+        slot->trigger_due = !sensor_hub_free_running(slot) && (!slot->busy || slot->read_due)
+                            && slot->release <= now + hub->cfg.merge_us;
+        if (slot->read_due) {
+            slot->read_op = op_num;
+            memcpy(&hub->ops[op_num], slot->cfg.read_ops, slot->cfg.read_op_num * sizeof(i2c_bus_op_t));
+            op_num += slot->cfg.read_op_num;
+        }
+    }
+    for (int i = first; i < hub->num; i++) {
+        sensor_hub_slot_t *slot = &hub->slot[i];
+        if (slot->cfg.bus == bus && slot->trigger_due) {
+            slot->trigger_op = op_num;
+            memcpy(&hub->ops[op_num], slot->cfg.trigger_ops, slot->cfg.trigger_op_num * sizeof(i2c_bus_op_t));
+            op_num += slot->cfg.trigger_op_num;
+        }
+    }
+
+    if (op_num > 0) {
+        // on ESP_FAIL the per op results in ops[].ret tell the sensors that failed apart,
+        // any other error means the batch did not run and no op result can be trusted
+        esp_err_t ret = hub->cfg.batch(bus, hub->ops, op_num, SENSOR_HUB_BATCH_TICKS);
+        if (ret != ESP_OK && ret != ESP_FAIL) {
+            for (int i = 0; i < op_num; i++) {
+                hub->ops[i].ret = ret;
+            }
+        }
+        hub->stats.acquisitions++;
+        now = hub->cfg.clock();
+    }
+    for (int i = first; i < hub->num; i++) {
+        sensor_hub_slot_t *slot = &hub->slot[i];
+        if (slot->cfg.bus != bus) {
+            continue;
+        }
+        if (slot->read_due) {
+            sensor_hub_read_slot(hub, i, now);
+        }
+        if (slot->trigger_due) {
+            sensor_hub_trigger_slot(hub, slot, now);
+        }
+        slot->read_due = slot->trigger_due = false;
+    }
+}
+
+/* When to wake up for the bus of the first slot */
+static int64_t sensor_hub_next_bus(const sensor_hub_t *hub, int first, bool *done)
+{
+    i2c_bus_handle_t bus = hub->slot[first].cfg.bus;
+    int64_t next = INT64_MAX;
+    for (int i = first; i < hub->num; i++) {
+        const sensor_hub_slot_t *slot = &hub->slot[i];
+        if (slot->cfg.bus == bus) {
+            int64_t t = slot->busy ? slot->ready : slot->release;
+            next = t < next ? t : next;
+            done[i] = true;
+        }
+    }
+    // a read can't be moved earlier like a trigger, so wait up to merge_us for the
+    // other reads of the bus and take them all in one acquisition
+    int64_t wake = next;
+    for (int i = first; i < hub->num; i++) {
+        const sensor_hub_slot_t *slot = &hub->slot[i];
+        if (slot->cfg.bus == bus && (slot->busy || sensor_hub_free_running(slot))) {
+            int64_t t = slot->busy ? slot->ready : slot->release;
+            wake = t <= next + hub->cfg.merge_us && t > wake ? t : wake;
+        }
+    }
+    return wake;
+}
+
+int64_t iot_sensor_hub_poll(sensor_hub_handle_t hub_handle)
+{
+    sensor_hub_t *hub = (sensor_hub_t *) hub_handle;
+    bool done[SENSOR_HUB_SENSOR_MAX] = { false };
+    uint32_t samples = hub->stats.samples;
+    int64_t now = hub->cfg.clock();
+
+    if (!hub->primed) {
+        for (int i = 0; i < hub->num; i++) {
+            hub->slot[i].release = now;
+        }
+        hub->primed = true;
+    }
+    for (int i = 0; i < hub->num; i++) {
+        if (!done[i]) {
+            sensor_hub_run_bus(hub, i, now, done);
+        }
+    }
+    if (hub->stats.samples != samples) {
+        xSemaphoreGive(hub->data_sem);
+    }
+
+    int64_t next = hub->cfg.clock() + SENSOR_HUB_IDLE_US;
+    memset(done, 0, sizeof(done));
+    for (int i = 0; i < hub->num; i++) {
+        if (!done[i]) {
+            int64_t t = sensor_hub_next_bus(hub, i, done);
+            next = t < next ? t : next;
+        }
+    }
+    return next;
+}
+
+static void sensor_hub_timer_cb(void *arg)
+{
+    sensor_hub_t *hub = (sensor_hub_t *) arg;
+    xSemaphoreGive(hub->wake_sem);
+}
+
+static void sensor_hub_task(void *arg)
+{
+    sensor_hub_t *hub = (sensor_hub_t *) arg;
+    while (hub->run) {
+        int64_t wait = iot_sensor_hub_poll(hub) - hub->cfg.clock();
+        if (wait > 0) {
+            // the tick is far too coarse for conversion times, the timer wakes us to the microsecond
+            esp_timer_start_once(hub->timer, wait);
+            xSemaphoreTake(hub->wake_sem, portMAX_DELAY);
+            esp_timer_stop(hub->timer);
+        }
+    }
+    hub->task = NULL;
+    xSemaphoreGive(hub->exit_sem);
+    vTaskDelete(NULL);
+}
+
+sensor_hub_handle_t iot_sensor_hub_create(const sensor_hub_config_t *cfg)
+{
+    IOT_CHECK(TAG, cfg != NULL && cfg->ring_len >= 0, NULL);
+    sensor_hub_t *hub = (sensor_hub_t *) calloc(1, sizeof(sensor_hub_t));
+    IOT_CHECK(TAG, hub != NULL, NULL);
+    hub->cfg = *cfg;
+    hub->cfg.clock = cfg->clock ? cfg->clock : esp_timer_get_time;
+    hub->cfg.batch = cfg->batch ? cfg->batch : iot_i2c_bus_batch;
+    hub->cfg.task_priority = cfg->task_priority ? cfg->task_priority : SENSOR_HUB_TASK_PRIO;
+    hub->cfg.task_stack = cfg->task_stack ? cfg->task_stack : SENSOR_HUB_TASK_STACK;
+    // free running indices wrap cleanly only with a power of two length
+    hub->ring_len = 1;
+    while (hub->ring_len < (cfg->ring_len > 0 ? cfg->ring_len : SENSOR_HUB_RING_LEN_DEFAULT)) {
+        hub->ring_len <<= 1;
+    }
+    hub->ring = (sensor_hub_sample_t *) calloc(hub->ring_len, sizeof(sensor_hub_sample_t));
+    hub->data_sem = xSemaphoreCreateBinary();
+    hub->wake_sem = xSemaphoreCreateBinary();
+    hub->exit_sem = xSemaphoreCreateBinary();
+    if (hub->ring == NULL || hub->data_sem == NULL || hub->wake_sem == NULL || hub->exit_sem == NULL) {
+        ESP_LOGE(TAG, "sensor hub create fail");
+        iot_sensor_hub_delete(hub);
+        return NULL;
+    }
+    return (sensor_hub_handle_t) hub;
+}
+
+esp_err_t iot_sensor_hub_delete(sensor_hub_handle_t hub_handle)
+{
+    sensor_hub_t *hub = (sensor_hub_t *) hub_handle;
+    IOT_CHECK(TAG, hub != NULL, ESP_ERR_INVALID_ARG);
+    iot_sensor_hub_stop(hub);
+    if (hub->data_sem) {
+        vSemaphoreDelete(hub->data_sem);
+    }
+    if (hub->wake_sem) {
+        vSemaphoreDelete(hub->wake_sem);
+    }
+    if (hub->exit_sem) {
+        vSemaphoreDelete(hub->exit_sem);
+    }
+    free(hub->ring);
+    free(hub);
+    return ESP_OK;
+}
+
+int iot_sensor_hub_add(sensor_hub_handle_t hub_handle, const sensor_hub_sensor_config_t *sensor)
+{
+    sensor_hub_t *hub = (sensor_hub_t *) hub_handle;
+    IOT_CHECK(TAG, hub != NULL && sensor != NULL && sensor->read != NULL && sensor->period_us > 0, -1);
+    IOT_CHECK(TAG, sensor->trigger_op_num <= SENSOR_HUB_OP_MAX && sensor->read_op_num <= SENSOR_HUB_OP_MAX, -1);
+    // the schedule is laid out at the first poll
+    IOT_CHECK(TAG, hub->num < SENSOR_HUB_SENSOR_MAX && !hub->primed, -1);
+    sensor_hub_slot_t *slot = &hub->slot[hub->num];
+    memset(slot, 0, sizeof(sensor_hub_slot_t));
+    slot->cfg = *sensor;
+    return hub->num++;
+}
+
+esp_err_t iot_sensor_hub_start(sensor_hub_handle_t hub_handle)
+{
+    sensor_hub_t *hub = (sensor_hub_t *) hub_handle;
+    IOT_CHECK(TAG, hub != NULL, ESP_ERR_INVALID_ARG);
+    if (hub->task) {
+        return ESP_OK;
+    }
+    if (hub->timer == NULL) {
+        esp_timer_create_args_t timer_args = {
+            .callback = sensor_hub_timer_cb,
+            .arg = hub,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "sensor_hub",
+        };
+        if (esp_timer_create(&timer_args, &hub->timer) != ESP_OK) {
+            ESP_LOGE(TAG, "sensor hub timer create fail");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    hub->run = true;
+    if (xTaskCreate(sensor_hub_task, "sensor_hub", hub->cfg.task_stack, hub,
+            hub->cfg.task_priority, &hub->task) != pdPASS) {
+        ESP_LOGE(TAG, "sensor hub task create fail");
+        hub->run = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t iot_sensor_hub_stop(sensor_hub_handle_t hub_handle)
+{
+    sensor_hub_t *hub = (sensor_hub_t *) hub_handle;
+    IOT_CHECK(TAG, hub != NULL, ESP_ERR_INVALID_ARG);
+    if (hub->task) {
+        // Let the task finish its bus access and exit on its own
+        hub->run = false;
+        xSemaphoreGive(hub->wake_sem);
+        xSemaphoreTake(hub->exit_sem, portMAX_DELAY);
+    }
+    if (hub->timer) {
+        esp_timer_stop(hub->timer);
+        esp_timer_delete(hub->timer);
+        hub->timer = NULL;
+    }
+    for (int i = 0; i < hub->num; i++) {
+        hub->slot[i].busy = false;
+    }
+    // a restart lays out a new schedule
+    hub->primed = false;
+    return ESP_OK;
+}
+
+int iot_sensor_hub_read(sensor_hub_handle_t hub_handle, sensor_hub_sample_t *samples, int max_num, TickType_t ticks)
+{
+    sensor_hub_t *hub = (sensor_hub_t *) hub_handle;
+    int num = 0;
+    if (hub == NULL || samples == NULL) {
+        return 0;
+    }
+    // the semaphore may still be given for samples taken by an earlier call, so wait on
+    // until there is something to read or the time is up
+    TickType_t start = xTaskGetTickCount();
+    while (hub->head == hub->tail) {
+        TickType_t waited = xTaskGetTickCount() - start;
+        if (waited >= ticks || xSemaphoreTake(hub->data_sem, ticks - waited) != pdTRUE) {
+            break;
+        }
+    }
+    uint32_t tail = hub->tail;
+    uint32_t head = hub->head;
+    __sync_synchronize();
+    while (num < max_num && tail != head) {
+        samples[num++] = hub->ring[tail & (hub->ring_len - 1)];
+        tail++;
+    }
+    // done with the slots before the scheduler may reuse them
+    __sync_synchronize();
+    hub->tail = tail;
+    return num;
+}
+
+esp_err_t iot_sensor_hub_get_stats(sensor_hub_handle_t hub_handle, sensor_hub_stats_t *stats)
+{
+    sensor_hub_t *hub = (sensor_hub_t *) hub_handle;
+    IOT_CHECK(TAG, hub != NULL && stats != NULL, ESP_ERR_INVALID_ARG);
+    *stats = hub->stats;
+    return ESP_OK;
+}
@@ -0,0 +1,126 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <stdio.h>
+#include <string.h>
+#include "iot_sensor_hub_sim.h"
+
+#define SENSOR_HUB_SIM_REG_CMD      (0x00)
+#define SENSOR_HUB_SIM_REG_DATA     (0x01)
+
+static int64_t s_sim_clock = 0;
+
+int64_t iot_sensor_hub_sim_clock(void)
+{
+    return s_sim_clock;
+}
+
+void iot_sensor_hub_sim_set_clock(int64_t us)
+{
+    s_sim_clock = us > s_sim_clock ? us : s_sim_clock;
+}
+
+static void sensor_hub_sim_access(sensor_hub_sim_sensor_t *sim, i2c_bus_op_t *op)
+{
+    if (op->type == I2C_BUS_OP_WRITE) {
+        if (op->reg == SENSOR_HUB_SIM_REG_CMD && !sim->free_running) {
+            sim->triggered = true;
+            sim->ready = s_sim_clock + sim->conversion_us;
+        }
+        return;
+    }
+    uint32_t seq;
+    if (sim->free_running) {
+        // the results finished by now, a second read within one period gets the same one again
+        seq = (uint32_t) (s_sim_clock / sim->conversion_us);
+        sim->early += (seq == sim->results && sim->results > 0);
+        sim->results = seq;
+    } else if (sim->triggered && s_sim_clock >= sim->ready) {
+        sim->triggered = false;
+        seq = ++sim->results;
+    } else {
+        // a real sensor hands out the previous result
+        sim->early++;
+        seq = sim->results;
+    }
+    uint8_t out[sizeof(sim->data)] = { 0 };
+    memcpy(out, &seq, sizeof(seq));
+    memcpy(op->data, out, op->len < sim->len ? op->len : sim->len);
+}
+
+esp_err_t iot_sensor_hub_sim_batch(i2c_bus_handle_t bus, i2c_bus_op_t *ops, int op_num, portBASE_TYPE ticks_to_wait)
+{
+    sensor_hub_sim_bus_t *sim_bus = (sensor_hub_sim_bus_t *) bus;
+    if (sim_bus->error == ESP_FAIL) {
+        // like a NACK on every access of a batch without replay
+        for (int i = 0; i < op_num; i++) {
+            ops[i].ret = ESP_FAIL;
+        }
+        return ESP_FAIL;
+    } else if (sim_bus->error != ESP_OK) {
+        return sim_bus->error;
+    }
+    int64_t start = s_sim_clock;
+    s_sim_clock += sim_bus->batch_us;
+    for (int i = 0; i < op_num; i++) {
+        // a register access takes effect when its stop condition is sent
+        s_sim_clock += sim_bus->op_us + (int64_t) ops[i].len * sim_bus->byte_us;
+        sensor_hub_sim_access((sensor_hub_sim_sensor_t *) ops[i].dev, &ops[i]);
+        ops[i].ret = ESP_OK;
+    }
+    sim_bus->acquisitions++;
+    sim_bus->busy_us += s_sim_clock - start;
+    return ESP_OK;
+}
+
+static esp_err_t sensor_hub_sim_read(void *ctx, sensor_hub_sample_t *sample)
+{
+    sensor_hub_sim_sensor_t *sim = (sensor_hub_sim_sensor_t *) ctx;
+    uint32_t seq;
+    memcpy(&seq, sim->data, sizeof(seq));
+    sample->value[0] = seq;
+    sample->num = 1;
+    return ESP_OK;
+}
+
+void iot_sensor_hub_sim_sensor_init(sensor_hub_sim_sensor_t *sim, sensor_hub_sim_bus_t *bus,
+                                    uint32_t conversion_us, uint8_t len, bool free_running)
+{
+    memset(sim, 0, sizeof(sensor_hub_sim_sensor_t));
+    sim->bus = bus;
+    sim->conversion_us = conversion_us > 0 ? conversion_us : 1;
+    sim->len = len < 4 ? 4 : (len > sizeof(sim->data) ? sizeof(sim->data) : len);
+    sim->free_running = free_running;
+}
+
+void iot_sensor_hub_sim_sensor_config(sensor_hub_sim_sensor_t *sim, uint32_t period_us,
+                                      sensor_hub_sensor_config_t *cfg)
+{
+    memset(cfg, 0, sizeof(sensor_hub_sensor_config_t));
+    cfg->bus = sim->bus;
+    cfg->period_us = period_us;
+    if (!sim->free_running) {
+        cfg->conversion_us = sim->conversion_us;
+        cfg->trigger_ops[0] = (i2c_bus_op_t) {
+            .dev = sim, .type = I2C_BUS_OP_WRITE, .reg = SENSOR_HUB_SIM_REG_CMD, .data = &sim->cmd, .len = 1,
+        };
+        cfg->trigger_op_num = 1;
+    }
+    // the hub reads into the buffer of the sensor, like a driver would
+    cfg->read_ops[0] = (i2c_bus_op_t) {
+        .dev = sim, .type = I2C_BUS_OP_READ, .reg = SENSOR_HUB_SIM_REG_DATA, .data = sim->data, .len = sim->len,
+    };
+    cfg->read_op_num = 1;
+    cfg->read = sensor_hub_sim_read;
+    cfg->ctx = sim;
+}
@@ -0,0 +1,243 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "esp_timer.h"
+#include "iot_sensor_hub.h"
+#include "iot_sensor_hub_sim.h"
+
+#define HUB_TEST_TIME_US        (10 * 1000000)
+#define HUB_TEST_MERGE_US       (2000)
+
+/* A sensor board modelled on the drivers of this repo, two buses at 100 kHz */
+typedef struct {
+    const char *name;
+    int bus;
+    uint32_t conversion_us;
+    uint8_t len;
+    bool free_running;
+    uint32_t period_us;
+} hub_test_sensor_t;
+
+static const hub_test_sensor_t s_board[] = {
+    { "bme280",   0, 9300,   8, false, 50000 },
+    { "lis2dh12", 0, 10000,  6, true,  10000 },
+    { "hdc2010",  0, 1300,   4, false, 100000 },
+    { "hts221",   0, 4500,   4, false, 200000 },
+    { "bh1750",   1, 120000, 4, false, 200000 },
+    { "veml6040", 1, 40000,  8, true,  40000 },
+};
+#define HUB_TEST_SENSOR_NUM     (sizeof(s_board) / sizeof(s_board[0]))
+
+static sensor_hub_sim_bus_t s_bus[2];
+static sensor_hub_sim_sensor_t s_sim[HUB_TEST_SENSOR_NUM];
+
+static void hub_test_board_init(void)
+{
+    for (int i = 0; i < 2; i++) {
+        s_bus[i] = (sensor_hub_sim_bus_t) { .batch_us = 50, .op_us = 300, .byte_us = 90 };
+    }
+    for (int i = 0; i < HUB_TEST_SENSOR_NUM; i++) {
+        iot_sensor_hub_sim_sensor_init(&s_sim[i], &s_bus[s_board[i].bus], s_board[i].conversion_us,
+                                       s_board[i].len, s_board[i].free_running);
+    }
+}
+
+/* What the examples do today: one sensor after the other, waiting out each conversion */
+static void hub_test_sequential(uint32_t count[])
+{
+    int64_t end = iot_sensor_hub_sim_clock() + HUB_TEST_TIME_US;
+    while (iot_sensor_hub_sim_clock() < end) {
+        for (int i = 0; i < HUB_TEST_SENSOR_NUM; i++) {
+            sensor_hub_sensor_config_t cfg;
+            iot_sensor_hub_sim_sensor_config(&s_sim[i], s_board[i].period_us, &cfg);
+            if (cfg.trigger_op_num) {
+                iot_sensor_hub_sim_batch(cfg.bus, cfg.trigger_ops, cfg.trigger_op_num, 0);
+                iot_sensor_hub_sim_set_clock(iot_sensor_hub_sim_clock() + cfg.conversion_us);
+            }
+            iot_sensor_hub_sim_batch(cfg.bus, cfg.read_ops, cfg.read_op_num, 0);
+            count[i]++;
+        }
+    }
+}
+
+TEST_CASE("Sensor hub schedule benchmark", "[sensor_hub][iot]")
+{
+    static sensor_hub_sample_t samples[SENSOR_HUB_RING_LEN_DEFAULT];
+    uint32_t seq_count[HUB_TEST_SENSOR_NUM] = { 0 };
+    uint32_t hub_count[HUB_TEST_SENSOR_NUM] = { 0 };
+    float last_seq[HUB_TEST_SENSOR_NUM];
+    int64_t last_ts[HUB_TEST_SENSOR_NUM];
+
+    hub_test_board_init();
+    hub_test_sequential(seq_count);
+    uint32_t seq_acq = s_bus[0].acquisitions + s_bus[1].acquisitions;
+
+    hub_test_board_init();
+    sensor_hub_config_t hub_cfg = {
+        .ring_len = SENSOR_HUB_RING_LEN_DEFAULT,
+        .merge_us = HUB_TEST_MERGE_US,
+        .clock = iot_sensor_hub_sim_clock,
+        .batch = iot_sensor_hub_sim_batch,
+    };
+    sensor_hub_handle_t hub = iot_sensor_hub_create(&hub_cfg);
+    TEST_ASSERT_NOT_NULL(hub);
+    for (int i = 0; i < HUB_TEST_SENSOR_NUM; i++) {
+        sensor_hub_sensor_config_t cfg;
+        iot_sensor_hub_sim_sensor_config(&s_sim[i], s_board[i].period_us, &cfg);
+        TEST_ASSERT_EQUAL(i, iot_sensor_hub_add(hub, &cfg));
+        last_seq[i] = -1;
+        last_ts[i] = 0;
+    }
+
+    int64_t start = iot_sensor_hub_sim_clock();
+    int64_t cpu_us = 0;
+    int polls = 0;
+    while (iot_sensor_hub_sim_clock() < start + HUB_TEST_TIME_US) {
+        int64_t t0 = esp_timer_get_time();
+        int64_t next = iot_sensor_hub_poll(hub);
+        cpu_us += esp_timer_get_time() - t0;
+        polls++;
+        iot_sensor_hub_sim_set_clock(next);
+        int num = iot_sensor_hub_read(hub, samples, SENSOR_HUB_RING_LEN_DEFAULT, 0);
+        for (int i = 0; i < num; i++) {
+            int id = samples[i].sensor;
+            TEST_ASSERT(id < HUB_TEST_SENSOR_NUM);
+            TEST_ASSERT(samples[i].timestamp > last_ts[id]);
+            TEST_ASSERT(samples[i].value[0] > last_seq[id]);
+            last_ts[id] = samples[i].timestamp;
+            last_seq[id] = samples[i].value[0];
+            hub_count[id]++;
+        }
+    }
+    sensor_hub_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, iot_sensor_hub_get_stats(hub, &stats));
+    uint32_t hub_acq = s_bus[0].acquisitions + s_bus[1].acquisitions;
+
+    printf("%-10s %8s %10s %10s %6s\n", "sensor", "target", "sequential", "hub", "early");
+    for (int i = 0; i < HUB_TEST_SENSOR_NUM; i++) {
+        uint32_t target = HUB_TEST_TIME_US / s_board[i].period_us;
+        printf("%-10s %8u %10u %10u %6u\n", s_board[i].name, target, seq_count[i], hub_count[i], s_sim[i].early);
+        TEST_ASSERT_EQUAL(0, s_sim[i].early);
+        TEST_ASSERT_INT_WITHIN(1, target, hub_count[i]);
+    }
+    printf("bus acquisitions: sequential %u, hub %u for %u samples\n", seq_acq, hub_acq, stats.samples);
+    printf("bus busy: %.1f%% / %.1f%%, %.2f us cpu per poll\n", s_bus[0].busy_us * 100.0 / HUB_TEST_TIME_US,
+           s_bus[1].busy_us * 100.0 / HUB_TEST_TIME_US, (float) cpu_us / polls);
+    TEST_ASSERT_EQUAL(0, stats.overruns);
+    TEST_ASSERT_EQUAL(0, stats.errors);
+    TEST_ASSERT_EQUAL(0, stats.dropped);
+    // fewer acquisitions than results, reads share them and not only reads with triggers
+    TEST_ASSERT(hub_acq < stats.samples);
+    TEST_ASSERT_EQUAL(ESP_OK, iot_sensor_hub_delete(hub));
+}
+
+TEST_CASE("Sensor hub ring test", "[sensor_hub][iot]")
+{
+    sensor_hub_sample_t samples[8];
+    sensor_hub_sensor_config_t cfg;
+    sensor_hub_stats_t stats;
+    sensor_hub_config_t hub_cfg = {
+        .ring_len = 5,
+        .clock = iot_sensor_hub_sim_clock,
+        .batch = iot_sensor_hub_sim_batch,
+    };
+
+    hub_test_board_init();
+    sensor_hub_handle_t hub = iot_sensor_hub_create(&hub_cfg);
+    TEST_ASSERT_NOT_NULL(hub);
+    iot_sensor_hub_sim_sensor_config(&s_sim[1], 10000, &cfg);
+    cfg.period_us = 0;
+    TEST_ASSERT_EQUAL(-1, iot_sensor_hub_add(hub, &cfg));
+    cfg.period_us = 10000;
+    TEST_ASSERT_EQUAL(0, iot_sensor_hub_add(hub, &cfg));
+
+    // nobody reads, the ring of 8 fills up and the newest samples are lost
+    for (int i = 0; i < 20; i++) {
+        iot_sensor_hub_sim_set_clock(iot_sensor_hub_poll(hub));
+    }
+    TEST_ASSERT_EQUAL(-1, iot_sensor_hub_add(hub, &cfg));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_sensor_hub_get_stats(hub, &stats));
+    TEST_ASSERT_EQUAL(8, stats.samples);
+    TEST_ASSERT_EQUAL(12, stats.dropped);
+
+    TEST_ASSERT_EQUAL(5, iot_sensor_hub_read(hub, samples, 5, 0));
+    TEST_ASSERT_EQUAL(3, iot_sensor_hub_read(hub, samples + 5, 8, 0));
+    for (int i = 1; i < 8; i++) {
+        TEST_ASSERT_EQUAL(samples[i - 1].timestamp + 10000, samples[i].timestamp);
+    }
+    TEST_ASSERT_EQUAL(0, iot_sensor_hub_read(hub, samples, 8, 0));
+
+    // room again, and the indices wrap around the ring
+    for (int i = 0; i < 12; i++) {
+        iot_sensor_hub_sim_set_clock(iot_sensor_hub_poll(hub));
+        TEST_ASSERT_EQUAL(1, iot_sensor_hub_read(hub, samples, 8, 0));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, iot_sensor_hub_delete(hub));
+}
+
+TEST_CASE("Sensor hub bus error test", "[sensor_hub][iot]")
+{
+    static const esp_err_t errors[] = { ESP_ERR_TIMEOUT, ESP_FAIL };
+    sensor_hub_sample_t samples[8];
+    sensor_hub_sensor_config_t cfg;
+    sensor_hub_stats_t stats;
+    sensor_hub_config_t hub_cfg = {
+        .clock = iot_sensor_hub_sim_clock,
+        .batch = iot_sensor_hub_sim_batch,
+    };
+
+    hub_test_board_init();
+    sensor_hub_handle_t hub = iot_sensor_hub_create(&hub_cfg);
+    TEST_ASSERT_NOT_NULL(hub);
+    for (int i = 0; i < 2; i++) {
+        iot_sensor_hub_sim_sensor_config(&s_sim[i], s_board[i].period_us, &cfg);
+        TEST_ASSERT_EQUAL(i, iot_sensor_hub_add(hub, &cfg));
+    }
+
+    for (int e = 0; e < sizeof(errors) / sizeof(errors[0]); e++) {
+        for (int i = 0; i < 20; i++) {
+            iot_sensor_hub_sim_set_clock(iot_sensor_hub_poll(hub));
+        }
+        while (iot_sensor_hub_read(hub, samples, 8, 0) > 0) {
+        }
+        TEST_ASSERT_EQUAL(ESP_OK, iot_sensor_hub_get_stats(hub, &stats));
+        uint32_t good = stats.samples;
+        uint32_t errs = stats.errors;
+
+        // nothing comes out of a bus that fails, however the batch reports it
+        s_bus[0].error = errors[e];
+        for (int i = 0; i < 20; i++) {
+            int64_t next = iot_sensor_hub_poll(hub);
+            TEST_ASSERT(next > iot_sensor_hub_sim_clock());
+            iot_sensor_hub_sim_set_clock(next);
+            TEST_ASSERT_EQUAL(0, iot_sensor_hub_read(hub, samples, 8, 0));
+        }
+        TEST_ASSERT_EQUAL(ESP_OK, iot_sensor_hub_get_stats(hub, &stats));
+        TEST_ASSERT_EQUAL(good, stats.samples);
+        TEST_ASSERT(stats.errors >= errs + 20);
+
+        // and the schedule goes on once the bus is back
+        s_bus[0].error = ESP_OK;
+        for (int i = 0; i < 20; i++) {
+            iot_sensor_hub_sim_set_clock(iot_sensor_hub_poll(hub));
+        }
+        TEST_ASSERT_EQUAL(ESP_OK, iot_sensor_hub_get_stats(hub, &stats));
+        TEST_ASSERT(stats.samples > good);
+    }
+    TEST_ASSERT_EQUAL(0, s_sim[0].early);
+    TEST_ASSERT_EQUAL(0, s_sim[1].early);
+    TEST_ASSERT_EQUAL(ESP_OK, iot_sensor_hub_delete(hub));
+}
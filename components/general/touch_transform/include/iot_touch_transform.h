@@ -0,0 +1,117 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef _IOT_TOUCH_TRANSFORM_H_
+#define _IOT_TOUCH_TRANSFORM_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TOUCH_TRANSFORM_SHIFT   (16)    /*!< fraction bits of the matrix */
+
+/**
+ * @brief Screen rotation, the same convention as the display drivers
+ */
+typedef enum {
+    TOUCH_ROTATE_0 = 0,
+    TOUCH_ROTATE_90,
+    TOUCH_ROTATE_180,
+    TOUCH_ROTATE_270,
+} touch_rotate_t;
+
+/**
+ * @brief 3 point calibration result, maps raw readings to the unrotated screen
+ *
+ * Same layout as the calibration saved by the GUI libraries:
+ * x = ax * raw_x + bx * raw_y + cx, y = ay * raw_x + by * raw_y + cy
+ */
+typedef struct {
+    float ax;
+    float bx;
+    float cx;
+    float ay;
+    float by;
+    float cy;
+} touch_calibration_t;
+
+/**
+ * @brief Fixed point 2x3 matrix, calibration, rotation and scaling in one
+ */
+typedef struct {
+    int32_t xx;     /*!< raw x weight of screen x */
+    int32_t xy;     /*!< raw y weight of screen x */
+    int32_t x0;     /*!< screen x offset, rounding included */
+    int32_t yx;     /*!< raw x weight of screen y */
+    int32_t yy;     /*!< raw y weight of screen y */
+    int32_t y0;     /*!< screen y offset, rounding included */
+} touch_transform_t;
+
+/**
+ * @brief Build the transform from a calibration and the screen rotation
+ *
+ * @param tf transform to fill
+ * @param cal calibration of the unrotated screen
+ * @param rotate screen rotation
+ * @param hor_res horizontal resolution of the rotated screen
+ * @param ver_res vertical resolution of the rotated screen
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG The matrix doesn't fit in fixed point
+ */
+esp_err_t iot_touch_transform_init(touch_transform_t *tf, const touch_calibration_t *cal, touch_rotate_t rotate,
+                                   int hor_res, int ver_res);
+
+/**
+ * @brief Build the transform for a panel that needs no calibration, only scaling
+ *
+ * Raw readings 0 ~ raw_w - 1 and 0 ~ raw_h - 1 are stretched edge to edge over the unrotated screen.
+ *
+ * @param tf transform to fill
+ * @param raw_w raw x range of the panel
+ * @param raw_h raw y range of the panel
+ * @param rotate screen rotation
+ * @param hor_res horizontal resolution of the rotated screen
+ * @param ver_res vertical resolution of the rotated screen
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG The matrix doesn't fit in fixed point
+ */
+esp_err_t iot_touch_transform_init_scale(touch_transform_t *tf, int raw_w, int raw_h, touch_rotate_t rotate,
+                                         int hor_res, int ver_res);
+
+/**
+ * @brief Map a raw reading to a screen point
+ *
+ * @param tf transform
+ * @param x raw x in, screen x out
+ * @param y raw y in, screen y out
+ */
+static inline void iot_touch_transform_apply(const touch_transform_t *tf, int32_t *x, int32_t *y)
+{
+    int64_t sx = (int64_t) tf->xx * *x + (int64_t) tf->xy * *y + tf->x0;
+    int64_t sy = (int64_t) tf->yx * *x + (int64_t) tf->yy * *y + tf->y0;
+    *x = (int32_t) (sx >> TOUCH_TRANSFORM_SHIFT);
+    *y = (int32_t) (sy >> TOUCH_TRANSFORM_SHIFT);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include "unity.h"
+#include "iot_touch_transform.h"
+
+typedef struct {
+    const char *name;
+    touch_calibration_t cal;
+    int raw_min;        /*!< raw readings that land on the panel */
+    int raw_max;
+    int raw_step;       /*!< sweep step, below one pixel */
+    int w;              /*!< unrotated screen size */
+    int h;
+} test_panel_t;
+
+static const test_panel_t test_panels[] = {
+    /* XPT2046 on a 320x240 screen, mounted slightly skewed */
+    { "resistive", { 0.0872f, 0.0013f, -18.37f, -0.0009f, 0.0671f, -14.82f }, 180, 3920, 7, 320, 240 },
+    /* FT5x06 on an 800x480 screen, close to identity */
+    { "capacitive", { 1.0031f, -0.0042f, 1.71f, 0.0027f, 0.9968f, -2.35f }, 0, 810, 2, 800, 480 },
+};
+
+/* The per-sample path the adapters used to run: float calibration, then rotation */
+static void test_float_path(const touch_calibration_t *cal, touch_rotate_t rotate, int hor_res, int ver_res,
+                            float *x, float *y)
+{
+    float u = cal->ax * *x + cal->bx * *y + cal->cx;
+    float v = cal->ay * *x + cal->by * *y + cal->cy;
+    switch (rotate) {
+        case TOUCH_ROTATE_90:
+            *x = hor_res - 1 - v;
+            *y = u;
+            break;
+        case TOUCH_ROTATE_180:
+            *x = hor_res - 1 - u;
+            *y = ver_res - 1 - v;
+            break;
+        case TOUCH_ROTATE_270:
+            *x = v;
+            *y = ver_res - 1 - u;
+            break;
+        default:
+            *x = u;
+            *y = v;
+            break;
+    }
+}
+
+TEST_CASE("Touch transform accuracy test", "[touch_transform][iot]")
+{
+    for (int p = 0; p < sizeof(test_panels) / sizeof(test_panels[0]); p++) {
+        const test_panel_t *panel = &test_panels[p];
+        for (touch_rotate_t rotate = TOUCH_ROTATE_0; rotate <= TOUCH_ROTATE_270; rotate++) {
+            bool swap = (rotate == TOUCH_ROTATE_90 || rotate == TOUCH_ROTATE_270);
+            int hor_res = swap ? panel->h : panel->w;
+            int ver_res = swap ? panel->w : panel->h;
+            touch_transform_t tf;
+            TEST_ASSERT_EQUAL(ESP_OK, iot_touch_transform_init(&tf, &panel->cal, rotate, hor_res, ver_res));
+
+            float max_err = 0;
+            int cnt = 0;
+            for (int ry = panel->raw_min; ry <= panel->raw_max; ry += panel->raw_step) {
+                for (int rx = panel->raw_min; rx <= panel->raw_max; rx += panel->raw_step) {
+                    float fx = rx, fy = ry;
+                    int32_t x = rx, y = ry;
+                    test_float_path(&panel->cal, rotate, hor_res, ver_res, &fx, &fy);
+                    iot_touch_transform_apply(&tf, &x, &y);
+                    max_err = fmaxf(max_err, fmaxf(fabsf(x - fx), fabsf(y - fy)));
+                    cnt++;
+                }
+            }
+            printf("%s rotate %d: %d samples, max error %.3f px\n", panel->name, rotate * 90, cnt, max_err);
+            // Half a pixel of rounding, plus 1/16 pixel of Q16 coefficients over a 12 bit range
+            TEST_ASSERT(max_err <= 0.5f + 0.0625f);
+        }
+    }
+}
+
+TEST_CASE("Touch transform scale test", "[touch_transform][iot]")
+{
+    touch_transform_t tf;
+    int32_t x, y;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, iot_touch_transform_init_scale(&tf, 0, 4096, TOUCH_ROTATE_0, 320, 240));
+
+    /* Corners of a 12 bit panel land on the screen corners */
+    TEST_ASSERT_EQUAL(ESP_OK, iot_touch_transform_init_scale(&tf, 4096, 4096, TOUCH_ROTATE_0, 320, 240));
+    x = 0, y = 0;
+    iot_touch_transform_apply(&tf, &x, &y);
+    TEST_ASSERT_EQUAL_INT32(0, x);
+    TEST_ASSERT_EQUAL_INT32(0, y);
+    x = 4095, y = 4095;
+    iot_touch_transform_apply(&tf, &x, &y);
+    TEST_ASSERT_EQUAL_INT32(319, x);
+    TEST_ASSERT_EQUAL_INT32(239, y);
+
+    /* Rotated by 90 degrees, the raw x axis runs down the screen */
+    TEST_ASSERT_EQUAL(ESP_OK, iot_touch_transform_init_scale(&tf, 4096, 4096, TOUCH_ROTATE_90, 240, 320));
+    x = 4095, y = 0;
+    iot_touch_transform_apply(&tf, &x, &y);
+    TEST_ASSERT_EQUAL_INT32(239, x);
+    TEST_ASSERT_EQUAL_INT32(319, y);
+}
@@ -0,0 +1,110 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
+#include "esp_log.h"
+#include "iot_touch_transform.h"
+
+#define TOUCH_TRANSFORM_ONE     ((double) (1 << TOUCH_TRANSFORM_SHIFT))
+
+static const char* TAG = "touch_transform";
+
+static bool touch_transform_fixed(double val, int32_t *fixed)
+{
+    double f = round(val * TOUCH_TRANSFORM_ONE);
+    if (f > INT32_MAX || f < INT32_MIN) {
+        return false;
+    }
+    *fixed = (int32_t) f;
+    return true;
+}
+
+esp_err_t iot_touch_transform_init(touch_transform_t *tf, const touch_calibration_t *cal, touch_rotate_t rotate,
+                                   int hor_res, int ver_res)
+{
+    /* Rows of the calibration, they give the unrotated screen point (u, v) */
+    double u[3] = { cal->ax, cal->bx, cal->cx };
+    double v[3] = { cal->ay, cal->by, cal->cy };
+    double x[3], y[3];
+
+    /* Fold the rotation of the display drivers into the rows */
+    switch (rotate) {
+        case TOUCH_ROTATE_90:
+            // x = hor_res - 1 - v, y = u
+            for (int i = 0; i < 3; i++) {
+                x[i] = -v[i];
+                y[i] = u[i];
+            }
+            x[2] += hor_res - 1;
+            break;
+        case TOUCH_ROTATE_180:
+            // x = hor_res - 1 - u, y = ver_res - 1 - v
+            for (int i = 0; i < 3; i++) {
+                x[i] = -u[i];
+                y[i] = -v[i];
+            }
+            x[2] += hor_res - 1;
+            y[2] += ver_res - 1;
+            break;
+        case TOUCH_ROTATE_270:
+            // x = v, y = ver_res - 1 - u
+            for (int i = 0; i < 3; i++) {
+                x[i] = v[i];
+                y[i] = -u[i];
+            }
+            y[2] += ver_res - 1;
+            break;
+        case TOUCH_ROTATE_0:
+        default:
+            for (int i = 0; i < 3; i++) {
+                x[i] = u[i];
+                y[i] = v[i];
+            }
+            break;
+    }
+    /* Round to nearest instead of truncating, the half is added to the offsets once here */
+    x[2] += 0.5;
+    y[2] += 0.5;
+
+    touch_transform_t t;
+    if (!touch_transform_fixed(x[0], &t.xx) || !touch_transform_fixed(x[1], &t.xy) || !touch_transform_fixed(x[2], &t.x0)
+        || !touch_transform_fixed(y[0], &t.yx) || !touch_transform_fixed(y[1], &t.yy) || !touch_transform_fixed(y[2], &t.y0)) {
+        ESP_LOGE(TAG, "calibration out of fixed point range");
+        return ESP_ERR_INVALID_ARG;
+    }
+    *tf = t;
+    return ESP_OK;
+}
+
+esp_err_t iot_touch_transform_init_scale(touch_transform_t *tf, int raw_w, int raw_h, touch_rotate_t rotate,
+                                         int hor_res, int ver_res)
+{
+    if (raw_w < 2 || raw_h < 2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    /* Size of the unrotated screen */
+    bool swap = (rotate == TOUCH_ROTATE_90 || rotate == TOUCH_ROTATE_270);
+    int w = swap ? ver_res : hor_res;
+    int h = swap ? hor_res : ver_res;
+    touch_calibration_t cal = {
+        .ax = (float) (w - 1) / (raw_w - 1),
+        .bx = 0,
+        .cx = 0,
+        .ay = 0,
+        .by = (float) (h - 1) / (raw_h - 1),
+        .cy = 0,
+    };
+    return iot_touch_transform_init(tf, &cal, rotate, hor_res, ver_res);
+}
@@ -6,7 +6,7 @@
 ifdef CONFIG_UGFX_GUI_ENABLE
 
     ifndef CONFIG_UGFX_USE_CUSTOM_DRIVER
-        COMPONENT_SRCDIRS := 
+        COMPONENT_SRCDIRS := ./gdisp/region
         COMPONENT_ADD_INCLUDEDIRS := . \
             ./include \
 
@@ -81,7 +81,7 @@ else
     ifdef CONFIG_LVGL_GUI_ENABLE
 
         ifndef CONFIG_LVGL_USE_CUSTOM_DRIVER
-            COMPONENT_SRCDIRS := 
+            COMPONENT_SRCDIRS := ./gdisp/region ./gdisp/lvgl
             COMPONENT_ADD_INCLUDEDIRS := . \
                 ./include \
 
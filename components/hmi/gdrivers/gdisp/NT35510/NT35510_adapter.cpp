@@ -28,6 +28,7 @@
 #include "i2s_lcd_com.h"
 #include "iot_nt35510.h"
 #include "lcd_adapter.h"
+#include "disp_region.h"
 
 /* ESP Includes */
 #include "esp_log.h"
@@ -36,20 +37,44 @@
 #include "sdkconfig.h"
 
 static nt35510_handle_t nt35510_handle = NULL;
-static uint16_t *pFrameBuffer = NULL;
+
+/* Restarting the I2S DMA for a new window costs about as much as sending this many pixels */
+#define NT35510_REGION_SETUP_COST   (256)
+
+/* Send an area of the frame buffer, as whole lines in one transfer when that is cheaper than line by line */
+static void lcd_flush_rect(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *frame, int16_t stride)
+{
+    if (NT35510_REGION_SETUP_COST + h * stride <= h * (NT35510_REGION_SETUP_COST + w)) {
+        iot_nt35510_draw_bmp(nt35510_handle, (uint16_t *)(frame + y * stride), 0, y, stride, h);
+    } else {
+        for (int i = 0; i < h; i++) {
+            iot_nt35510_draw_bmp(nt35510_handle, (uint16_t *)(frame + (y + i) * stride + x), x, y + i, w, 1);
+        }
+    }
+}
 
 #if CONFIG_UGFX_DRIVER_AUTO_FLUSH_ENABLE
 SemaphoreHandle_t flush_sem = NULL;
-static uint16_t flush_width;
-static uint16_t flush_height;
+static portMUX_TYPE flush_mux = portMUX_INITIALIZER_UNLOCKED;
+static disp_region_t flush_dirty;
+static const uint16_t *flush_frame;
+static int16_t flush_stride;
 
 void board_lcd_flush_task(void *arg)
 {
     portBASE_TYPE res;
+    disp_region_t dirty;
     while (1) {
         res = xSemaphoreTake(flush_sem, portMAX_DELAY);
         if (res == pdTRUE) {
-            iot_nt35510_draw_bmp(nt35510_handle, (uint16_t *)pFrameBuffer, 0, 0, flush_width, flush_height);
+            portENTER_CRITICAL(&flush_mux);
+            dirty = flush_dirty;
+            disp_region_clear(&flush_dirty);
+            portEXIT_CRITICAL(&flush_mux);
+            disp_region_merge(&dirty);
+            for (int i = 0; i < dirty.num; i++) {
+                lcd_flush_rect(dirty.rect[i].x, dirty.rect[i].y, dirty.rect[i].w, dirty.rect[i].h, flush_frame, flush_stride);
+            }
             vTaskDelay(CONFIG_UGFX_DRIVER_AUTO_FLUSH_INTERVAL / portTICK_RATE_MS);
         }
     }
@@ -90,21 +115,29 @@ void board_lcd_init()
     if (flush_sem == NULL) {
         flush_sem = xSemaphoreCreateBinary();
     }
-    xTaskCreate(board_lcd_flush_task, "flush_task", 1500, NULL, 5, NULL);
+    disp_region_init(&flush_dirty, NT35510_REGION_SETUP_COST);
+    xTaskCreate(board_lcd_flush_task, "flush_task", 2048, NULL, 5, NULL);
 #endif
 }
 
 #endif
 
 void board_lcd_flush(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h)
+{
+    iot_nt35510_draw_bmp(nt35510_handle, bitmap, x, y, w, h);
+}
+
+void board_lcd_flush_area(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *frame, int16_t stride)
 {
 #if CONFIG_UGFX_DRIVER_AUTO_FLUSH_ENABLE
-    flush_width = w;
-    flush_height = h;
-    pFrameBuffer = bitmap;
+    portENTER_CRITICAL(&flush_mux);
+    disp_region_add(&flush_dirty, x, y, w, h);
+    flush_frame = frame;
+    flush_stride = stride;
+    portEXIT_CRITICAL(&flush_mux);
     xSemaphoreGive(flush_sem);
 #else
-    iot_nt35510_draw_bmp(nt35510_handle, bitmap, x, y, w, h);
+    lcd_flush_rect(x, y, w, h, frame, stride);
 #endif
 }
 
@@ -172,13 +205,10 @@ void board_lcd_set_orientation(uint16_t orientation)
 /* lvgl include */
 #include "lvgl_disp_config.h"
 
-/*Write the internal buffer (VDB) to the display. 'lv_flush_ready()' has to be called when finished*/
-void ex_disp_flush(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const lv_color_t *color_p)
+/*Write the internal buffer (VDB) to the display, lvgl_disp_flush calls 'lv_flush_ready()' once it returns*/
+static void ex_disp_send(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const lv_color_t *color_p)
 {
     iot_nt35510_draw_bmp(nt35510_handle, (uint16_t *)color_p, (uint16_t)x1, (uint16_t)y1, (uint16_t)(x2 - x1 + 1), (uint16_t)(y2 - y1 + 1));
-    /* IMPORTANT!!!
-     * Inform the graphics library that you are ready with the flushing*/
-    lv_flush_ready();
 }
 
 /*Fill an area with a color on the display*/
@@ -239,7 +269,8 @@ lv_disp_drv_t lvgl_lcd_display_init()
 
     /* Set up the functions to access to your display */
     if (LV_VDB_SIZE != 0) {
-        disp_drv.disp_flush = ex_disp_flush; /*Used in buffered mode (LV_VDB_SIZE != 0  in lv_conf.h)*/
+        lvgl_disp_flush_init(ex_disp_send);
+        disp_drv.disp_flush = lvgl_disp_flush; /*Used in buffered mode (LV_VDB_SIZE != 0  in lv_conf.h)*/
     } else if (LV_VDB_SIZE == 0) {
         disp_drv.disp_fill = ex_disp_fill; /*Used in unbuffered mode (LV_VDB_SIZE == 0  in lv_conf.h)*/
         disp_drv.disp_map = ex_disp_map;   /*Used in unbuffered mode (LV_VDB_SIZE == 0  in lv_conf.h)*/
@@ -46,6 +46,22 @@ void board_lcd_init();
  */
 void board_lcd_flush(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h);
 
+/**
+ * @brief Flush the specified area of a frame buffer at (x,y),
+ *        the width of the specified area is w, the height of the specified area is h.
+ *        With auto flush enabled, the area is merged into the pending areas
+ *        and sent later by the flush task.
+ *
+ * @param x The ordinate of the starting point of the specified area.
+ * @param y The abscissa of the starting point of the specified region.
+ * @param w the width of the specified area.
+ * @param h the height of the specified area.
+ * @param frame The frame buffer, pixel (x,y) is frame[y * stride + x].
+ * @param stride The number of pixels in one line of the frame buffer.
+ */
+void board_lcd_flush_area(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *frame, int16_t stride);
+#define BOARD_LCD_FLUSH_AREA_SUPPORTED    (1)
+
 /**
  * @brief Fill an area using a bitmap
  * @pre GDISP_HARDWARE_BITFILLS is GFXON
@@ -27,6 +27,7 @@
 #include "ST7789.h"
 #include "iot_lcd.h"
 #include "lcd_adapter.h"
+#include "disp_region.h"
 
 /* ESP Includes */
 #include "esp_log.h"
@@ -37,7 +38,6 @@
 class CEspLcdAdapter : public CEspLcd
 {
 public:
-    const uint16_t *pFrameBuffer = NULL;
     CEspLcdAdapter(lcd_conf_t *lcd_conf, int height = LCD_TFTHEIGHT, int width = LCD_TFTWIDTH, bool dma_en = true, int dma_word_size = 1024, int dma_chan = 1) : CEspLcd(lcd_conf, height, width, dma_en, dma_word_size, dma_chan)
     {
         /* Code here*/
@@ -72,21 +72,32 @@ static CEspLcdAdapter *lcd_obj = NULL;
 
 #if CONFIG_UGFX_DRIVER_AUTO_FLUSH_ENABLE
 SemaphoreHandle_t flush_sem = NULL;
-static uint16_t flush_width;
-static uint16_t flush_height;
+static portMUX_TYPE flush_mux = portMUX_INITIALIZER_UNLOCKED;
+static disp_region_t flush_dirty;
+static const uint16_t *flush_frame;
+static int16_t flush_stride;
 
 void board_lcd_flush_task(void *arg)
 {
     portBASE_TYPE res;
+    disp_region_t dirty;
     while (1) {
         res = xSemaphoreTake(flush_sem, portMAX_DELAY);
         if (res == pdTRUE) {
-            lcd_obj->drawBitmap(0, 0, (const uint16_t *)lcd_obj->pFrameBuffer, flush_width, flush_height);
+            portENTER_CRITICAL(&flush_mux);
+            dirty = flush_dirty;
+            disp_region_clear(&flush_dirty);
+            portEXIT_CRITICAL(&flush_mux);
+            disp_region_merge(&dirty);
+            for (int i = 0; i < dirty.num; i++) {
+                disp_rect_t *r = &dirty.rect[i];
+                lcd_obj->drawBitmap(r->x, r->y, flush_frame + r->y * flush_stride + r->x, r->w, r->h, flush_stride);
+            }
             vTaskDelay(CONFIG_UGFX_DRIVER_AUTO_FLUSH_INTERVAL / portTICK_RATE_MS);
         }
     }
 }
-#endif
+#endif /* CONFIG_UGFX_DRIVER_AUTO_FLUSH_ENABLE */
 
 #ifdef CONFIG_UGFX_GUI_ENABLE
 
@@ -119,21 +130,29 @@ void board_lcd_init()
     if (flush_sem == NULL) {
         flush_sem = xSemaphoreCreateBinary();
     }
-    xTaskCreate(board_lcd_flush_task, "flush_task", 1500, NULL, 5, NULL);
+    disp_region_init(&flush_dirty, DISP_REGION_SETUP_COST);
+    xTaskCreate(board_lcd_flush_task, "flush_task", 2048, NULL, 5, NULL);
 #endif
 }
 
 #endif
 
 void board_lcd_flush(int16_t x, int16_t y, const uint16_t *bitmap, int16_t w, int16_t h)
+{
+    lcd_obj->drawBitmap(x, y, bitmap, w, h);
+}
+
+void board_lcd_flush_area(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *frame, int16_t stride)
 {
 #if CONFIG_UGFX_DRIVER_AUTO_FLUSH_ENABLE
-    flush_width = w;
-    flush_height = h;
-    lcd_obj->pFrameBuffer = bitmap;
+    portENTER_CRITICAL(&flush_mux);
+    disp_region_add(&flush_dirty, x, y, w, h);
+    flush_frame = frame;
+    flush_stride = stride;
+    portEXIT_CRITICAL(&flush_mux);
     xSemaphoreGive(flush_sem);
 #else
-    lcd_obj->drawBitmap(x, y, bitmap, w, h);
+    lcd_obj->drawBitmap(x, y, frame + y * stride + x, w, h, stride);
 #endif
 }
 
@@ -206,13 +225,10 @@ void board_lcd_set_orientation(uint16_t orientation)
 /* lvgl include */
 #include "lvgl_disp_config.h"
 
-/*Write the internal buffer (VDB) to the display. 'lv_flush_ready()' has to be called when finished*/
-void ex_disp_flush(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const lv_color_t *color_p)
+/*Write the internal buffer (VDB) to the display, lvgl_disp_flush calls 'lv_flush_ready()' once it returns*/
+static void ex_disp_send(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const lv_color_t *color_p)
 {
     lcd_obj->drawBitmap((int16_t)x1, (int16_t)y1, (const uint16_t *)color_p, (int16_t)(x2 - x1 + 1), (int16_t)(y2 - y1 + 1));
-    /* IMPORTANT!!!
-     * Inform the graphics library that you are ready with the flushing*/
-    lv_flush_ready();
 }
 
 /*Fill an area with a color on the display*/
@@ -269,7 +285,8 @@ lv_disp_drv_t lvgl_lcd_display_init()
 
     /* Set up the functions to access to your display */
     if (LV_VDB_SIZE != 0) {
-        disp_drv.disp_flush = ex_disp_flush; /*Used in buffered mode (LV_VDB_SIZE != 0  in lv_conf.h)*/
+        lvgl_disp_flush_init(ex_disp_send);
+        disp_drv.disp_flush = lvgl_disp_flush; /*Used in buffered mode (LV_VDB_SIZE != 0  in lv_conf.h)*/
     } else if (LV_VDB_SIZE == 0) {
         disp_drv.disp_fill = ex_disp_fill; /*Used in unbuffered mode (LV_VDB_SIZE == 0  in lv_conf.h)*/
         disp_drv.disp_map = ex_disp_map;   /*Used in unbuffered mode (LV_VDB_SIZE == 0  in lv_conf.h)*/
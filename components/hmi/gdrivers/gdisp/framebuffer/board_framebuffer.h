@@ -15,6 +15,7 @@
 /* Disp Includes */
 #include "gdisp_lld_config.h"
 #include "lcd_adapter.h"
+#include "disp_region.h"
 
 /* uGFX Include */
 #include "sdkconfig.h"
@@ -46,11 +47,22 @@ static void board_init(GDisplay *g, fbInfo_t *fbi)
 }
 
 #if GDISP_HARDWARE_FLUSH
-static void board_flush(GDisplay *g)
+static void board_flush(GDisplay *g, disp_region_t *dirty)
 {
-    // TODO: Can be an empty function if your hardware doesn't support this
-    (void) g;
-    board_lcd_flush(0, 0, p_frame, g->g.Width, g->g.Height);
+#ifdef BOARD_LCD_FLUSH_AREA_SUPPORTED
+    // Only the changed areas are sent, an unchanged frame leaves the bus idle
+    disp_region_merge(dirty);
+    for (int i = 0; i < dirty->num; i++) {
+        disp_rect_t *r = &dirty->rect[i];
+        board_lcd_flush_area(r->x, r->y, r->w, r->h, p_frame, g->g.Width);
+    }
+#else
+    // The adapter only takes whole frames, still skip the unchanged ones
+    if (dirty->num > 0) {
+        board_lcd_flush(0, 0, p_frame, g->g.Width, g->g.Height);
+    }
+#endif
+    disp_region_clear(dirty);
 }
 #endif //GDISP_HARDWARE_FLUSH
 
@@ -22,14 +22,17 @@
 #include "gdisp_lld_config.h"
 #include "src/gdisp/gdisp_driver.h"
 #include "lcd_adapter.h"
+#include "disp_region.h"
 #include "board_framebuffer.h"
 
 typedef struct fbPriv {
     fbInfo_t fbi;            // Display information
+    disp_region_t dirty;     // Areas changed since the last flush
 } fbPriv_t;
 
 #define PIXIL_POS(g, x, y)        ((y) * ((fbPriv_t *)(g)->priv)->fbi.linelen + (x) * sizeof(LLDCOLOR_TYPE))
 #define PIXEL_ADDR(g, pos)        ((LLDCOLOR_TYPE *)(((char *)((fbPriv_t *)(g)->priv)->fbi.pixels)+pos))
+#define MARK_DIRTY(g, x, y, w, h) disp_region_add(&((fbPriv_t *)(g)->priv)->dirty, x, y, w, h)
 
 LLDSPEC bool_t gdisp_lld_init(GDisplay *g)
 {
@@ -39,12 +42,14 @@ LLDSPEC bool_t gdisp_lld_init(GDisplay *g)
     }
     ((fbPriv_t *)g->priv)->fbi.pixels = 0;
     ((fbPriv_t *)g->priv)->fbi.linelen = 0;
+    disp_region_init(&((fbPriv_t *)g->priv)->dirty, DISP_REGION_SETUP_COST);
 
     // Initialize the GDISP structure
     g->g.Orientation = GDISP_ROTATE_0;
     g->g.Powermode = powerOn;
     g->board = 0;                            // preinitialize
     board_init(g, &((fbPriv_t *)g->priv)->fbi);
+    MARK_DIRTY(g, 0, 0, g->g.Width, g->g.Height);
 
     return TRUE;
 }
@@ -52,13 +57,14 @@ LLDSPEC bool_t gdisp_lld_init(GDisplay *g)
 #if GDISP_HARDWARE_FLUSH
 LLDSPEC void gdisp_lld_flush(GDisplay *g)
 {
-    board_flush(g);
+    board_flush(g, &((fbPriv_t *)g->priv)->dirty);
 }
 #endif //GDISP_HARDWARE_FLUSH
 
 LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g)
 {
     PIXEL_ADDR(g, PIXIL_POS(g, g->p.x, g->p.y))[0] = gdispColor2Native(g->p.color);
+    MARK_DIRTY(g, g->p.x, g->p.y, 1, 1);
 }
 
 LLDSPEC color_t gdisp_lld_get_pixel_color(GDisplay *g)
@@ -79,6 +85,7 @@ LLDSPEC void gdisp_lld_fill_area(GDisplay *g)
             *pointer++ = c;
         }
     }
+    MARK_DIRTY(g, g->p.x, g->p.y, g->p.cx, g->p.cy);
 }
 #endif // GDISP_HARDWARE_FILLS
 
@@ -95,6 +102,7 @@ LLDSPEC void gdisp_lld_blit_area(GDisplay *g)
             *pointer++ = *pointer1++;
         }
     }
+    MARK_DIRTY(g, g->p.x, g->p.y, g->p.cx, g->p.cy);
 }
 #endif // GDISP_HARDWARE_BITFILLS
 
@@ -143,6 +151,9 @@ LLDSPEC void gdisp_lld_control(GDisplay *g)
             return;
         }
         g->g.Orientation = (orientation_t)g->p.ptr;
+        // The panel scans the frame buffer differently now, resend all of it
+        disp_region_clear(&((fbPriv_t *)g->priv)->dirty);
+        MARK_DIRTY(g, 0, 0, g->g.Width, g->g.Height);
         return;
 
     case GDISP_CONTROL_BACKLIGHT:
@@ -0,0 +1,170 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* C Includes */
+#include <stdio.h>
+#include <string.h>
+
+/* RTOS Includes */
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+/* ESP Includes */
+#include "esp_log.h"
+#include "esp_timer.h"
+
+/* lvgl include */
+#include "lvgl_disp_config.h"
+
+/* LVGL spins in lv_vdb_flush until lv_flush_ready() is called, so the flush
+ * task must be able to preempt the LittlevGL task */
+#define LVGL_FLUSH_TASK_PRIO    (CONFIG_LVGL_TASK_PRIORITY + 1)
+#define LVGL_FLUSH_TASK_STACK   (2048)
+#define LVGL_FLUSH_QUEUE_LEN    (4)
+
+typedef struct {
+    int32_t x1;
+    int32_t y1;
+    int32_t x2;
+    int32_t y2;
+    const lv_color_t *color_p;      /* NULL marks the end of a frame */
+} lvgl_flush_area_t;
+
+static lvgl_disp_send_cb_t s_send = NULL;
+static lvgl_disp_monitor_cb_t s_app_monitor = NULL;
+static bool s_stats_en = false;
+static portMUX_TYPE s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static lvgl_disp_flush_stats_t s_stats;     /* last complete frame */
+static lvgl_disp_flush_stats_t s_frame;     /* frame being flushed */
+static int64_t s_frame_start;
+static int64_t s_idle_since;
+#if LV_VDB_DOUBLE
+static const char *TAG = "lvgl_flush";
+static QueueHandle_t s_flush_queue = NULL;
+#endif
+
+static void flush_area_send(const lvgl_flush_area_t *area)
+{
+    if (!s_stats_en) {
+        s_send(area->x1, area->y1, area->x2, area->y2, area->color_p);
+        return;
+    }
+    int64_t start = esp_timer_get_time();
+    if (s_frame.chunk_cnt == 0) {
+        s_frame_start = start;
+    } else {
+        // The display sat idle until LVGL finished this area
+        s_frame.render_us += start - s_idle_since;
+    }
+    s_frame.chunk_cnt++;
+    s_send(area->x1, area->y1, area->x2, area->y2, area->color_p);
+    s_idle_since = esp_timer_get_time();
+    s_frame.transfer_us += s_idle_since - start;
+}
+
+static void flush_frame_end()
+{
+    if (s_frame.chunk_cnt == 0) {
+        return;
+    }
+    s_frame.frame_us = s_idle_since - s_frame_start;
+    s_frame.frame_cnt = s_stats.frame_cnt + 1;
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats = s_frame;
+    portEXIT_CRITICAL(&s_stats_mux);
+    memset(&s_frame, 0, sizeof(s_frame));
+}
+
+#if LV_VDB_DOUBLE
+static void lvgl_flush_task(void *arg)
+{
+    lvgl_flush_area_t area;
+    while (1) {
+        if (xQueueReceive(s_flush_queue, &area, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (area.color_p == NULL) {
+            flush_frame_end();
+            continue;
+        }
+        flush_area_send(&area);
+        // The VDB is free again, LVGL may render into it
+        lv_flush_ready();
+    }
+}
+#endif
+
+static void lvgl_flush_monitor_cb(uint32_t time_ms, uint32_t px_num)
+{
+#if LV_VDB_DOUBLE
+    // The last areas may still be in flight, end the frame behind them
+    lvgl_flush_area_t end = { 0 };
+    xQueueSend(s_flush_queue, &end, portMAX_DELAY);
+#else
+    flush_frame_end();
+#endif
+    if (s_app_monitor) {
+        s_app_monitor(time_ms, px_num);
+    }
+}
+
+esp_err_t lvgl_disp_flush_init(lvgl_disp_send_cb_t send)
+{
+    s_send = send;
+    memset(&s_frame, 0, sizeof(s_frame));
+    memset(&s_stats, 0, sizeof(s_stats));
+#if LV_VDB_DOUBLE
+    if (s_flush_queue == NULL) {
+        s_flush_queue = xQueueCreate(LVGL_FLUSH_QUEUE_LEN, sizeof(lvgl_flush_area_t));
+        if (s_flush_queue == NULL) {
+            ESP_LOGE(TAG, "flush queue create failed");
+            return ESP_ERR_NO_MEM;
+        }
+        if (xTaskCreate(lvgl_flush_task, "lvgl_flush", LVGL_FLUSH_TASK_STACK, NULL, LVGL_FLUSH_TASK_PRIO, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "flush task create failed");
+            vQueueDelete(s_flush_queue);
+            s_flush_queue = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+    }
+#endif
+    return ESP_OK;
+}
+
+void lvgl_disp_flush_enable_stats(lvgl_disp_monitor_cb_t app_cb)
+{
+    s_app_monitor = app_cb;
+    s_stats_en = true;
+    lv_refr_set_monitor_cb(lvgl_flush_monitor_cb);
+}
+
+void lvgl_disp_flush(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const lv_color_t *color_p)
+{
+    lvgl_flush_area_t area = { x1, y1, x2, y2, color_p };
+#if LV_VDB_DOUBLE
+    // lv_flush_ready() follows from the flush task once the area is sent
+    xQueueSend(s_flush_queue, &area, portMAX_DELAY);
+#else
+    flush_area_send(&area);
+    lv_flush_ready();
+#endif
+}
+
+void lvgl_disp_flush_get_stats(lvgl_disp_flush_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_stats_mux);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
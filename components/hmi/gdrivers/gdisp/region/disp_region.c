@@ -0,0 +1,136 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <stdint.h>
+#include "disp_region.h"
+
+static inline int32_t rect_area(const disp_rect_t *r)
+{
+    return (int32_t) r->w * r->h;
+}
+
+static inline void rect_union(disp_rect_t *u, const disp_rect_t *a, const disp_rect_t *b)
+{
+    int16_t x0 = a->x < b->x ? a->x : b->x;
+    int16_t y0 = a->y < b->y ? a->y : b->y;
+    int16_t x1 = a->x + a->w > b->x + b->w ? a->x + a->w : b->x + b->w;
+    int16_t y1 = a->y + a->h > b->y + b->h ? a->y + a->h : b->y + b->h;
+    u->x = x0;
+    u->y = y0;
+    u->w = x1 - x0;
+    u->h = y1 - y0;
+}
+
+/* Extra pixels sent when a and b go out as their bounding box, negative if they overlap */
+static inline int32_t merge_waste(const disp_rect_t *a, const disp_rect_t *b)
+{
+    disp_rect_t u;
+    rect_union(&u, a, b);
+    return rect_area(&u) - rect_area(a) - rect_area(b);
+}
+
+static void region_remove(disp_region_t *region, int idx)
+{
+    region->rect[idx] = region->rect[--region->num];
+}
+
+/* Merge the cheapest pair, returns its waste or INT32_MAX with less than two rectangles */
+static int32_t region_merge_best(disp_region_t *region, int32_t limit)
+{
+    int32_t best = INT32_MAX;
+    int best_i = 0, best_j = 0;
+    for (int i = 0; i < region->num; i++) {
+        for (int j = i + 1; j < region->num; j++) {
+            int32_t waste = merge_waste(&region->rect[i], &region->rect[j]);
+            if (waste < best) {
+                best = waste;
+                best_i = i;
+                best_j = j;
+            }
+        }
+    }
+    if (best <= limit) {
+        rect_union(&region->rect[best_i], &region->rect[best_i], &region->rect[best_j]);
+        region_remove(region, best_j);
+    }
+    return best;
+}
+
+void disp_region_init(disp_region_t *region, uint32_t setup_cost)
+{
+    region->num = 0;
+    region->setup_cost = setup_cost;
+}
+
+void disp_region_clear(disp_region_t *region)
+{
+    region->num = 0;
+}
+
+void disp_region_add(disp_region_t *region, int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    disp_rect_t r = { x, y, w, h };
+    int32_t best = (int32_t) region->setup_cost;
+    int merged = -1;
+
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    for (int i = 0; i < region->num; i++) {
+        disp_rect_t *d = &region->rect[i];
+        if (x >= d->x && y >= d->y && x + w <= d->x + d->w && y + h <= d->y + d->h) {
+            return;     // already covered, the common case for pixel writes
+        }
+        int32_t waste = merge_waste(d, &r);
+        if (waste <= best) {
+            best = waste;
+            merged = i;
+        }
+    }
+    if (merged < 0) {
+        if (region->num == DISP_REGION_RECT_NUM) {
+            region_merge_best(region, INT32_MAX);
+        }
+        region->rect[region->num++] = r;
+        return;
+    }
+    rect_union(&region->rect[merged], &region->rect[merged], &r);
+
+    // The grown rectangle may now be worth merging with others
+    for (int i = 0; i < region->num; i++) {
+        if (i != merged && merge_waste(&region->rect[i], &region->rect[merged]) <= (int32_t) region->setup_cost) {
+            rect_union(&region->rect[merged], &region->rect[merged], &region->rect[i]);
+            region_remove(region, i);
+            if (merged == region->num) {
+                merged = i;
+            }
+            i = -1;
+        }
+    }
+}
+
+int disp_region_merge(disp_region_t *region)
+{
+    while (region_merge_best(region, (int32_t) region->setup_cost) <= (int32_t) region->setup_cost) {
+    }
+    return region->num;
+}
+
+uint32_t disp_region_cost(const disp_region_t *region)
+{
+    uint32_t cost = 0;
+    for (int i = 0; i < region->num; i++) {
+        cost += region->setup_cost + rect_area(&region->rect[i]);
+    }
+    return cost;
+}
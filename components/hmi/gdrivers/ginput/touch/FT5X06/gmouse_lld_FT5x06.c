@@ -24,6 +24,16 @@
 #include "gmouse_lld_FT5x06.h"
 // Hardware definitions
 #include "FT5x06.h"
+#include "esp_log.h"
+
+// A negative INT GPIO keeps polling the panel over I2C
+#if defined(CONFIG_UGFX_TOUCH_INT_GPIO) && CONFIG_UGFX_TOUCH_INT_GPIO >= 0
+#define FT5X06_INTR_MODE
+static const char *TAG = "gmouse_ft5x06";
+#endif
+
+// Set once the INT pin is armed, otherwise the panel is polled over I2C
+static bool_t intr_mode = FALSE;
 
 static bool_t MouseInit(GMouse *m, unsigned driverinstance)
 {
@@ -61,23 +71,45 @@ static bool_t MouseInit(GMouse *m, unsigned driverinstance)
     // Timer to enter 'idle' when in 'Monitor' (ms)
     write_reg(m, FT5x06_ID_G_PERIODMONITOR, 0x28);
 
+#ifdef FT5X06_INTR_MODE
+    intr_mode = iot_ft5x06_intr_start(dev, CONFIG_UGFX_TOUCH_INT_GPIO, 0) == ESP_OK;
+    if (!intr_mode) {
+        ESP_LOGW(TAG, "touch INT on GPIO %d unavailable, polling over I2C", CONFIG_UGFX_TOUCH_INT_GPIO);
+    }
+#endif
+
     release_bus(m);
     return TRUE;
 }
 
 static bool_t read_xyz(GMouse *m, GMouseReading *pdr)
 {
+    ft5x06_touch_event_t evt;
     // Assume not touched.
     pdr->buttons = 0;
     pdr->z = 0;
     aquire_bus(m);
 
+    if (intr_mode) {
+        // Only the newest queued state matters to the polling mouse driver
+        static ft5x06_touch_event_t last = { 0 };
+        while (iot_ft5x06_get_event(dev, &evt, 0) == ESP_OK) {
+            last = evt;
+        }
+        evt = last;
+    } else {
+        // Status and points come in one burst read
+        if (iot_ft5x06_read_points(dev, &evt) != ESP_OK) {
+            evt.point_num = 0;
+        }
+    }
+
     // Only take a reading if we are touched.
-    if ((read_byte(m, FT5x06_TOUCH_POINTS) & 0x07)) {
+    if (evt.point_num > 0) {
 
         /* Get the X, Y, Z values */
-        pdr->x = (coord_t)(read_word(m, FT5x06_TOUCH1_XH) & 0x0fff);
-        pdr->y = (coord_t)read_word(m, FT5x06_TOUCH1_YH);
+        pdr->x = (coord_t) evt.points[0].x;
+        pdr->y = (coord_t) evt.points[0].y;
         pdr->z = 1;
 
         // Rescale X,Y if we are using self-calibration
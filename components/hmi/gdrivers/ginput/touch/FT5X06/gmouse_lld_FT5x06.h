@@ -90,22 +90,6 @@ static void write_reg(GMouse *m, uint8_t reg, uint8_t val)
     iot_ft5x06_write(dev, reg, 1, &val);
 }
 
-static uint8_t read_byte(GMouse *m, uint8_t reg)
-{
-    uint8_t data;
-    iot_ft5x06_read(dev, reg, 1, &data);
-    return data;
-}
-
-static uint16_t read_word(GMouse *m, uint8_t reg)
-{
-    uint8_t data[2];
-    uint16_t result;
-    iot_ft5x06_read(dev, reg, 2, &data);
-    result = data[0] << 8 | data[1];
-    return result;
-}
-
 static GFXINLINE void touch_save_calibration(GMouse *m, const void *buf, size_t sz)
 {
     iot_param_save((const char *)TOUCH_CAL_VAL_NAMESPACE, (const char *) TOUCH_CAL_VAL_KEY, (void *) buf, sz);
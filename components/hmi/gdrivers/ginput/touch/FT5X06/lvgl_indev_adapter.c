@@ -37,70 +37,57 @@
 /* FT5x06 Include */
 #include "FT5x06.h"
 
+// A negative INT GPIO keeps polling the panel over I2C
+#if defined(CONFIG_LVGL_TOUCH_INT_GPIO) && CONFIG_LVGL_TOUCH_INT_GPIO >= 0
+#define FT5X06_INTR_MODE
+static const char *TAG = "lvgl_indev";
+#endif
+
 static ft5x06_handle_t dev = NULL;
+// Set once the INT pin is armed, otherwise the panel is polled over I2C
+static bool intr_mode = false;
 
 static void write_reg(uint8_t reg, uint8_t val)
 {
     iot_ft5x06_write(dev, reg, 1, &val);
 }
 
-static uint8_t read_byte(uint8_t reg)
-{
-    uint8_t data;
-    iot_ft5x06_read(dev, reg, 1, &data);
-    return data;
-}
-
-static uint16_t read_word(uint8_t reg)
-{
-    uint8_t data[2];
-    uint16_t result;
-    iot_ft5x06_read(dev, reg, 2, &data);
-    result = data[0] << 8 | data[1];
-    return result;
-}
-
 /*Function pointer to read data. Return 'true' if there is still data to be read (buffered)*/
 static bool ex_tp_read(lv_indev_data_t *data)
 {
     static lv_coord_t x = 0xFFFF, y = 0xFFFF;
-    data->state = LV_INDEV_STATE_REL;
+    static lv_indev_state_t state = LV_INDEV_STATE_REL;
+    ft5x06_touch_event_t evt;
+    bool more = false;
+
+    if (intr_mode) {
+        // Drain the events queued by the FT5x06 driver, the bus is idle while untouched
+        if (iot_ft5x06_get_event(dev, &evt, 0) == ESP_OK) {
+            state = evt.point_num > 0 ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+        } else {
+            evt.point_num = 0;
+        }
+        // Let LVGL come back for the rest of a burst in the same poll
+        more = iot_ft5x06_get_event_num(dev) > 0;
+    } else {
+        // Only take a reading if we are touched, status and points come in one burst read
+        if (iot_ft5x06_read_points(dev, &evt) != ESP_OK) {
+            evt.point_num = 0;
+        }
+        state = evt.point_num > 0 ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+    }
+    if (evt.point_num > 0) {
+        lv_point_t point = { .x = evt.points[0].x, .y = evt.points[0].y };
+        // Apply calibration and rotation, the calibration itself reads the raw point
+        lvgl_touch_transform(&point);
+        x = point.x;
+        y = point.y;
+    }
     // please be sure that your touch driver every time return old (last clcked) value. 
+    data->state = state;
     data->point.x = x;
     data->point.y = y;
-    // Only take a reading if we are touched.
-    if ((read_byte(FT5x06_TOUCH_POINTS) & 0x07)) {
-
-        /* Get the X, Y, values */
-        data->point.x = (lv_coord_t)(read_word(FT5x06_TOUCH1_XH) & 0x0fff);
-        data->point.y = (lv_coord_t)read_word(FT5x06_TOUCH1_YH);
-        data->state = LV_INDEV_STATE_PR;
-
-        // Apply calibration, rotation
-        // Transform the co-ordinates
-        if (lvgl_calibration_transform(&(data->point))) {
-            lv_coord_t t;
-            // Rescale X,Y if we are using self-calibration
-            #ifdef CONFIG_LVGL_DISP_ROTATE_0
-                data->point.x = data->point.x;
-                data->point.y = data->point.y;
-            #elif defined(CONFIG_LVGL_DISP_ROTATE_90)
-                t = data->point.x;
-                data->point.x = LV_HOR_RES - 1 - data->point.y;
-                data->point.y = t;
-            #elif defined(CONFIG_LVGL_DISP_ROTATE_180)
-                data->point.x = LV_HOR_RES - 1 - data->point.x;
-                data->point.y = LV_VER_RES - 1 - data->point.y;
-            #elif defined(CONFIG_LVGL_DISP_ROTATE_270)
-                t = data->point.y;
-                data->point.y = LV_VER_RES - 1 - data->point.x;
-                data->point.x = t;
-            #endif
-            x = data->point.x;
-            y = data->point.y;
-        }
-    }
-    return false;
+    return more;
 }
 
 /* Input device interface */
@@ -147,6 +134,13 @@ lv_indev_drv_t lvgl_indev_init()
     // Timer to enter 'idle' when in 'Monitor' (ms)
     write_reg(FT5x06_ID_G_PERIODMONITOR, 0x28);
 
+#ifdef FT5X06_INTR_MODE
+    intr_mode = iot_ft5x06_intr_start(dev, CONFIG_LVGL_TOUCH_INT_GPIO, 0) == ESP_OK;
+    if (!intr_mode) {
+        ESP_LOGW(TAG, "touch INT on GPIO %d unavailable, polling over I2C", CONFIG_LVGL_TOUCH_INT_GPIO);
+    }
+#endif
+
     lv_indev_drv_t indev_drv;      /*Descriptor of an input device driver*/
     lv_indev_drv_init(&indev_drv); /*Basic initialization*/
 
@@ -73,6 +73,13 @@ int board_touch_get_position(int port)
     return xpt->get_sample(port);
 }
 
+void board_touch_get_raw_position(int *x, int *y)
+{
+    position pos = xpt->get_raw_position();
+    *x = pos.x;
+    *y = pos.y;
+}
+
 #ifdef CONFIG_LVGL_GUI_ENABLE
 
 /* lvgl include */
@@ -93,24 +100,7 @@ static bool ex_tp_read(lv_indev_data_t *data)
         data->state = LV_INDEV_STATE_PR;
         // Apply calibration, rotation
         // Transform the co-ordinates
-        if (lvgl_calibration_transform(&(data->point))) {
-            lv_coord_t t;
-            // Rescale X,Y if we are using self-calibration
-            #ifdef CONFIG_LVGL_DISP_ROTATE_0
-                data->point.x = data->point.x;
-                data->point.y = data->point.y;
-            #elif defined(CONFIG_LVGL_DISP_ROTATE_90)
-                t = data->point.x;
-                data->point.x = LV_HOR_RES - 1 - data->point.y;
-                data->point.y = t;
-            #elif defined(CONFIG_LVGL_DISP_ROTATE_180)
-                data->point.x = LV_HOR_RES - 1 - data->point.x;
-                data->point.y = LV_VER_RES - 1 - data->point.y;
-            #elif defined(CONFIG_LVGL_DISP_ROTATE_270)
-                t = data->point.y;
-                data->point.y = LV_VER_RES - 1 - data->point.x;
-                data->point.x = t;
-            #endif
+        if (lvgl_touch_transform(&(data->point))) {
             x = data->point.x;
             y = data->point.y;
         }
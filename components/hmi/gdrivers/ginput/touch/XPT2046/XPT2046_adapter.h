@@ -58,6 +58,14 @@ bool board_touch_is_pressed();
   */
 int board_touch_get_position(int port);
 
+/**
+  * @brief Get the filtered position sampled by the last board_touch_is_pressed()
+  *
+  * @param x raw x of the position
+  * @param y raw y of the position
+  */
+void board_touch_get_raw_position(int *x, int *y);
+
 #ifdef __cplusplus
 }
 #endif
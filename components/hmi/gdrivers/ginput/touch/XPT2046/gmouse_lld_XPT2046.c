@@ -23,10 +23,6 @@
 // Get the hardware interface
 #include "gmouse_lld_XPT2046.h"
 
-#define CMD_X                0xD1
-#define CMD_Y                0x91
-#define CMD_ENABLE_IRQ       0x80
-
 static bool_t touch_get_xyz(GMouse *m, GMouseReading *pdr)
 {
     // No buttons
@@ -36,15 +32,9 @@ static bool_t touch_get_xyz(GMouse *m, GMouseReading *pdr)
     if (getpin_pressed(m)) {
         pdr->z = 1;                        // Set to Z_MAX as we are pressed
 
+        // The pressed check already sampled and filtered X/Y in one burst
         aquire_bus(m);
-        read_value(m, CMD_X);              // Dummy read - disable PenIRQ
-        pdr->x = read_value(m, CMD_X);     // Read X-Value
-
-        read_value(m, CMD_Y);              // Dummy read - disable PenIRQ
-        pdr->y = read_value(m, CMD_Y);     // Read Y-Value
-
-        read_value(m, CMD_ENABLE_IRQ);     // Enable IRQ
-
+        read_position(m, &pdr->x, &pdr->y);
         release_bus(m);
     }
     return TRUE;
@@ -75,6 +75,14 @@ static GFXINLINE uint16_t read_value(GMouse *m, uint16_t port)
     return board_touch_get_position(port);
 }
 
+static GFXINLINE void read_position(GMouse *m, coord_t *x, coord_t *y)
+{
+    int px, py;
+    board_touch_get_raw_position(&px, &py);
+    *x = px;
+    *y = py;
+}
+
 static GFXINLINE void touch_save_calibration(GMouse *m, const void *buf, size_t sz)
 {
     iot_param_save((const char *)TOUCH_CAL_VAL_NAMESPACE, (const char *) TOUCH_CAL_VAL_KEY, (void *) buf, sz);
@@ -0,0 +1,101 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef __DISP_REGION_H__
+#define __DISP_REGION_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DISP_REGION_RECT_NUM        (16)    /*!< Rectangles a region holds before it merges them by force */
+#define DISP_REGION_SETUP_COST      (128)   /*!< Default cost of opening one transfer window, in pixels */
+
+/**
+ * @brief A rectangle of the screen
+ */
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+} disp_rect_t;
+
+/**
+ * @brief Areas invalidated during one frame
+ *
+ * Sending a rectangle costs setup_cost plus one per pixel. Two rectangles are
+ * merged into their bounding box when that is not more expensive than sending
+ * them apart, so overlapping areas are sent once and close areas share a window.
+ */
+typedef struct {
+    disp_rect_t rect[DISP_REGION_RECT_NUM];
+    int num;
+    uint32_t setup_cost;
+} disp_region_t;
+
+/**
+ * @brief Initialize an empty region
+ *
+ * @param region region to initialize
+ * @param setup_cost cost of one transfer window, in pixels sent
+ */
+void disp_region_init(disp_region_t *region, uint32_t setup_cost);
+
+/**
+ * @brief Forget all areas of a region
+ *
+ * @param region region
+ */
+void disp_region_clear(disp_region_t *region);
+
+/**
+ * @brief Add an invalidated area, the area must already be clipped to the screen
+ *
+ * Areas that are covered already are dropped, areas that are cheaper to send
+ * together with an existing rectangle are merged into it right away.
+ *
+ * @param region region
+ * @param x,y the area position
+ * @param w,h the area size
+ */
+void disp_region_add(disp_region_t *region, int16_t x, int16_t y, int16_t w, int16_t h);
+
+/**
+ * @brief Merge the rectangles of a region into the cheapest set of transfers
+ *
+ * Repeatedly merges the pair of rectangles that saves the most, until no
+ * merge saves anything. Call it once per frame before sending the rectangles.
+ *
+ * @param region region
+ *
+ * @return number of rectangles left
+ */
+int disp_region_merge(disp_region_t *region);
+
+/**
+ * @brief Cost of sending every rectangle of a region
+ *
+ * @param region region
+ *
+ * @return setup_cost per rectangle plus the number of pixels
+ */
+uint32_t disp_region_cost(const disp_region_t *region);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DISP_REGION_H__ */
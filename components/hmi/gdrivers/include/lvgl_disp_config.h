@@ -3,17 +3,77 @@
 
 /* lvgl include */
 #include "iot_lvgl.h"
+#include "esp_err.h"
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+/**
+ * @brief Send one VDB area to the display and return once it is sent
+ */
+typedef void (*lvgl_disp_send_cb_t)(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const lv_color_t *color_p);
+
+/**
+ * @brief LVGL refresh monitor callback, see lv_refr_set_monitor_cb
+ */
+typedef void (*lvgl_disp_monitor_cb_t)(uint32_t time_ms, uint32_t px_num);
+
+/**
+ * @brief Frame timing of the LVGL flush path
+ */
+typedef struct {
+    uint32_t frame_cnt;     /*!< frames flushed so far */
+    uint32_t chunk_cnt;     /*!< VDB areas in the last frame */
+    uint32_t frame_us;      /*!< last frame, from the first area handed over to the last area sent */
+    uint32_t transfer_us;   /*!< time spent sending the areas of the last frame */
+    uint32_t render_us;     /*!< time of the last frame the display waited for LVGL to render */
+} lvgl_disp_flush_stats_t;
+
 /**
  * @brief Initialize display
  */
 lv_disp_drv_t lvgl_lcd_display_init();
 
+/**
+ * @brief Set up the VDB flush path, call it once from lvgl_lcd_display_init
+ *
+ * With CONFIG_LVGL_DRIVER_DOUBLE_BUFFER_ENABLE the areas are sent by a flush task
+ * and lv_flush_ready() is called once an area is sent, so LVGL renders into the
+ * other VDB meanwhile. Otherwise areas are sent directly from lvgl_disp_flush.
+ *
+ * @param send function that sends one area to the display
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_NO_MEM no memory for the flush task
+ */
+esp_err_t lvgl_disp_flush_init(lvgl_disp_send_cb_t send);
+
+/**
+ * @brief disp_flush function of the LVGL display driver
+ */
+void lvgl_disp_flush(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const lv_color_t *color_p);
+
+/**
+ * @brief Start measuring the frame timing
+ *
+ * The end of each frame is found with the LVGL refresh monitor callback. LVGL keeps only
+ * one, so an application that uses the monitor itself passes its callback here instead
+ * of calling lv_refr_set_monitor_cb(), and it is called after each frame as before.
+ *
+ * @param app_cb application monitor callback, NULL if there is none
+ */
+void lvgl_disp_flush_enable_stats(lvgl_disp_monitor_cb_t app_cb);
+
+/**
+ * @brief Get the frame timing of the last flushed frame, see lvgl_disp_flush_enable_stats
+ *
+ * @param stats frame timing
+ */
+void lvgl_disp_flush_get_stats(lvgl_disp_flush_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
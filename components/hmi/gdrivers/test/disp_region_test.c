@@ -0,0 +1,144 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "disp_region.h"
+
+#define SCREEN_W        (320)
+#define SCREEN_H        (240)
+#define REPLAY_LOOPS    (100)
+
+static const char *TAG = "DISP_REGION";
+
+typedef struct {
+    const char *name;
+    const disp_rect_t *rects;
+    int num;
+} region_trace_t;
+
+/* Thermostat: status icon, three seven-segment digits drawn segment by segment, clock text */
+static const disp_rect_t s_trace_thermostat[] = {
+    {8, 8, 24, 24},
+    {64, 60, 32, 6}, {92, 64, 6, 26}, {92, 94, 6, 26}, {64, 118, 32, 6}, {60, 94, 6, 26}, {60, 64, 6, 26}, {64, 89, 32, 6},
+    {109, 60, 32, 6}, {137, 64, 6, 26}, {137, 94, 6, 26}, {109, 118, 32, 6}, {105, 94, 6, 26}, {105, 64, 6, 26},
+    {154, 60, 32, 6}, {182, 64, 6, 26}, {182, 94, 6, 26}, {154, 118, 32, 6}, {154, 89, 32, 6},
+    {260, 4, 8, 16}, {268, 4, 8, 16}, {276, 4, 8, 16}, {284, 4, 8, 16}, {292, 4, 8, 16},
+};
+
+/* List scroll: every row repainted */
+static const disp_rect_t s_trace_list[] = {
+    {0, 40, 320, 40}, {0, 80, 320, 40}, {0, 120, 320, 40}, {0, 160, 320, 40}, {0, 200, 320, 40},
+    {300, 40, 20, 200},
+};
+
+/* Button press: background, border lines and label glyphs on top of each other */
+static const disp_rect_t s_trace_button[] = {
+    {110, 100, 100, 40},
+    {110, 100, 100, 1}, {110, 139, 100, 1}, {110, 100, 1, 40}, {209, 100, 1, 40},
+    {136, 112, 8, 16}, {144, 112, 8, 16}, {152, 112, 8, 16}, {160, 112, 8, 16}, {168, 112, 8, 16}, {176, 112, 8, 16},
+};
+
+/* Icons in the four corners, far apart */
+static const disp_rect_t s_trace_corners[] = {
+    {0, 0, 16, 16}, {304, 0, 16, 16}, {0, 224, 16, 16}, {304, 224, 16, 16},
+};
+
+static disp_rect_t s_trace_line[190];
+
+static const region_trace_t s_traces[] = {
+    {"thermostat", s_trace_thermostat, sizeof(s_trace_thermostat) / sizeof(disp_rect_t)},
+    {"list", s_trace_list, sizeof(s_trace_list) / sizeof(disp_rect_t)},
+    {"button", s_trace_button, sizeof(s_trace_button) / sizeof(disp_rect_t)},
+    {"corners", s_trace_corners, sizeof(s_trace_corners) / sizeof(disp_rect_t)},
+    {"line", s_trace_line, sizeof(s_trace_line) / sizeof(disp_rect_t)},
+};
+
+static bool region_covers(const disp_region_t *region, int x, int y)
+{
+    for (int i = 0; i < region->num; i++) {
+        const disp_rect_t *r = &region->rect[i];
+        if (x >= r->x && x < r->x + r->w && y >= r->y && y < r->y + r->h) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void region_replay(disp_region_t *region, const region_trace_t *trace)
+{
+    disp_region_clear(region);
+    for (int i = 0; i < trace->num; i++) {
+        const disp_rect_t *r = &trace->rects[i];
+        disp_region_add(region, r->x, r->y, r->w, r->h);
+    }
+    disp_region_merge(region);
+}
+
+TEST_CASE("Display region merge test", "[disp_region][iot]")
+{
+    disp_region_t region;
+    disp_region_init(&region, DISP_REGION_SETUP_COST);
+
+    // A diagonal line drawn pixel by pixel
+    for (int i = 0; i < (int) (sizeof(s_trace_line) / sizeof(disp_rect_t)); i++) {
+        s_trace_line[i] = (disp_rect_t) {10 + i, 10 + i * 3 / 5, 1, 1};
+    }
+
+    for (int t = 0; t < (int) (sizeof(s_traces) / sizeof(region_trace_t)); t++) {
+        const region_trace_t *trace = &s_traces[t];
+        uint32_t naive = 0;
+        disp_rect_t bbox = trace->rects[0];
+        for (int i = 0; i < trace->num; i++) {
+            const disp_rect_t *r = &trace->rects[i];
+            naive += DISP_REGION_SETUP_COST + r->w * r->h;
+            int x1 = bbox.x + bbox.w > r->x + r->w ? bbox.x + bbox.w : r->x + r->w;
+            int y1 = bbox.y + bbox.h > r->y + r->h ? bbox.y + bbox.h : r->y + r->h;
+            bbox.x = bbox.x < r->x ? bbox.x : r->x;
+            bbox.y = bbox.y < r->y ? bbox.y : r->y;
+            bbox.w = x1 - bbox.x;
+            bbox.h = y1 - bbox.y;
+        }
+
+        int64_t t0 = esp_timer_get_time();
+        for (int i = 0; i < REPLAY_LOOPS; i++) {
+            region_replay(&region, trace);
+        }
+        int64_t replay_us = (esp_timer_get_time() - t0) / REPLAY_LOOPS;
+
+        // Every invalidated pixel must still be sent
+        for (int i = 0; i < trace->num; i++) {
+            const disp_rect_t *r = &trace->rects[i];
+            for (int y = r->y; y < r->y + r->h; y++) {
+                for (int x = r->x; x < r->x + r->w; x++) {
+                    TEST_ASSERT(region_covers(&region, x, y));
+                }
+            }
+        }
+        uint32_t cost = disp_region_cost(&region);
+        ESP_LOGI(TAG, "%-10s %3d areas -> %2d transfers, cost %6u (one per area %6u, bounding box %6u), %lld us",
+                 trace->name, trace->num, region.num, cost, naive, (uint32_t) (DISP_REGION_SETUP_COST + bbox.w * bbox.h), replay_us);
+        TEST_ASSERT(cost <= naive);
+    }
+
+    // Areas far apart stay apart
+    region_replay(&region, &s_traces[3]);
+    TEST_ASSERT_EQUAL(4, region.num);
+    // Full rows next to each other become one transfer
+    region_replay(&region, &s_traces[1]);
+    TEST_ASSERT_EQUAL(1, region.num);
+}
@@ -45,7 +45,7 @@ COMPONENT_PRIV_INCLUDEDIRS +=  . \
 ifdef CONFIG_LVGL_USE_CUSTOM_DRIVER
 COMPONENT_DEPENDS += $(call dequote,$(CONFIG_LVGL_CUSTOM_DRIVER_COMPONENT_NAME))
 else
-COMPONENT_DEPENDS += gdrivers
+COMPONENT_DEPENDS += gdrivers touch_transform
 endif
 
 endif  #CONFIG_LVGL_GUI_ENABLE
\ No newline at end of file
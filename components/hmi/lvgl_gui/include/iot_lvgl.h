@@ -22,6 +22,16 @@ extern "C"
 /* lvgl calibration includes */
 #include "lv_calibration.h"
 
+/**
+ * @brief Render time of the LittlevGL task
+ */
+typedef struct {
+    uint32_t loop_cnt;      /*!< lv_task_handler calls so far */
+    uint32_t last_us;       /*!< duration of the last call */
+    uint32_t max_us;        /*!< longest call */
+    uint64_t total_us;      /*!< time spent in lv_task_handler so far */
+} lvgl_task_stats_t;
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -31,6 +41,21 @@ extern "C"
  */
 void lvgl_init();
 
+/**
+ * @brief Wake the LittlevGL task to run lv_task_handler now
+ *
+ * The task runs lv_task_handler every 5 ms, call this after changing
+ * objects from another task to have them drawn without that delay.
+ */
+void lvgl_task_wakeup();
+
+/**
+ * @brief Get the render time statistics of the LittlevGL task
+ *
+ * @param stats copy of the statistics
+ */
+void lvgl_get_task_stats(lvgl_task_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -46,6 +46,15 @@ bool lvgl_calibrate_mouse(lv_indev_drv_t indev_drv, bool recalibrate);
  */
 bool lvgl_calibration_transform(lv_point_t *data);
 
+/**
+ * @brief Transform Mouse data to the rotated display, calibration and rotation in one step
+ * 
+ * @param data pointer to a lv_point_t
+ * 
+ * @return Whether the transform is successful
+ */
+bool lvgl_touch_transform(lv_point_t *data);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
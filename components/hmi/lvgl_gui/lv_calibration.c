@@ -37,6 +37,9 @@
 #include "iot_param.h"
 #include "nvs_flash.h"
 
+/* Touch transform Include */
+#include "iot_touch_transform.h"
+
 /**********************
  *      MACROS
  **********************/
@@ -71,24 +74,24 @@
 #define GMOUSE_FINGER_CLICK_ERROR       18      // Movement allowed without discarding the CLICK or CLICKCXT event
 #define GMOUSE_FINGER_MOVE_ERROR        14      // Movement allowed without discarding the MOVE event
 
-/**********************
- *      TYPEDEFS
- **********************/
-typedef struct GMouseCalibration {
-    float ax;
-    float bx;
-    float cx;
-    float ay;
-    float by;
-    float cy;
-} GMouseCalibration;
+#ifdef CONFIG_LVGL_DISP_ROTATE_90
+#define TOUCH_ROTATE                    TOUCH_ROTATE_90
+#elif defined(CONFIG_LVGL_DISP_ROTATE_180)
+#define TOUCH_ROTATE                    TOUCH_ROTATE_180
+#elif defined(CONFIG_LVGL_DISP_ROTATE_270)
+#define TOUCH_ROTATE                    TOUCH_ROTATE_270
+#else
+#define TOUCH_ROTATE                    TOUCH_ROTATE_0
+#endif
 
 /**********************
  *  STATIC VARIABLES
  **********************/
 static lv_obj_t *line[12];
 static lv_point_t p[24];
-static GMouseCalibration caldata;
+static touch_calibration_t caldata;     // Saved to NVS as it is, keep the layout
+static touch_transform_t cal_tf;        // Calibration only
+static touch_transform_t touch_tf;      // Calibration and rotation
 static bool calibrated = false;
 
 /**********************
@@ -314,21 +317,38 @@ static void CalibrationCalculate(const lv_point_t *cross, const lv_point_t *poin
                 + c2 * ((float)points[0].x * (float)points[1].y - (float)points[1].x * (float)points[0].y)) / dx;
 }
 
+/* Fold caldata into the fixed point transforms, called whenever caldata changes */
+static bool CalibrationApply()
+{
+    if (iot_touch_transform_init(&cal_tf, &caldata, TOUCH_ROTATE_0, LV_HOR_RES, LV_VER_RES) != ESP_OK
+        || iot_touch_transform_init(&touch_tf, &caldata, TOUCH_ROTATE, LV_HOR_RES, LV_VER_RES) != ESP_OK) {
+        return false;
+    }
+    return true;
+}
+
+static bool CalibrationTransform(const touch_transform_t *tf, lv_point_t *data)
+{
+    if (calibrated) {
+        int32_t x = data->x, y = data->y;
+        iot_touch_transform_apply(tf, &x, &y);
+        data->x = (lv_coord_t) x;
+        data->y = (lv_coord_t) y;
+    }
+    return calibrated;
+}
+
 /**********************
  *   GLOBAL FUNCTIONS
  **********************/
 bool lvgl_calibration_transform(lv_point_t *data)
 {
-    if (calibrated) {
-        lv_coord_t x, y;
-
-        x = (lv_coord_t)(caldata.ax * data->x + caldata.bx * data->y + caldata.cx);
-        y = (lv_coord_t)(caldata.ay * data->x + caldata.by * data->y + caldata.cy);
+    return CalibrationTransform(&cal_tf, data);
+}
 
-        data->x = x;
-        data->y = y;
-    }
-    return calibrated;
+bool lvgl_touch_transform(lv_point_t *data)
+{
+    return CalibrationTransform(&touch_tf, data);
 }
 
 bool lvgl_calibrate_mouse(lv_indev_drv_t indev_drv, bool recalibrate)
@@ -343,7 +363,7 @@ bool lvgl_calibrate_mouse(lv_indev_drv_t indev_drv, bool recalibrate)
     ESP_ERROR_CHECK( err );
     vTaskDelay(CALIBRATION_POLL_PERIOD / portTICK_PERIOD_MS);   //Wait until nvs is stable， otherwise will cause exception
 
-    if (!recalibrate && touch_load_calibration(&caldata)) {
+    if (!recalibrate && touch_load_calibration(&caldata) && CalibrationApply()) {
         calibrated = true;
         return ESP_OK;
     }
@@ -431,6 +451,8 @@ bool lvgl_calibrate_mouse(lv_indev_drv_t indev_drv, bool recalibrate)
 
         // Apply 3 point calibration algorithm
         CalibrationCalculate(cross, points);
+        // Degenerate readings give a matrix out of fixed point range
+        bool applied = CalibrationApply();
 
         /* Verification of correctness of calibration (optional) :
         *  See if the 4th point (Middle of the screen) coincides with the calibrated
@@ -438,30 +460,13 @@ bool lvgl_calibrate_mouse(lv_indev_drv_t indev_drv, bool recalibrate)
         *  Else return the error.
         */
         if (GMOUSE_VFLG_CAL_TEST) {
-            lv_coord_t t;
-            calibrated = true;
-
-            // Transform the co-ordinates
-            lvgl_calibration_transform(&points[3]);
-
-            // Do we need to rotate the reading to match the display
-            #ifdef CONFIG_LVGL_DISP_ROTATE_0
-                /* Don't rotate */
-            #elif defined(CONFIG_LVGL_DISP_ROTATE_90)
-                t = points[3].x;
-                points[3].x = w - 1 - points[3].y;
-                points[3].y = t;
-            #elif defined(CONFIG_LVGL_DISP_ROTATE_180)
-                points[3].x = w - 1 - points[3].x;
-                points[3].y = h - 1 - points[3].y;
-            #elif defined(CONFIG_LVGL_DISP_ROTATE_270)
-                t = points[3].y;
-                points[3].y = h - 1 - points[3].x;
-                points[3].x = t;
-            #endif
+            calibrated = applied;
+
+            // Transform the co-ordinates, rotated to match the display
+            lvgl_touch_transform(&points[3]);
 
             // Is this accurate enough?
-            calibrate_error = (points[3].x - cross[3].x) * (points[3].x - cross[3].x) 
+            calibrate_error = !applied ? UINT32_MAX : (points[3].x - cross[3].x) * (points[3].x - cross[3].x) 
                 + (points[3].y - cross[3].y) * (points[3].y - cross[3].y);
             if (calibrate_error > (uint32_t)GMOUSE_FINGER_CALIBRATE_ERROR * (uint32_t)GMOUSE_FINGER_CALIBRATE_ERROR) {
                 lv_label_set_text(label1, "Calibration Failed!");
@@ -475,7 +480,7 @@ bool lvgl_calibrate_mouse(lv_indev_drv_t indev_drv, bool recalibrate)
 
         // Save the calibration data (if possible)
         if (!calibrate_error) {
-            touch_save_calibration(&caldata, sizeof(GMouseCalibration));
+            touch_save_calibration(&caldata, sizeof(caldata));
         }
 
         // Force an initial reading
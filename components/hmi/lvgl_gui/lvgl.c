@@ -14,13 +14,33 @@
 
 /* FreeRTOS includes */
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "freertos/timers.h"
 
+/* ESP includes */
+#include "esp_log.h"
+#include "esp_timer.h"
+
 /* LVGL includes */
 #include "iot_lvgl.h"
 
 // wait for execute lv_task_handler and lv_tick_inc to avoid some widget don't refresh.
 #define LVGL_INIT_DELAY 100 // unit ms
+// lv_task_handler period, the one of the former esp_timer callback
+#define LVGL_TASK_PERIOD 5 // unit ms
+
+#if CONFIG_LVGL_TASK_CORE_0
+#define LVGL_TASK_CORE 0
+#elif CONFIG_LVGL_TASK_CORE_1
+#define LVGL_TASK_CORE 1
+#else
+#define LVGL_TASK_CORE tskNO_AFFINITY
+#endif
+
+static const char *TAG = "lvgl";
+static TaskHandle_t s_lvgl_task = NULL;
+static portMUX_TYPE s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static lvgl_task_stats_t s_stats;
 
 static void lv_tick_timercb(void *timer)
 {
@@ -30,11 +50,25 @@ static void lv_tick_timercb(void *timer)
     lv_tick_inc(1);
 }
 
-static void lv_task_timercb(void *timer)
+static void lvgl_task(void *arg)
 {
-    /* Periodically call this function.
-     * The timing is not critical but should be between 1..10 ms */
-    lv_task_handler();
+    while (1) {
+        int64_t start = esp_timer_get_time();
+        lv_task_handler();
+        uint32_t cost = esp_timer_get_time() - start;
+
+        portENTER_CRITICAL(&s_stats_mux);
+        s_stats.loop_cnt++;
+        s_stats.last_us = cost;
+        s_stats.total_us += cost;
+        if (cost > s_stats.max_us) {
+            s_stats.max_us = cost;
+        }
+        portEXIT_CRITICAL(&s_stats_mux);
+
+        /* Sleep for one period, lvgl_task_wakeup() cuts it short */
+        ulTaskNotifyTake(pdTRUE, LVGL_TASK_PERIOD / portTICK_PERIOD_MS);
+    }
 }
 
 void lvgl_init()
@@ -63,15 +97,12 @@ void lvgl_init()
     lv_indev_drv_t indevdrv = lvgl_indev_init(); /*Initialize your indev*/
 #endif
 
-    esp_timer_create_args_t lv_task_timer_conf = {
-        .callback = lv_task_timercb,
-        .name     = "lv_task_timer"
-    };
-
-    esp_timer_handle_t lv_task_timer = NULL;
-    esp_timer_create(&lv_task_timer_conf, &lv_task_timer);
-
-    esp_timer_start_periodic(lv_task_timer, 5 * 1000U);
+    /* Rendering runs in its own task so it doesn't hold up the esp_timer task */
+    if (xTaskCreatePinnedToCore(lvgl_task, "lvgl_task", CONFIG_LVGL_TASK_STACK_SIZE, NULL,
+                                CONFIG_LVGL_TASK_PRIORITY, &s_lvgl_task, LVGL_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "lvgl task create failed");
+        return;
+    }
 
     vTaskDelay(LVGL_INIT_DELAY / portTICK_PERIOD_MS);    // wait for execute lv_task_handler and lv_tick_inc to avoid some widget don't refresh.
 
@@ -79,4 +110,18 @@ void lvgl_init()
     /* Calibrate touch screen */
     lvgl_calibrate_mouse(indevdrv, false);
 #endif
+}
+
+void lvgl_task_wakeup()
+{
+    if (s_lvgl_task != NULL) {
+        xTaskNotifyGive(s_lvgl_task);
+    }
+}
+
+void lvgl_get_task_stats(lvgl_task_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_stats_mux);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_stats_mux);
 }
\ No newline at end of file
@@ -12,15 +12,28 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 #include "driver/i2c.h"
 #include "iot_i2c_bus.h"
 
+typedef struct i2c_bus_device i2c_bus_device_t;
+
 typedef struct {
     i2c_config_t i2c_conf;   /*!<I2C bus parameters*/
     i2c_port_t i2c_port;     /*!<I2C port number */
+    SemaphoreHandle_t mux;   /*!<Held for every transaction or batch on the bus */
+    i2c_bus_device_t* dev_list;  /*!<Devices registered on the bus */
 } i2c_bus_t;
 
+struct i2c_bus_device {
+    i2c_bus_t* bus;          /*!<Bus the device sits on */
+    uint8_t dev_addr;        /*!<7-bit device address */
+    i2c_bus_device_t* next;
+};
+
 static const char* I2C_BUS_TAG = "i2c_bus";
 #define I2C_BUS_CHECK(a, str, ret)  if(!(a)) {                                             \
     ESP_LOGE(I2C_BUS_TAG,"%s:%d (%s):%s", __FILE__, __LINE__, __FUNCTION__, str);      \
@@ -28,14 +41,22 @@ static const char* I2C_BUS_TAG = "i2c_bus";
     }
 #define ESP_INTR_FLG_DEFAULT  (0)
 #define ESP_I2C_MASTER_BUF_LEN  (0)
+#define I2C_BUS_ACK_CHECK_EN    (1)
+#define I2C_BUS_ACK_VAL         (0)
+#define I2C_BUS_NACK_VAL        (1)
 
 i2c_bus_handle_t iot_i2c_bus_create(i2c_port_t port, i2c_config_t* conf)
 {
     I2C_BUS_CHECK(port < I2C_NUM_MAX, "I2C port error", NULL);
     I2C_BUS_CHECK(conf != NULL, "Pointer error", NULL);
     i2c_bus_t* bus = (i2c_bus_t*) calloc(1, sizeof(i2c_bus_t));
+    I2C_BUS_CHECK(bus != NULL, "Memory error", NULL);
     bus->i2c_conf = *conf;
     bus->i2c_port = port;
+    bus->mux = xSemaphoreCreateMutex();
+    if (bus->mux == NULL) {
+        goto error;
+    }
     esp_err_t ret = i2c_param_config(bus->i2c_port, &bus->i2c_conf);
     if(ret != ESP_OK) {
         goto error;
@@ -48,6 +69,9 @@ i2c_bus_handle_t iot_i2c_bus_create(i2c_port_t port, i2c_config_t* conf)
 
     error:
     if(bus) {
+        if (bus->mux) {
+            vSemaphoreDelete(bus->mux);
+        }
         free(bus);
     }
     return NULL;
@@ -57,7 +81,9 @@ esp_err_t iot_i2c_bus_delete(i2c_bus_handle_t bus)
 {
     I2C_BUS_CHECK(bus != NULL, "Handle error", ESP_FAIL);
     i2c_bus_t* i2c_bus = (i2c_bus_t*) bus;
+    I2C_BUS_CHECK(i2c_bus->dev_list == NULL, "Devices still registered", ESP_FAIL);
     i2c_driver_delete(i2c_bus->i2c_port);
+    vSemaphoreDelete(i2c_bus->mux);
     free(bus);
     return ESP_OK;
 }
@@ -67,5 +93,158 @@ esp_err_t iot_i2c_bus_cmd_begin(i2c_bus_handle_t bus, i2c_cmd_handle_t cmd, port
     I2C_BUS_CHECK(bus != NULL, "Handle error", ESP_FAIL);
     I2C_BUS_CHECK(cmd != NULL, "I2C cmd error", ESP_FAIL);
     i2c_bus_t* i2c_bus = (i2c_bus_t*) bus;
-    return i2c_master_cmd_begin(i2c_bus->i2c_port, cmd, ticks_to_wait);
+    if (xSemaphoreTake(i2c_bus->mux, ticks_to_wait) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t ret = i2c_master_cmd_begin(i2c_bus->i2c_port, cmd, ticks_to_wait);
+    xSemaphoreGive(i2c_bus->mux);
+    return ret;
+}
+
+i2c_bus_device_handle_t iot_i2c_bus_device_create(i2c_bus_handle_t bus, uint8_t dev_addr)
+{
+    I2C_BUS_CHECK(bus != NULL, "Handle error", NULL);
+    I2C_BUS_CHECK(dev_addr < 0x80, "Device address error", NULL);
+    i2c_bus_t* i2c_bus = (i2c_bus_t*) bus;
+    i2c_bus_device_t* dev = (i2c_bus_device_t*) calloc(1, sizeof(i2c_bus_device_t));
+    I2C_BUS_CHECK(dev != NULL, "Memory error", NULL);
+    dev->bus = i2c_bus;
+    dev->dev_addr = dev_addr;
+
+    xSemaphoreTake(i2c_bus->mux, portMAX_DELAY);
+    for (i2c_bus_device_t* it = i2c_bus->dev_list; it != NULL; it = it->next) {
+        if (it->dev_addr == dev_addr) {
+            xSemaphoreGive(i2c_bus->mux);
+            free(dev);
+            ESP_LOGE(I2C_BUS_TAG, "device 0x%02x already registered", dev_addr);
+            return NULL;
+        }
+    }
+    dev->next = i2c_bus->dev_list;
+    i2c_bus->dev_list = dev;
+    xSemaphoreGive(i2c_bus->mux);
+    return (i2c_bus_device_handle_t) dev;
+}
+
+esp_err_t iot_i2c_bus_device_delete(i2c_bus_device_handle_t dev)
+{
+    I2C_BUS_CHECK(dev != NULL, "Handle error", ESP_FAIL);
+    i2c_bus_device_t* i2c_dev = (i2c_bus_device_t*) dev;
+    i2c_bus_t* i2c_bus = i2c_dev->bus;
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    xSemaphoreTake(i2c_bus->mux, portMAX_DELAY);
+    for (i2c_bus_device_t** it = &i2c_bus->dev_list; *it != NULL; it = &(*it)->next) {
+        if (*it == i2c_dev) {
+            *it = i2c_dev->next;
+            ret = ESP_OK;
+            break;
+        }
+    }
+    xSemaphoreGive(i2c_bus->mux);
+    if (ret != ESP_OK) {
+        ESP_LOGE(I2C_BUS_TAG, "device not registered");
+        return ret;
+    }
+    free(i2c_dev);
+    return ESP_OK;
+}
+
+uint8_t iot_i2c_bus_device_get_address(i2c_bus_device_handle_t dev)
+{
+    return ((i2c_bus_device_t*) dev)->dev_addr;
+}
+
+/* Append one register access to a command link, each access ends with a stop
+ * so devices see the same sequence as a standalone transaction */
+static void i2c_bus_op_append(i2c_cmd_handle_t cmd, const i2c_bus_op_t* op)
+{
+    uint8_t addr = ((i2c_bus_device_t*) op->dev)->dev_addr;
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_WRITE, I2C_BUS_ACK_CHECK_EN);
+    i2c_master_write_byte(cmd, op->reg, I2C_BUS_ACK_CHECK_EN);
+    if (op->type == I2C_BUS_OP_WRITE) {
+        if (op->len > 0) {
+            i2c_master_write(cmd, op->data, op->len, I2C_BUS_ACK_CHECK_EN);
+        }
+    } else {
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_READ, I2C_BUS_ACK_CHECK_EN);
+        if (op->len > 1) {
+            i2c_master_read(cmd, op->data, op->len - 1, I2C_BUS_ACK_VAL);
+        }
+        i2c_master_read_byte(cmd, op->data + op->len - 1, I2C_BUS_NACK_VAL);
+    }
+    i2c_master_stop(cmd);
+}
+
+static esp_err_t i2c_bus_ops_run(i2c_bus_t* i2c_bus, i2c_bus_op_t* ops, int op_num, portBASE_TYPE ticks_to_wait)
+{
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    if (cmd == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (int i = 0; i < op_num; i++) {
+        i2c_bus_op_append(cmd, &ops[i]);
+    }
+    esp_err_t ret = i2c_master_cmd_begin(i2c_bus->i2c_port, cmd, ticks_to_wait);
+    i2c_cmd_link_delete(cmd);
+    return ret;
+}
+
+static esp_err_t i2c_bus_ops_set_ret(i2c_bus_op_t* ops, int op_num, esp_err_t ret)
+{
+    for (int i = 0; i < op_num; i++) {
+        ops[i].ret = ret;
+    }
+    return ret;
+}
+
+esp_err_t iot_i2c_bus_batch(i2c_bus_handle_t bus, i2c_bus_op_t* ops, int op_num, portBASE_TYPE ticks_to_wait)
+{
+    I2C_BUS_CHECK(ops != NULL && op_num > 0, "Batch error", ESP_ERR_INVALID_ARG);
+    if (bus == NULL) {
+        ESP_LOGE(I2C_BUS_TAG, "Handle error");
+        return i2c_bus_ops_set_ret(ops, op_num, ESP_FAIL);
+    }
+    i2c_bus_t* i2c_bus = (i2c_bus_t*) bus;
+    for (int i = 0; i < op_num; i++) {
+        if (ops[i].dev == NULL || ((i2c_bus_device_t*) ops[i].dev)->bus != i2c_bus
+                || (ops[i].type == I2C_BUS_OP_READ && (ops[i].data == NULL || ops[i].len == 0))) {
+            ESP_LOGE(I2C_BUS_TAG, "Batch access %d error", i);
+            return i2c_bus_ops_set_ret(ops, op_num, ESP_ERR_INVALID_ARG);
+        }
+    }
+
+    if (xSemaphoreTake(i2c_bus->mux, ticks_to_wait) != pdTRUE) {
+        return i2c_bus_ops_set_ret(ops, op_num, ESP_ERR_TIMEOUT);
+    }
+    // The whole batch goes out as one command link
+    esp_err_t ret = i2c_bus_ops_run(i2c_bus, ops, op_num, ticks_to_wait);
+    i2c_bus_ops_set_ret(ops, op_num, ret);
+    if (ret == ESP_FAIL && op_num > 1) {
+        // A device didn't ACK and the driver aborted the link. The accesses before it
+        // took effect, so only those marked replay are run again to tell which failed.
+        for (int i = 0; i < op_num; i++) {
+            if (ops[i].replay) {
+                ops[i].ret = i2c_bus_ops_run(i2c_bus, &ops[i], 1, ticks_to_wait);
+            }
+        }
+    }
+    xSemaphoreGive(i2c_bus->mux);
+    return ret;
+}
+
+esp_err_t iot_i2c_bus_read_reg(i2c_bus_device_handle_t dev, uint8_t reg, uint8_t* data, size_t len, portBASE_TYPE ticks_to_wait)
+{
+    I2C_BUS_CHECK(dev != NULL, "Handle error", ESP_FAIL);
+    i2c_bus_op_t op = { .dev = dev, .type = I2C_BUS_OP_READ, .reg = reg, .data = data, .len = len };
+    return iot_i2c_bus_batch(((i2c_bus_device_t*) dev)->bus, &op, 1, ticks_to_wait);
+}
+
+esp_err_t iot_i2c_bus_write_reg(i2c_bus_device_handle_t dev, uint8_t reg, const uint8_t* data, size_t len, portBASE_TYPE ticks_to_wait)
+{
+    I2C_BUS_CHECK(dev != NULL, "Handle error", ESP_FAIL);
+    i2c_bus_op_t op = { .dev = dev, .type = I2C_BUS_OP_WRITE, .reg = reg, .data = (uint8_t*) data, .len = len };
+    return iot_i2c_bus_batch(((i2c_bus_device_t*) dev)->bus, &op, 1, ticks_to_wait);
 }
@@ -39,6 +39,11 @@ esp_err_t CI2CBus::send(i2c_cmd_handle_t cmd, portBASE_TYPE ticks_to_wait)
     return iot_i2c_bus_cmd_begin(m_i2c_bus_handle, cmd, ticks_to_wait);
 }
 
+esp_err_t CI2CBus::batch(i2c_bus_op_t* ops, int op_num, portBASE_TYPE ticks_to_wait)
+{
+    return iot_i2c_bus_batch(m_i2c_bus_handle, ops, op_num, ticks_to_wait);
+}
+
 i2c_bus_handle_t CI2CBus::get_bus_handle()
 {
     return m_i2c_bus_handle;
@@ -21,6 +21,28 @@ extern "C"
 #endif
 
 typedef void* i2c_bus_handle_t;
+typedef void* i2c_bus_device_handle_t;
+
+/**
+ * @brief Direction of a register access in a batch
+ */
+typedef enum {
+    I2C_BUS_OP_WRITE = 0,   /*!< write len bytes starting at reg */
+    I2C_BUS_OP_READ,        /*!< read len bytes starting at reg */
+} i2c_bus_op_type_t;
+
+/**
+ * @brief One register access of a batch
+ */
+typedef struct {
+    i2c_bus_device_handle_t dev;    /*!< device to access, registered on the bus the batch runs on */
+    i2c_bus_op_type_t type;         /*!< read or write */
+    uint8_t reg;                    /*!< first register address */
+    uint8_t* data;                  /*!< data to write or buffer to read into */
+    size_t len;                     /*!< number of bytes */
+    bool replay;                    /*!< may run again alone when the batch fails, only for accesses without side effects */
+    esp_err_t ret;                  /*!< result of this access, set by iot_i2c_bus_batch */
+} i2c_bus_op_t;
 
 /**
  * @brief Create and init I2C bus and return a I2C bus handle
@@ -47,16 +69,106 @@ esp_err_t iot_i2c_bus_delete(i2c_bus_handle_t bus);
 /**
  * @brief I2C start sending buffered commands
  *
+ * The bus is locked for the whole transaction, so commands from different
+ * tasks never interleave.
+ *
  * @param bus I2C bus handle
  * @param cmd I2C cmd handle
  * @param ticks_to_wait Maximum blocking time
  *
  * @return
  *     - ESP_OK Success
+ *     - ESP_ERR_TIMEOUT The bus stayed locked or busy
  *     - ESP_FAIL Fail
  */
 esp_err_t iot_i2c_bus_cmd_begin(i2c_bus_handle_t bus, i2c_cmd_handle_t cmd,
 portBASE_TYPE ticks_to_wait);
+
+/**
+ * @brief Register a device on the I2C bus
+ *
+ * @param bus I2C bus handle
+ * @param dev_addr 7-bit device address
+ *
+ * @return
+ *     - NULL Fail, or a device with this address is already registered
+ *     - Others Success
+ */
+i2c_bus_device_handle_t iot_i2c_bus_device_create(i2c_bus_handle_t bus, uint8_t dev_addr);
+
+/**
+ * @brief Remove a device from its I2C bus and release it
+ *
+ * @param dev I2C device handle
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ *     - ESP_ERR_NOT_FOUND The device is not registered on its bus
+ */
+esp_err_t iot_i2c_bus_device_delete(i2c_bus_device_handle_t dev);
+
+/**
+ * @brief Get the 7-bit address of a registered device
+ *
+ * @param dev I2C device handle
+ *
+ * @return device address
+ */
+uint8_t iot_i2c_bus_device_get_address(i2c_bus_device_handle_t dev);
+
+/**
+ * @brief Run a batch of register accesses, possibly to different devices, in one bus acquisition
+ *
+ * The accesses are sent in order as a single command link, and the ret field of each
+ * access is set to the result. If a device doesn't ACK, the driver aborts the link and
+ * every access reports ESP_FAIL, since the ones before the failed access may have taken
+ * effect. Accesses with replay set are then run again one by one, so their ret tells
+ * which of them failed. Only set it for accesses that can safely run twice, not for
+ * writes, triggers or FIFO reads.
+ *
+ * @param bus I2C bus handle
+ * @param ops register accesses
+ * @param op_num number of accesses
+ * @param ticks_to_wait Maximum blocking time
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Parameter error
+ *     - ESP_ERR_TIMEOUT The bus stayed locked or busy
+ *     - ESP_FAIL At least one device didn't ACK
+ */
+esp_err_t iot_i2c_bus_batch(i2c_bus_handle_t bus, i2c_bus_op_t* ops, int op_num, portBASE_TYPE ticks_to_wait);
+
+/**
+ * @brief Read consecutive registers of a device
+ *
+ * @param dev I2C device handle
+ * @param reg first register address
+ * @param data buffer to read into
+ * @param len number of bytes
+ * @param ticks_to_wait Maximum blocking time
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_i2c_bus_read_reg(i2c_bus_device_handle_t dev, uint8_t reg, uint8_t* data, size_t len, portBASE_TYPE ticks_to_wait);
+
+/**
+ * @brief Write consecutive registers of a device
+ *
+ * @param dev I2C device handle
+ * @param reg first register address
+ * @param data data to write
+ * @param len number of bytes
+ * @param ticks_to_wait Maximum blocking time
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_i2c_bus_write_reg(i2c_bus_device_handle_t dev, uint8_t reg, const uint8_t* data, size_t len, portBASE_TYPE ticks_to_wait);
 #ifdef __cplusplus
 }
 #endif
@@ -106,6 +218,19 @@ public:
      */
     esp_err_t send(i2c_cmd_handle_t cmd, portBASE_TYPE ticks_to_wait);
 
+    /**
+     * @brief Run a batch of register accesses in one bus acquisition
+     * @param ops register accesses, see iot_i2c_bus_batch
+     * @param op_num number of accesses
+     * @param ticks_to_wait max block time
+     * @return
+     *     - ESP_OK Success
+     *     - ESP_ERR_INVALID_ARG Parameter error
+     *     - ESP_ERR_TIMEOUT The bus stayed locked or busy
+     *     - ESP_FAIL At least one device didn't ACK
+     */
+    esp_err_t batch(i2c_bus_op_t* ops, int op_num, portBASE_TYPE ticks_to_wait);
+
     /**
      * @brief Get bus handle
      * @return bus handle
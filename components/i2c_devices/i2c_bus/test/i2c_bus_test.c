@@ -0,0 +1,98 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <stdio.h>
+#include "unity.h"
+#include "driver/i2c.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "iot_i2c_bus.h"
+
+#define I2C_MASTER_SCL_IO           21          /*!< gpio number for I2C master clock */
+#define I2C_MASTER_SDA_IO           15          /*!< gpio number for I2C master data  */
+#define I2C_MASTER_NUM              I2C_NUM_1   /*!< I2C port number for master dev */
+#define I2C_MASTER_FREQ_HZ          100000      /*!< I2C master clock frequency */
+
+#define TEST_DEV_ADDR               0x5F        /*!< HTS221 on the sensor board */
+#define TEST_DEV_ID_REG             0x0F
+#define TEST_DEV_ID                 0xBC
+#define TEST_ABSENT_ADDR            0x0A        /*!< nothing answers here */
+#define TEST_BATCH_NUM              8
+
+static const char *TAG = "I2C_BUS";
+
+TEST_CASE("I2C bus batch test", "[i2c_bus][iot]")
+{
+    i2c_config_t conf;
+    conf.mode = I2C_MODE_MASTER;
+    conf.sda_io_num = I2C_MASTER_SDA_IO;
+    conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
+    conf.scl_io_num = I2C_MASTER_SCL_IO;
+    conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
+    conf.master.clk_speed = I2C_MASTER_FREQ_HZ;
+    i2c_bus_handle_t bus = iot_i2c_bus_create(I2C_MASTER_NUM, &conf);
+    TEST_ASSERT(bus != NULL);
+
+    i2c_bus_device_handle_t dev = iot_i2c_bus_device_create(bus, TEST_DEV_ADDR);
+    i2c_bus_device_handle_t absent = iot_i2c_bus_device_create(bus, TEST_ABSENT_ADDR);
+    TEST_ASSERT(dev != NULL && absent != NULL);
+    TEST_ASSERT(iot_i2c_bus_device_create(bus, TEST_DEV_ADDR) == NULL);
+    TEST_ASSERT_EQUAL(ESP_FAIL, iot_i2c_bus_delete(bus));
+
+    uint8_t id[TEST_BATCH_NUM] = { 0 };
+    i2c_bus_op_t ops[TEST_BATCH_NUM];
+    for (int i = 0; i < TEST_BATCH_NUM; i++) {
+        ops[i] = (i2c_bus_op_t) { .dev = dev, .type = I2C_BUS_OP_READ, .reg = TEST_DEV_ID_REG, .data = &id[i], .len = 1 };
+    }
+
+    // One bus acquisition against one transaction per register
+    int64_t t0 = esp_timer_get_time();
+    for (int i = 0; i < TEST_BATCH_NUM; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, iot_i2c_bus_read_reg(dev, TEST_DEV_ID_REG, &id[i], 1, 1000 / portTICK_RATE_MS));
+    }
+    int64_t single_us = esp_timer_get_time() - t0;
+    t0 = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, iot_i2c_bus_batch(bus, ops, TEST_BATCH_NUM, 1000 / portTICK_RATE_MS));
+    int64_t batch_us = esp_timer_get_time() - t0;
+    ESP_LOGI(TAG, "%d reads: one by one %lld us, batch %lld us", TEST_BATCH_NUM, single_us, batch_us);
+    for (int i = 0; i < TEST_BATCH_NUM; i++) {
+        TEST_ASSERT_EQUAL_HEX8(TEST_DEV_ID, id[i]);
+        TEST_ASSERT_EQUAL(ESP_OK, ops[i].ret);
+    }
+
+    // A missing device fails the whole batch, nothing is sent twice
+    ops[1].dev = absent;
+    TEST_ASSERT_EQUAL(ESP_FAIL, iot_i2c_bus_batch(bus, ops, 3, 1000 / portTICK_RATE_MS));
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(ESP_FAIL, ops[i].ret);
+    }
+
+    // Reads of the ID register can run again, that tells the failed access apart
+    for (int i = 0; i < 3; i++) {
+        ops[i].replay = true;
+    }
+    TEST_ASSERT_EQUAL(ESP_FAIL, iot_i2c_bus_batch(bus, ops, 3, 1000 / portTICK_RATE_MS));
+    TEST_ASSERT_EQUAL(ESP_OK, ops[0].ret);
+    TEST_ASSERT_EQUAL(ESP_FAIL, ops[1].ret);
+    TEST_ASSERT_EQUAL(ESP_OK, ops[2].ret);
+
+    // Bad handles leave the ret fields telling why
+    ops[1].dev = NULL;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, iot_i2c_bus_batch(bus, ops, 3, 1000 / portTICK_RATE_MS));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, ops[0].ret);
+    ops[1].dev = dev;
+
+    TEST_ASSERT_EQUAL(ESP_OK, iot_i2c_bus_device_delete(absent));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_i2c_bus_device_delete(dev));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_i2c_bus_delete(bus));
+}
@@ -12,13 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include <stdio.h>
+#include <string.h>
 #include "driver/i2c.h"
+#include "esp_timer.h"
 #include "iot_i2c_bus.h"
 #include "iot_at24c02.h"
 
+#define AT24C02_WRITE_TIMEOUT_US    (10 * 1000)     /* tWR is 5 ms max, leave some margin */
+
 typedef struct {
     i2c_bus_handle_t bus;
     uint16_t dev_addr;
+    uint8_t *cache;             /* copy of the whole array when the write-back cache is on */
+    uint32_t dirty_pages;       /* bit n set: cached page n has not been written back */
 } at24c02_dev_t;
 
 at24c02_handle_t iot_at24c02_create(i2c_bus_handle_t bus, uint16_t dev_addr)
@@ -32,110 +38,178 @@ at24c02_handle_t iot_at24c02_create(i2c_bus_handle_t bus, uint16_t dev_addr)
 esp_err_t iot_at24c02_delete(at24c02_handle_t dev, bool del_bus)
 {
     at24c02_dev_t* device = (at24c02_dev_t*) dev;
+    // the handle goes away either way, but tell the caller when cached writes were lost
+    esp_err_t ret = iot_at24c02_cache_enable(dev, false);
     if (del_bus) {
         iot_i2c_bus_delete(device->bus);
         device->bus = NULL;
     }
     free(device);
-    return ESP_OK;
+    return ret;
 }
 
-esp_err_t iot_at24c02_write_byte(at24c02_handle_t dev, uint8_t addr,
-        uint8_t data)
+/* The chip does not ACK its address during the internal write cycle, so probe until it does */
+static esp_err_t at24c02_wait_write_done(at24c02_dev_t* device)
 {
-    //start-device_addr-word_addr-data-stop
     esp_err_t ret;
-    at24c02_dev_t* device = (at24c02_dev_t*) dev;
+    int64_t deadline = esp_timer_get_time() + AT24C02_WRITE_TIMEOUT_US;
+    do {
+        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, (device->dev_addr << 1) | WRITE_BIT, ACK_CHECK_EN);
+        i2c_master_stop(cmd);
+        ret = iot_i2c_bus_cmd_begin(device->bus, cmd, 1000 / portTICK_RATE_MS);
+        i2c_cmd_link_delete(cmd);
+    } while (ret == ESP_FAIL && esp_timer_get_time() < deadline);
+    return ret;
+}
+
+/* Write len bytes that do not cross a page boundary and wait for the write cycle */
+static esp_err_t at24c02_write_page(at24c02_dev_t* device, uint8_t addr, const uint8_t *data, uint8_t len)
+{
+    //start-device_addr-word_addr-data...-stop
+    esp_err_t ret;
     i2c_cmd_handle_t cmd = i2c_cmd_link_create();
     i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (device->dev_addr << 1) | WRITE_BIT,
-            ACK_CHECK_EN);
+    i2c_master_write_byte(cmd, (device->dev_addr << 1) | WRITE_BIT, ACK_CHECK_EN);
     i2c_master_write_byte(cmd, addr, ACK_CHECK_EN);
-    i2c_master_write_byte(cmd, data, ACK_CHECK_EN);
+    i2c_master_write(cmd, (uint8_t *) data, len, ACK_CHECK_EN);
     i2c_master_stop(cmd);
     ret = iot_i2c_bus_cmd_begin(device->bus, cmd, 1000 / portTICK_RATE_MS);
     i2c_cmd_link_delete(cmd);
-    return ret;
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return at24c02_wait_write_done(device);
 }
 
-esp_err_t iot_at24c02_write(at24c02_handle_t dev, uint8_t start_addr,
-        uint8_t write_num, uint8_t *data_buf)
+static esp_err_t at24c02_write_pages(at24c02_dev_t* device, uint8_t start_addr, uint16_t write_num, const uint8_t *data_buf)
 {
-    uint32_t i = 0;
-    i2c_cmd_handle_t cmd;
-    esp_err_t ret = ESP_FAIL;
-    uint32_t writeNum = write_num;
-    at24c02_dev_t* device = (at24c02_dev_t*) dev;
-    if (data_buf != NULL) {
-        for (uint32_t j = 0; j < write_num; j += 8) {
-            cmd = i2c_cmd_link_create();
-            i2c_master_start(cmd);
-            i2c_master_write_byte(cmd, (device->dev_addr << 1) | WRITE_BIT,
-                    ACK_CHECK_EN);
-            i2c_master_write_byte(cmd, start_addr, ACK_CHECK_EN);
-            for (i = j; i < ((writeNum >= 8) ? 8 : writeNum); i++) {
-                i2c_master_write_byte(cmd, data_buf[i], ACK_CHECK_EN);
-                vTaskDelay(100 / portTICK_RATE_MS);
-            }
-            i2c_master_stop(cmd);
-            ret = iot_i2c_bus_cmd_begin(device->bus, cmd, 1000 / portTICK_RATE_MS);
-            i2c_cmd_link_delete(cmd);
-
-            writeNum -= 8;              //write num count
-            if (ret == ESP_FAIL) {
-                return ret;
-            }
-        }
+    esp_err_t ret = ESP_OK;
+    uint16_t addr = start_addr;
+    while (write_num > 0 && ret == ESP_OK) {
+        // The page address counter wraps inside a page, so never cross a page boundary
+        uint8_t len = AT24C02_PAGE_SIZE - addr % AT24C02_PAGE_SIZE;
+        len = write_num < len ? write_num : len;
+        ret = at24c02_write_page(device, addr, data_buf, len);
+        addr += len;
+        data_buf += len;
+        write_num -= len;
     }
     return ret;
 }
 
-esp_err_t iot_at24c02_read_byte(at24c02_handle_t dev, uint8_t addr,
-        uint8_t *data)
+/* Sequential read, the address counter rolls over across pages so one transaction reads any length */
+static esp_err_t at24c02_read_seq(at24c02_dev_t* device, uint8_t start_addr, uint16_t read_num, uint8_t *data_buf)
 {
-    //start-device_addr-word_addr-start-device_addr-data-stop; no_ack of end data
+    //start-device_addr-word_addr-start-device_addr-data...-stop; no_ack of end data
     esp_err_t ret;
-    at24c02_dev_t* device = (at24c02_dev_t*) dev;
     i2c_cmd_handle_t cmd = i2c_cmd_link_create();
     i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (device->dev_addr << 1) | WRITE_BIT,
-            ACK_CHECK_EN);
-    i2c_master_write_byte(cmd, addr, ACK_CHECK_EN);
-
+    i2c_master_write_byte(cmd, (device->dev_addr << 1) | WRITE_BIT, ACK_CHECK_EN);
+    i2c_master_write_byte(cmd, start_addr, ACK_CHECK_EN);
     i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (device->dev_addr << 1) | READ_BIT,
-            ACK_CHECK_EN);
-    i2c_master_read_byte(cmd, data, NACK_VAL);
+    i2c_master_write_byte(cmd, (device->dev_addr << 1) | READ_BIT, ACK_CHECK_EN);
+    if (read_num > 1) {
+        i2c_master_read(cmd, data_buf, read_num - 1, ACK_VAL);
+    }
+    i2c_master_read_byte(cmd, &data_buf[read_num - 1], NACK_VAL);
     i2c_master_stop(cmd);
     ret = iot_i2c_bus_cmd_begin(device->bus, cmd, 1000 / portTICK_RATE_MS);
     i2c_cmd_link_delete(cmd);
     return ret;
 }
 
+esp_err_t iot_at24c02_write_byte(at24c02_handle_t dev, uint8_t addr,
+        uint8_t data)
+{
+    return iot_at24c02_write(dev, addr, 1, &data);
+}
+
+esp_err_t iot_at24c02_write(at24c02_handle_t dev, uint8_t start_addr,
+        uint8_t write_num, uint8_t *data_buf)
+{
+    at24c02_dev_t* device = (at24c02_dev_t*) dev;
+    if (data_buf == NULL || start_addr + write_num > AT24C02_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (write_num == 0) {
+        return ESP_OK;
+    }
+    if (device->cache) {
+        memcpy(device->cache + start_addr, data_buf, write_num);
+        for (int page = start_addr / AT24C02_PAGE_SIZE; page * AT24C02_PAGE_SIZE < start_addr + write_num; page++) {
+            device->dirty_pages |= 1UL << page;
+        }
+        return ESP_OK;
+    }
+    return at24c02_write_pages(device, start_addr, write_num, data_buf);
+}
+
+esp_err_t iot_at24c02_read_byte(at24c02_handle_t dev, uint8_t addr,
+        uint8_t *data)
+{
+    return iot_at24c02_read(dev, addr, 1, data);
+}
+
 esp_err_t iot_at24c02_read(at24c02_handle_t dev, uint8_t start_addr,
         uint8_t read_num, uint8_t *data_buf)
 {
-    uint32_t i = 0;
-    esp_err_t ret = ESP_FAIL;
-    if (data_buf != NULL) {
-        at24c02_dev_t* device = (at24c02_dev_t*) dev;
-        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-        i2c_master_start(cmd);
-        i2c_master_write_byte(cmd, (device->dev_addr << 1) | WRITE_BIT,
-                ACK_CHECK_EN);
-        i2c_master_write_byte(cmd, start_addr, ACK_CHECK_EN);
+    at24c02_dev_t* device = (at24c02_dev_t*) dev;
+    if (data_buf == NULL || read_num == 0 || start_addr + read_num > AT24C02_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (device->cache) {
+        memcpy(data_buf, device->cache + start_addr, read_num);
+        return ESP_OK;
+    }
+    return at24c02_read_seq(device, start_addr, read_num, data_buf);
+}
 
-        i2c_master_start(cmd);
-        i2c_master_write_byte(cmd, (device->dev_addr << 1) | READ_BIT,
-                ACK_CHECK_EN);
-        for (i = 0; i < read_num - 1; i++) {
-            i2c_master_read_byte(cmd, &data_buf[i], ACK_VAL);
-        }
-        i2c_master_read_byte(cmd, &data_buf[i], NACK_VAL);
-        i2c_master_stop(cmd);
-        ret = iot_i2c_bus_cmd_begin(device->bus, cmd, 1000 / portTICK_RATE_MS);
-        i2c_cmd_link_delete(cmd);
+esp_err_t iot_at24c02_cache_enable(at24c02_handle_t dev, bool enable)
+{
+    at24c02_dev_t* device = (at24c02_dev_t*) dev;
+    esp_err_t ret;
+    if (enable == (device->cache != NULL)) {
+        return ESP_OK;
     }
-    return ret;
+    if (!enable) {
+        ret = iot_at24c02_flush(dev);
+        free(device->cache);
+        device->cache = NULL;
+        return ret;
+    }
+    uint8_t *cache = (uint8_t *) malloc(AT24C02_SIZE);
+    if (cache == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    ret = at24c02_read_seq(device, 0, AT24C02_SIZE, cache);
+    if (ret != ESP_OK) {
+        free(cache);
+        return ret;
+    }
+    device->cache = cache;
+    device->dirty_pages = 0;
+    return ESP_OK;
 }
 
+esp_err_t iot_at24c02_flush(at24c02_handle_t dev)
+{
+    at24c02_dev_t* device = (at24c02_dev_t*) dev;
+    esp_err_t ret;
+    if (device->cache == NULL) {
+        return ESP_OK;
+    }
+    for (int page = 0; page < AT24C02_SIZE / AT24C02_PAGE_SIZE; page++) {
+        if ((device->dirty_pages & (1UL << page)) == 0) {
+            continue;
+        }
+        ret = at24c02_write_page(device, page * AT24C02_PAGE_SIZE,
+                device->cache + page * AT24C02_PAGE_SIZE, AT24C02_PAGE_SIZE);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        device->dirty_pages &= ~(1UL << page);
+    }
+    return ESP_OK;
+}
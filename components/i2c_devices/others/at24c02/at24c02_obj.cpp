@@ -52,3 +52,13 @@ esp_err_t CAT24C02::read(uint8_t start_addr, uint8_t read_num,
 {
     return iot_at24c02_read(m_dev_handle, start_addr, read_num, data_buf);
 }
+
+esp_err_t CAT24C02::cache_enable(bool enable)
+{
+    return iot_at24c02_cache_enable(m_dev_handle, enable);
+}
+
+esp_err_t CAT24C02::flush()
+{
+    return iot_at24c02_flush(m_dev_handle);
+}
@@ -23,6 +23,8 @@ extern "C"
 #include "iot_i2c_bus.h"
 
 #define AT24C02_I2C_ADDRESS_DEFAULT   (0x50)    //1 0  1  0   A2  A1  A0  R/W
+#define AT24C02_SIZE                  (256)     /*!< bytes in the array */
+#define AT24C02_PAGE_SIZE             (8)       /*!< bytes written in one write cycle */
 
 #define WRITE_BIT      I2C_MASTER_WRITE         /*!< I2C master write */
 #define READ_BIT       I2C_MASTER_READ          /*!< I2C master read */
@@ -46,18 +48,19 @@ at24c02_handle_t iot_at24c02_create(i2c_bus_handle_t bus, uint16_t dev_addr);
 
 /**
  * @brief   delete AT24C02 handle_t
+ *          An enabled cache is flushed first, the handle is freed even if that fails.
  *
  * @param   dev object handle of AT24C02
  * @param   whether delete i2c bus
  *
  * @return
  *     - ESP_OK Success
- *     - ESP_FAIL Fail
+ *     - ESP_FAIL Fail, cached writes did not reach the chip
  */
 esp_err_t iot_at24c02_delete(at24c02_handle_t dev, bool del_bus);
 
 /**
- * @brief   Write a data on addr
+ * @brief   Write a data on addr, returns after the write cycle is done
  *
  * @param   dev object handle of at24c02
  * @param   The address of the data to be written
@@ -86,6 +89,9 @@ esp_err_t iot_at24c02_read_byte(at24c02_handle_t dev, uint8_t addr,
 
 /**
  * @brief   Write some data start addr
+ *          Data is split at page boundaries, each page is written in one
+ *          transaction and the chip is ACK polled until its write cycle ends.
+ *          With the cache enabled only the cache is updated.
  *
  * @param   dev object handle of at24c02
  * @param   The address of the data to be written
@@ -94,13 +100,14 @@ esp_err_t iot_at24c02_read_byte(at24c02_handle_t dev, uint8_t addr,
  *
  * @return
  *    - ESP_OK Success
+ *    - ESP_ERR_INVALID_ARG data runs past the end of the array
  *    - ESP_FAIL Fail
  */
 esp_err_t iot_at24c02_write(at24c02_handle_t dev, uint8_t start_addr,
         uint8_t write_num, uint8_t *data_buf);
 
 /**
- * @brief   Read some data start addr
+ * @brief   Read some data start addr in one sequential read
  *
  * @param   dev object handle of at24c02
  * @param   The address of the data to be read
@@ -109,11 +116,39 @@ esp_err_t iot_at24c02_write(at24c02_handle_t dev, uint8_t start_addr,
  *
  * @return
  *    - ESP_OK Success
+ *    - ESP_ERR_INVALID_ARG data runs past the end of the array
  *    - ESP_FAIL Fail
  */
 esp_err_t iot_at24c02_read(at24c02_handle_t dev, uint8_t start_addr,
         uint8_t read_num, uint8_t *data_buf);
 
+/**
+ * @brief   Enable or disable the write-back cache
+ *          Enabling reads the whole array into RAM, after that reads and writes
+ *          only touch RAM and changed pages are written by iot_at24c02_flush.
+ *          Disabling flushes first.
+ *
+ * @param   dev object handle of at24c02
+ * @param   enable true to enable the cache
+ *
+ * @return
+ *    - ESP_OK Success
+ *    - ESP_ERR_NO_MEM no memory for the cache
+ *    - ESP_FAIL Fail
+ */
+esp_err_t iot_at24c02_cache_enable(at24c02_handle_t dev, bool enable);
+
+/**
+ * @brief   Write the pages changed in the cache back to the chip
+ *
+ * @param   dev object handle of at24c02
+ *
+ * @return
+ *    - ESP_OK Success, or the cache is disabled
+ *    - ESP_FAIL Fail
+ */
+esp_err_t iot_at24c02_flush(at24c02_handle_t dev);
+
 #ifdef __cplusplus
 }
 #endif
@@ -200,6 +235,27 @@ public:
      */
     esp_err_t read(uint8_t start_addr, uint8_t read_num,
             uint8_t *data_buf);
+
+    /**
+     * @brief   Enable or disable the write-back cache
+     *
+     * @param   enable true to enable the cache
+     *
+     * @return
+     *    - ESP_OK Success
+     *    - ESP_ERR_NO_MEM no memory for the cache
+     *    - ESP_FAIL Fail
+     */
+    esp_err_t cache_enable(bool enable);
+
+    /**
+     * @brief   Write the pages changed in the cache back to the chip
+     *
+     * @return
+     *    - ESP_OK Success
+     *    - ESP_FAIL Fail
+     */
+    esp_err_t flush();
 };
 #endif
 
@@ -17,6 +17,7 @@
 #include <stdio.h>
 #include "unity.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "driver/i2c.h"
 #include "iot_at24c02.h"
 #include "iot_i2c_bus.h"
@@ -103,4 +104,38 @@ TEST_CASE("Device at24c02 test", "[at24c02][iot][device]")
     at24c02_test();
 }
 
+TEST_CASE("Device at24c02 page write test", "[at24c02][iot][device]")
+{
+    uint8_t wbuf[AT24C02_SIZE], rbuf[AT24C02_SIZE];
+    at24c02_init();
+
+    /* Unaligned start and length so the first and last pages are partial */
+    for (int i = 0; i < sizeof(wbuf); i++) {
+        wbuf[i] = i ^ 0x5a;
+    }
+    int64_t start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, iot_at24c02_write(dev, 3, 250, wbuf));
+    printf("250 byte write: %d us\n", (int) (esp_timer_get_time() - start));
+    start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, iot_at24c02_read(dev, 3, 250, rbuf));
+    printf("250 byte read: %d us\n", (int) (esp_timer_get_time() - start));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(wbuf, rbuf, 250);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, iot_at24c02_write(dev, 250, 10, wbuf));
+
+    /* Cached writes reach the chip on flush only */
+    TEST_ASSERT_EQUAL(ESP_OK, iot_at24c02_cache_enable(dev, true));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_at24c02_write_byte(dev, 0x20, 0xa5));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_at24c02_write_byte(dev, 0x21, 0x5a));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_at24c02_read(dev, 0x20, 2, rbuf));
+    TEST_ASSERT_EQUAL_HEX8(0xa5, rbuf[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x5a, rbuf[1]);
+    TEST_ASSERT_EQUAL(ESP_OK, iot_at24c02_flush(dev));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_at24c02_cache_enable(dev, false));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_at24c02_read(dev, 0x20, 2, rbuf));
+    TEST_ASSERT_EQUAL_HEX8(0xa5, rbuf[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x5a, rbuf[1]);
+
+    iot_at24c02_delete(dev, true);
+}
+
 #endif
@@ -253,6 +253,8 @@ void iot_ssd1306_draw_bitmap(ssd1306_handle_t dev, uint8_t chXpos,
 
 /**
  * @brief   refresh dot matrix panel
+ *          Only the pages changed since the last successful refresh are sent,
+ *          all of them in a single bus transaction.
  *
  * @param   dev object handle of ssd1306
 
@@ -263,7 +265,7 @@ void iot_ssd1306_draw_bitmap(ssd1306_handle_t dev, uint8_t chXpos,
 esp_err_t iot_ssd1306_refresh_gram(ssd1306_handle_t dev);
 
 /**
- * @brief   Clear screen
+ * @brief   Clear screen buffer, call iot_ssd1306_refresh_gram to show it
  *
  * @param   dev object handle of ssd1306
  * @param   chFill whether fill and fill char
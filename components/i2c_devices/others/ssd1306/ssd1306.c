@@ -14,13 +14,18 @@
 #include "driver/i2c.h"
 #include "iot_ssd1306.h"
 #include "ssd1306_fonts.h"
+#include <string.h>
 #include <time.h>
 #include <sys/time.h>
 
+#define SSD1306_PAGES           (SSD1306_HEIGHT / 8)
+#define SSD1306_ALL_PAGES       ((1 << SSD1306_PAGES) - 1)
+
 typedef struct {
     i2c_bus_handle_t bus;
     uint16_t dev_addr;
-    uint8_t s_chDisplayBuffer[128][8];
+    uint8_t s_chDisplayBuffer[SSD1306_PAGES][SSD1306_WIDTH];    /* page-major, same layout as the GRAM */
+    uint8_t dirty_pages;                                        /* bit n set: page n differs from the GRAM */
 } ssd1306_dev_t;
 
 static uint32_t _pow(uint8_t m, uint8_t n)
@@ -177,10 +182,11 @@ void iot_ssd1306_fill_point(ssd1306_handle_t dev, uint8_t chXpos, uint8_t chYpos
     chBx = chYpos % 8;
     chTemp = 1 << (7 - chBx);
 
-    if (chPoint) {
-        device->s_chDisplayBuffer[chXpos][chPos] |= chTemp;
-    } else {
-        device->s_chDisplayBuffer[chXpos][chPos] &= ~chTemp;
+    uint8_t *pchByte = &device->s_chDisplayBuffer[chPos][chXpos];
+    uint8_t chNew = chPoint ? (*pchByte | chTemp) : (*pchByte & ~chTemp);
+    if (chNew != *pchByte) {
+        *pchByte = chNew;
+        device->dirty_pages |= 1 << chPos;
     }
 }
 
@@ -284,9 +290,14 @@ esp_err_t iot_ssd1306_init(ssd1306_handle_t dev)
     iot_ssd1306_write_byte(dev, 0x14, SSD1306_CMD); //--set(0x10) disable
     iot_ssd1306_write_byte(dev, 0xA4, SSD1306_CMD); // Disable Entire Display On (0xa4/0xa5)
     iot_ssd1306_write_byte(dev, 0xA6, SSD1306_CMD); // Disable Inverse Display On (0xa6/a7)
-    iot_ssd1306_write_byte(dev, 0xAF, SSD1306_CMD); //--turn on oled panel
+    ret = iot_ssd1306_write_byte(dev, 0xAF, SSD1306_CMD); //--turn on oled panel
+    if (ret == ESP_FAIL) {
+        return ret;
+    }
 
     ret = iot_ssd1306_clear_screen(dev, 0x00);
+    // GRAM content is unknown after power up, the first refresh sends every page
+    ((ssd1306_dev_t*) dev)->dirty_pages = SSD1306_ALL_PAGES;
     return ret;
 }
 
@@ -317,22 +328,36 @@ esp_err_t iot_ssd1306_delete(ssd1306_handle_t dev, bool del_bus)
 esp_err_t iot_ssd1306_refresh_gram(ssd1306_handle_t dev)
 {
     ssd1306_dev_t* device = (ssd1306_dev_t*) dev;
-    uint8_t i, j;
+    uint8_t i;
     esp_err_t ret;
 
-    for (i = 0; i < 8; i++) {
-        ret = iot_ssd1306_write_byte(dev, SSD1306_SET_PAGE_ADDR + i, SSD1306_CMD);
-        if (ret == ESP_FAIL) {
-            return ret;
-        }
-        iot_set_column_address(dev);
-        for (j = 0; j < 128; j++) {
-            ret = iot_ssd1306_write_byte(dev, device->s_chDisplayBuffer[j][i],
-            SSD1306_DAT);
-            if (ret == ESP_FAIL) {
-                return ret;
-            }
+    if (device->dirty_pages == 0) {
+        return ESP_OK;
+    }
+    // All dirty pages go out in one command link, each page as an address
+    // transaction followed by one 128 byte data transaction
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    for (i = 0; i < SSD1306_PAGES; i++) {
+        if ((device->dirty_pages & (1 << i)) == 0) {
+            continue;
         }
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, (device->dev_addr << 1) | WRITE_BIT, ACK_CHECK_EN);
+        i2c_master_write_byte(cmd, SSD1306_WRITE_CMD, ACK_CHECK_EN);
+        i2c_master_write_byte(cmd, SSD1306_SET_PAGE_ADDR + i, ACK_CHECK_EN);
+        i2c_master_write_byte(cmd, SSD1306_SET_LOWER_ADDRESS, ACK_CHECK_EN);
+        i2c_master_write_byte(cmd, SSD1306_SET_HIGHER_ADDRESS, ACK_CHECK_EN);
+        i2c_master_stop(cmd);
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, (device->dev_addr << 1) | WRITE_BIT, ACK_CHECK_EN);
+        i2c_master_write_byte(cmd, SSD1306_WRITE_DAT, ACK_CHECK_EN);
+        i2c_master_write(cmd, device->s_chDisplayBuffer[i], SSD1306_WIDTH, ACK_CHECK_EN);
+        i2c_master_stop(cmd);
+    }
+    ret = iot_i2c_bus_cmd_begin(device->bus, cmd, 1000 / portTICK_RATE_MS);
+    i2c_cmd_link_delete(cmd);
+    if (ret == ESP_OK) {
+        device->dirty_pages = 0;
     }
     return ret;
 }
@@ -341,16 +366,14 @@ esp_err_t iot_ssd1306_clear_screen(ssd1306_handle_t dev, uint8_t chFill)
 {
     ssd1306_dev_t* device = (ssd1306_dev_t*) dev;
     uint8_t i, j;
-    esp_err_t ret;
-    for (i = 0; i < 8; i++) {
-        ret = iot_ssd1306_write_byte(dev, SSD1306_SET_PAGE_ADDR + i, SSD1306_CMD);
-        if (ret == ESP_FAIL) {
-            return ret;
+    for (i = 0; i < SSD1306_PAGES; i++) {
+        for (j = 0; j < SSD1306_WIDTH; j++) {
+            if (device->s_chDisplayBuffer[i][j] != chFill) {
+                memset(device->s_chDisplayBuffer[i], chFill, SSD1306_WIDTH);
+                device->dirty_pages |= 1 << i;
+                break;
+            }
         }
-        iot_set_column_address(dev);
-        for (j = 0; j < 128; j++)
-            device->s_chDisplayBuffer[j][i] = chFill;
     }
     return ESP_OK;
 }
-
@@ -23,6 +23,7 @@
 
 #include "unity.h"
 #include "esp_deep_sleep.h"
+#include "esp_timer.h"
 
 #include "iot_touchpad.h"
 #include "driver/touch_pad.h"
@@ -188,4 +189,29 @@ TEST_CASE("Device ssd1306 test", "[ssd1306][iot][device]")
     ssd1306_test();
 }
 
+TEST_CASE("Device ssd1306 refresh test", "[ssd1306][iot][device]")
+{
+    int64_t start;
+    power_cntl_init();
+    power_cntl_on();
+    i2c_bus_init();
+    dev = iot_ssd1306_create(i2c_bus, 0x3C);
+
+    iot_ssd1306_fill_rectangle(dev, 0, 0, SSD1306_WIDTH - 1, SSD1306_HEIGHT - 1, 1);
+    start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, iot_ssd1306_refresh_gram(dev));
+    ESP_LOGI(TAG, "full refresh: %d us", (int) (esp_timer_get_time() - start));
+
+    iot_ssd1306_draw_string(dev, 0, 0, (const uint8_t *) "PAGE", 12, 0);
+    start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, iot_ssd1306_refresh_gram(dev));
+    ESP_LOGI(TAG, "two page refresh: %d us", (int) (esp_timer_get_time() - start));
+
+    start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, iot_ssd1306_refresh_gram(dev));
+    ESP_LOGI(TAG, "unchanged refresh: %d us", (int) (esp_timer_get_time() - start));
+
+    iot_ssd1306_delete(dev, true);
+}
+
 #endif
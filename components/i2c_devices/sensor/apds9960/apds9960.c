@@ -12,10 +12,40 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include <stdio.h>
+#include <stdlib.h>
 #include "driver/i2c.h"
+#include "driver/gpio.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
 #include "iot_apds9960.h"
 
 #define APDS9960_TIMEOUT_MS_DEFAULT   (1000)
+#define APDS9960_GESTURE_END_MS       (60)      /* longer than the longest gesture wait time */
+#define APDS9960_GESTURE_POLL_MS      (10)
+#define APDS9960_GESTURE_TIMEOUT_MS   (30000)
+#define APDS9960_GESTURE_DRAIN_MAX    (4)       /* block reads per drain, the FIFO keeps filling at short wait times */
+#define APDS9960_GESTURE_QUEUE_LEN    (8)
+#define APDS9960_GESTURE_TASK_PRIO    (configMAX_PRIORITIES - 5)
+#define APDS9960_GESTURE_TASK_STACK   (2048)
+#define APDS9960_GFIFO_CLR            (0x04)    /* GCONF4 */
+
+static const char* TAG = "apds9960";
+
+/* McCamy's CCT = 449n^3 + 3525n^2 + 6823.3n + 5520.33 for n = -1 ~ 1 in steps of 1/16 */
+static const uint16_t apds9960_cct_lut[] = {
+    1773, 1852, 1948, 2063, 2196, 2350, 2523, 2718, 2934, 3172, 3434, 3719, 4028, 4362, 4722, 5108,
+    5520, 5961, 6429, 6927, 7453, 8011, 8598, 9218, 9869, 10554, 11271, 12023, 12810, 13632, 14490, 15385,
+    16318,
+};
+
+/* RGB to XYZ correlation in Q12, based on 6500K fluorescent, 3000K fluorescent and 60W incandescent */
+static const int32_t apds9960_xyz_coef[3][3] = {
+    { -585, 6346, -3917 },
+    { -1330, 6465, -2998 },     /* Y is the illuminance */
+    { -2794, 3157, 2307 },
+};
 typedef struct
 {
     i2c_bus_handle_t bus;
@@ -39,18 +69,22 @@ typedef struct
     apds9960_gespulse_t _gpulse_t; /*< config ges pulse register>*/
     apds9960_pers_t _pers_t;       /*< config pers register>*/
 
-    uint8_t gest_cnt;              /*< counter of gesture >*/
-    uint8_t up_cnt;                /*< counter of up gesture >*/
-    uint8_t down_cnt;              /*< counter of down gesture >*/
-    uint8_t left_cnt;              /*< counter of left gesture >*/
-    uint8_t right_cnt;             /*< counter of right gesture >*/
+    apds9960_gesture_config_t gest_cfg;
+    uint8_t gest_cnt;              /*< valid datasets of the current gesture >*/
+    int16_t first_ud;              /*< up/down ratio of the first dataset, Q8 >*/
+    int16_t first_lr;              /*< left/right ratio of the first dataset, Q8 >*/
+    int16_t last_ud;               /*< up/down ratio of the last dataset, Q8 >*/
+    int16_t last_lr;               /*< left/right ratio of the last dataset, Q8 >*/
+    TickType_t gest_last;          /*< tick of the last valid dataset >*/
+
+    int int_pin;                   /*< -1 unless in interrupt mode >*/
+    xSemaphoreHandle int_sem;
+    xQueueHandle gest_queue;
+    xTaskHandle gest_task;
+    xSemaphoreHandle exit_sem;     /*< given by the gesture task right before it is deleted >*/
+    volatile bool gest_run;
 } apds9960_dev_t;
 
-static float __powf(const float x, const float y)
-{
-    return (float) (pow((double) x, (double) y));
-}
-
 uint8_t iot_apds9960_get_enable(apds9960_handle_t sensor)
 {
     apds9960_dev_t* sens = (apds9960_dev_t*) sensor;
@@ -155,10 +189,10 @@ void iot_apds9960_reset_counts(apds9960_handle_t sensor)
 {
     apds9960_dev_t* sens = (apds9960_dev_t*) sensor;
     sens->gest_cnt = 0;
-    sens->up_cnt = 0;
-    sens->down_cnt = 0;
-    sens->left_cnt = 0;
-    sens->right_cnt = 0;
+    sens->first_ud = 0;
+    sens->first_lr = 0;
+    sens->last_ud = 0;
+    sens->last_lr = 0;
 }
 
 esp_err_t iot_apds9960_write_byte(apds9960_handle_t sensor, uint8_t reg_addr, uint8_t data)
@@ -175,6 +209,7 @@ esp_err_t iot_apds9960_write(apds9960_handle_t sensor, uint8_t addr, uint8_t *bu
     i2c_master_write_byte(cmd, (sens->dev_addr << 1) | WRITE_BIT, ACK_CHECK_EN);
     i2c_master_write_byte(cmd, addr, ACK_CHECK_EN);
     i2c_master_write(cmd, buf, len, ACK_CHECK_EN);
+    i2c_master_stop(cmd);
     ret = iot_i2c_bus_cmd_begin(sens->bus, cmd, sens->timeout / portTICK_RATE_MS);
     i2c_cmd_link_delete(cmd);
     return ret;
@@ -426,56 +461,49 @@ bool iot_apds9960_color_data_ready(apds9960_handle_t sensor)
 
 esp_err_t iot_apds9960_get_color_data(apds9960_handle_t sensor, uint16_t *r, uint16_t *g, uint16_t *b, uint16_t *c)
 {
-    uint8_t data[2] = { 0 };
-    iot_apds9960_read(sensor, APDS9960_CDATAL, data, 2);
-    *c = (data[0] << 8) | data[1];
-    iot_apds9960_read(sensor, APDS9960_RDATAL, data, 2);
-    *r = (data[0] << 8) | data[1];
-    iot_apds9960_read(sensor, APDS9960_GDATAL, data, 2);
-    *g = (data[0] << 8) | data[1];
-    iot_apds9960_read(sensor, APDS9960_BDATAL, data, 2);
-    *b = (data[0] << 8) | data[1];
-    return ESP_OK;
+    // CDATAL ~ BDATAH in one burst, little endian
+    uint8_t data[8] = { 0 };
+    esp_err_t ret = iot_apds9960_read(sensor, APDS9960_CDATAL, data, sizeof(data));
+    *c = (data[1] << 8) | data[0];
+    *r = (data[3] << 8) | data[2];
+    *g = (data[5] << 8) | data[4];
+    *b = (data[7] << 8) | data[6];
+    return ret;
 }
 
-uint16_t iot_apds9960_calculate_color_temperature(apds9960_handle_t sensor, uint16_t r, uint16_t g, uint16_t b)
+static int32_t apds9960_xyz(int i, uint16_t r, uint16_t g, uint16_t b)
 {
-    float rgb_xcorrelation, rgb_ycorrelation, rgb_zcorrelation; /* RGB to XYZ correlation      */
-    float chromaticity_xc, chromaticity_yc; /* Chromaticity co-ordinates   */
-    float formula; /* McCamy's formula            */
-    float cct;
-
-    /* 1. Map RGB values to their XYZ counterparts.    */
-    /* Based on 6500K fluorescent, 3000K fluorescent   */
-    /* and 60W incandescent values for a wide range.   */
-    /* Note: Y = Illuminance or lux                    */
-    rgb_xcorrelation = (-0.14282F * r) + (1.54924F * g) + (-0.95641F * b);
-    rgb_ycorrelation = (-0.32466F * r) + (1.57837F * g) + (-0.73191F * b);
-    rgb_zcorrelation = (-0.68202F * r) + (0.77073F * g) + (0.56332F * b);
-
-    /* 2. Calculate the chromaticity co-ordinates      */
-    chromaticity_xc = (rgb_xcorrelation) / (rgb_xcorrelation);
-    chromaticity_yc = (rgb_ycorrelation) / (rgb_xcorrelation + rgb_ycorrelation + rgb_zcorrelation);
+    return apds9960_xyz_coef[i][0] * r + apds9960_xyz_coef[i][1] * g + apds9960_xyz_coef[i][2] * b;
+}
 
-    /* 3. Use McCamy's formula to determine the CCT    */
-    formula = (chromaticity_xc - 0.3320F) / (0.1858F - chromaticity_yc);
+uint16_t iot_apds9960_calculate_color_temperature(apds9960_handle_t sensor, uint16_t r, uint16_t g, uint16_t b)
+{
+    /* 1. Map RGB values to their XYZ counterparts, Q12 */
+    int64_t x = apds9960_xyz(0, r, g, b);
+    int64_t y = apds9960_xyz(1, r, g, b);
+    int64_t sum = x + apds9960_xyz(2, r, g, b) + y;
 
-    /* Calculate the final CCT */
-    cct = (449.0F * __powf(formula, 3)) + (3525.0F * __powf(formula, 2)) + (6823.3F * formula) + 5520.33F;
+    /* 2. McCamy's n = (xc - 0.3320) / (0.1858 - yc) with the chromaticity xc = X / sum, yc = Y / sum */
+    int64_t num = 10000 * x - 3320 * sum;
+    int64_t den = 1858 * sum - 10000 * y;
+    if (sum <= 0 || den == 0) {
+        return 0;
+    }
 
-    /* Return the results in degrees Kelvin */
-    return (uint16_t) cct;
+    /* 3. Interpolate the CCT table, n in Q12 clamped to -1 ~ 1 */
+    int64_t n = num * 4096 / den;
+    n = n < -4096 ? -4096 : (n > 4095 ? 4095 : n);
+    int idx = (int) (n + 4096) >> 8;
+    int frac = (int) (n + 4096) & 0xff;
+    return apds9960_cct_lut[idx] + (((apds9960_cct_lut[idx + 1] - apds9960_cct_lut[idx]) * frac) >> 8);
 }
 
 uint16_t iot_apds9960_calculate_lux(apds9960_handle_t sensor, uint16_t r, uint16_t g, uint16_t b)
 {
-    float illuminance;
-
     /* This only uses RGB ... how can we integrate clear or calculate lux */
     /* based exclusively on clear since this might be more reliable?      */
-    illuminance = (-0.32466F * r) + (1.57837F * g) + (-0.73191F * b);
-
-    return (uint16_t) illuminance;
+    int32_t illuminance = apds9960_xyz(1, r, g, b) >> 12;
+    return illuminance < 0 ? 0 : (illuminance > UINT16_MAX ? UINT16_MAX : illuminance);
 }
 
 esp_err_t iot_apds9960_enable_color_interrupt(apds9960_handle_t sensor, bool en)
@@ -662,79 +690,272 @@ esp_err_t iot_apds9960_set_gesture_offset(apds9960_handle_t sensor, uint8_t offs
     return ESP_OK;
 }
 
-uint8_t iot_apds9960_read_gesture(apds9960_handle_t sensor)
+esp_err_t iot_apds9960_set_gesture_config(apds9960_handle_t sensor, const apds9960_gesture_config_t *cfg)
 {
-    uint8_t toRead, bytesRead;
-    uint8_t buf[256];
-    unsigned long t = 0;
-    uint8_t gestureReceived;
     apds9960_dev_t* sens = (apds9960_dev_t*) sensor;
-    while (1) {
-        int up_down_diff = 0;
-        int left_right_diff = 0;
-        gestureReceived = 0;
-        if (!iot_apds9960_gesture_valid(sensor)) {
-            return 0;
-        }
-
-        vTaskDelay(30 / portTICK_RATE_MS);
-        iot_apds9960_read_byte(sensor, APDS9960_GFLVL, &toRead);
-        iot_apds9960_read(sensor, APDS9960_GFIFO_U, buf, toRead);
-        bytesRead = toRead;
+    if (cfg->sensitivity == 0 || cfg->min_datasets < 2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sens->gest_cfg = *cfg;
+    iot_apds9960_reset_counts(sensor);
+    return ESP_OK;
+}
 
-        for (int i = 0; i < (bytesRead >> 2); i++) {
-            if (abs((int) buf[0] - (int) buf[1]) > 13) {
-                up_down_diff += (int) buf[0] - (int) buf[1];
-            }
+/* Compare the ratios of the first and the last dataset, the larger change wins */
+static uint8_t apds9960_gesture_end(apds9960_dev_t* sens)
+{
+    uint8_t gesture = 0;
+    if (sens->gest_cnt >= sens->gest_cfg.min_datasets) {
+        int ud = sens->last_ud - sens->first_ud;
+        int lr = sens->last_lr - sens->first_lr;
+        int sensitivity = sens->gest_cfg.sensitivity;
+        if (abs(ud) >= abs(lr)) {
+            gesture = ud <= -sensitivity ? APDS9960_UP : (ud >= sensitivity ? APDS9960_DOWN : 0);
+        } else {
+            gesture = lr <= -sensitivity ? APDS9960_LEFT : (lr >= sensitivity ? APDS9960_RIGHT : 0);
         }
+    }
+    iot_apds9960_reset_counts(sens);
+    return gesture;
+}
 
-        for (int i = 0; i < (bytesRead >> 2); i++) {
-            if (abs((int) buf[2] - (int) buf[3]) > 13) {
-                left_right_diff += (int) buf[2] - (int) buf[3];
+uint8_t iot_apds9960_gesture_feed(apds9960_handle_t sensor, const uint8_t *data, int num)
+{
+    apds9960_dev_t* sens = (apds9960_dev_t*) sensor;
+    uint8_t gesture = 0;
+    for (int i = 0; i < num; i++, data += APDS9960_GFIFO_DATASET) {
+        int u = data[0], d = data[1], l = data[2], r = data[3];
+        int thresh = sens->gest_cfg.valid_thresh;
+        if (u <= thresh || d <= thresh || l <= thresh || r <= thresh) {
+            // the object left the field of view, a dataset below the threshold ends the gesture
+            if (sens->gest_cnt > 0) {
+                uint8_t g = apds9960_gesture_end(sens);
+                gesture = g ? g : gesture;
             }
+            continue;
         }
-
-        if (up_down_diff != 0) {
-            if (up_down_diff < 0) {
-                if (sens->down_cnt > 0) {
-                    gestureReceived = APDS9960_UP;
-                } else {
-                    sens->up_cnt++;
-                }
-            } else if (up_down_diff > 0) {
-                if (sens->up_cnt > 0) {
-                    gestureReceived = APDS9960_DOWN;
-                } else {
-                    sens->down_cnt++;
-                }
-            }
+        // difference over sum, -256 ~ 256, independent of the distance
+        sens->last_ud = ((u - d) * 256) / (u + d);
+        sens->last_lr = ((l - r) * 256) / (l + r);
+        if (sens->gest_cnt == 0) {
+            sens->first_ud = sens->last_ud;
+            sens->first_lr = sens->last_lr;
+        }
+        if (sens->gest_cnt < UINT8_MAX) {
+            sens->gest_cnt++;
         }
+        sens->gest_last = xTaskGetTickCount();
+    }
+    return gesture;
+}
 
-        if (left_right_diff != 0) {
-            if (left_right_diff < 0) {
-                if (sens->right_cnt > 0) {
-                    gestureReceived = APDS9960_LEFT;
-                } else {
-                    sens->left_cnt++;
-                }
-            } else if (left_right_diff > 0) {
-                if (sens->left_cnt > 0) {
-                    gestureReceived = APDS9960_RIGHT;
-                } else {
-                    sens->right_cnt++;
-                }
-            }
+esp_err_t iot_apds9960_process_gesture_fifo(apds9960_handle_t sensor, uint8_t *gesture)
+{
+    apds9960_dev_t* sens = (apds9960_dev_t*) sensor;
+    uint8_t buf[APDS9960_GFIFO_DEPTH * APDS9960_GFIFO_DATASET];
+    uint8_t lvl[2];
+    int total = 0;
+    esp_err_t ret;
+    *gesture = 0;
+    for (int i = 0; i < APDS9960_GESTURE_DRAIN_MAX; i++) {
+        // GFLVL and GSTATUS in one read
+        ret = iot_apds9960_read(sensor, APDS9960_GFLVL, lvl, sizeof(lvl));
+        if (ret != ESP_OK) {
+            return ret;
         }
+        iot_apds9960_set_gstatus(sensor, lvl[1]);
+        int num = lvl[0] > APDS9960_GFIFO_DEPTH ? APDS9960_GFIFO_DEPTH : lvl[0];
+        if (num == 0) {
+            break;
+        }
+        if (sens->_gstatus_t.gfov) {
+            ESP_LOGD(TAG, "gesture FIFO overflow");
+        }
+        // reading past GFIFO_R wraps to GFIFO_U of the next dataset, the whole FIFO comes in one block
+        ret = iot_apds9960_read(sensor, APDS9960_GFIFO_U, buf, num * APDS9960_GFIFO_DATASET);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        uint8_t g = iot_apds9960_gesture_feed(sensor, buf, num);
+        *gesture = g ? g : *gesture;
+        total += num;
+    }
+    // the engine exited without a dataset below the threshold
+    if (total == 0 && sens->gest_cnt > 0
+            && xTaskGetTickCount() - sens->gest_last > APDS9960_GESTURE_END_MS / portTICK_RATE_MS) {
+        uint8_t g = apds9960_gesture_end(sens);
+        *gesture = g ? g : *gesture;
+    }
+    return ESP_OK;
+}
 
-        if (up_down_diff != 0 || left_right_diff != 0) {
-            t = xTaskGetTickCount();
+uint8_t iot_apds9960_read_gesture(apds9960_handle_t sensor)
+{
+    apds9960_dev_t* sens = (apds9960_dev_t*) sensor;
+    uint8_t gesture;
+    TickType_t start = xTaskGetTickCount();
+    while (xTaskGetTickCount() - start < APDS9960_GESTURE_TIMEOUT_MS / portTICK_RATE_MS) {
+        if (iot_apds9960_process_gesture_fifo(sensor, &gesture) != ESP_OK) {
+            return 0;
+        }
+        if (gesture) {
+            return gesture;
         }
+        if (sens->gest_cnt == 0 && !sens->_gstatus_t.gvalid) {
+            return 0;
+        }
+        vTaskDelay(APDS9960_GESTURE_POLL_MS / portTICK_RATE_MS);
+    }
+    iot_apds9960_reset_counts(sensor);
+    return 0;
+}
 
-        if (gestureReceived || xTaskGetTickCount() - t > (30000)) {
-            iot_apds9960_reset_counts(sensor);
-            return gestureReceived;
+static void IRAM_ATTR apds9960_isr_handler(void *arg)
+{
+    apds9960_dev_t* sens = (apds9960_dev_t*) arg;
+    portBASE_TYPE task_woken = pdFALSE;
+    xSemaphoreGiveFromISR(sens->int_sem, &task_woken);
+    if (task_woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void apds9960_gesture_task(void *arg)
+{
+    apds9960_dev_t* sens = (apds9960_dev_t*) arg;
+    uint8_t gesture;
+    while (sens->gest_run) {
+        // wake up without an interrupt too, to end a gesture that left less than GFIFOTH datasets,
+        // with no gesture in progress such a wake up has nothing to do on the bus
+        bool intr = xSemaphoreTake(sens->int_sem, APDS9960_GESTURE_END_MS / portTICK_RATE_MS) == pdTRUE;
+        if (!sens->gest_run) {
+            break;
         }
+        if (!intr && sens->gest_cnt == 0) {
+            continue;
+        }
+        if (iot_apds9960_process_gesture_fifo(sens, &gesture) == ESP_OK && gesture) {
+            xQueueSend(sens->gest_queue, &gesture, 0);
+        }
+    }
+    sens->gest_task = NULL;
+    xSemaphoreGive(sens->exit_sem);
+    vTaskDelete(NULL);
+}
+
+static void apds9960_gesture_intr_free(apds9960_dev_t* sens)
+{
+    if (sens->int_sem) {
+        vSemaphoreDelete(sens->int_sem);
+        sens->int_sem = NULL;
+    }
+    if (sens->exit_sem) {
+        vSemaphoreDelete(sens->exit_sem);
+        sens->exit_sem = NULL;
+    }
+    if (sens->gest_queue) {
+        vQueueDelete(sens->gest_queue);
+        sens->gest_queue = NULL;
+    }
+}
+
+esp_err_t iot_apds9960_gesture_intr_start(apds9960_handle_t sensor, int int_pin)
+{
+    apds9960_dev_t* sens = (apds9960_dev_t*) sensor;
+    esp_err_t ret;
+    bool gpio_armed = false;
+    if (sens->int_pin >= 0) {
+        return ESP_OK;
+    }
+    sens->int_sem = xSemaphoreCreateBinary();
+    sens->exit_sem = xSemaphoreCreateBinary();
+    sens->gest_queue = xQueueCreate(APDS9960_GESTURE_QUEUE_LEN, sizeof(uint8_t));
+    if (sens->int_sem == NULL || sens->exit_sem == NULL || sens->gest_queue == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
     }
+    iot_apds9960_reset_counts(sensor);
+
+    // empty the FIFO and raise GINT whenever it holds more than GFIFOTH datasets
+    sens->_gconf4_t.gien = 1;
+    ret = iot_apds9960_write_byte(sensor, APDS9960_GCONF4,
+            (sens->_gconf4_t.gien << 1) | sens->_gconf4_t.gmode | APDS9960_GFIFO_CLR);
+    if (ret != ESP_OK) {
+        goto fail;
+    }
+
+    // INT is open drain and active low
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << int_pin,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_NEGEDGE,
+    };
+    gpio_config(&io_conf);
+    gpio_armed = true;
+    // The service may already be installed by another driver
+    ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        goto fail;
+    }
+    sens->gest_run = true;
+    if (xTaskCreate(apds9960_gesture_task, "apds9960_gest", APDS9960_GESTURE_TASK_STACK, sens,
+            APDS9960_GESTURE_TASK_PRIO, &sens->gest_task) != pdPASS) {
+        sens->gest_run = false;
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+    ret = gpio_isr_handler_add(int_pin, apds9960_isr_handler, sens);
+    if (ret != ESP_OK) {
+        gpio_set_intr_type(int_pin, GPIO_INTR_DISABLE);
+        iot_apds9960_gesture_intr_stop(sensor);
+        return ret;
+    }
+    sens->int_pin = int_pin;
+    return ESP_OK;
+
+fail:
+    ESP_LOGE(TAG, "gesture interrupt start fail");
+    if (gpio_armed) {
+        gpio_set_intr_type(int_pin, GPIO_INTR_DISABLE);
+    }
+    if (sens->_gconf4_t.gien) {
+        // leave GINT off again, nobody would serve it
+        sens->_gconf4_t.gien = 0;
+        iot_apds9960_write_byte(sensor, APDS9960_GCONF4, (sens->_gconf4_t.gien << 1) | sens->_gconf4_t.gmode);
+    }
+    apds9960_gesture_intr_free(sens);
+    return ret;
+}
+
+esp_err_t iot_apds9960_gesture_intr_stop(apds9960_handle_t sensor)
+{
+    apds9960_dev_t* sens = (apds9960_dev_t*) sensor;
+    if (sens->int_pin >= 0) {
+        gpio_isr_handler_remove(sens->int_pin);
+        gpio_set_intr_type(sens->int_pin, GPIO_INTR_DISABLE);
+        sens->int_pin = -1;
+    }
+    if (sens->gest_task) {
+        // Let the task finish its bus access and exit on its own
+        sens->gest_run = false;
+        xSemaphoreGive(sens->int_sem);
+        xSemaphoreTake(sens->exit_sem, portMAX_DELAY);
+    }
+    apds9960_gesture_intr_free(sens);
+    sens->_gconf4_t.gien = 0;
+    return iot_apds9960_write_byte(sensor, APDS9960_GCONF4, (sens->_gconf4_t.gien << 1) | sens->_gconf4_t.gmode);
+}
+
+uint8_t iot_apds9960_gesture_wait(apds9960_handle_t sensor, TickType_t ticks_to_wait)
+{
+    apds9960_dev_t* sens = (apds9960_dev_t*) sensor;
+    uint8_t gesture = 0;
+    if (sens->gest_queue == NULL || xQueueReceive(sens->gest_queue, &gesture, ticks_to_wait) != pdTRUE) {
+        return 0;
+    }
+    return gesture;
 }
 
 bool iot_apds9960_gesture_valid(apds9960_handle_t sensor)
@@ -775,12 +996,19 @@ apds9960_handle_t iot_apds9960_create(i2c_bus_handle_t bus, uint16_t dev_addr)
     sensor->bus = bus;
     sensor->dev_addr = dev_addr;
     sensor->timeout = APDS9960_TIMEOUT_MS_DEFAULT;
+    sensor->int_pin = -1;
+    sensor->gest_cfg.valid_thresh = APDS9960_GESTURE_THRESH_DEFAULT;
+    sensor->gest_cfg.min_datasets = APDS9960_GESTURE_DATASETS_DEFAULT;
+    sensor->gest_cfg.sensitivity = APDS9960_GESTURE_SENSITIVITY_DEFAULT;
     return (apds9960_handle_t) sensor;
 }
 
 esp_err_t iot_apds9960_delete(apds9960_handle_t sensor, bool del_bus)
 {
     apds9960_dev_t* sens = (apds9960_dev_t*) sensor;
+    if (sens->int_pin >= 0) {
+        iot_apds9960_gesture_intr_stop(sensor);
+    }
     if (del_bus) {
         iot_i2c_bus_delete(sens->bus);
         sens->bus = NULL;
@@ -211,6 +211,26 @@ uint8_t CApds9960::read_gesture(void)
     return iot_apds9960_read_gesture(m_sensor_handle);
 }
 
+esp_err_t CApds9960::set_gesture_config(const apds9960_gesture_config_t *cfg)
+{
+    return iot_apds9960_set_gesture_config(m_sensor_handle, cfg);
+}
+
+esp_err_t CApds9960::gesture_intr_start(int int_pin)
+{
+    return iot_apds9960_gesture_intr_start(m_sensor_handle, int_pin);
+}
+
+esp_err_t CApds9960::gesture_intr_stop(void)
+{
+    return iot_apds9960_gesture_intr_stop(m_sensor_handle);
+}
+
+uint8_t CApds9960::gesture_wait(TickType_t ticks_to_wait)
+{
+    return iot_apds9960_gesture_wait(m_sensor_handle, ticks_to_wait);
+}
+
 esp_err_t CApds9960::set_gesture_dimensions(uint8_t dims)
 {
     return iot_apds9960_set_gesture_dimensions(m_sensor_handle, dims);
@@ -392,6 +392,24 @@ typedef struct gpulse {
     uint8_t gplen :2;
 } apds9960_gespulse_t;
 
+#define APDS9960_GFIFO_DEPTH                    32      /*!< datasets in the gesture FIFO */
+#define APDS9960_GFIFO_DATASET                  4       /*!< bytes of one dataset, U, D, L, R */
+#define APDS9960_GESTURE_THRESH_DEFAULT         10
+#define APDS9960_GESTURE_DATASETS_DEFAULT       3
+#define APDS9960_GESTURE_SENSITIVITY_DEFAULT    128
+
+/**
+ * @brief Thresholds of the gesture recognizer
+ *
+ * Each dataset gives an up/down and a left/right ratio, (U - D) / (U + D) and (L - R) / (L + R),
+ * scaled to -256 ~ 256. A gesture is the change of the ratios from its first to its last dataset.
+ */
+typedef struct {
+    uint8_t valid_thresh;   /*!< a dataset counts when all four channels are above it, keep it at or above GEXTH */
+    uint8_t min_datasets;   /*!< datasets a gesture needs at least, 2 ~ 255 */
+    uint16_t sensitivity;   /*!< change of a ratio that makes a swipe, 1 ~ 512 */
+} apds9960_gesture_config_t;
+
 typedef void* apds9960_handle_t;
 
 /**
@@ -779,6 +797,85 @@ esp_err_t iot_apds9960_set_gesture_offset(apds9960_handle_t sensor,
  */
 uint8_t iot_apds9960_read_gesture(apds9960_handle_t sensor);
 
+/**
+ * @brief Set the thresholds of the gesture recognizer, it also drops a gesture in progress
+ *
+ * @param sensor object handle of apds9960
+ * @param cfg thresholds
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG zero sensitivity or less than 2 datasets
+ */
+esp_err_t iot_apds9960_set_gesture_config(apds9960_handle_t sensor, const apds9960_gesture_config_t *cfg);
+
+/**
+ * @brief Run gesture datasets through the recognizer
+ *
+ * Integer only, for datasets read from the FIFO by other means.
+ *
+ * @param sensor object handle of apds9960
+ * @param data datasets, 4 bytes each in FIFO order, U, D, L, R
+ * @param num number of datasets
+ *
+ * @return
+ *     - APDS9960_UP, APDS9960_DOWN, APDS9960_LEFT or APDS9960_RIGHT when a gesture ended, else 0
+ */
+uint8_t iot_apds9960_gesture_feed(apds9960_handle_t sensor, const uint8_t *data, int num);
+
+/**
+ * @brief Drain the gesture FIFO and run it through the recognizer
+ *
+ * The whole FIFO, up to 32 datasets, comes in one block read. A gesture also ends
+ * when no dataset arrived for 60 ms.
+ *
+ * @param sensor object handle of apds9960
+ * @param gesture the gesture that ended, 0 if none
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_apds9960_process_gesture_fifo(apds9960_handle_t sensor, uint8_t *gesture);
+
+/**
+ * @brief Recognize gestures on the GINT interrupt
+ *
+ * A driver task drains the FIFO each time INT falls and queues the gestures.
+ * Use iot_apds9960_gesture_wait() to get them, not iot_apds9960_read_gesture().
+ *
+ * @param sensor object handle of apds9960
+ * @param int_pin GPIO connected to INT of the sensor
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_NO_MEM no memory for the queue or the task
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_apds9960_gesture_intr_start(apds9960_handle_t sensor, int int_pin);
+
+/**
+ * @brief Stop recognizing gestures on the interrupt
+ *
+ * @param sensor object handle of apds9960
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_apds9960_gesture_intr_stop(apds9960_handle_t sensor);
+
+/**
+ * @brief Wait for a gesture recognized on the interrupt
+ *
+ * @param sensor object handle of apds9960
+ * @param ticks_to_wait ticks to wait for a gesture
+ *
+ * @return
+ *     - APDS9960_UP, APDS9960_DOWN, APDS9960_LEFT or APDS9960_RIGHT, 0 on timeout
+ */
+uint8_t iot_apds9960_gesture_wait(apds9960_handle_t sensor, TickType_t ticks_to_wait);
+
 /**
  * @brief Reset some temp counts of gesture detection
  *
@@ -1208,6 +1305,47 @@ public:
      */
     uint8_t read_gesture(void);
 
+    /**
+     * @brief Set the thresholds of the gesture recognizer
+     *
+     * @param cfg thresholds
+     *
+     * @return
+     *     - ESP_OK Success
+     *     - ESP_ERR_INVALID_ARG bad thresholds
+     */
+    esp_err_t set_gesture_config(const apds9960_gesture_config_t *cfg);
+
+    /**
+     * @brief Recognize gestures on the GINT interrupt
+     *
+     * @param int_pin GPIO connected to INT of the sensor
+     *
+     * @return
+     *     - ESP_OK Success
+     *     - ESP_FAIL Fail
+     */
+    esp_err_t gesture_intr_start(int int_pin);
+
+    /**
+     * @brief Stop recognizing gestures on the interrupt
+     *
+     * @return
+     *     - ESP_OK Success
+     *     - ESP_FAIL Fail
+     */
+    esp_err_t gesture_intr_stop(void);
+
+    /**
+     * @brief Wait for a gesture recognized on the interrupt
+     *
+     * @param ticks_to_wait ticks to wait for a gesture
+     *
+     * @return
+     *     - Number corresponding to gesture, 0 on timeout
+     */
+    uint8_t gesture_wait(TickType_t ticks_to_wait);
+
     /**
      * @brief Get gesture status
      *
@@ -12,12 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include <stdio.h>
+#include <string.h>
 #include "unity.h"
 #include "esp_log.h"
 #include "driver/i2c.h"
 #include "iot_i2c_bus.h"
 #include "iot_apds9960.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 
 #define APDS9960_I2C_MASTER_SCL_IO           (gpio_num_t)21          /*!< gpio number for I2C master clock */
 #define APDS9960_I2C_MASTER_SDA_IO           (gpio_num_t)22          /*!< gpio number for I2C master data  */
@@ -25,6 +27,7 @@
 #define APDS9960_I2C_MASTER_TX_BUF_DISABLE   0           /*!< I2C master do not need buffer */
 #define APDS9960_I2C_MASTER_RX_BUF_DISABLE   0           /*!< I2C master do not need buffer */
 #define APDS9960_I2C_MASTER_FREQ_HZ          100000      /*!< I2C master clock frequency */
+#define APDS9960_INT_IO                      4           /*!< gpio number for INT of sensor */
 
 i2c_bus_handle_t i2c_bus = NULL;
 apds9960_handle_t apds9960 = NULL;
@@ -94,3 +97,115 @@ TEST_CASE("Sensor apds9960 test", "[apds9960][iot][sensor]")
     apds9960_test();
 }
 
+/* An object crossing the sensor along one axis, the ratio of the pair goes from +60% to -60% */
+static int gesture_test_swipe(uint8_t *data, int num, bool up_down)
+{
+    for (int i = 0; i < num; i++) {
+        int p = 60 - 120 * i / (num - 1);
+        uint8_t hi = 100 + p, lo = 100 - p;
+        data[i * 4 + 0] = up_down ? hi : 100;
+        data[i * 4 + 1] = up_down ? lo : 100;
+        data[i * 4 + 2] = up_down ? 100 : hi;
+        data[i * 4 + 3] = up_down ? 100 : lo;
+    }
+    // the exit dataset, below the threshold
+    memset(data + num * 4, 0, 4);
+    return num + 1;
+}
+
+TEST_CASE("Sensor apds9960 gesture recognizer test", "[apds9960][iot][sensor]")
+{
+    uint8_t data[(APDS9960_GFIFO_DEPTH + 1) * APDS9960_GFIFO_DATASET];
+    apds9960_handle_t sens = iot_apds9960_create(NULL, APDS9960_I2C_ADDRESS);
+    apds9960_gesture_config_t cfg = { .valid_thresh = 10, .min_datasets = 1, .sensitivity = 128 };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, iot_apds9960_set_gesture_config(sens, &cfg));
+    cfg.min_datasets = APDS9960_GESTURE_DATASETS_DEFAULT;
+    TEST_ASSERT_EQUAL(ESP_OK, iot_apds9960_set_gesture_config(sens, &cfg));
+
+    /* the fastest swipes leave only a few datasets */
+    int num = gesture_test_swipe(data, 3, true);
+    TEST_ASSERT_EQUAL(APDS9960_UP, iot_apds9960_gesture_feed(sens, data, num));
+    num = gesture_test_swipe(data, APDS9960_GFIFO_DEPTH, false);
+    TEST_ASSERT_EQUAL(APDS9960_LEFT, iot_apds9960_gesture_feed(sens, data, num));
+
+    /* the reverse directions, fed one dataset at a time as a slow FIFO would */
+    num = gesture_test_swipe(data, 8, true);
+    for (int i = 0; i < (num - 1) / 2; i++) {
+        uint8_t tmp[APDS9960_GFIFO_DATASET];
+        memcpy(tmp, data + i * 4, 4);
+        memcpy(data + i * 4, data + (num - 2 - i) * 4, 4);
+        memcpy(data + (num - 2 - i) * 4, tmp, 4);
+    }
+    for (int i = 0; i < num - 1; i++) {
+        TEST_ASSERT_EQUAL(0, iot_apds9960_gesture_feed(sens, data + i * 4, 1));
+    }
+    TEST_ASSERT_EQUAL(APDS9960_DOWN, iot_apds9960_gesture_feed(sens, data + (num - 1) * 4, 1));
+    num = gesture_test_swipe(data, 8, false);
+    for (int i = 0; i < num - 1; i++) {
+        uint8_t t = data[i * 4 + 2];
+        data[i * 4 + 2] = data[i * 4 + 3];
+        data[i * 4 + 3] = t;
+    }
+    TEST_ASSERT_EQUAL(APDS9960_RIGHT, iot_apds9960_gesture_feed(sens, data, num));
+
+    /* hovering, and a blip too short for a gesture */
+    memset(data, 120, APDS9960_GFIFO_DEPTH * APDS9960_GFIFO_DATASET);
+    memset(data + APDS9960_GFIFO_DEPTH * APDS9960_GFIFO_DATASET, 0, APDS9960_GFIFO_DATASET);
+    TEST_ASSERT_EQUAL(0, iot_apds9960_gesture_feed(sens, data, APDS9960_GFIFO_DEPTH + 1));
+    num = gesture_test_swipe(data, 2, true);
+    TEST_ASSERT_EQUAL(0, iot_apds9960_gesture_feed(sens, data, num));
+
+    /* a full FIFO */
+    num = gesture_test_swipe(data, APDS9960_GFIFO_DEPTH, true);
+    int64_t t0 = esp_timer_get_time();
+    uint8_t gesture = iot_apds9960_gesture_feed(sens, data, num);
+    printf("%d datasets in %d us\n", num, (int) (esp_timer_get_time() - t0));
+    TEST_ASSERT_EQUAL(APDS9960_UP, gesture);
+    iot_apds9960_delete(sens, false);
+}
+
+TEST_CASE("Sensor apds9960 color calculation test", "[apds9960][iot][sensor]")
+{
+    static const uint16_t rgb[][3] = {
+        { 1200, 1000, 600 }, { 800, 1000, 900 }, { 300, 500, 450 }, { 2000, 1400, 700 }, { 5000, 6000, 5800 },
+    };
+    for (int i = 0; i < sizeof(rgb) / sizeof(rgb[0]); i++) {
+        float r = rgb[i][0], g = rgb[i][1], b = rgb[i][2];
+        float x = -0.14282f * r + 1.54924f * g - 0.95641f * b;
+        float y = -0.32466f * r + 1.57837f * g - 0.73191f * b;
+        float z = -0.68202f * r + 0.77073f * g + 0.56332f * b;
+        float n = (x / (x + y + z) - 0.3320f) / (0.1858f - y / (x + y + z));
+        float cct = 449.0f * n * n * n + 3525.0f * n * n + 6823.3f * n + 5520.33f;
+        uint16_t val = iot_apds9960_calculate_color_temperature(NULL, rgb[i][0], rgb[i][1], rgb[i][2]);
+        uint16_t lux = iot_apds9960_calculate_lux(NULL, rgb[i][0], rgb[i][1], rgb[i][2]);
+        printf("rgb %u %u %u, cct %u K (%.0f K), lux %u (%.1f)\n", rgb[i][0], rgb[i][1], rgb[i][2], val, cct, lux, y);
+        if (n >= -1 && n < 1) {
+            TEST_ASSERT_INT_WITHIN(10, (int) cct, val);
+        }
+        TEST_ASSERT_INT_WITHIN(1, (int) y, lux);
+    }
+    TEST_ASSERT_EQUAL(0, iot_apds9960_calculate_color_temperature(NULL, 0, 0, 0));
+    TEST_ASSERT_EQUAL(0, iot_apds9960_calculate_lux(NULL, 1000, 0, 1000));
+}
+
+TEST_CASE("Sensor apds9960 gesture interrupt test", "[apds9960][iot][sensor]")
+{
+    int cnt = 0;
+    gpio_init();
+    i2c_sensor_apds9960_init();
+    iot_apds9960_gesture_init(apds9960);
+    iot_apds9960_set_gesture_waittime(apds9960, APDS9960_GWTIME_0MS);
+    TEST_ASSERT_EQUAL(ESP_OK, iot_apds9960_gesture_intr_start(apds9960, APDS9960_INT_IO));
+    while (cnt < 5) {
+        uint8_t gesture = iot_apds9960_gesture_wait(apds9960, 10000 / portTICK_RATE_MS);
+        if (gesture == 0) {
+            break;
+        }
+        printf("gesture %s\n", gesture == APDS9960_UP ? "UP" : gesture == APDS9960_DOWN ? "DOWN" :
+               gesture == APDS9960_LEFT ? "LEFT" : "RIGHT");
+        cnt++;
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, iot_apds9960_gesture_intr_stop(apds9960));
+    iot_apds9960_delete(apds9960, true);
+    TEST_ASSERT_EQUAL(5, cnt);
+}
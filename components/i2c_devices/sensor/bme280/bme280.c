@@ -144,36 +144,6 @@ esp_err_t iot_bme280_read(bme280_handle_t dev, uint8_t start_addr,
     return ret;
 }
 
-static esp_err_t iot_bme280_read_uint16(bme280_handle_t dev, uint8_t addr,
-        uint16_t *data)
-{
-    esp_err_t ret = ESP_FAIL;
-    uint8_t data0, data1;
-    if (iot_bme280_read_byte(dev, addr, &data0) == ESP_FAIL) {
-        return ret;
-    }
-    if (iot_bme280_read_byte(dev, addr + 1, &data1) == ESP_FAIL) {
-        return ret;
-    }
-    *data = (data0 << 8) | data1;
-    return ESP_OK;
-}
-
-static esp_err_t iot_bme280_read_uint16_le(bme280_handle_t dev, uint8_t addr,
-        uint16_t *data)
-{
-    esp_err_t ret = ESP_FAIL;
-    uint8_t data0, data1;
-    if (iot_bme280_read_byte(dev, addr, &data0) == ESP_FAIL) {
-        return ret;
-    }
-    if (iot_bme280_read_byte(dev, addr + 1, &data1) == ESP_FAIL) {
-        return ret;
-    }
-    *data = (data1 << 8) | data0;
-    return ESP_OK;
-}
-
 unsigned int iot_bme280_getconfig(bme280_handle_t dev)
 {
     bme280_dev_t* device = (bme280_dev_t*) dev;
@@ -204,107 +174,49 @@ bool iot_bme280_is_reading_calibration(bme280_handle_t dev)
     return (rstatus & (1 << 0)) != 0;
 }
 
+void iot_bme280_parse_coefficients(bme280_data_t *calib, const uint8_t *tp,
+        const uint8_t *h)
+{
+    // all words are little endian, see DS 4.2.2
+    calib->dig_t1 = (uint16_t) ((tp[1] << 8) | tp[0]);
+    calib->dig_t2 = (int16_t) ((tp[3] << 8) | tp[2]);
+    calib->dig_t3 = (int16_t) ((tp[5] << 8) | tp[4]);
+    calib->dig_p1 = (uint16_t) ((tp[7] << 8) | tp[6]);
+    calib->dig_p2 = (int16_t) ((tp[9] << 8) | tp[8]);
+    calib->dig_p3 = (int16_t) ((tp[11] << 8) | tp[10]);
+    calib->dig_p4 = (int16_t) ((tp[13] << 8) | tp[12]);
+    calib->dig_p5 = (int16_t) ((tp[15] << 8) | tp[14]);
+    calib->dig_p6 = (int16_t) ((tp[17] << 8) | tp[16]);
+    calib->dig_p7 = (int16_t) ((tp[19] << 8) | tp[18]);
+    calib->dig_p8 = (int16_t) ((tp[21] << 8) | tp[20]);
+    calib->dig_p9 = (int16_t) ((tp[23] << 8) | tp[22]);
+    // tp[24] is reserved
+    calib->dig_h1 = tp[25];
+
+    calib->dig_h2 = (int16_t) ((h[1] << 8) | h[0]);
+    calib->dig_h3 = h[2];
+    // dig_H4 and dig_H5 are signed 12 bit values sharing 0xE5
+    calib->dig_h4 = (int16_t) (((int8_t) h[3] * 16) | (h[4] & 0x0F));
+    calib->dig_h5 = (int16_t) (((int8_t) h[5] * 16) | (h[4] >> 4));
+    calib->dig_h6 = (int8_t) h[6];
+}
+
 esp_err_t iot_bme280_read_coefficients(bme280_handle_t dev)
 {
-    uint8_t data = 0;
-    uint8_t data1 = 0;
-    uint16_t data16 = 0;
+    uint8_t tp[BME280_CALIB_TP_LEN];
+    uint8_t h[BME280_CALIB_H_LEN];
     bme280_dev_t* device = (bme280_dev_t*) dev;
 
-    if (iot_bme280_read_uint16_le(dev, BME280_REGISTER_DIG_T1,
-            &data16) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_t1 = data16;
-    if (iot_bme280_read_uint16_le(dev, BME280_REGISTER_DIG_T2,
-            &data16) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_t2 = (int16_t) data16;
-    if (iot_bme280_read_uint16_le(dev, BME280_REGISTER_DIG_T3,
-            &data16) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_t3 = (int16_t) data16;
-
-    if (iot_bme280_read_uint16_le(dev, BME280_REGISTER_DIG_P1,
-            &data16) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_p1 = data16;
-    if (iot_bme280_read_uint16_le(dev, BME280_REGISTER_DIG_P2,
-            &data16) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_p2 = (int16_t) data16;
-    if (iot_bme280_read_uint16_le(dev, BME280_REGISTER_DIG_P3,
-            &data16) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_p3 = (int16_t) data16;
-    if (iot_bme280_read_uint16_le(dev, BME280_REGISTER_DIG_P4,
-            &data16) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_p4 = (int16_t) data16;
-    if (iot_bme280_read_uint16_le(dev, BME280_REGISTER_DIG_P5,
-            &data16) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_p5 = (int16_t) data16;
-    if (iot_bme280_read_uint16_le(dev, BME280_REGISTER_DIG_P6,
-            &data16) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_p6 = (int16_t) data16;
-    if (iot_bme280_read_uint16_le(dev, BME280_REGISTER_DIG_P7,
-            &data16) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_p7 = (int16_t) data16;
-    if (iot_bme280_read_uint16_le(dev, BME280_REGISTER_DIG_P8,
-            &data16) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_p8 = (int16_t) data16;
-    if (iot_bme280_read_uint16_le(dev, BME280_REGISTER_DIG_P9,
-            &data16) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_p9 = (int16_t) data16;
-
-    if (iot_bme280_read_byte(dev, BME280_REGISTER_DIG_H1, &data) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_h1 = data;
-    if (iot_bme280_read_uint16_le(dev, BME280_REGISTER_DIG_H2,
-            &data16) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_h2 = (int16_t) data16;
-    if (iot_bme280_read_byte(dev, BME280_REGISTER_DIG_H3, &data) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_h3 = data;
-    if (iot_bme280_read_byte(dev, BME280_REGISTER_DIG_H4, &data) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    if (iot_bme280_read_byte(dev, BME280_REGISTER_DIG_H4 + 1,
-            &data1) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    device->data_t.dig_h4 = (data << 4) | (data1 & 0xF);
-    if (iot_bme280_read_byte(dev, BME280_REGISTER_DIG_H5 + 1, &data) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
-    if (iot_bme280_read_byte(dev, BME280_REGISTER_DIG_H5, &data1) == ESP_FAIL) {
+    // two bursts instead of a transaction per byte
+    if (iot_bme280_read(dev, BME280_REGISTER_DIG_T1, BME280_CALIB_TP_LEN,
+            tp) != ESP_OK) {
         return ESP_FAIL;
     }
-    device->data_t.dig_h5 = (data << 4) | (data1 >> 4);
-    if (iot_bme280_read_byte(dev, BME280_REGISTER_DIG_H6, &data) == ESP_FAIL) {
+    if (iot_bme280_read(dev, BME280_REGISTER_DIG_H2, BME280_CALIB_H_LEN,
+            h) != ESP_OK) {
         return ESP_FAIL;
     }
-    device->data_t.dig_h6 = (int8_t) data;
+    iot_bme280_parse_coefficients(&device->data_t, tp, h);
     return ESP_OK;
 }
 
@@ -379,6 +291,29 @@ esp_err_t iot_bme280_init(bme280_handle_t dev)
     return ESP_OK;
 }
 
+static uint32_t iot_bme280_oversampling(unsigned int osrs)
+{
+    // 001 = x1 ... 101 and above = x16
+    return osrs == 0 ? 0 : 1 << ((osrs > 5 ? 5 : osrs) - 1);
+}
+
+uint32_t iot_bme280_measure_time_us(bme280_handle_t dev)
+{
+    bme280_dev_t* device = (bme280_dev_t*) dev;
+    uint32_t osrs_t = iot_bme280_oversampling(device->ctrl_meas_t.osrs_t);
+    uint32_t osrs_p = iot_bme280_oversampling(device->ctrl_meas_t.osrs_p);
+    uint32_t osrs_h = iot_bme280_oversampling(device->ctrl_hum_t.osrs_h);
+    uint32_t t = 1250 + 2300 * osrs_t;
+
+    if (osrs_p) {
+        t += 2300 * osrs_p + 575;
+    }
+    if (osrs_h) {
+        t += 2300 * osrs_h + 575;
+    }
+    return t;
+}
+
 esp_err_t iot_bme280_take_forced_measurement(bme280_handle_t dev)
 {
     uint8_t data = 0;
@@ -389,139 +324,158 @@ esp_err_t iot_bme280_take_forced_measurement(bme280_handle_t dev)
                 iot_bme280_getctrl_meas(dev)) == ESP_FAIL) {
             return ESP_FAIL;
         }
-        // wait until measurement has been completed, otherwise we would read, the values from the last measurement
+        // sleep through the whole conversion instead of polling, rounded up to a tick
+        uint32_t ms = (iot_bme280_measure_time_us(dev) + 999) / 1000;
+        vTaskDelay((ms + portTICK_RATE_MS - 1) / portTICK_RATE_MS);
+        // the status check is only a safety net, the conversion is normally done by now
         if (iot_bme280_read_byte(dev, BME280_REGISTER_STATUS, &data) == ESP_FAIL) {
             return ESP_FAIL;
         }
         while (data & 0x08) {
-            iot_bme280_read_byte(dev, BME280_REGISTER_STATUS, &data);
-            vTaskDelay(10 / portTICK_RATE_MS);
+            vTaskDelay(1);
+            if (iot_bme280_read_byte(dev, BME280_REGISTER_STATUS, &data) == ESP_FAIL) {
+                return ESP_FAIL;
+            }
         }
     }
     return ESP_OK;
 }
 
-float iot_bme280_read_temperature(bme280_handle_t dev)
+static int32_t bme280_compensate_t(const bme280_data_t *calib, int32_t adc_T)
 {
     int32_t var1, var2;
-    uint8_t data[3] = { 0 };
-    bme280_dev_t* device = (bme280_dev_t*) dev;
 
-    if (iot_bme280_read(dev, BME280_REGISTER_TEMPDATA, 3, data) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
+    var1 = ((((adc_T >> 3) - ((int32_t) calib->dig_t1 << 1)))
+            * ((int32_t) calib->dig_t2)) >> 11;
 
-    int32_t adc_T = (data[0] << 16) | (data[1] << 8) | data[2];
-    if (adc_T == 0x800000) {      // value in case temp measurement was disabled
-        return ESP_FAIL;
-    }
-    adc_T >>= 4;
+    var2 = (((((adc_T >> 4) - ((int32_t) calib->dig_t1))
+            * ((adc_T >> 4) - ((int32_t) calib->dig_t1))) >> 12)
+            * ((int32_t) calib->dig_t3)) >> 14;
 
-    var1 = ((((adc_T >> 3) - ((int32_t) device->data_t.dig_t1 << 1)))
-            * ((int32_t) device->data_t.dig_t2)) >> 11;
+    return var1 + var2;
+}
 
-    var2 = (((((adc_T >> 4) - ((int32_t) device->data_t.dig_t1))
-            * ((adc_T >> 4) - ((int32_t) device->data_t.dig_t1))) >> 12)
-            * ((int32_t) device->data_t.dig_t3)) >> 14;
+static uint32_t bme280_compensate_p(const bme280_data_t *calib, int32_t adc_P,
+        int32_t t_fine)
+{
+    int64_t var1, var2, p;
 
-    device->t_fine = var1 + var2;
+    var1 = ((int64_t) t_fine) - 128000;
+    var2 = var1 * var1 * (int64_t) calib->dig_p6;
+    var2 = var2 + ((var1 * (int64_t) calib->dig_p5) << 17);
+    var2 = var2 + (((int64_t) calib->dig_p4) << 35);
+    var1 = ((var1 * var1 * (int64_t) calib->dig_p3) >> 8)
+            + ((var1 * (int64_t) calib->dig_p2) << 12);
+    var1 = (((((int64_t) 1) << 47) + var1)) * ((int64_t) calib->dig_p1)
+            >> 33;
 
-    return (((device->t_fine * 5 + 128) >> 8) / 100.0);
+    if (var1 == 0) {
+        return 0; // avoid exception caused by division by zero
+    }
+    p = 1048576 - adc_P;
+    p = (((p << 31) - var2) * 3125) / var1;
+    var1 = (((int64_t) calib->dig_p9) * (p >> 13) * (p >> 13)) >> 25;
+    var2 = (((int64_t) calib->dig_p8) * p) >> 19;
+
+    p = ((p + var1 + var2) >> 8) + (((int64_t) calib->dig_p7) << 4);
+    return (uint32_t) p;
 }
 
-float iot_bme280_read_pressure(bme280_handle_t dev)
+static uint32_t bme280_compensate_h(const bme280_data_t *calib, int32_t adc_H,
+        int32_t t_fine)
 {
-    int64_t var1, var2, p;
-    uint8_t data[3] = { 0 };
-    bme280_dev_t* device = (bme280_dev_t*) dev;
+    int32_t v_x1_u32r;
 
-    if (iot_bme280_read_temperature(dev) == ESP_FAIL) {
-        // must be done first to get t_fine
-        return ESP_FAIL;
-    }
+    v_x1_u32r = (t_fine - ((int32_t) 76800));
 
-    if (iot_bme280_read(dev, BME280_REGISTER_PRESSUREDATA, 3, data) == ESP_FAIL) {
-        return ESP_FAIL;
-    }
+    v_x1_u32r = (((((adc_H << 14) - (((int32_t) calib->dig_h4) << 20)
+            - (((int32_t) calib->dig_h5) * v_x1_u32r))
+            + ((int32_t) 16384)) >> 15)
+            * (((((((v_x1_u32r * ((int32_t) calib->dig_h6)) >> 10)
+                    * (((v_x1_u32r * ((int32_t) calib->dig_h3)) >> 11)
+                            + ((int32_t) 32768))) >> 10) + ((int32_t) 2097152))
+                    * ((int32_t) calib->dig_h2) + 8192) >> 14));
 
-    int32_t adc_P = (data[0] << 16) | (data[1] << 8) | data[2];
-    if (adc_P == 0x800000) {  // value in case pressure measurement was disabled
-        return ESP_FAIL;
-    }
+    v_x1_u32r = (v_x1_u32r
+            - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7)
+                    * ((int32_t) calib->dig_h1)) >> 4));
 
-    adc_P >>= 4;
+    v_x1_u32r = (v_x1_u32r < 0) ? 0 : v_x1_u32r;
+    v_x1_u32r = (v_x1_u32r > 419430400) ? 419430400 : v_x1_u32r;
+    return (uint32_t) (v_x1_u32r >> 12);
+}
 
-    var1 = ((int64_t) device->t_fine) - 128000;
-    var2 = var1 * var1 * (int64_t) device->data_t.dig_p6;
-    var2 = var2 + ((var1 * (int64_t) device->data_t.dig_p5) << 17);
-    var2 = var2 + (((int64_t) device->data_t.dig_p4) << 35);
-    var1 = ((var1 * var1 * (int64_t) device->data_t.dig_p3) >> 8)
-            + ((var1 * (int64_t) device->data_t.dig_p2) << 12);
-    var1 = (((((int64_t) 1) << 47) + var1)) * ((int64_t) device->data_t.dig_p1)
-            >> 33;
+esp_err_t iot_bme280_compensate(const bme280_data_t *calib, const uint8_t *raw,
+        bme280_measure_t *meas)
+{
+    int32_t adc_P = (raw[0] << 12) | (raw[1] << 4) | (raw[2] >> 4);
+    int32_t adc_T = (raw[3] << 12) | (raw[4] << 4) | (raw[5] >> 4);
+    int32_t adc_H = (raw[6] << 8) | raw[7];
 
-    if (var1 == 0) {
-        return ESP_FAIL; // avoid exception caused by division by zero
+    if (adc_T == 0x80000) {      // value in case temp measurement was disabled
+        return ESP_FAIL;
     }
-    p = 1048576 - adc_P;
-    p = (((p << 31) - var2) * 3125) / var1;
-    var1 = (((int64_t) device->data_t.dig_p9) * (p >> 13) * (p >> 13)) >> 25;
-    var2 = (((int64_t) device->data_t.dig_p8) * p) >> 19;
-
-    p = ((p + var1 + var2) >> 8) + (((int64_t) device->data_t.dig_p7) << 4);
-    p = p >> 8; // /256
-    return ((float) p / 100);
+    meas->t_fine = bme280_compensate_t(calib, adc_T);
+    meas->temperature = (meas->t_fine * 5 + 128) >> 8;
+    // disabled pressure and humidity read back as 0x80000 and 0x8000
+    meas->pressure = (adc_P == 0x80000) ? 0 : bme280_compensate_p(calib, adc_P, meas->t_fine);
+    meas->humidity = (adc_H == 0x8000) ? 0 : bme280_compensate_h(calib, adc_H, meas->t_fine);
+    return ESP_OK;
 }
 
-float iot_bme280_read_humidity(bme280_handle_t dev)
+esp_err_t iot_bme280_read_all(bme280_handle_t dev, bme280_measure_t *meas)
 {
-    uint16_t data16;
+    uint8_t data[BME280_DATA_LEN] = { 0 };
     bme280_dev_t* device = (bme280_dev_t*) dev;
 
-    if (iot_bme280_read_temperature(dev) == ESP_FAIL) {
-        // must be done first to get t_fine
+    // one burst over 0xF7 ~ 0xFE, the shadow registers are locked until it ends
+    if (iot_bme280_read(dev, BME280_REGISTER_PRESSUREDATA, BME280_DATA_LEN,
+            data) != ESP_OK) {
         return ESP_FAIL;
     }
-
-    if (iot_bme280_read_uint16(dev, BME280_REGISTER_HUMIDDATA,
-            &data16) == ESP_FAIL) {
+    if (iot_bme280_compensate(&device->data_t, data, meas) != ESP_OK) {
         return ESP_FAIL;
     }
+    device->t_fine = meas->t_fine;
+    return ESP_OK;
+}
 
-    int32_t adc_H = data16;
-    if (adc_H == 0x8000) { // value in case humidity measurement was disabled
+float iot_bme280_read_temperature(bme280_handle_t dev)
+{
+    bme280_measure_t meas;
+    if (iot_bme280_read_all(dev, &meas) != ESP_OK) {
         return ESP_FAIL;
     }
+    return meas.temperature / 100.0;
+}
 
-    int32_t v_x1_u32r;
-
-    v_x1_u32r = (device->t_fine - ((int32_t) 76800));
-
-    v_x1_u32r = (((((adc_H << 14) - (((int32_t) device->data_t.dig_h4) << 20)
-            - (((int32_t) device->data_t.dig_h5) * v_x1_u32r))
-            + ((int32_t) 16384)) >> 15)
-            * (((((((v_x1_u32r * ((int32_t) device->data_t.dig_h6)) >> 10)
-                    * (((v_x1_u32r * ((int32_t) device->data_t.dig_h3)) >> 11)
-                            + ((int32_t) 32768))) >> 10) + ((int32_t) 2097152))
-                    * ((int32_t) device->data_t.dig_h2) + 8192) >> 14));
-
-    v_x1_u32r = (v_x1_u32r
-            - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7)
-                    * ((int32_t) device->data_t.dig_h1)) >> 4));
+float iot_bme280_read_pressure(bme280_handle_t dev)
+{
+    bme280_measure_t meas;
+    if (iot_bme280_read_all(dev, &meas) != ESP_OK || meas.pressure == 0) {
+        return ESP_FAIL;
+    }
+    return ((float) (meas.pressure >> 8) / 100);
+}
 
-    v_x1_u32r = (v_x1_u32r < 0) ? 0 : v_x1_u32r;
-    v_x1_u32r = (v_x1_u32r > 419430400) ? 419430400 : v_x1_u32r;
-    return ((v_x1_u32r >> 12) / 1024.0);
+float iot_bme280_read_humidity(bme280_handle_t dev)
+{
+    bme280_measure_t meas;
+    bme280_dev_t* device = (bme280_dev_t*) dev;
+    // a skipped humidity channel is compensated as 0, which is also a valid reading
+    if (device->ctrl_hum_t.osrs_h == BME280_SAMPLING_NONE
+            || iot_bme280_read_all(dev, &meas) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    return (meas.humidity / 1024.0);
 }
 
 float iot_bme280_read_altitude(bme280_handle_t dev, float seaLevel)
 {
-    float pressure = 0;
-    if (iot_bme280_read_pressure(dev) == ESP_FAIL) {
+    float atmospheric = iot_bme280_read_pressure(dev);
+    if (atmospheric == ESP_FAIL) {
         return ESP_FAIL;
     }
-
-    float atmospheric = pressure / 100.0F;
     return (44330.0 * (1.0 - pow(atmospheric / seaLevel, 0.1903)));
 }
 
@@ -54,6 +54,16 @@ esp_err_t CBme280::take_forced_measurement(void)
     return iot_bme280_take_forced_measurement(m_dev_handle);
 }
 
+esp_err_t CBme280::read_all(bme280_measure_t *meas)
+{
+    return iot_bme280_read_all(m_dev_handle, meas);
+}
+
+uint32_t CBme280::measure_time_us()
+{
+    return iot_bme280_measure_time_us(m_dev_handle);
+}
+
 float CBme280::temperature()
 {
     return iot_bme280_read_temperature(m_dev_handle);
@@ -67,6 +67,10 @@ extern "C"
 #define BME280_REGISTER_TEMPDATA            0xFA
 #define BME280_REGISTER_HUMIDDATA           0xFD
 
+#define BME280_CALIB_TP_LEN                 26    // 0x88 ~ 0xA1, dig_T1 ~ dig_H1
+#define BME280_CALIB_H_LEN                  7     // 0xE1 ~ 0xE7, dig_H2 ~ dig_H6
+#define BME280_DATA_LEN                     8     // 0xF7 ~ 0xFE, press_msb ~ hum_lsb
+
 typedef struct {
     uint16_t dig_t1;
     int16_t dig_t2;
@@ -193,6 +197,16 @@ typedef struct ctrl_hum {
     unsigned int osrs_h :3;
 } bme280_ctrl_hum_t;
 
+/**
+ * @brief One compensated measurement, the fixed point output of the Bosch integer formulas
+ */
+typedef struct {
+    int32_t temperature;    /*!< 0.01 DegC, 5123 is 51.23 DegC */
+    uint32_t pressure;      /*!< Pa in Q24.8, 24674867 is 96386.2 Pa, 0 if pressure is skipped */
+    uint32_t humidity;      /*!< %RH in Q22.10, 47445 is 46.333 %RH, 0 if humidity is skipped */
+    int32_t t_fine;         /*!< fine temperature shared by the pressure and humidity formulas */
+} bme280_measure_t;
+
 typedef void* bme280_handle_t; /*handle of bme280*/
 
 /**
@@ -328,6 +342,46 @@ bool iot_bme280_is_reading_calibration(bme280_handle_t dev);
  */
 esp_err_t iot_bme280_read_coefficients(bme280_handle_t dev);
 
+/**
+ * @brief Unpack the factory-set coefficients from the two calibration blocks
+ *
+ * @param   calib coefficients to fill
+ * @param   tp BME280_CALIB_TP_LEN bytes read from BME280_REGISTER_DIG_T1
+ * @param   h BME280_CALIB_H_LEN bytes read from BME280_REGISTER_DIG_H2
+ */
+void iot_bme280_parse_coefficients(bme280_data_t *calib, const uint8_t *tp,
+        const uint8_t *h);
+
+/**
+ * @brief Run the Bosch integer compensation on one raw data block
+ *
+ * Temperature is compensated first, its t_fine feeds pressure and humidity,
+ * so the three values always come from the same conversion.
+ *
+ * @param   calib factory-set coefficients
+ * @param   raw BME280_DATA_LEN bytes read from BME280_REGISTER_PRESSUREDATA
+ * @param   meas compensated result
+ *
+ * @return
+ *    - ESP_OK Success
+ *    - ESP_FAIL Temperature measurement is skipped, nothing can be compensated
+ */
+esp_err_t iot_bme280_compensate(const bme280_data_t *calib, const uint8_t *raw,
+        bme280_measure_t *meas);
+
+/**
+ * @brief Maximum time of one conversion with the current oversampling settings
+ *
+ * t = 1.25 + 2.3 * osrs_t + (2.3 * osrs_p + 0.575) + (2.3 * osrs_h + 0.575) ms,
+ * a skipped measurement adds nothing (see DS 9.1)
+ *
+ * @param   dev object handle of bme280
+ *
+ * @return
+ *    - measurement time in us
+ */
+uint32_t iot_bme280_measure_time_us(bme280_handle_t dev);
+
 /**
  * @brief  setup sensor with given parameters / settings
  *
@@ -375,6 +429,18 @@ esp_err_t iot_bme280_init(bme280_handle_t dev);
  */
 esp_err_t iot_bme280_take_forced_measurement(bme280_handle_t dev);
 
+/**
+ * @brief Read temperature, pressure and humidity in one burst and compensate them
+ *
+ * @param   dev object handle of bme280
+ * @param   meas compensated result
+ *
+ * @return
+ *    - ESP_OK Success
+ *    - ESP_FAIL Fail
+ */
+esp_err_t iot_bme280_read_all(bme280_handle_t dev, bme280_measure_t *meas);
+
 /**
  * @brief  Returns the temperature from the sensor
  *
@@ -402,6 +468,7 @@ float iot_bme280_read_pressure(bme280_handle_t dev);
  *
  * @return
  *    - humidity value
+ *    - ESP_FAIL if the read fails or humidity oversampling is BME280_SAMPLING_NONE
  */
 float iot_bme280_read_humidity(bme280_handle_t dev);
 
@@ -520,6 +587,25 @@ public:
      */
     esp_err_t take_forced_measurement(void);
 
+    /**
+     * @brief Read temperature, pressure and humidity in one burst and compensate them
+     *
+     * @param meas compensated result
+     *
+     * @return
+     *    - ESP_OK Success
+     *    - ESP_FAIL Fail
+     */
+    esp_err_t read_all(bme280_measure_t *meas);
+
+    /**
+     * @brief Maximum time of one conversion with the current oversampling settings
+     *
+     * @return
+     *    - measurement time in us
+     */
+    uint32_t measure_time_us();
+
     /**
      * @brief  Returns the temperature from the sensor
      *
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include <stdio.h>
+#include <stdlib.h>
 #include "unity.h"
 #include "esp_log.h"
 #include "driver/i2c.h"
@@ -75,3 +76,87 @@ TEST_CASE("Device bme280 test", "[bme280][iot][device]")
 {
     bme280_test();
 }
+
+/* Trimming registers 0x88 ~ 0xA1 with the coefficients of the datasheet example (DS 8.1) */
+static const uint8_t bme280_calib_tp[BME280_CALIB_TP_LEN] = {
+    0x70, 0x6B, 0x43, 0x67, 0x18, 0xFC,     // dig_T1 27504, dig_T2 26435, dig_T3 -1000
+    0x7D, 0x8E, 0x43, 0xD6, 0xD0, 0x0B,     // dig_P1 36477, dig_P2 -10685, dig_P3 3024
+    0x27, 0x0B, 0x8C, 0x00, 0xF9, 0xFF,     // dig_P4 2855, dig_P5 140, dig_P6 -7
+    0x8C, 0x3C, 0xF8, 0xC6, 0x70, 0x17,     // dig_P7 15500, dig_P8 -14600, dig_P9 6000
+    0x00, 0x4B,                             // reserved, dig_H1 75
+};
+
+/* Trimming registers 0xE1 ~ 0xE7, typical humidity coefficients, dig_H5 negative to cover the sign */
+static const uint8_t bme280_calib_h[BME280_CALIB_H_LEN] = {
+    0x6A, 0x01, 0x00,                       // dig_H2 362, dig_H3 0
+    0x13, 0x99, 0xFC,                       // dig_H4 313, dig_H5 -55
+    0x1E,                                   // dig_H6 30
+};
+
+/* Floating point humidity formula of the datasheet, the reference for the integer one */
+static double bme280_humidity_ref(const bme280_data_t *calib, int32_t adc_H, int32_t t_fine)
+{
+    double h = t_fine - 76800.0;
+    h = (adc_H - (calib->dig_h4 * 64.0 + calib->dig_h5 / 16384.0 * h))
+        * (calib->dig_h2 / 65536.0 * (1.0 + calib->dig_h6 / 67108864.0 * h
+                * (1.0 + calib->dig_h3 / 67108864.0 * h)));
+    h = h * (1.0 - calib->dig_h1 * h / 524288.0);
+    return h < 0 ? 0 : (h > 100 ? 100 : h);
+}
+
+TEST_CASE("BME280 compensation test", "[bme280][iot]")
+{
+    bme280_data_t calib;
+    bme280_measure_t meas;
+    iot_bme280_parse_coefficients(&calib, bme280_calib_tp, bme280_calib_h);
+    TEST_ASSERT_EQUAL_INT(27504, calib.dig_t1);
+    TEST_ASSERT_EQUAL_INT(-1000, calib.dig_t3);
+    TEST_ASSERT_EQUAL_INT(-7, calib.dig_p6);
+    TEST_ASSERT_EQUAL_INT(313, calib.dig_h4);
+    TEST_ASSERT_EQUAL_INT(-55, calib.dig_h5);
+
+    /* adc_T 519888, adc_P 415148, adc_H 26000 */
+    uint8_t raw[BME280_DATA_LEN] = { 0x65, 0x5A, 0xC0, 0x7E, 0xED, 0x00, 0x65, 0x90 };
+    TEST_ASSERT_EQUAL(ESP_OK, iot_bme280_compensate(&calib, raw, &meas));
+    // datasheet: t_fine 128422, 25.08 DegC, 100653 Pa, the 64 bit formula gives 100653.25 Pa in Q24.8
+    TEST_ASSERT_EQUAL_INT32(128422, meas.t_fine);
+    TEST_ASSERT_EQUAL_INT32(2508, meas.temperature);
+    TEST_ASSERT_EQUAL_UINT32(100653, meas.pressure >> 8);
+    TEST_ASSERT_EQUAL_UINT32(25767233, meas.pressure);
+    // the integer formula keeps 1/1024 %RH, allow a few LSB against the float one
+    double hum = bme280_humidity_ref(&calib, 26000, meas.t_fine);
+    ESP_LOGI("BME280:", "humidity %.4f, reference %.4f", meas.humidity / 1024.0, hum);
+    TEST_ASSERT_INT_WITHIN(8, (int32_t) (hum * 1024), (int32_t) meas.humidity);
+
+    /* Skipped pressure and humidity read back as 0x80000 and 0x8000 */
+    uint8_t skipped[BME280_DATA_LEN] = { 0x80, 0x00, 0x00, 0x7E, 0xED, 0x00, 0x80, 0x00 };
+    TEST_ASSERT_EQUAL(ESP_OK, iot_bme280_compensate(&calib, skipped, &meas));
+    TEST_ASSERT_EQUAL_INT32(2508, meas.temperature);
+    TEST_ASSERT_EQUAL_UINT32(0, meas.pressure);
+    TEST_ASSERT_EQUAL_UINT32(0, meas.humidity);
+
+    /* Without temperature there is no t_fine */
+    skipped[3] = 0x80;
+    skipped[4] = 0x00;
+    TEST_ASSERT_EQUAL(ESP_FAIL, iot_bme280_compensate(&calib, skipped, &meas));
+}
+
+TEST_CASE("Device bme280 forced mode test", "[bme280][iot][device]")
+{
+    bme280_measure_t meas;
+    if (dev == NULL) {
+        bme280_init();
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, iot_bme280_set_sampling(dev, BME280_MODE_FORCED,
+            BME280_SAMPLING_X1, BME280_SAMPLING_X1, BME280_SAMPLING_X1,
+            BME280_FILTER_OFF, BME280_STANDBY_MS_0_5));
+    // 1.25 + 2.3 + 2.875 + 2.875 ms, see DS 9.1
+    TEST_ASSERT_EQUAL_UINT32(9300, iot_bme280_measure_time_us(dev));
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, iot_bme280_take_forced_measurement(dev));
+        TEST_ASSERT_EQUAL(ESP_OK, iot_bme280_read_all(dev, &meas));
+        ESP_LOGI("BME280:", "temperature:%d.%02d, pressure:%u, humidity:%u.%03u",
+                meas.temperature / 100, abs(meas.temperature % 100), meas.pressure >> 8,
+                meas.humidity >> 10, (meas.humidity & 0x3FF) * 1000 / 1024);
+    }
+}
@@ -18,6 +18,12 @@
 #include "esp_log.h"
 #include "string.h"
 
+#define FT5X06_INTR_TASK_PRIO       (configMAX_PRIORITIES - 5)
+#define FT5X06_INTR_TASK_STACK      (2048)
+#define FT5X06_RELEASE_TIMEOUT_MS   (100)   /* no report for this long while touched means released */
+
+static const char* TAG = "FT5X06";
+
 esp_err_t iot_ft5x06_read(ft5x06_handle_t dev, uint8_t start_addr,
         uint8_t read_num, uint8_t *data_buf)
 {
@@ -132,5 +138,191 @@ ft5x06_handle_t iot_ft5x06_create(i2c_bus_handle_t bus, uint16_t dev_addr)
     dev->x_size = SCREEN_XSIZE;
     dev->y_size = SCREEN_YSIZE;
     dev->xy_swap = false;
+    dev->int_pin = -1;
     return (ft5x06_handle_t) dev;
+}
+
+esp_err_t iot_ft5x06_read_points(ft5x06_handle_t dev, ft5x06_touch_event_t *evt)
+{
+    uint8_t data[1 + FT5X06_MAX_POINTS * FT5X0X_POINT_REG_SIZE];
+    if (dev == NULL || evt == NULL) {
+        return ESP_FAIL;
+    }
+    if (iot_ft5x06_read(dev, FT5X0X_REG_TD_STATUS, sizeof(data), data) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    evt->point_num = data[0] & 0x0f;
+    if (evt->point_num > FT5X06_MAX_POINTS) {
+        evt->point_num = 0;
+    }
+    for (int i = 0; i < evt->point_num; i++) {
+        const uint8_t *reg = &data[1 + i * FT5X0X_POINT_REG_SIZE];
+        evt->points[i].event = reg[0] >> 6;
+        evt->points[i].x = ((uint16_t)(reg[0] & 0x0f) << 8) | reg[1];
+        evt->points[i].id = reg[2] >> 4;
+        evt->points[i].y = ((uint16_t)(reg[2] & 0x0f) << 8) | reg[3];
+    }
+    return ESP_OK;
+}
+
+static void IRAM_ATTR ft5x06_isr_handler(void *arg)
+{
+    ft5x06_dev_t* dev = (ft5x06_dev_t*) arg;
+    portBASE_TYPE task_woken = pdFALSE;
+    xSemaphoreGiveFromISR(dev->int_sem, &task_woken);
+    if (task_woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void ft5x06_queue_event(ft5x06_dev_t* dev, ft5x06_touch_event_t *evt)
+{
+    ft5x06_touch_event_t old;
+    // Keep the newest position when nobody drains the queue
+    if (xQueueSend(dev->evt_queue, evt, 0) != pdTRUE) {
+        xQueueReceive(dev->evt_queue, &old, 0);
+        xQueueSend(dev->evt_queue, evt, 0);
+    }
+}
+
+static void ft5x06_intr_task(void *arg)
+{
+    ft5x06_dev_t* dev = (ft5x06_dev_t*) arg;
+    ft5x06_touch_event_t evt;
+    bool touched = false;
+    while (dev->intr_run) {
+        // While touched the panel pulses INT every report period, a missing pulse
+        // means the lift-up report was lost, so read once more to catch the release
+        if (xSemaphoreTake(dev->int_sem, touched ? FT5X06_RELEASE_TIMEOUT_MS / portTICK_RATE_MS : portMAX_DELAY) != pdTRUE
+                && !touched) {
+            continue;
+        }
+        if (!dev->intr_run) {
+            break;
+        }
+        if (iot_ft5x06_read_points(dev, &evt) != ESP_OK) {
+            continue;
+        }
+        if (evt.point_num > 0 || touched) {
+            ft5x06_queue_event(dev, &evt);
+        }
+        touched = evt.point_num > 0;
+    }
+    dev->intr_task = NULL;
+    xSemaphoreGive(dev->exit_sem);
+    vTaskDelete(NULL);
+}
+
+static void ft5x06_intr_free(ft5x06_dev_t* device)
+{
+    if (device->int_sem) {
+        vSemaphoreDelete(device->int_sem);
+        device->int_sem = NULL;
+    }
+    if (device->exit_sem) {
+        vSemaphoreDelete(device->exit_sem);
+        device->exit_sem = NULL;
+    }
+    if (device->evt_queue) {
+        vQueueDelete(device->evt_queue);
+        device->evt_queue = NULL;
+    }
+}
+
+esp_err_t iot_ft5x06_intr_start(ft5x06_handle_t dev, int int_pin, int queue_len)
+{
+    ft5x06_dev_t* device = (ft5x06_dev_t*) dev;
+    uint8_t mode = 1;   // trigger mode, one INT pulse per report
+    esp_err_t ret;
+    bool gpio_armed = false;
+    if (device->int_pin >= 0) {
+        return ESP_OK;
+    }
+    if (iot_ft5x06_write(dev, FT5X0X_REG_MODE, 1, &mode) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    device->int_sem = xSemaphoreCreateBinary();
+    device->exit_sem = xSemaphoreCreateBinary();
+    device->evt_queue = xQueueCreate(queue_len > 0 ? queue_len : FT5X06_INTR_QUEUE_LEN_DEFAULT,
+            sizeof(ft5x06_touch_event_t));
+    if (device->int_sem == NULL || device->exit_sem == NULL || device->evt_queue == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << int_pin,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_NEGEDGE,
+    };
+    gpio_config(&io_conf);
+    gpio_armed = true;
+    // The service may already be installed by another driver
+    ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        goto fail;
+    }
+    device->intr_run = true;
+    if (xTaskCreate(ft5x06_intr_task, "ft5x06_intr", FT5X06_INTR_TASK_STACK, device,
+            FT5X06_INTR_TASK_PRIO, &device->intr_task) != pdPASS) {
+        device->intr_run = false;
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+    ret = gpio_isr_handler_add(int_pin, ft5x06_isr_handler, device);
+    if (ret != ESP_OK) {
+        gpio_set_intr_type(int_pin, GPIO_INTR_DISABLE);
+        iot_ft5x06_intr_stop(dev);
+        return ret;
+    }
+    device->int_pin = int_pin;
+    // Catch a touch that started before the handler was added
+    xSemaphoreGive(device->int_sem);
+    return ESP_OK;
+
+fail:
+    ESP_LOGE(TAG, "interrupt mode start fail");
+    if (gpio_armed) {
+        // nobody would serve the falling edge gpio_config armed
+        gpio_set_intr_type(int_pin, GPIO_INTR_DISABLE);
+    }
+    ft5x06_intr_free(device);
+    return ret;
+}
+
+esp_err_t iot_ft5x06_intr_stop(ft5x06_handle_t dev)
+{
+    ft5x06_dev_t* device = (ft5x06_dev_t*) dev;
+    if (device->int_pin >= 0) {
+        gpio_isr_handler_remove(device->int_pin);
+        gpio_set_intr_type(device->int_pin, GPIO_INTR_DISABLE);
+        device->int_pin = -1;
+    }
+    if (device->intr_task) {
+        // Let the task finish its bus access and exit on its own
+        device->intr_run = false;
+        xSemaphoreGive(device->int_sem);
+        xSemaphoreTake(device->exit_sem, portMAX_DELAY);
+    }
+    ft5x06_intr_free(device);
+    return ESP_OK;
+}
+
+esp_err_t iot_ft5x06_get_event(ft5x06_handle_t dev, ft5x06_touch_event_t *evt, TickType_t ticks)
+{
+    ft5x06_dev_t* device = (ft5x06_dev_t*) dev;
+    if (device->evt_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return xQueueReceive(device->evt_queue, evt, ticks) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+int iot_ft5x06_get_event_num(ft5x06_handle_t dev)
+{
+    ft5x06_dev_t* device = (ft5x06_dev_t*) dev;
+    if (device->evt_queue == NULL) {
+        return 0;
+    }
+    return uxQueueMessagesWaiting(device->evt_queue);
 }
\ No newline at end of file
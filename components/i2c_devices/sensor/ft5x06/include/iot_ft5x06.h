@@ -20,6 +20,10 @@ extern "C"
 #endif
 
 #include "driver/i2c.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "iot_i2c_bus.h"
 
 #define FT5X06_ADDR_DEF    (0x38)
@@ -77,6 +81,11 @@ extern "C"
 #define    FT5X0X_REG_FT5201ID               0xa8
 #define    FT5X0X_REG_ERR                    0xa9
 #define    FT5X0X_REG_CLB                    0xaa
+#define    FT5X0X_REG_TD_STATUS              0x02   /* number of touch points, followed by the point registers */
+#define    FT5X0X_POINT_REG_SIZE             6      /* XH XL YH YL WEIGHT MISC per touch point */
+
+#define    FT5X06_MAX_POINTS                 5
+#define    FT5X06_INTR_QUEUE_LEN_DEFAULT     8
 
 typedef enum {
     TOUCH_EVT_RELEASE = 0x0,
@@ -90,6 +99,24 @@ typedef struct {
     uint16_t cury[5];
 } touch_info_t;
 
+typedef enum {
+    FT5X06_POINT_DOWN    = 0x0,
+    FT5X06_POINT_UP      = 0x1,
+    FT5X06_POINT_CONTACT = 0x2,
+} ft5x06_point_evt_t;
+
+typedef struct {
+    uint8_t id;                 /* touch id, kept while the finger stays on the panel */
+    uint8_t event;              /* ft5x06_point_evt_t */
+    uint16_t x;                 /* raw panel coordinates */
+    uint16_t y;
+} ft5x06_point_t;
+
+typedef struct {
+    uint8_t point_num;          /* 0 once every finger is lifted */
+    ft5x06_point_t points[FT5X06_MAX_POINTS];
+} ft5x06_touch_event_t;
+
 typedef struct {
     int reversed;
 } ft5x06_cfg_t;
@@ -101,6 +128,12 @@ typedef struct {
     uint16_t x_size;
     uint16_t y_size;
     //touch_info_t tch_info;
+    int int_pin;                /* -1 unless interrupt mode is running */
+    xSemaphoreHandle int_sem;
+    xQueueHandle evt_queue;
+    xTaskHandle intr_task;
+    xSemaphoreHandle exit_sem;  /* given by the interrupt task right before it is deleted */
+    volatile bool intr_run;
 } ft5x06_dev_t;
 
 typedef void*  ft5x06_handle_t;
@@ -170,6 +203,70 @@ ft5x06_handle_t iot_ft5x06_create(i2c_bus_handle_t bus, uint16_t dev_addr);
  */
 esp_err_t iot_ft5x06_init(ft5x06_handle_t dev, ft5x06_cfg_t * cfg);
 
+/**
+ * @brief Read all touch points in one burst read of the report registers
+ *
+ * @param dev object handle of FT5X06.
+ * @param evt touch points in raw panel coordinates.
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_ft5x06_read_points(ft5x06_handle_t dev, ft5x06_touch_event_t *evt);
+
+/**
+ * @brief Start interrupt mode
+ *        The panel is switched to trigger mode, so INT pulses once per report.
+ *        A task reads the points on every pulse and queues them, the bus is
+ *        left alone while nothing touches the panel. When the queue is full
+ *        the oldest event is dropped.
+ *
+ * @param dev object handle of FT5X06.
+ * @param int_pin GPIO connected to the INT pin of the panel.
+ * @param queue_len number of events to buffer, 0 for FT5X06_INTR_QUEUE_LEN_DEFAULT.
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_NO_MEM no memory for the queue or task
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_ft5x06_intr_start(ft5x06_handle_t dev, int int_pin, int queue_len);
+
+/**
+ * @brief Stop interrupt mode and free its resources
+ *
+ * @param dev object handle of FT5X06.
+ *
+ * @return
+ *     - ESP_OK Success
+ */
+esp_err_t iot_ft5x06_intr_stop(ft5x06_handle_t dev);
+
+/**
+ * @brief Take the oldest queued touch event in interrupt mode
+ *
+ * @param dev object handle of FT5X06.
+ * @param evt touch event
+ * @param ticks time to wait for an event
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_TIMEOUT no event
+ *     - ESP_ERR_INVALID_STATE interrupt mode is not running
+ */
+esp_err_t iot_ft5x06_get_event(ft5x06_handle_t dev, ft5x06_touch_event_t *evt, TickType_t ticks);
+
+/**
+ * @brief Number of touch events waiting in interrupt mode
+ *
+ * @param dev object handle of FT5X06.
+ *
+ * @return
+ *     - number of queued events
+ */
+int iot_ft5x06_get_event_num(ft5x06_handle_t dev);
+
 #ifdef __cplusplus
 }
 #endif
@@ -97,3 +97,27 @@ TEST_CASE("Device ft5x06 test", "[ft5x06][iot][device]")
 {
     ft5x06_test();
 }
+
+TEST_CASE("Device ft5x06 interrupt test", "[ft5x06][iot][device]")
+{
+    ft5x06_touch_event_t evt;
+    int cnt = 0;
+    ft5x06_init();
+    TEST_ASSERT_EQUAL(ESP_OK, iot_ft5x06_intr_start(dev, TOUCH_INT_IO, 0));
+    ESP_LOGI("FT5X06", "touch the panel, 200 events to go");
+    while (cnt < 200) {
+        if (iot_ft5x06_get_event(dev, &evt, portMAX_DELAY) != ESP_OK) {
+            continue;
+        }
+        cnt++;
+        if (evt.point_num == 0) {
+            ESP_LOGI("FT5X06", "release");
+        }
+        for (int i = 0; i < evt.point_num; i++) {
+            ESP_LOGI("FT5X06", "point %d id %d evt %d x:%d y:%d", i, evt.points[i].id,
+                    evt.points[i].event, evt.points[i].x, evt.points[i].y);
+        }
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, iot_ft5x06_intr_stop(dev));
+    iot_i2c_bus_delete(i2c_bus);
+}
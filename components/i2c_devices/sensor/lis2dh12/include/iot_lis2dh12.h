@@ -15,6 +15,7 @@
 #define _IOT_LIS2DH12_H_
 
 #include "driver/i2c.h"
+#include "freertos/FreeRTOS.h"
 #include "iot_i2c_bus.h"
 #ifdef __cplusplus
 extern "C" {
@@ -126,6 +127,38 @@ typedef struct
     lis2dh12_state_t      fifo_enable;     /*!< FIFO enable  */
 }lis2dh12_config_t; 
 
+/**
+* @brief  FIFO mode selection
+*/
+typedef enum {
+    LIS2DH12_FM_BYPASS       = 0x00,    /*!< Bypass mode, FIFO is not used */
+    LIS2DH12_FM_FIFO         = 0x01,    /*!< FIFO mode, stops collecting data when full */
+    LIS2DH12_FM_STREAM       = 0x02,    /*!< Stream mode, the oldest sample is overwritten when full */
+    LIS2DH12_FM_STREAM_FIFO  = 0x03,    /*!< Stream-to-FIFO mode */
+}lis2dh12_fifo_mode_t;
+
+/**
+* @brief  Acceleration of the three axes, left-justified raw output
+*/
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+} lis2dh12_acc_value_t;
+
+/**
+* @brief  One sample drained from the FIFO in stream mode
+*/
+typedef struct {
+    int16_t x;              /*!< left-justified raw output, as lis2dh12_acc_value_t */
+    int16_t y;
+    int16_t z;
+    int64_t timestamp;      /*!< us since boot, estimated from the drain time and the data rate */
+} lis2dh12_fifo_sample_t;
+
+#define LIS2DH12_FIFO_SIZE                  (32)    /*!< samples held by the sensor FIFO */
+#define LIS2DH12_FIFO_BUF_LEN_DEFAULT       (256)   /*!< samples held by the driver ring buffer */
+
 /**
 * @brief  Bitfield positioning.
 */
@@ -136,6 +169,11 @@ typedef struct
 */
 #define LIS2DH12_I2C_ADDRESS   0x18
 
+/**
+* @brief  Set on the register address to read or write several registers in one transfer.
+*/
+#define LIS2DH12_AUTO_INCREMENT   0x80
+
 
 /**
 * @brief  Temperature data status register
@@ -782,6 +820,101 @@ esp_err_t iot_lis2dh12_get_y_acc(lis2dh12_handle_t sensor, uint16_t *y_acc);
  */
 esp_err_t iot_lis2dh12_get_z_acc(lis2dh12_handle_t sensor, uint16_t *z_acc);
 
+/**
+ * @brief Get the acceleration of all three axes in one burst read
+ *
+ * @param sensor object handle of LIS2DH12
+ * @param acc a pointer of acceleration
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_lis2dh12_get_acc(lis2dh12_handle_t sensor, lis2dh12_acc_value_t *acc);
+
+/**
+ * @brief Start streaming through the FIFO
+ *
+ * The FIFO runs in stream mode and raises INT1 when it holds watermark samples.
+ * A driver task then drains it with one auto-increment burst read and stores the
+ * samples in a ring buffer, so the bus is only used once per watermark.
+ * The data rate, full scale and axes are taken from the current configuration.
+ *
+ * @note The samples of one drain get timestamps spaced by the output data rate,
+ *       counted back from the time of the read. Timestamps never go backwards, but
+ *       samples of two drains may share one when the reads jitter.
+ *
+ * @param sensor object handle of LIS2DH12
+ * @param int1_pin GPIO connected to INT1
+ * @param watermark FIFO level that raises INT1, 1 ~ LIS2DH12_FIFO_SIZE - 1
+ * @param buf_len samples kept in the ring buffer, 0 for LIS2DH12_FIFO_BUF_LEN_DEFAULT,
+ *        the oldest samples are dropped when it is full
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG watermark out of range
+ *     - ESP_ERR_NO_MEM no memory for the buffer or the task
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_lis2dh12_fifo_start(lis2dh12_handle_t sensor, int int1_pin, uint8_t watermark, int buf_len);
+
+/**
+ * @brief Stop streaming and put the FIFO back in bypass mode
+ *
+ * @param sensor object handle of LIS2DH12
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_lis2dh12_fifo_stop(lis2dh12_handle_t sensor);
+
+/**
+ * @brief Take the oldest samples from the ring buffer
+ *
+ * @param sensor object handle of LIS2DH12
+ * @param samples buffer for the samples
+ * @param max_num size of the buffer in samples
+ * @param ticks time to wait when the ring buffer is empty
+ *
+ * @return
+ *     - number of samples copied, 0 on timeout or when not streaming
+ */
+int iot_lis2dh12_fifo_read(lis2dh12_handle_t sensor, lis2dh12_fifo_sample_t *samples, int max_num, TickType_t ticks);
+
+/**
+ * @brief Number of samples waiting in the ring buffer
+ *
+ * @param sensor object handle of LIS2DH12
+ *
+ * @return
+ *     - number of samples
+ */
+int iot_lis2dh12_fifo_get_num(lis2dh12_handle_t sensor);
+
+/**
+ * @brief Number of samples overwritten in the full ring buffer since streaming started
+ *
+ * @param sensor object handle of LIS2DH12
+ *
+ * @return
+ *     - number of samples
+ */
+uint32_t iot_lis2dh12_fifo_get_dropped(lis2dh12_handle_t sensor);
+
+/**
+ * @brief Number of sensor FIFO overruns since streaming started
+ *
+ * The sensor does not tell how many samples an overrun lost, so these are
+ * events, at least one sample each.
+ *
+ * @param sensor object handle of LIS2DH12
+ *
+ * @return
+ *     - number of overruns
+ */
+uint32_t iot_lis2dh12_fifo_get_overruns(lis2dh12_handle_t sensor);
+
 /**
  * @brief Create and init sensor object and return a sensor handle
  *
@@ -861,6 +994,43 @@ public:
      * @return acceleration on z-axis
      */
     uint16_t az();
+
+    /**
+     * @brief get acceleration on all three axes in one read
+     * @param acc acceleration
+     * @return
+     *     - ESP_OK Success
+     *     - ESP_FAIL Fail
+     */
+    esp_err_t acc(lis2dh12_acc_value_t *acc);
+
+    /**
+     * @brief start streaming through the FIFO, see iot_lis2dh12_fifo_start
+     * @param int1_pin GPIO connected to INT1
+     * @param watermark FIFO level that raises INT1
+     * @param buf_len samples kept in the ring buffer, 0 for default
+     * @return
+     *     - ESP_OK Success
+     *     - others Fail
+     */
+    esp_err_t fifo_start(int int1_pin, uint8_t watermark = LIS2DH12_FIFO_SIZE / 2, int buf_len = 0);
+
+    /**
+     * @brief stop streaming
+     * @return
+     *     - ESP_OK Success
+     *     - ESP_FAIL Fail
+     */
+    esp_err_t fifo_stop();
+
+    /**
+     * @brief take the oldest streamed samples
+     * @param samples buffer for the samples
+     * @param max_num size of the buffer in samples
+     * @param ticks time to wait when no sample is buffered
+     * @return number of samples copied
+     */
+    int fifo_read(lis2dh12_fifo_sample_t *samples, int max_num, TickType_t ticks = portMAX_DELAY);
 };
 #endif
 #endif
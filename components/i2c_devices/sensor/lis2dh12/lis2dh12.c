@@ -12,7 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include <stdio.h>
+#include <string.h>
 #include "driver/i2c.h"
+#include "driver/gpio.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
 #include "iot_lis2dh12.h"
 #include "esp_log.h"
 
@@ -26,9 +32,29 @@ static const char* TAG = "lis2dh12";
 #define POINT_ASSERT(tag, param)    IOT_CHECK(tag, (param) != NULL, ESP_FAIL)
 #define RES_ASSERT(tag, res, ret)   IOT_CHECK(tag, (res) != pdFALSE, ret)
 
+#define LIS2DH12_FIFO_TASK_PRIO     (configMAX_PRIORITIES - 5)
+#define LIS2DH12_FIFO_TASK_STACK    (2048)
+#define LIS2DH12_SAMPLE_SIZE        (6)     /* OUT_X_L ~ OUT_Z_H */
+
 typedef struct {
     i2c_bus_handle_t bus;
     uint16_t dev_addr;
+    int int_pin;                        /* -1 unless streaming */
+    xSemaphoreHandle int_sem;
+    xSemaphoreHandle data_sem;          /* given when samples are pushed */
+    xSemaphoreHandle buf_mux;
+    xTaskHandle fifo_task;
+    xSemaphoreHandle exit_sem;          /* given by the FIFO task right before it is deleted */
+    volatile bool fifo_run;
+    lis2dh12_fifo_sample_t *buf;        /* ring buffer */
+    int buf_len;
+    int buf_head;                       /* oldest sample */
+    int buf_cnt;
+    uint32_t dropped;                   /* samples overwritten in a full ring buffer */
+    uint32_t overruns;                  /* sensor FIFO overruns, their sample count is unknown */
+    uint32_t period_us;                 /* sample period of the current data rate */
+    int64_t last_ts;                    /* timestamp of the newest sample pushed */
+    TickType_t fill_ticks;              /* time to reach the watermark */
 } lis2dh12_dev_t;
 
 esp_err_t iot_lis2dh12_write_byte(lis2dh12_handle_t sensor, uint8_t reg_addr, uint8_t data)
@@ -40,6 +66,7 @@ esp_err_t iot_lis2dh12_write_byte(lis2dh12_handle_t sensor, uint8_t reg_addr, ui
     i2c_master_write_byte(cmd, (sens->dev_addr << 1) | WRITE_BIT, ACK_CHECK_EN);
     i2c_master_write_byte(cmd, reg_addr, ACK_CHECK_EN);
     i2c_master_write_byte(cmd, data, ACK_CHECK_EN);
+    i2c_master_stop(cmd);
     ret = iot_i2c_bus_cmd_begin(sens->bus, cmd, 1000 / portTICK_RATE_MS);
     i2c_cmd_link_delete(cmd);
     return ret;
@@ -80,17 +107,26 @@ esp_err_t iot_lis2dh12_read_byte(lis2dh12_handle_t sensor, uint8_t reg, uint8_t
 
 esp_err_t iot_lis2dh12_read(lis2dh12_handle_t sensor, uint8_t reg_start_addr, uint8_t reg_num, uint8_t *data_buf)
 {
-    uint32_t i = 0;
-    uint8_t data_t = 0;
-    if (data_buf != NULL) {
-        for (i = 0; i < reg_num; i++) {
-            ERR_ASSERT(TAG, iot_lis2dh12_read_byte(sensor, reg_start_addr + i, &data_t));
-            data_buf[i] = data_t;
-        }
-        return ESP_OK;
-    } else {
+    //start-device_addr-word_addr(auto increment)-start-device_addr-data...-stop; no_ack of end data
+    lis2dh12_dev_t* sens = (lis2dh12_dev_t*) sensor;
+    esp_err_t ret;
+    if (data_buf == NULL || reg_num == 0) {
         return ESP_FAIL;
     }
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (sens->dev_addr << 1) | WRITE_BIT, ACK_CHECK_EN);
+    i2c_master_write_byte(cmd, reg_start_addr | LIS2DH12_AUTO_INCREMENT, ACK_CHECK_EN);
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (sens->dev_addr << 1) | READ_BIT, ACK_CHECK_EN);
+    if (reg_num > 1) {
+        i2c_master_read(cmd, data_buf, reg_num - 1, ACK_VAL);
+    }
+    i2c_master_read_byte(cmd, &data_buf[reg_num - 1], NACK_VAL);
+    i2c_master_stop(cmd);
+    ret = iot_i2c_bus_cmd_begin(sens->bus, cmd, 1000 / portTICK_RATE_MS);
+    i2c_cmd_link_delete(cmd);
+    return ret;
 }
 
 esp_err_t iot_lis2dh12_get_deviceid(lis2dh12_handle_t sensor, uint8_t* deviceid)
@@ -250,17 +286,324 @@ esp_err_t iot_lis2dh12_get_z_acc(lis2dh12_handle_t sensor, uint16_t *z_acc)
     return ESP_OK;
 }
 
+esp_err_t iot_lis2dh12_get_acc(lis2dh12_handle_t sensor, lis2dh12_acc_value_t *acc)
+{
+    uint8_t buffer[LIS2DH12_SAMPLE_SIZE];
+    ERR_ASSERT(TAG, iot_lis2dh12_read(sensor, LIS2DH12_OUT_X_L_REG, LIS2DH12_SAMPLE_SIZE, buffer));
+    acc->x = (int16_t)((((uint16_t)buffer[1])<<8) | (uint16_t)buffer[0]);
+    acc->y = (int16_t)((((uint16_t)buffer[3])<<8) | (uint16_t)buffer[2]);
+    acc->z = (int16_t)((((uint16_t)buffer[5])<<8) | (uint16_t)buffer[4]);
+    return ESP_OK;
+}
+
+static uint32_t lis2dh12_odr_hz(uint8_t ctrl_reg1)
+{
+    static const uint16_t odr_hz[] = { 0, 1, 10, 25, 50, 100, 200, 400, 1620, 1344 };
+    uint8_t odr = (ctrl_reg1 & LIS2DH12_ODR_MASK) >> LIS2DH12_ODR_BIT;
+    if (odr == LIS2DH12_ODR_1344HZ && (ctrl_reg1 & LIS2DH12_LP_EN_MASK)) {
+        return 5376;
+    }
+    return odr < sizeof(odr_hz) / sizeof(odr_hz[0]) ? odr_hz[odr] : 0;
+}
+
+static void IRAM_ATTR lis2dh12_isr_handler(void *arg)
+{
+    lis2dh12_dev_t* sens = (lis2dh12_dev_t*) arg;
+    portBASE_TYPE task_woken = pdFALSE;
+    xSemaphoreGiveFromISR(sens->int_sem, &task_woken);
+    if (task_woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void lis2dh12_fifo_push(lis2dh12_dev_t* sens, const uint8_t *data, int num, int64_t now)
+{
+    xSemaphoreTake(sens->buf_mux, portMAX_DELAY);
+    for (int i = 0; i < num; i++, data += LIS2DH12_SAMPLE_SIZE) {
+        int pos = (sens->buf_head + sens->buf_cnt) % sens->buf_len;
+        if (sens->buf_cnt == sens->buf_len) {
+            // full, overwrite the oldest one
+            sens->buf_head = (sens->buf_head + 1) % sens->buf_len;
+            sens->dropped++;
+        } else {
+            sens->buf_cnt++;
+        }
+        lis2dh12_fifo_sample_t *sample = &sens->buf[pos];
+        sample->x = (int16_t)((((uint16_t)data[1])<<8) | (uint16_t)data[0]);
+        sample->y = (int16_t)((((uint16_t)data[3])<<8) | (uint16_t)data[2]);
+        sample->z = (int16_t)((((uint16_t)data[5])<<8) | (uint16_t)data[4]);
+        // the newest sample was taken around now, the others one period apart before it,
+        // but never before the last drain, its read time jitters with the task latency
+        int64_t ts = now - (int64_t)(num - 1 - i) * sens->period_us;
+        sample->timestamp = ts > sens->last_ts ? ts : sens->last_ts;
+        sens->last_ts = sample->timestamp;
+    }
+    xSemaphoreGive(sens->buf_mux);
+    xSemaphoreGive(sens->data_sem);
+}
+
+static void lis2dh12_fifo_task(void *arg)
+{
+    lis2dh12_dev_t* sens = (lis2dh12_dev_t*) arg;
+    uint8_t data[LIS2DH12_FIFO_SIZE * LIS2DH12_SAMPLE_SIZE];
+    uint8_t src;
+    while (sens->fifo_run) {
+        // INT1 follows the watermark level, a missed edge would stall the stream,
+        // so drain anyway when it has been quiet for twice the fill time
+        xSemaphoreTake(sens->int_sem, sens->fill_ticks * 2);
+        if (!sens->fifo_run) {
+            break;
+        }
+        // keep draining until the level is under the watermark, INT1 then goes low for the next edge
+        do {
+            if (iot_lis2dh12_read(sens, LIS2DH12_FIFO_SRC_CTRL_REG, 1, &src) != ESP_OK) {
+                break;
+            }
+            int64_t now = esp_timer_get_time();
+            int num = src & LIS2DH12_FSS_MASK;
+            if (src & LIS2DH12_OVRN_FIFO_MASK) {
+                // full and already overwritten, FSS stops at 31
+                num = LIS2DH12_FIFO_SIZE;
+                sens->overruns++;
+            }
+            if (num == 0) {
+                break;
+            }
+            // the output registers roll over from OUT_Z_H to OUT_X_L in FIFO mode,
+            // so every stored sample comes out in one auto-increment burst
+            if (iot_lis2dh12_read(sens, LIS2DH12_OUT_X_L_REG, num * LIS2DH12_SAMPLE_SIZE, data) != ESP_OK) {
+                break;
+            }
+            lis2dh12_fifo_push(sens, data, num, now);
+        } while (src & LIS2DH12_WTM_MASK);
+    }
+    sens->fifo_task = NULL;
+    xSemaphoreGive(sens->exit_sem);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t lis2dh12_update_reg(lis2dh12_handle_t sensor, uint8_t reg, uint8_t mask, uint8_t val)
+{
+    uint8_t tmp;
+    ERR_ASSERT(TAG, iot_lis2dh12_read_byte(sensor, reg, &tmp));
+    tmp = (tmp & ~mask) | (val & mask);
+    ERR_ASSERT(TAG, iot_lis2dh12_write_byte(sensor, reg, tmp));
+    return ESP_OK;
+}
+
+static void lis2dh12_fifo_free(lis2dh12_dev_t* sens)
+{
+    if (sens->int_sem) {
+        vSemaphoreDelete(sens->int_sem);
+        sens->int_sem = NULL;
+    }
+    if (sens->data_sem) {
+        vSemaphoreDelete(sens->data_sem);
+        sens->data_sem = NULL;
+    }
+    if (sens->buf_mux) {
+        vSemaphoreDelete(sens->buf_mux);
+        sens->buf_mux = NULL;
+    }
+    if (sens->exit_sem) {
+        vSemaphoreDelete(sens->exit_sem);
+        sens->exit_sem = NULL;
+    }
+    free(sens->buf);
+    sens->buf = NULL;
+    sens->buf_cnt = 0;
+}
+
+esp_err_t iot_lis2dh12_fifo_start(lis2dh12_handle_t sensor, int int1_pin, uint8_t watermark, int buf_len)
+{
+    lis2dh12_dev_t* sens = (lis2dh12_dev_t*) sensor;
+    uint8_t ctrl_reg1;
+    uint8_t saved_reg3 = 0, saved_fifo_ctrl = 0, saved_reg5 = 0;
+    esp_err_t ret;
+    bool regs_saved = false;
+    bool gpio_armed = false;
+    if (sens->int_pin >= 0) {
+        return ESP_OK;
+    }
+    IOT_CHECK(TAG, watermark > 0 && watermark < LIS2DH12_FIFO_SIZE, ESP_ERR_INVALID_ARG);
+
+    ERR_ASSERT(TAG, iot_lis2dh12_read_byte(sensor, LIS2DH12_CTRL_REG1, &ctrl_reg1));
+    uint32_t hz = lis2dh12_odr_hz(ctrl_reg1);
+    IOT_CHECK(TAG, hz > 0, ESP_FAIL);
+    sens->period_us = 1000000 / hz;
+    sens->fill_ticks = (uint64_t) sens->period_us * watermark / 1000 / portTICK_RATE_MS + 1;
+
+    sens->buf_len = buf_len > 0 ? buf_len : LIS2DH12_FIFO_BUF_LEN_DEFAULT;
+    sens->buf = (lis2dh12_fifo_sample_t *) calloc(sens->buf_len, sizeof(lis2dh12_fifo_sample_t));
+    sens->int_sem = xSemaphoreCreateBinary();
+    sens->data_sem = xSemaphoreCreateBinary();
+    sens->buf_mux = xSemaphoreCreateMutex();
+    sens->exit_sem = xSemaphoreCreateBinary();
+    if (sens->buf == NULL || sens->int_sem == NULL || sens->data_sem == NULL || sens->buf_mux == NULL
+            || sens->exit_sem == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+    sens->buf_head = 0;
+    sens->buf_cnt = 0;
+    sens->dropped = 0;
+    sens->overruns = 0;
+    sens->last_ts = 0;
+
+    // kept to put the sensor back as it was if the start fails half way
+    ret = ESP_FAIL;
+    if (iot_lis2dh12_read_byte(sensor, LIS2DH12_CTRL_REG3, &saved_reg3) != ESP_OK
+            || iot_lis2dh12_read_byte(sensor, LIS2DH12_FIFO_CTRL_REG, &saved_fifo_ctrl) != ESP_OK
+            || iot_lis2dh12_read_byte(sensor, LIS2DH12_CTRL_REG5, &saved_reg5) != ESP_OK) {
+        goto fail;
+    }
+    regs_saved = true;
+
+    // bypass first to empty the FIFO, then stream with the watermark on INT1
+    if (lis2dh12_update_reg(sensor, LIS2DH12_CTRL_REG5, LIS2DH12_FIFO_EN_MASK, LIS2DH12_FIFO_EN_MASK) != ESP_OK
+            || iot_lis2dh12_write_byte(sensor, LIS2DH12_FIFO_CTRL_REG, LIS2DH12_FM_BYPASS << LIS2DH12_FM_BIT) != ESP_OK
+            || iot_lis2dh12_write_byte(sensor, LIS2DH12_FIFO_CTRL_REG,
+                    (LIS2DH12_FM_STREAM << LIS2DH12_FM_BIT) | (watermark << LIS2DH12_FTH_BIT)) != ESP_OK
+            || lis2dh12_update_reg(sensor, LIS2DH12_CTRL_REG3, LIS2DH12_I1_WTM_MASK, LIS2DH12_I1_WTM_MASK) != ESP_OK) {
+        goto fail;
+    }
+
+    // INT1 is push-pull and active high by default
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << int1_pin,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_POSEDGE,
+    };
+    gpio_config(&io_conf);
+    gpio_armed = true;
+    // The service may already be installed by another driver
+    ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        goto fail;
+    }
+    sens->fifo_run = true;
+    if (xTaskCreate(lis2dh12_fifo_task, "lis2dh12_fifo", LIS2DH12_FIFO_TASK_STACK, sens,
+            LIS2DH12_FIFO_TASK_PRIO, &sens->fifo_task) != pdPASS) {
+        sens->fifo_run = false;
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+    ret = gpio_isr_handler_add(int1_pin, lis2dh12_isr_handler, sens);
+    if (ret != ESP_OK) {
+        goto fail;
+    }
+    sens->int_pin = int1_pin;
+    // Catch a watermark reached before the handler was added
+    xSemaphoreGive(sens->int_sem);
+    return ESP_OK;
+
+fail:
+    ESP_LOGE(TAG, "fifo stream start fail");
+    if (gpio_armed) {
+        // nobody would serve the rising edge gpio_config armed
+        gpio_set_intr_type(int1_pin, GPIO_INTR_DISABLE);
+    }
+    if (sens->fifo_task) {
+        sens->fifo_run = false;
+        xSemaphoreGive(sens->int_sem);
+        xSemaphoreTake(sens->exit_sem, portMAX_DELAY);
+    }
+    if (regs_saved) {
+        // INT1 off first, then the FIFO mode, as iot_lis2dh12_fifo_stop does
+        iot_lis2dh12_write_byte(sensor, LIS2DH12_CTRL_REG3, saved_reg3);
+        iot_lis2dh12_write_byte(sensor, LIS2DH12_FIFO_CTRL_REG, saved_fifo_ctrl);
+        iot_lis2dh12_write_byte(sensor, LIS2DH12_CTRL_REG5, saved_reg5);
+    }
+    lis2dh12_fifo_free(sens);
+    return ret;
+}
+
+esp_err_t iot_lis2dh12_fifo_stop(lis2dh12_handle_t sensor)
+{
+    lis2dh12_dev_t* sens = (lis2dh12_dev_t*) sensor;
+    if (sens->int_pin >= 0) {
+        gpio_isr_handler_remove(sens->int_pin);
+        gpio_set_intr_type(sens->int_pin, GPIO_INTR_DISABLE);
+        sens->int_pin = -1;
+    }
+    if (sens->fifo_task) {
+        // Let the task finish its bus access and exit on its own
+        sens->fifo_run = false;
+        xSemaphoreGive(sens->int_sem);
+        xSemaphoreTake(sens->exit_sem, portMAX_DELAY);
+    }
+    lis2dh12_fifo_free(sens);
+    ERR_ASSERT(TAG, lis2dh12_update_reg(sensor, LIS2DH12_CTRL_REG3, LIS2DH12_I1_WTM_MASK, 0));
+    ERR_ASSERT(TAG, iot_lis2dh12_write_byte(sensor, LIS2DH12_FIFO_CTRL_REG, LIS2DH12_FM_BYPASS << LIS2DH12_FM_BIT));
+    ERR_ASSERT(TAG, lis2dh12_update_reg(sensor, LIS2DH12_CTRL_REG5, LIS2DH12_FIFO_EN_MASK, 0));
+    return ESP_OK;
+}
+
+int iot_lis2dh12_fifo_read(lis2dh12_handle_t sensor, lis2dh12_fifo_sample_t *samples, int max_num, TickType_t ticks)
+{
+    lis2dh12_dev_t* sens = (lis2dh12_dev_t*) sensor;
+    int num = 0;
+    if (sens->buf == NULL || samples == NULL) {
+        return 0;
+    }
+    // data_sem may still be given for samples an earlier call took, wait on until the time is up
+    TickType_t start = xTaskGetTickCount();
+    while (iot_lis2dh12_fifo_get_num(sensor) == 0) {
+        TickType_t waited = xTaskGetTickCount() - start;
+        if (waited >= ticks || xSemaphoreTake(sens->data_sem, ticks - waited) != pdTRUE) {
+            break;
+        }
+    }
+    xSemaphoreTake(sens->buf_mux, portMAX_DELAY);
+    while (num < max_num && sens->buf_cnt > 0) {
+        // copy up to the end of the ring, then wrap
+        int len = sens->buf_len - sens->buf_head;
+        len = len < sens->buf_cnt ? len : sens->buf_cnt;
+        len = len < max_num - num ? len : max_num - num;
+        memcpy(&samples[num], &sens->buf[sens->buf_head], len * sizeof(lis2dh12_fifo_sample_t));
+        sens->buf_head = (sens->buf_head + len) % sens->buf_len;
+        sens->buf_cnt -= len;
+        num += len;
+    }
+    xSemaphoreGive(sens->buf_mux);
+    return num;
+}
+
+int iot_lis2dh12_fifo_get_num(lis2dh12_handle_t sensor)
+{
+    lis2dh12_dev_t* sens = (lis2dh12_dev_t*) sensor;
+    return sens->buf ? sens->buf_cnt : 0;
+}
+
+uint32_t iot_lis2dh12_fifo_get_dropped(lis2dh12_handle_t sensor)
+{
+    lis2dh12_dev_t* sens = (lis2dh12_dev_t*) sensor;
+    return sens->dropped;
+}
+
+uint32_t iot_lis2dh12_fifo_get_overruns(lis2dh12_handle_t sensor)
+{
+    lis2dh12_dev_t* sens = (lis2dh12_dev_t*) sensor;
+    return sens->overruns;
+}
+
 lis2dh12_handle_t iot_lis2dh12_create(lis2dh12_handle_t bus, uint16_t dev_addr)
 {
     lis2dh12_dev_t* sensor = (lis2dh12_dev_t*) calloc(1, sizeof(lis2dh12_dev_t));
     sensor->bus = bus;
     sensor->dev_addr = dev_addr;
+    sensor->int_pin = -1;
     return (lis2dh12_handle_t) sensor;
 }
 
 esp_err_t iot_lis2dh12_delete(lis2dh12_handle_t sensor, bool del_bus)
 {
     lis2dh12_dev_t* sens = (lis2dh12_dev_t*) sensor;
+    if (sens->buf) {
+        iot_lis2dh12_fifo_stop(sensor);
+    }
     if(del_bus) {
         iot_i2c_bus_delete(sens->bus);
         sens->bus = NULL;
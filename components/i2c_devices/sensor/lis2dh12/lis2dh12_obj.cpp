@@ -69,6 +69,26 @@ uint16_t CLis2dh12::az()
     return acc_val;
 }
 
+esp_err_t CLis2dh12::acc(lis2dh12_acc_value_t *acc)
+{
+    return iot_lis2dh12_get_acc(m_sensor_handle, acc);
+}
+
+esp_err_t CLis2dh12::fifo_start(int int1_pin, uint8_t watermark, int buf_len)
+{
+    return iot_lis2dh12_fifo_start(m_sensor_handle, int1_pin, watermark, buf_len);
+}
+
+esp_err_t CLis2dh12::fifo_stop()
+{
+    return iot_lis2dh12_fifo_stop(m_sensor_handle);
+}
+
+int CLis2dh12::fifo_read(lis2dh12_fifo_sample_t *samples, int max_num, TickType_t ticks)
+{
+    return iot_lis2dh12_fifo_read(m_sensor_handle, samples, max_num, ticks);
+}
+
 
 
 
@@ -22,6 +22,9 @@
 #define I2C_MASTER_TX_BUF_DISABLE   0  /*!< I2C master do not need buffer */
 #define I2C_MASTER_RX_BUF_DISABLE   0  /*!< I2C master do not need buffer */
 #define I2C_MASTER_FREQ_HZ    100000   /*!< I2C master clock frequency */
+#define LIS2DH12_INT1_IO      5        /*!< gpio number for INT1 of sensor */
+#define FIFO_TEST_WATERMARK   24       /*!< samples per burst read */
+#define FIFO_TEST_TIME_MS     2000
 
 static i2c_bus_handle_t i2c_bus = NULL;
 static lis2dh12_handle_t sens = NULL;
@@ -96,3 +99,51 @@ TEST_CASE("Sensor lis2dh12 test", "[lis2dh12][iot][sensor]")
 {
     lis2dh12_test();
 }
+
+TEST_CASE("Sensor lis2dh12 fifo stream test", "[lis2dh12][iot][sensor]")
+{
+    static lis2dh12_fifo_sample_t samples[LIS2DH12_FIFO_SIZE];
+    if (sens == NULL) {
+        i2c_master_init();
+    }
+    lis2dh12_config_t  lis2dh12_config;
+    TEST_ASSERT_EQUAL(ESP_OK, iot_lis2dh12_get_config(sens, &lis2dh12_config));
+    lis2dh12_config.temp_enable = LIS2DH12_TEMP_DISABLE;
+    lis2dh12_config.odr = LIS2DH12_ODR_400HZ;
+    lis2dh12_config.opt_mode = LIS2DH12_OPT_HIGH_RES;
+    lis2dh12_config.z_enable = LIS2DH12_ENABLE;
+    lis2dh12_config.y_enable = LIS2DH12_ENABLE;
+    lis2dh12_config.x_enable = LIS2DH12_ENABLE;
+    lis2dh12_config.bdu_status = LIS2DH12_ENABLE;
+    lis2dh12_config.fs = LIS2DH12_FS_4G;
+    TEST_ASSERT_EQUAL(ESP_OK, iot_lis2dh12_set_config(sens, &lis2dh12_config));
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, iot_lis2dh12_fifo_start(sens, LIS2DH12_INT1_IO, LIS2DH12_FIFO_SIZE, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_lis2dh12_fifo_start(sens, LIS2DH12_INT1_IO, FIFO_TEST_WATERMARK, 0));
+
+    int total = 0;
+    int64_t last = 0;
+    TickType_t start = xTaskGetTickCount();
+    while (xTaskGetTickCount() - start < FIFO_TEST_TIME_MS / portTICK_RATE_MS) {
+        int num = iot_lis2dh12_fifo_read(sens, samples, LIS2DH12_FIFO_SIZE, 100 / portTICK_RATE_MS);
+        for (int i = 0; i < num; i++) {
+            // estimated from the read time, equal stamps are fine, going back is not
+            TEST_ASSERT(samples[i].timestamp >= last);
+            last = samples[i].timestamp;
+        }
+        if (num > 0) {
+            printf("%2d samples, x: %6d y: %6d z: %6d\n", num, samples[num - 1].x >> 4, samples[num - 1].y >> 4,
+                    samples[num - 1].z >> 4);
+        }
+        total += num;
+    }
+    uint32_t dropped = iot_lis2dh12_fifo_get_dropped(sens);
+    uint32_t overruns = iot_lis2dh12_fifo_get_overruns(sens);
+    TEST_ASSERT_EQUAL(ESP_OK, iot_lis2dh12_fifo_stop(sens));
+
+    // 400 Hz, minus what is still waiting in the sensor FIFO
+    printf("%d samples in %d ms, %d dropped, %d overruns\n", total, FIFO_TEST_TIME_MS, dropped, overruns);
+    TEST_ASSERT_EQUAL(0, dropped);
+    TEST_ASSERT_EQUAL(0, overruns);
+    TEST_ASSERT_INT_WITHIN(LIS2DH12_FIFO_SIZE * 2, 400 * FIFO_TEST_TIME_MS / 1000, total);
+}
@@ -22,6 +22,8 @@ extern "C" {
 #include "iot_i2c_bus.h"
 
 #define MPU6050_I2C_ADDRESS         0x68    /*!< slave address for MPU6050 sensor */
+#define MPU6050_FIFO_SIZE           1024    /*!< bytes of the FIFO */
+#define MPU6050_FIFO_FRAME_LEN      12      /*!< bytes of one accelerometer and gyroscope frame in the FIFO */
 
 /* MPU6050 register */
 #define MPU6050_SELF_TEST_X         0x0D
@@ -122,6 +124,16 @@ typedef enum {
     GYRO_FS_2000DPS = 3,     /*!< Gyroscope full scale range is +/- 2000 degree per sencond */
 } mpu6050_gyro_fs_t;
 
+typedef enum {
+    DLPF_260HZ = 0,     /*!< Accelerometer 260 Hz, gyroscope 256 Hz, 8 kHz gyroscope output rate */
+    DLPF_184HZ = 1,     /*!< Accelerometer 184 Hz, gyroscope 188 Hz, 1 kHz output rate */
+    DLPF_94HZ  = 2,     /*!< Accelerometer 94 Hz, gyroscope 98 Hz, 1 kHz output rate */
+    DLPF_44HZ  = 3,     /*!< Accelerometer 44 Hz, gyroscope 42 Hz, 1 kHz output rate */
+    DLPF_21HZ  = 4,     /*!< Accelerometer 21 Hz, gyroscope 20 Hz, 1 kHz output rate */
+    DLPF_10HZ  = 5,     /*!< Accelerometer 10 Hz, gyroscope 10 Hz, 1 kHz output rate */
+    DLPF_5HZ   = 6,     /*!< Accelerometer 5 Hz, gyroscope 5 Hz, 1 kHz output rate */
+} mpu6050_dlpf_t;
+
 typedef struct {
     int16_t raw_acce_x;
     int16_t raw_acce_y;
@@ -134,6 +146,14 @@ typedef struct {
     int16_t raw_gyro_z;
 } mpu6050_raw_gyro_value_t;
 
+/**
+ * @brief One FIFO frame, the layout matches the FIFO, accelerometer first
+ */
+typedef struct {
+    mpu6050_raw_acce_value_t acce;
+    mpu6050_raw_gyro_value_t gyro;
+} mpu6050_raw_frame_t;
+
 typedef struct {
     float acce_x;
     float acce_y;
@@ -345,6 +365,73 @@ esp_err_t iot_mpu6050_get_gyro(mpu6050_handle_t sensor, mpu6050_gyro_value_t *gy
 esp_err_t iot_mpu6050_complimentory_filter(mpu6050_handle_t sensor, mpu6050_acce_value_t *acce_value, 
                         mpu6050_gyro_value_t *gyro_value, complimentary_angle_t *complimentary_angle);
 
+/**
+ * @brief Set the digital low pass filter, it also sets the gyroscope output rate
+ *
+ * @param sensor object handle of mpu6050
+ * @param dlpf filter bandwidth
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_mpu6050_set_dlpf(mpu6050_handle_t sensor, mpu6050_dlpf_t dlpf);
+
+/**
+ * @brief Set the sample rate divider, sample rate = gyroscope output rate / (1 + div)
+ *
+ * @param sensor object handle of mpu6050
+ * @param div sample rate divider
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_mpu6050_set_sample_rate_div(mpu6050_handle_t sensor, uint8_t div);
+
+/**
+ * @brief Reset the FIFO and start buffering accelerometer and gyroscope frames at the sample rate
+ *
+ * @param sensor object handle of mpu6050
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_mpu6050_fifo_enable(mpu6050_handle_t sensor);
+
+/**
+ * @brief Stop buffering frames in the FIFO
+ *
+ * @param sensor object handle of mpu6050
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_mpu6050_fifo_disable(mpu6050_handle_t sensor);
+
+/**
+ * @brief Read the buffered frames, oldest first, in one burst
+ *
+ * Call it often enough that the FIFO holds less than MPU6050_FIFO_SIZE bytes,
+ * 85 frames, 85 ms at 1 kHz. Overflows are taken from INT_STATUS, reading it
+ * clears the other interrupt flags as well, so the byte is handed back in int_status.
+ *
+ * @param sensor object handle of mpu6050
+ * @param frames frames read
+ * @param max_num size of frames
+ * @param num number of frames read
+ * @param int_status INT_STATUS read by this call, NULL if it is not needed
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_STATE the FIFO overflowed, it has been reset and the frames in it are lost
+ *     - ESP_FAIL Fail
+ */
+esp_err_t iot_mpu6050_fifo_read(mpu6050_handle_t sensor, mpu6050_raw_frame_t *frames, int max_num, int *num,
+        uint8_t *int_status);
+
 
 
 #ifdef __cplusplus
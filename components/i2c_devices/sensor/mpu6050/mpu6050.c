@@ -30,6 +30,11 @@
 #define ALPHA 0.99             /*!< Weight for gyroscope */
 #define RAD_TO_DEG 57.27272727 /*!< Radians to degrees */
 
+#define MPU6050_FIFO_EN_ACCEL_GYRO  0x78    /*!< XG, YG, ZG and ACCEL go to the FIFO, temperature does not */
+#define MPU6050_USER_CTRL_FIFO_EN   BIT6
+#define MPU6050_USER_CTRL_FIFO_RST  BIT2
+#define MPU6050_INT_STATUS_FIFO_OFLOW   BIT4
+
 typedef struct {
     i2c_bus_handle_t bus;
     uint16_t dev_addr;
@@ -47,6 +52,7 @@ esp_err_t iot_mpu6050_write_byte(mpu6050_handle_t sensor, uint8_t reg_addr, uint
     i2c_master_write_byte(cmd, (sens->dev_addr << 1) | WRITE_BIT, ACK_CHECK_EN);
     i2c_master_write_byte(cmd, reg_addr, ACK_CHECK_EN);
     i2c_master_write_byte(cmd, data, ACK_CHECK_EN);
+    i2c_master_stop(cmd);
     ret = iot_i2c_bus_cmd_begin(sens->bus, cmd, 1000 / portTICK_RATE_MS);
     i2c_cmd_link_delete(cmd);
     if (ret == ESP_FAIL) {
@@ -92,18 +98,32 @@ esp_err_t iot_mpu6050_read_byte(mpu6050_handle_t sensor, uint8_t reg, uint8_t *d
     return ret;
 }
 
+/* One transaction with a repeated start, the register address auto increments, except for FIFO_R_W */
+static esp_err_t mpu6050_read_burst(mpu6050_dev_t* sens, uint8_t reg, uint8_t *data_buf, size_t len)
+{
+    esp_err_t ret;
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (sens->dev_addr << 1) | WRITE_BIT, ACK_CHECK_EN);
+    i2c_master_write_byte(cmd, reg, ACK_CHECK_EN);
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (sens->dev_addr << 1) | READ_BIT, ACK_CHECK_EN);
+    if (len > 1) {
+        i2c_master_read(cmd, data_buf, len - 1, ACK_VAL);
+    }
+    i2c_master_read_byte(cmd, data_buf + len - 1, NACK_VAL);
+    i2c_master_stop(cmd);
+    ret = iot_i2c_bus_cmd_begin(sens->bus, cmd, 1000 / portTICK_RATE_MS);
+    i2c_cmd_link_delete(cmd);
+    return ret;
+}
+
 esp_err_t iot_mpu6050_read(mpu6050_handle_t sensor, uint8_t reg_start_addr, uint8_t reg_num, uint8_t *data_buf)
 {
-    uint32_t i = 0;
-    uint8_t data_t = 0;
-    if (data_buf != NULL) {
-        for(i=0; i<reg_num; i++){
-            iot_mpu6050_read_byte(sensor, reg_start_addr+i, &data_t);
-            data_buf[i] = data_t;
-        }
-        return ESP_OK;
-    } 
-    return ESP_FAIL;  
+    if (data_buf == NULL || reg_num == 0) {
+        return ESP_FAIL;
+    }
+    return mpu6050_read_burst((mpu6050_dev_t*) sensor, reg_start_addr, data_buf, reg_num);
 }
 
 mpu6050_handle_t iot_mpu6050_create(i2c_bus_handle_t bus, uint16_t dev_addr)
@@ -274,18 +294,7 @@ esp_err_t iot_mpu6050_get_gyro_sensitivity(mpu6050_handle_t sensor, float *gyro_
 esp_err_t iot_mpu6050_get_raw_acce(mpu6050_handle_t sensor, mpu6050_raw_acce_value_t *raw_acce_value)
 {
     uint8_t data_rd[6] = {0};
-    mpu6050_dev_t* sens = (mpu6050_dev_t*) sensor;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, ( MPU6050_I2C_ADDRESS << 1 ) | WRITE_BIT, ACK_CHECK_EN);
-    i2c_master_write_byte(cmd, MPU6050_ACCEL_XOUT_H, ACK_CHECK_EN);
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, ( MPU6050_I2C_ADDRESS << 1 ) | READ_BIT, ACK_CHECK_EN);
-    i2c_master_read(cmd, data_rd, 5, ACK_VAL);
-    i2c_master_read(cmd, data_rd + 5, 1, NACK_VAL);
-    i2c_master_stop(cmd);
-    int ret = iot_i2c_bus_cmd_begin(sens->bus, cmd, 1000 / portTICK_RATE_MS);
-    i2c_cmd_link_delete(cmd);
+    esp_err_t ret = iot_mpu6050_read(sensor, MPU6050_ACCEL_XOUT_H, sizeof(data_rd), data_rd);
 
     raw_acce_value->raw_acce_x = (int16_t)((data_rd[0] << 8) + (data_rd[1]));
     raw_acce_value->raw_acce_y = (int16_t)((data_rd[2] << 8) + (data_rd[3]));
@@ -296,18 +305,7 @@ esp_err_t iot_mpu6050_get_raw_acce(mpu6050_handle_t sensor, mpu6050_raw_acce_val
 esp_err_t iot_mpu6050_get_raw_gyro(mpu6050_handle_t sensor, mpu6050_raw_gyro_value_t *raw_gyro_value)
 {
     uint8_t data_rd[6] = {0};
-    mpu6050_dev_t* sens = (mpu6050_dev_t*) sensor;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, ( MPU6050_I2C_ADDRESS << 1 ) | WRITE_BIT, ACK_CHECK_EN);
-    i2c_master_write_byte(cmd, MPU6050_GYRO_XOUT_H, ACK_CHECK_EN);
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, ( MPU6050_I2C_ADDRESS << 1 ) | READ_BIT, ACK_CHECK_EN);
-    i2c_master_read(cmd, data_rd, 5, ACK_VAL);
-    i2c_master_read(cmd, data_rd + 5, 1, NACK_VAL);
-    i2c_master_stop(cmd);
-    int ret = iot_i2c_bus_cmd_begin(sens->bus, cmd, 1000 / portTICK_RATE_MS);
-    i2c_cmd_link_delete(cmd);
+    esp_err_t ret = iot_mpu6050_read(sensor, MPU6050_GYRO_XOUT_H, sizeof(data_rd), data_rd);
 
     raw_gyro_value->raw_gyro_x = (int16_t)((data_rd[0] << 8) + (data_rd[1]));
     raw_gyro_value->raw_gyro_y = (int16_t)((data_rd[2] << 8) + (data_rd[3]));
@@ -387,3 +385,102 @@ esp_err_t iot_mpu6050_complimentory_filter(mpu6050_handle_t sensor, mpu6050_acce
     return ESP_OK;
 }
 
+esp_err_t iot_mpu6050_set_dlpf(mpu6050_handle_t sensor, mpu6050_dlpf_t dlpf)
+{
+    esp_err_t ret;
+    uint8_t tmp;
+    ret = iot_mpu6050_read_byte(sensor, MPU6050_CONFIG, &tmp);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    tmp &= (~0x07);
+    tmp |= dlpf;
+    return iot_mpu6050_write_byte(sensor, MPU6050_CONFIG, tmp);
+}
+
+esp_err_t iot_mpu6050_set_sample_rate_div(mpu6050_handle_t sensor, uint8_t div)
+{
+    return iot_mpu6050_write_byte(sensor, MPU6050_SMPLRT_DIV, div);
+}
+
+esp_err_t iot_mpu6050_fifo_enable(mpu6050_handle_t sensor)
+{
+    esp_err_t ret;
+    uint8_t tmp;
+    ret = iot_mpu6050_write_byte(sensor, MPU6050_FIFO_EN, MPU6050_FIFO_EN_ACCEL_GYRO);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = iot_mpu6050_read_byte(sensor, MPU6050_USER_CTRL, &tmp);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    // FIFO_RESET only takes effect while the FIFO is disabled
+    tmp &= (~MPU6050_USER_CTRL_FIFO_EN);
+    ret = iot_mpu6050_write_byte(sensor, MPU6050_USER_CTRL, tmp | MPU6050_USER_CTRL_FIFO_RST);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return iot_mpu6050_write_byte(sensor, MPU6050_USER_CTRL, tmp | MPU6050_USER_CTRL_FIFO_EN);
+}
+
+esp_err_t iot_mpu6050_fifo_disable(mpu6050_handle_t sensor)
+{
+    esp_err_t ret;
+    uint8_t tmp;
+    ret = iot_mpu6050_read_byte(sensor, MPU6050_USER_CTRL, &tmp);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = iot_mpu6050_write_byte(sensor, MPU6050_USER_CTRL, tmp & (~MPU6050_USER_CTRL_FIFO_EN));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return iot_mpu6050_write_byte(sensor, MPU6050_FIFO_EN, 0);
+}
+
+esp_err_t iot_mpu6050_fifo_read(mpu6050_handle_t sensor, mpu6050_raw_frame_t *frames, int max_num, int *num,
+        uint8_t *int_status)
+{
+    mpu6050_dev_t* sens = (mpu6050_dev_t*) sensor;
+    esp_err_t ret;
+    uint8_t cnt_rd[2];
+    uint8_t status;
+    *num = 0;
+    ret = iot_mpu6050_read_byte(sensor, MPU6050_INT_STATUS, &status);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    // the read cleared every flag, the caller may still want the others
+    if (int_status) {
+        *int_status = status;
+    }
+    if (status & MPU6050_INT_STATUS_FIFO_OFLOW) {
+        // the oldest bytes were overwritten, frames no longer start at a frame boundary
+        iot_mpu6050_fifo_enable(sensor);
+        return ESP_ERR_INVALID_STATE;
+    }
+    ret = mpu6050_read_burst(sens, MPU6050_FIFO_COUNTH, cnt_rd, sizeof(cnt_rd));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    // a frame may be half written while the count is read, leave its bytes for the next call
+    int count = (cnt_rd[0] << 8) | cnt_rd[1];
+    int n = count / MPU6050_FIFO_FRAME_LEN;
+    n = n < max_num ? n : max_num;
+    if (n == 0) {
+        return ESP_OK;
+    }
+    // the frames are read as they are, big endian, and swapped in place
+    uint8_t *data_rd = (uint8_t *) frames;
+    int16_t *val = (int16_t *) frames;
+    ret = mpu6050_read_burst(sens, MPU6050_FIFO_R_W, data_rd, n * MPU6050_FIFO_FRAME_LEN);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    for (int i = 0; i < n * MPU6050_FIFO_FRAME_LEN / 2; i++) {
+        val[i] = (int16_t) ((data_rd[2 * i] << 8) | data_rd[2 * i + 1]);
+    }
+    *num = n;
+    return ESP_OK;
+}
@@ -16,6 +16,8 @@
 #include "driver/i2c.h"
 #include "iot_i2c_bus.h"
 #include "iot_mpu6050.h"
+#include "iot_imu_fusion.h"
+#include "esp_timer.h"
 #include "esp_system.h"
 
 #define I2C_MASTER_SCL_IO           26          /*!< gpio number for I2C master clock */
@@ -24,6 +26,8 @@
 #define I2C_MASTER_TX_BUF_DISABLE   0           /*!< I2C master do not need buffer */
 #define I2C_MASTER_RX_BUF_DISABLE   0           /*!< I2C master do not need buffer */
 #define I2C_MASTER_FREQ_HZ          100000      /*!< I2C master clock frequency */
+#define FIFO_TEST_RATE_HZ           1000        /*!< 1 kHz gyroscope output rate, divider 0 */
+#define FIFO_TEST_TIME_MS           2000
 
 static i2c_bus_handle_t i2c_bus = NULL;
 static mpu6050_handle_t mpu6050 = NULL;
@@ -80,3 +84,55 @@ TEST_CASE("Sensor mpu6050 test", "[mpu6050][iot][sensor]")
     mpu6050_test();
 }
 
+TEST_CASE("Sensor mpu6050 fifo fusion test", "[mpu6050][iot][sensor]")
+{
+    static mpu6050_raw_frame_t frames[MPU6050_FIFO_SIZE / MPU6050_FIFO_FRAME_LEN];
+    imu_fusion_config_t cfg = {
+        .mode = IMU_FUSION_MAHONY,
+        .kp = IMU_FUSION_Q16(1.0),
+        .ki = IMU_FUSION_Q16(0.05),
+        .beta = IMU_FUSION_Q16(0.05),
+        .sample_rate_hz = FIFO_TEST_RATE_HZ,
+    };
+    imu_fusion_t fusion;
+    imu_fusion_euler_t euler;
+    const int32_t scale = IMU_FUSION_GYRO_SCALE(65.5);
+    if (mpu6050 == NULL) {
+        i2c_sensor_mpu6050_init();
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, iot_mpu6050_wake_up(mpu6050));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_mpu6050_set_acce_fs(mpu6050, ACCE_FS_4G));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_mpu6050_set_gyro_fs(mpu6050, GYRO_FS_500DPS));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_mpu6050_set_dlpf(mpu6050, DLPF_184HZ));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_mpu6050_set_sample_rate_div(mpu6050, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_imu_fusion_init(&fusion, &cfg));
+    TEST_ASSERT_EQUAL(ESP_OK, iot_mpu6050_fifo_enable(mpu6050));
+
+    int total = 0;
+    int64_t fusion_us = 0;
+    TickType_t start = xTaskGetTickCount();
+    while (xTaskGetTickCount() - start < FIFO_TEST_TIME_MS / portTICK_RATE_MS) {
+        int num;
+        vTaskDelay(20 / portTICK_RATE_MS);
+        TEST_ASSERT_EQUAL(ESP_OK, iot_mpu6050_fifo_read(mpu6050, frames, sizeof(frames) / sizeof(frames[0]), &num, NULL));
+        int64_t t0 = esp_timer_get_time();
+        for (int i = 0; i < num; i++) {
+            int32_t gyro[3] = {
+                iot_imu_fusion_gyro_from_raw(frames[i].gyro.raw_gyro_x, scale),
+                iot_imu_fusion_gyro_from_raw(frames[i].gyro.raw_gyro_y, scale),
+                iot_imu_fusion_gyro_from_raw(frames[i].gyro.raw_gyro_z, scale),
+            };
+            int32_t acce[3] = { frames[i].acce.raw_acce_x, frames[i].acce.raw_acce_y, frames[i].acce.raw_acce_z };
+            iot_imu_fusion_update(&fusion, gyro, acce);
+        }
+        fusion_us += esp_timer_get_time() - t0;
+        total += num;
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, iot_mpu6050_fifo_disable(mpu6050));
+
+    iot_imu_fusion_get_euler(&fusion, &euler);
+    printf("%d frames in %d ms, %.2f us per fusion update\n", total, FIFO_TEST_TIME_MS, (float) fusion_us / total);
+    printf("roll: %.2f, pitch: %.2f, yaw: %.2f\n", euler.roll / 65536.0, euler.pitch / 65536.0, euler.yaw / 65536.0);
+    // what is still in the FIFO after the last read
+    TEST_ASSERT_INT_WITHIN(MPU6050_FIFO_SIZE / MPU6050_FIFO_FRAME_LEN, FIFO_TEST_RATE_HZ * FIFO_TEST_TIME_MS / 1000, total);
+}
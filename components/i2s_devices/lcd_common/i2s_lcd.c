@@ -19,12 +19,15 @@
 #include "freertos/queue.h"
 #include "freertos/xtensa_api.h"
 #include "soc/dport_reg.h"
+#include "soc/i2s_reg.h"
 #include "rom/lldesc.h"
 #include "driver/gpio.h"
 #include "iot_i2s_lcd.h"
+#include "i2s_lcd_pack.h"
 #include "esp_intr.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
 
 #define I2S_CHECK(a, str, ret) if (!(a)) {                                              \
         ESP_LOGE(I2S_TAG,"%s:%d (%s):%s", __FILE__, __LINE__, __FUNCTION__, str);       \
@@ -39,20 +42,52 @@
 
 //This macro definition only for lcd and camera mode.
 //In i2s dma link descriptor, the maximum of dma buffer is 4095 bytes,
-//so we take the length of 1023 words here.
-#define DMA_SIZE (2000)  //words
+//so one chunk is at most 1023 words. Every descriptor has its own chunk buffer.
+#ifdef CONFIG_I2S_LCD_DMA_DESC_NUM
+#define DMA_DESC_NUM    CONFIG_I2S_LCD_DMA_DESC_NUM
+#else
+#define DMA_DESC_NUM    (4)
+#endif
+#ifdef CONFIG_I2S_LCD_DMA_CHUNK_WORDS
+#define DMA_CHUNK_SIZE  (CONFIG_I2S_LCD_DMA_CHUNK_WORDS & ~1)  //words, even to keep byte pairs together
+#else
+#define DMA_CHUNK_SIZE  (1000)
+#endif
+
 /**
  * @brief DMA buffer object
  *
+ * The descriptors form a ring. A transfer fills as many descriptors as it can,
+ * starts the engine once, and the EOF ISR refills every finished descriptor
+ * with the next chunk, so a whole frame streams without restarting the peripheral.
+ * The descriptor holding the last chunk ends the chain.
+ *
+ * A solid fill packs one chunk of the pattern into buf[0] and points every
+ * descriptor at it, so the ring keeps replaying the same buffer and the EOF
+ * ISR only has to account for it.
+ *
+ * The DMA clears the owner bit of a finished descriptor and stops at one it
+ * does not own, so when the refills fall behind it waits instead of sending
+ * a stale chunk. The ISR counts that as an underrun and restarts the link
+ * once the descriptor is armed again.
  */
 typedef struct {
-    char **buf;
-    int buf_size;
+    char **buf;                      /*!< one chunk buffer per descriptor */
+    int buf_size;                    /*!< units (bytes in 8-bit mode, pixels in 16-bit mode) per chunk */
     int rw_pos;
     void *curr_ptr;
     SemaphoreHandle_t mux;
     xQueueHandle queue;
     lldesc_t **desc;
+    int desc_num;                    /*!< number of descriptors in the ring */
+    int next_done;                   /*!< oldest descriptor still owned by the DMA */
+    const uint8_t *src;              /*!< source data not yet packed into a descriptor, NULL while filling */
+    size_t remain;                   /*!< units not yet packed into a descriptor */
+    volatile size_t done;            /*!< units already sent */
+    bool swap;                       /*!< swap high/low byte while packing */
+    volatile bool packing;           /*!< the ISR packs chunks it has reserved */
+    volatile bool stalled;           /*!< the DMA stopped at a descriptor it does not own */
+    uint32_t underrun;               /*!< stalls during the current transfer */
 } i2s_dma_t;
 
 /**
@@ -90,41 +125,38 @@ static esp_err_t i2s_isr_register(i2s_port_t i2s_num, int intr_alloc_flags, void
 static esp_err_t i2s_set_parallel_mode(i2s_port_t i2s_num)
 {
     i2s_dma_t *dma = NULL;
-    if ((dma = (i2s_dma_t *)malloc(sizeof(i2s_dma_t))) == NULL) {
+    if ((dma = (i2s_dma_t *)calloc(1, sizeof(i2s_dma_t))) == NULL) {
         ESP_LOGE(I2S_TAG, "malloc i2s_dma_t fail");
         return ESP_FAIL;
     }
-    if ((dma->desc = (lldesc_t **)malloc(sizeof(lldesc_t *))) == NULL) {
+    dma->desc_num = DMA_DESC_NUM;
+    if ((dma->desc = (lldesc_t **)calloc(dma->desc_num, sizeof(lldesc_t *))) == NULL) {
         ESP_LOGE(I2S_TAG, "malloc lldesc_t* fail");
         goto _err;
     }
-    if ((*(dma->desc) = (lldesc_t *)malloc(sizeof(lldesc_t))) == NULL) {
-        ESP_LOGE(I2S_TAG, "malloc lldesc_t fail");
-        goto _err;
-    }
-    memset(*(dma->desc), 0, sizeof(lldesc_t));
-    (*(dma->desc))->sosf = 1;
-    (*(dma->desc))->eof = 1;
-    (*(dma->desc))->owner = 1;
-    if ((dma->buf = (char **)malloc(sizeof(char *) * 2)) == NULL) {
+    if ((dma->buf = (char **)calloc(dma->desc_num, sizeof(char *))) == NULL) {
         ESP_LOGE(I2S_TAG, "malloc dma buf fail");
         goto _err;
     }
-
-    // In lcd mode, we should allocate a buffer for dma, and configure clk for lcd mode.
-    char *buff = (char *)malloc(sizeof(uint32_t) * DMA_SIZE);
-    if (buff == NULL) {
-        ESP_LOGE(I2S_TAG, "malloc dma buf fail");
-        goto _err;
+    // In lcd mode, we should allocate buffers for dma, and configure clk for lcd mode.
+    for (int i = 0; i < dma->desc_num; i++) {
+        if ((dma->desc[i] = (lldesc_t *)heap_caps_calloc(1, sizeof(lldesc_t), MALLOC_CAP_DMA)) == NULL) {
+            ESP_LOGE(I2S_TAG, "malloc lldesc_t fail");
+            goto _err;
+        }
+        if ((dma->buf[i] = (char *)heap_caps_calloc(DMA_CHUNK_SIZE, sizeof(uint32_t), MALLOC_CAP_DMA)) == NULL) {
+            ESP_LOGE(I2S_TAG, "malloc dma buf fail");
+            goto _err;
+        }
+        dma->desc[i]->sosf = 1;
+        dma->desc[i]->eof = 1;      // EOF interrupt for every chunk, so it can be refilled
+        dma->desc[i]->owner = 0;    // armed when a chunk is packed into it
+        dma->desc[i]->buf = (uint8_t *)dma->buf[i];
     }
-    memset(buff, 0, sizeof(uint32_t) * DMA_SIZE);
-    dma->buf[0] = buff;
-    dma->buf[1] = buff + DMA_SIZE * 2;
-    (*(dma->desc))->buf = (uint8_t *)(dma->buf[0]);
-    dma->buf_size = DMA_SIZE / 2;
+    dma->buf_size = DMA_CHUNK_SIZE;
     p_i2s_obj[i2s_num]->tx = dma;
-    p_i2s_obj[i2s_num]->dma_buf_count = 1;
-    p_i2s_obj[i2s_num]->dma_buf_len = sizeof(uint32_t) * DMA_SIZE / 2;
+    p_i2s_obj[i2s_num]->dma_buf_count = dma->desc_num;
+    p_i2s_obj[i2s_num]->dma_buf_len = sizeof(uint32_t) * DMA_CHUNK_SIZE;
 
     //configure clk of lcd mode, 10M
     I2S[i2s_num]->sample_rate_conf.tx_bck_div_num = 2;
@@ -146,21 +178,58 @@ static esp_err_t i2s_set_parallel_mode(i2s_port_t i2s_num)
     return ESP_OK;
 
 _err:
+    for (int i = 0; i < dma->desc_num; i++) {
+        if (dma->desc && dma->desc[i]) {
+            free(dma->desc[i]);
+        }
+        if (dma->buf && dma->buf[i]) {
+            free(dma->buf[i]);
+        }
+    }
     if (dma->buf) {
         free(dma->buf);
     }
-    if (*(dma->desc)) {
-        free(*(dma->desc));
-    }
     if (dma->desc) {
         free(dma->desc);
     }
-    if (dma) {
-        free(dma);
-    }
+    free(dma);
     return ESP_FAIL;
 }
 
+/*
+ * Reserve the next chunk of the pending transfer for desc, the last chunk ends the chain.
+ * Called with the spinlock held while the link runs, returns the source to pack or NULL
+ * for a solid fill.
+ */
+static IRAM_ATTR const uint8_t *i2s_lcd_reserve_desc(i2s_dma_t *dma, lldesc_t *desc)
+{
+    const uint8_t *src = dma->src;
+    size_t cnt = dma->remain > (size_t) dma->buf_size ? (size_t) dma->buf_size : dma->remain;
+    if (dma->src != NULL) {
+#ifdef CONFIG_BIT_MODE_8BIT
+        dma->src += cnt;
+#else
+        dma->src += cnt * sizeof(uint16_t);
+#endif
+    }
+    dma->remain -= cnt;
+    desc->length = cnt * sizeof(uint32_t);
+    desc->size = cnt * sizeof(uint32_t);
+    if (dma->remain == 0) {
+        STAILQ_NEXT(desc, qe) = NULL;
+    }
+    return src;
+}
+
+/* Pack a reserved chunk and hand the descriptor to the DMA */
+static void IRAM_ATTR i2s_lcd_arm_desc(i2s_dma_t *dma, lldesc_t *desc, const uint8_t *src)
+{
+    if (src != NULL) {
+        i2s_lcd_pack((uint32_t *)desc->buf, src, desc->length / sizeof(uint32_t), dma->swap);
+    }
+    desc->owner = 1;
+}
+
 static void IRAM_ATTR i2s_intr_handler_default(void *arg)
 {
     i2s_obj_t *p_i2s = (i2s_obj_t *) arg;
@@ -169,21 +238,63 @@ static void IRAM_ATTR i2s_intr_handler_default(void *arg)
     int dummy;
     portBASE_TYPE high_priority_task_awoken = 0;
     lldesc_t *finish_desc;
-    if (i2s_reg->int_st.out_dscr_err || i2s_reg->int_st.in_dscr_err) {
-        ESP_EARLY_LOGE(I2S_TAG, "dma error, interrupt status: 0x%08x", i2s_reg->int_st.val);
+    // Take one snapshot of the status and clear exactly that, an event raised while the
+    // chunks below are packed stays pending and calls the handler again
+    uint32_t status = i2s_reg->int_st.val;
+    i2s_reg->int_clr.val = status;
+    if (status & I2S_IN_DSCR_ERR_INT_ST) {
+        ESP_EARLY_LOGE(I2S_TAG, "dma error, interrupt status: 0x%08x", status);
     }
-    if (i2s_reg->int_st.out_eof && p_i2s->tx) {
-        finish_desc = (lldesc_t *) i2s_reg->out_eof_des_addr;
+    if ((status & I2S_OUT_DSCR_ERR_INT_ST) && p_i2s->tx) {
+        // The refills fell behind and the DMA reached a descriptor it does not own
+        p_i2s->tx->stalled = true;
+        p_i2s->tx->underrun++;
+    }
+    // The address is read after the clear, so an EOF from before the clear is not lost,
+    // and one from after it may show up again for a descriptor that is retired already
+    finish_desc = (lldesc_t *) i2s_reg->out_eof_des_addr;
+    if ((status & I2S_OUT_EOF_INT_ST) && p_i2s->tx
+            && finish_desc != p_i2s->tx->desc[(p_i2s->tx->next_done + p_i2s->tx->desc_num - 1) % p_i2s->tx->desc_num]) {
+        i2s_dma_t *dma = p_i2s->tx;
+        lldesc_t *refill[DMA_DESC_NUM];
+        const uint8_t *refill_src[DMA_DESC_NUM];
+        int refill_num = 0;
+        // Retire every descriptor up to the reported one, in case EOFs were coalesced,
+        // and reserve the next chunk for it while the rest of the chain is streaming.
+        I2S_ENTER_CRITICAL_ISR();
+        for (int i = 0; i < dma->desc_num; i++) {
+            lldesc_t *desc = dma->desc[dma->next_done];
+            dma->next_done = (dma->next_done + 1) % dma->desc_num;
+            dma->done += desc->length / sizeof(uint32_t);
+            if (dma->remain > 0) {
+                refill_src[refill_num] = i2s_lcd_reserve_desc(dma, desc);
+                refill[refill_num++] = desc;
+            }
+            if (desc == finish_desc) {
+                break;
+            }
+        }
+        dma->packing = refill_num > 0;
+        I2S_EXIT_CRITICAL_ISR();
+        // The DMA does not own the reserved descriptors, so they are packed without the lock
+        for (int i = 0; i < refill_num; i++) {
+            i2s_lcd_arm_desc(dma, refill[i], refill_src[i]);
+        }
+        dma->packing = false;
         // All buffers are empty. This means we have an underflow on our hands.
-        if (xQueueIsQueueFullFromISR(p_i2s->tx->queue)) {
-            xQueueReceiveFromISR(p_i2s->tx->queue, &dummy, &high_priority_task_awoken);
+        if (xQueueIsQueueFullFromISR(dma->queue)) {
+            xQueueReceiveFromISR(dma->queue, &dummy, &high_priority_task_awoken);
         }
-        xQueueSendFromISR(p_i2s->tx->queue, (void *)(&finish_desc->buf), &high_priority_task_awoken);
+        xQueueSendFromISR(dma->queue, (void *)(&finish_desc->buf), &high_priority_task_awoken);
+    }
+    if (p_i2s->tx && p_i2s->tx->stalled && p_i2s->tx->desc[p_i2s->tx->next_done]->owner) {
+        // The descriptor the DMA stopped at is armed again
+        p_i2s->tx->stalled = false;
+        i2s_reg->out_link.restart = 1;
     }
     if (high_priority_task_awoken == pdTRUE) {
         portYIELD_FROM_ISR();
     }
-    i2s_reg->int_clr.val = I2S[i2s_num]->int_st.val;
 }
 
 static esp_err_t i2s_lcd_config(i2s_port_t i2s_num)
@@ -209,9 +320,9 @@ static esp_err_t i2s_lcd_config(i2s_port_t i2s_num)
     I2S[i2s_num]->lc_conf.out_rst = 1;
     I2S[i2s_num]->lc_conf.out_rst = 0;
     //Enable and configure DMA
-    I2S[i2s_num]->lc_conf.check_owner = 0;
+    I2S[i2s_num]->lc_conf.check_owner = 1;
     I2S[i2s_num]->lc_conf.out_loop_test = 0;
-    I2S[i2s_num]->lc_conf.out_auto_wrback = 0;
+    I2S[i2s_num]->lc_conf.out_auto_wrback = 1;
     I2S[i2s_num]->lc_conf.out_data_burst_en = 1;
     I2S[i2s_num]->lc_conf.out_no_restart_clr = 0;
     I2S[i2s_num]->lc_conf.indscr_burst_en = 0;
@@ -331,122 +442,120 @@ i2s_lcd_handle_t i2s_lcd_create(i2s_port_t i2s_num, i2s_lcd_config_t *pin_conf)
     return NULL;
 }
 
-#ifdef  CONFIG_BIT_MODE_8BIT
-
-int i2s_lcd_write_data(i2s_lcd_handle_t i2s_lcd_handle, const char *src, size_t size, TickType_t ticks_to_wait, bool swap)
+/* Stream total units through the descriptor ring and wait for them, dma->mux must be held */
+static size_t i2s_lcd_dma_run(i2s_port_t i2s_num, i2s_dma_t *dma, const uint8_t *src, size_t total, TickType_t ticks_to_wait, bool swap)
 {
-    i2s_lcd_t* i2s_lcd = (i2s_lcd_t*) i2s_lcd_handle;
-    i2s_port_t i2s_num = i2s_lcd->i2s_port;
-    I2S_CHECK((i2s_num < I2S_NUM_MAX), "i2s_num error", ESP_ERR_INVALID_ARG);
-    uint8_t tagle = 0x01;
-    uint8_t *ptr = (uint8_t *)src;
-    size_t size_remain = size;
-    size_t write_cnt = 0;
-    lldesc_t *desc = *(p_i2s_obj[i2s_num]->tx->desc);
-    uint32_t *buf = NULL;
-    uint32_t loop_cnt = 0;
-    xSemaphoreTake(p_i2s_obj[i2s_num]->tx->mux, (portTickType)portMAX_DELAY);
-    buf = (uint32_t *)(p_i2s_obj[i2s_num]->tx->buf[tagle ^ 0x1]);
-    write_cnt = size_remain > p_i2s_obj[i2s_num]->tx->buf_size ? p_i2s_obj[i2s_num]->tx->buf_size : size_remain;
-    for (loop_cnt = 0; loop_cnt < write_cnt; loop_cnt += 2) {
-        if (swap) {
-            buf[loop_cnt] = ptr[loop_cnt+1];
-            buf[loop_cnt+1] = ptr[loop_cnt];
-        } else {
-            buf[loop_cnt] = ptr[loop_cnt];
-            buf[loop_cnt+1] = ptr[loop_cnt+1];
-        }
+    xQueueReset(dma->queue);
+    // Rebuild the ring, the previous transfer has cut it after its last chunk
+    for (int i = 0; i < dma->desc_num; i++) {
+        STAILQ_NEXT(dma->desc[i], qe) = dma->desc[(i + 1) % dma->desc_num];
+        dma->desc[i]->length = 0;
+        dma->desc[i]->owner = 0;
     }
-    ptr += write_cnt;
-    size_remain -= write_cnt;
-    while (1) {
-        desc->buf = (uint8_t *)(p_i2s_obj[i2s_num]->tx->buf[tagle ^ 0x1]);
-        desc->length = write_cnt * sizeof(uint32_t);
-        desc->size = write_cnt * sizeof(uint32_t);
-        I2S[i2s_num]->out_link.addr = ((uint32_t)(desc))&I2S_OUTLINK_ADDR;
-        I2S[i2s_num]->out_link.start = 1;
-        I2S[i2s_num]->fifo_conf.dscr_en = 1;
-        I2S[i2s_num]->conf.tx_start = 1;
-        tagle ^= 0x1;
-        buf = (uint32_t *)(p_i2s_obj[i2s_num]->tx->buf[tagle ^ 0x1]);
-        write_cnt = size_remain > p_i2s_obj[i2s_num]->tx->buf_size ? p_i2s_obj[i2s_num]->tx->buf_size : size_remain;
-        for (loop_cnt = 0; loop_cnt < write_cnt; loop_cnt += 2) {
-            if (swap) {
-                buf[loop_cnt] = ptr[loop_cnt+1];
-                buf[loop_cnt+1] = ptr[loop_cnt];
-            } else {
-                buf[loop_cnt] = ptr[loop_cnt];
-                buf[loop_cnt+1] = ptr[loop_cnt+1];
-            }
-        }
-        ptr += write_cnt;
-        if (xQueueReceive(p_i2s_obj[i2s_num]->tx->queue, &p_i2s_obj[i2s_num]->tx->curr_ptr, ticks_to_wait) == pdFALSE) {
-            break;
-        }
-        I2S[i2s_num]->conf.tx_start = 0;
-        I2S[i2s_num]->conf.tx_reset = 1;
-        I2S[i2s_num]->conf.tx_reset = 0;
-        if (size_remain == 0) {
+    dma->src = src;
+    dma->remain = total;
+    dma->done = 0;
+    dma->swap = swap;
+    dma->next_done = 0;
+    dma->stalled = false;
+    dma->underrun = 0;
+    // The link is not started yet, so the ISR does not touch the ring
+    for (int i = 0; i < dma->desc_num && dma->remain > 0; i++) {
+        i2s_lcd_arm_desc(dma, dma->desc[i], i2s_lcd_reserve_desc(dma, dma->desc[i]));
+    }
+
+    I2S[i2s_num]->out_link.addr = ((uint32_t)(dma->desc[0]))&I2S_OUTLINK_ADDR;
+    I2S[i2s_num]->out_link.start = 1;
+    I2S[i2s_num]->fifo_conf.dscr_en = 1;
+    I2S[i2s_num]->conf.tx_start = 1;
+    while (dma->done < total) {
+        if (xQueueReceive(dma->queue, &dma->curr_ptr, ticks_to_wait) == pdFALSE) {
+            ESP_LOGW(I2S_TAG, "write timeout, %d of %d sent", dma->done, total);
             break;
         }
-        size_remain -= write_cnt;
     }
-    xSemaphoreGive(p_i2s_obj[i2s_num]->tx->mux);
+    I2S[i2s_num]->conf.tx_start = 0;
+    I2S[i2s_num]->out_link.stop = 1;
+    I2S[i2s_num]->conf.tx_reset = 1;
+    I2S[i2s_num]->conf.tx_reset = 0;
     I2S[i2s_num]->fifo_conf.dscr_en = 0;
-    return size - size_remain;
+    I2S_ENTER_CRITICAL();
+    dma->remain = 0;
+    size_t done = dma->done;
+    I2S_EXIT_CRITICAL();
+    // A chunk reserved before remain was cleared may still be read from src
+    while (dma->packing) {
+        ;
+    }
+    if (dma->underrun) {
+        ESP_LOGD(I2S_TAG, "%u DMA underruns", dma->underrun);
+    }
+    return done;
 }
 
-#else //CONFIG_BIT_MODE_16BIT
-
 int i2s_lcd_write_data(i2s_lcd_handle_t i2s_lcd_handle, const char *src, size_t size, TickType_t ticks_to_wait, bool swap)
 {
     i2s_lcd_t* i2s_lcd = (i2s_lcd_t*) i2s_lcd_handle;
     i2s_port_t i2s_num = i2s_lcd->i2s_port;
     I2S_CHECK((i2s_num < I2S_NUM_MAX), "i2s_num error", ESP_ERR_INVALID_ARG);
-    uint8_t tagle = 0x01;
-    uint16_t *ptr = (uint16_t *)src;
-    size_t size_remain = size / 2;
-    size_t write_cnt = 0;
-    lldesc_t *desc = *(p_i2s_obj[i2s_num]->tx->desc);
-    uint32_t *buf = NULL;
-    uint32_t loop_cnt = 0;
-    xSemaphoreTake(p_i2s_obj[i2s_num]->tx->mux, (portTickType)portMAX_DELAY);
-    buf = (uint32_t *)(p_i2s_obj[i2s_num]->tx->buf[tagle ^ 0x1]);
-    write_cnt = size_remain > p_i2s_obj[i2s_num]->tx->buf_size ? p_i2s_obj[i2s_num]->tx->buf_size : size_remain;
-    for (loop_cnt = 0; loop_cnt < write_cnt; loop_cnt++) {
-        buf[loop_cnt] = ptr[loop_cnt];
-    }
-    ptr += write_cnt;
-    size_remain -= write_cnt;
-    while (1) {
-        desc->buf = (uint8_t *)(p_i2s_obj[i2s_num]->tx->buf[tagle ^ 0x1]);
-        desc->length = write_cnt * sizeof(uint32_t);
-        desc->size = write_cnt * sizeof(uint32_t);
-        I2S[i2s_num]->out_link.addr = ((uint32_t)(desc))&I2S_OUTLINK_ADDR;
-        I2S[i2s_num]->out_link.start = 1;
-        I2S[i2s_num]->fifo_conf.dscr_en = 1;
-        I2S[i2s_num]->conf.tx_start = 1;
-        tagle ^= 0x1;
-        buf = (uint32_t *)(p_i2s_obj[i2s_num]->tx->buf[tagle ^ 0x1]);
-        write_cnt = size_remain > p_i2s_obj[i2s_num]->tx->buf_size ? p_i2s_obj[i2s_num]->tx->buf_size : size_remain;
-        for (loop_cnt = 0; loop_cnt < write_cnt; loop_cnt++) {
-            buf[loop_cnt] = ptr[loop_cnt];
-        }
-        ptr += write_cnt;
-        if (xQueueReceive(p_i2s_obj[i2s_num]->tx->queue, &p_i2s_obj[i2s_num]->tx->curr_ptr, ticks_to_wait) == pdFALSE) {
-            break;
-        }
-        I2S[i2s_num]->conf.tx_start = 0;
-        I2S[i2s_num]->conf.tx_reset = 1;
-        I2S[i2s_num]->conf.tx_reset = 0;
-        if (size_remain == 0) {
-            break;
-        }
-        size_remain -= write_cnt;
+    i2s_dma_t *dma = p_i2s_obj[i2s_num]->tx;
+#ifdef CONFIG_BIT_MODE_8BIT
+    // One FIFO word per byte
+    size_t total = size;
+#else
+    // One FIFO word per pixel, swap is done by the bus width
+    size_t total = size / 2;
+    swap = false;
+#endif
+    if (total == 0) {
+        return 0;
     }
-    xSemaphoreGive(p_i2s_obj[i2s_num]->tx->mux);
-    I2S[i2s_num]->fifo_conf.dscr_en = 0;
-    return size - (size_remain * 2);
+    xSemaphoreTake(dma->mux, (portTickType)portMAX_DELAY);
+    size_t done = i2s_lcd_dma_run(i2s_num, dma, (const uint8_t *)src, total, ticks_to_wait, swap);
+    xSemaphoreGive(dma->mux);
+#ifdef CONFIG_BIT_MODE_8BIT
+    return done;
+#else
+    return done * 2;
+#endif
 }
 
-#endif // CONFIG_BIT_MODE_16BIT
+int i2s_lcd_fill_data(i2s_lcd_handle_t i2s_lcd_handle, uint16_t data, size_t cnt, TickType_t ticks_to_wait, bool swap)
+{
+    i2s_lcd_t* i2s_lcd = (i2s_lcd_t*) i2s_lcd_handle;
+    i2s_port_t i2s_num = i2s_lcd->i2s_port;
+    I2S_CHECK((i2s_num < I2S_NUM_MAX), "i2s_num error", ESP_ERR_INVALID_ARG);
+    i2s_dma_t *dma = p_i2s_obj[i2s_num]->tx;
+#ifdef CONFIG_BIT_MODE_8BIT
+    // Two FIFO words per value, in the order i2s_lcd_pack would give them
+    uint8_t first = swap ? data >> 8 : data & 0xff;
+    uint8_t second = swap ? data & 0xff : data >> 8;
+    size_t total = cnt * 2;
+#else
+    uint16_t first = data;
+    uint16_t second = data;
+    size_t total = cnt;
+#endif
+    if (total == 0) {
+        return 0;
+    }
+    xSemaphoreTake(dma->mux, (portTickType)portMAX_DELAY);
+    uint32_t *pattern = (uint32_t *)dma->buf[0];
+    for (int i = 0; i < dma->buf_size; i += 2) {
+        pattern[i] = first;
+        pattern[i + 1] = second;
+    }
+    for (int i = 0; i < dma->desc_num; i++) {
+        dma->desc[i]->buf = (uint8_t *)pattern;
+    }
+    size_t done = i2s_lcd_dma_run(i2s_num, dma, NULL, total, ticks_to_wait, false);
+    for (int i = 0; i < dma->desc_num; i++) {
+        dma->desc[i]->buf = (uint8_t *)dma->buf[i];
+    }
+    xSemaphoreGive(dma->mux);
+#ifdef CONFIG_BIT_MODE_8BIT
+    return done;
+#else
+    return done * 2;
+#endif
+}
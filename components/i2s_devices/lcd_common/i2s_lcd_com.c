@@ -78,6 +78,11 @@ void iot_i2s_lcd_write(i2s_lcd_handle_t i2s_lcd_handle, uint16_t *data, uint32_t
     i2s_lcd_write_data(i2s_lcd_handle, (char *)data, len, 100, true);
 }
 
+void iot_i2s_lcd_fill(i2s_lcd_handle_t i2s_lcd_handle, uint16_t data, uint32_t cnt)
+{
+    i2s_lcd_fill_data(i2s_lcd_handle, data, cnt, 100, true);
+}
+
 #else // CONFIG_BIT_MODE_16BIT
 
 void iot_i2s_lcd_write_data(i2s_lcd_handle_t i2s_lcd_handle, uint16_t data)
@@ -152,6 +157,11 @@ void iot_i2s_lcd_write(i2s_lcd_handle_t i2s_lcd_handle, uint16_t *data, uint32_t
     i2s_lcd_write_data(i2s_lcd_handle, (char *)data, len, 100, false);
 }
 
+void iot_i2s_lcd_fill(i2s_lcd_handle_t i2s_lcd_handle, uint16_t data, uint32_t cnt)
+{
+    i2s_lcd_fill_data(i2s_lcd_handle, data, cnt, 100, false);
+}
+
 #endif // CONFIG_BIT_MODE_16BIT
 
 i2s_lcd_handle_t iot_i2s_lcd_pin_cfg(i2s_port_t i2s_port, i2s_lcd_config_t *i2s_lcd_pin_conf)
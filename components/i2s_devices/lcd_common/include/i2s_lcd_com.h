@@ -56,12 +56,24 @@ void iot_i2s_lcd_write_reg(i2s_lcd_handle_t i2s_lcd_handle, uint16_t reg, uint16
 /**
  * @brief Write data to lcd.
  *
+ * @note data may sit at any address, a source that is not 32-bit aligned is packed
+ *       with narrower loads
+ *
  * @param i2s_lcd_handle i2s_lcd_handle_t
  * @param data will write data 
  * @param len data length
  */
 void iot_i2s_lcd_write(i2s_lcd_handle_t i2s_lcd_handle, uint16_t *data, uint32_t len);
 
+/**
+ * @brief Write the same data to lcd repeatedly.
+ *
+ * @param i2s_lcd_handle i2s_lcd_handle_t
+ * @param data will write data
+ * @param cnt number of times to write it
+ */
+void iot_i2s_lcd_fill(i2s_lcd_handle_t i2s_lcd_handle, uint16_t data, uint32_t cnt);
+
 /**
  * @brief Lcd pin configuration.
  * 
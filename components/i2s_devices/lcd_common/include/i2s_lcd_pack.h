@@ -0,0 +1,110 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef __I2S_LCD_PACK_H__
+#define __I2S_LCD_PACK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_attr.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Widen LCD data into 32-bit I2S FIFO words
+ *
+ * In LCD mode the I2S FIFO takes one 32-bit word per bus cycle. A unit is one
+ * byte in CONFIG_BIT_MODE_8BIT and one pixel (uint16_t) in 16-bit mode.
+ * The kernel loads 32 bits at a time and writes 4 FIFO words per iteration;
+ * in 8-bit mode the high/low byte swap is folded into the same shifts.
+ * src needs no alignment: a leading half word is packed on its own, and a
+ * source at an odd address is packed byte by byte.
+ *
+ * @param dst FIFO words, cnt entries
+ * @param src source data
+ * @param cnt number of units, even in 8-bit mode
+ * @param swap swap high/low byte of every pixel, only used in 8-bit mode
+ */
+static inline void IRAM_ATTR i2s_lcd_pack(uint32_t *dst, const uint8_t *src, size_t cnt, bool swap)
+{
+    size_t i = 0;
+#ifdef CONFIG_BIT_MODE_8BIT
+    if (((uintptr_t)src & 0x1) == 0) {
+        if (((uintptr_t)src & 0x2) && cnt >= 2) {
+            // Align to 32 bits with one byte pair
+            dst[0] = swap ? src[1] : src[0];
+            dst[1] = swap ? src[0] : src[1];
+            i = 2;
+        }
+        const uint32_t *p32 = (const uint32_t *)(src + i);
+        if (swap) {
+            for (; i + 4 <= cnt; i += 4) {
+                uint32_t w = *p32++;
+                dst[i] = (w >> 8) & 0xff;
+                dst[i + 1] = w & 0xff;
+                dst[i + 2] = w >> 24;
+                dst[i + 3] = (w >> 16) & 0xff;
+            }
+        } else {
+            for (; i + 4 <= cnt; i += 4) {
+                uint32_t w = *p32++;
+                dst[i] = w & 0xff;
+                dst[i + 1] = (w >> 8) & 0xff;
+                dst[i + 2] = (w >> 16) & 0xff;
+                dst[i + 3] = w >> 24;
+            }
+        }
+    }
+    for (; i < cnt; i += 2) {
+        dst[i] = swap ? src[i + 1] : src[i];
+        dst[i + 1] = swap ? src[i] : src[i + 1];
+    }
+#else
+    if ((uintptr_t)src & 0x1) {
+        // Pixels straddle half words, 16-bit loads would fault
+        for (; i < cnt; i++) {
+            dst[i] = src[2 * i] | (src[2 * i + 1] << 8);
+        }
+        return;
+    }
+    const uint16_t *p16 = (const uint16_t *)src;
+    if (((uintptr_t)p16 & 0x2) && cnt >= 1) {
+        // Align to 32 bits with one pixel
+        dst[0] = p16[0];
+        i = 1;
+    }
+    const uint32_t *p32 = (const uint32_t *)(p16 + i);
+    for (; i + 4 <= cnt; i += 4) {
+        uint32_t w0 = *p32++;
+        uint32_t w1 = *p32++;
+        dst[i] = w0 & 0xffff;
+        dst[i + 1] = w0 >> 16;
+        dst[i + 2] = w1 & 0xffff;
+        dst[i + 3] = w1 >> 16;
+    }
+    for (; i < cnt; i++) {
+        dst[i] = p16[i];
+    }
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -70,4 +70,21 @@ i2s_lcd_handle_t i2s_lcd_create(i2s_port_t i2s_num, i2s_lcd_config_t *pin_conf);
  */
 int i2s_lcd_write_data(i2s_lcd_handle_t i2s_lcd, const char *src, size_t size, TickType_t ticks_to_wait, bool swap);
 
+/**
+ * @brief Write the same 16-bit value cnt times.
+ *
+ * One chunk of the value is packed once and the DMA ring replays it, so
+ * a whole rectangle is filled in one transfer without touching the data again.
+ *
+ * @param i2s_lcd i2s_lcd_handle_t
+ * @param data value to repeat
+ * @param cnt number of values
+ * @param ticks_to_wait The maximum amount of time to wait for each chunk
+ * @param swap swap high/low byte
+ *
+ * @return
+ *      - write data length in bytes
+ */
+int i2s_lcd_fill_data(i2s_lcd_handle_t i2s_lcd, uint16_t data, size_t cnt, TickType_t ticks_to_wait, bool swap);
+
 #endif //__IOT_I2S_H__
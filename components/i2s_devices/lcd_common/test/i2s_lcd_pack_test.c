@@ -0,0 +1,96 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "i2s_lcd_pack.h"
+
+#define PACK_UNITS   (1000)     // one DMA chunk
+#define PACK_LOOPS   (384)      // about one 800x480 frame in 16-bit mode
+
+static const char *TAG = "I2S_LCD_PACK";
+
+/* The per-unit loop i2s_lcd_write_data used before the packing kernel */
+static void i2s_lcd_pack_ref(uint32_t *buf, const uint8_t *src, size_t cnt, bool swap)
+{
+#ifdef CONFIG_BIT_MODE_8BIT
+    for (size_t loop_cnt = 0; loop_cnt < cnt; loop_cnt += 2) {
+        if (swap) {
+            buf[loop_cnt] = src[loop_cnt + 1];
+            buf[loop_cnt + 1] = src[loop_cnt];
+        } else {
+            buf[loop_cnt] = src[loop_cnt];
+            buf[loop_cnt + 1] = src[loop_cnt + 1];
+        }
+    }
+#else
+    if ((uintptr_t)src & 0x1) {
+        // Only the kernel test goes here, an odd address cannot be read as uint16_t
+        for (size_t loop_cnt = 0; loop_cnt < cnt; loop_cnt++) {
+            buf[loop_cnt] = src[2 * loop_cnt] | (src[2 * loop_cnt + 1] << 8);
+        }
+        return;
+    }
+    const uint16_t *ptr = (const uint16_t *)src;
+    for (size_t loop_cnt = 0; loop_cnt < cnt; loop_cnt++) {
+        buf[loop_cnt] = ptr[loop_cnt];
+    }
+#endif
+}
+
+TEST_CASE("I2S LCD pack kernel test", "[i2s_lcd][iot]")
+{
+    uint8_t *src = (uint8_t *)malloc(PACK_UNITS * 2 + 4);
+    uint32_t *ref = (uint32_t *)heap_caps_malloc(PACK_UNITS * sizeof(uint32_t), MALLOC_CAP_DMA);
+    uint32_t *dst = (uint32_t *)heap_caps_malloc(PACK_UNITS * sizeof(uint32_t), MALLOC_CAP_DMA);
+    TEST_ASSERT(src != NULL && ref != NULL && dst != NULL);
+    for (int i = 0; i < PACK_UNITS * 2 + 4; i++) {
+        src[i] = esp_random();
+    }
+
+    // Same output for every alignment, length and swap setting
+    for (int offset = 0; offset < 4; offset++) {
+        for (int cnt = 0; cnt <= 64; cnt += 2) {
+            for (int swap = 0; swap < 2; swap++) {
+                memset(ref, 0, PACK_UNITS * sizeof(uint32_t));
+                memset(dst, 0, PACK_UNITS * sizeof(uint32_t));
+                i2s_lcd_pack_ref(ref, src + offset, cnt, swap);
+                i2s_lcd_pack(dst, src + offset, cnt, swap);
+                TEST_ASSERT_EQUAL_UINT32_ARRAY(ref, dst, 66);
+            }
+        }
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    for (int i = 0; i < PACK_LOOPS; i++) {
+        i2s_lcd_pack_ref(ref, src, PACK_UNITS, true);
+    }
+    int64_t ref_us = esp_timer_get_time() - t0;
+    t0 = esp_timer_get_time();
+    for (int i = 0; i < PACK_LOOPS; i++) {
+        i2s_lcd_pack(dst, src, PACK_UNITS, true);
+    }
+    int64_t pack_us = esp_timer_get_time() - t0;
+    ESP_LOGI(TAG, "%d units x %d: per-unit loop %lld us, pack kernel %lld us", PACK_UNITS, PACK_LOOPS, ref_us, pack_us);
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(ref, dst, PACK_UNITS);
+
+    free(src);
+    free(ref);
+    free(dst);
+}
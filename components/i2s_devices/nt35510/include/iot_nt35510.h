@@ -16,12 +16,16 @@
 
 #include "i2s_lcd_com.h"
 #include "iot_i2s_lcd.h"
+#include "iot_glyph_cache.h"
 
 #define NT35510_CASET   0x2A00
 #define NT35510_RASET   0x2B00
 #define NT35510_RAMWR   0x2C00
 #define NT35510_MADCTL  0x3600
 
+#define NT35510_GLYPH_CACHE_NUM     (64)        /*!< glyphs kept pre-rendered for the text functions */
+#define NT35510_GLYPH_MAX_PIXELS    (16 * 16)   /*!< larger characters are rendered every time */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -33,7 +37,9 @@ typedef struct nt35510_dev {
     uint16_t xset_cmd;
     uint16_t yset_cmd;
     uint16_t *lcd_buf;
+    uint32_t lcd_buf_len;   /*!< pixels in lcd_buf, one line unless CONFIG_NT35510_FRAME_BUFFER is set */
     uint16_t pix;
+    glyph_cache_handle_t glyph_cache;
 } nt35510_dev_t;
 
 typedef void* nt35510_handle_t;
@@ -58,7 +64,9 @@ void iot_nt35510_set_orientation(nt35510_handle_t nt35510_handle, lcd_orientatio
 void iot_nt35510_set_box(nt35510_handle_t nt35510_handle, uint16_t x, uint16_t y, uint16_t x_size, uint16_t y_size);
 
 /**
- * @brief nt35510 refresh
+ * @brief nt35510 refresh, send the whole lcd_buf frame to the screen
+ * 
+ * @note Needs CONFIG_NT35510_FRAME_BUFFER, without a whole frame buffer this does nothing
  * 
  * @param nt35510_handle the handle of nt35510
  */
@@ -175,6 +183,19 @@ void iot_nt35510_init(nt35510_handle_t nt35510_handle);
  */
 nt35510_handle_t iot_nt35510_create(uint16_t x_size, uint16_t y_size, i2s_port_t i2s_port, i2s_lcd_config_t *pin_conf);
 
+/**
+ * @brief delete nt35510 handle, free the line or frame buffer and the glyph cache
+ * 
+ * @note The I2S port stays configured
+ * 
+ * @param nt35510_handle the handle of nt35510
+ * 
+ * @return
+ *      - ESP_OK Success
+ *      - ESP_ERR_INVALID_ARG the handle is NULL
+ */
+esp_err_t iot_nt35510_delete(nt35510_handle_t nt35510_handle);
+
 #ifdef __cplusplus
 }
 #endif
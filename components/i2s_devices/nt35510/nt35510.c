@@ -81,6 +81,10 @@ void iot_nt35510_refresh(nt35510_handle_t nt35510_handle)
 {
     nt35510_dev_t *device = (nt35510_dev_t *)nt35510_handle;
     i2s_lcd_handle_t i2s_lcd_handle = device->i2s_lcd_handle;
+    if ((uint32_t)device->x_size * device->y_size > device->lcd_buf_len) {
+        LCD_LOG("no frame buffer to refresh\n");
+        return;
+    }
     iot_i2s_lcd_write(i2s_lcd_handle, device->lcd_buf, device->x_size * device->y_size * 2);
 }
 
@@ -88,41 +92,23 @@ void iot_nt35510_fill_screen(nt35510_handle_t nt35510_handle, uint16_t color)
 {
     nt35510_dev_t *device = (nt35510_dev_t *)nt35510_handle;
     i2s_lcd_handle_t i2s_lcd_handle = device->i2s_lcd_handle;
-    uint16_t *p = device->lcd_buf;
     iot_nt35510_set_box(nt35510_handle, 0, 0, device->x_size, device->y_size);
-    for (int i = 0; i < device->x_size; i++) {
-        p[i] = color;
-    }
-    for (int i = 0; i < device->y_size; i++) {
-        iot_i2s_lcd_write(i2s_lcd_handle, device->lcd_buf, device->x_size * device->pix);
-    }
+    iot_i2s_lcd_fill(i2s_lcd_handle, color, device->x_size * device->y_size);
 }
 
 void iot_nt35510_fill_area(nt35510_handle_t nt35510_handle, uint16_t color, uint16_t x, uint16_t y)
 {
     nt35510_dev_t *device = (nt35510_dev_t *)nt35510_handle;
     i2s_lcd_handle_t i2s_lcd_handle = device->i2s_lcd_handle;
-    uint16_t *p = device->lcd_buf;
-    for (int i = 0; i < x; i++) {
-        p[i] = color;
-    }
-    for (int i = 0; i < y; i++) {
-        iot_i2s_lcd_write(i2s_lcd_handle, device->lcd_buf, x * device->pix);
-    }
+    iot_i2s_lcd_fill(i2s_lcd_handle, color, x * y);
 }
 
 void iot_nt35510_fill_rect(nt35510_handle_t nt35510_handle, uint16_t color, uint16_t x, uint16_t y, uint16_t x_size, uint16_t y_size)
 {
     nt35510_dev_t *device = (nt35510_dev_t *)nt35510_handle;
     i2s_lcd_handle_t i2s_lcd_handle = device->i2s_lcd_handle;
-    uint16_t *p = device->lcd_buf;
     iot_nt35510_set_box(nt35510_handle, x, y, x_size, y_size);
-    for(int i = 0; i < x_size; i++) {
-        p[i] = color;
-    }
-    for(int i = 0; i < y_size; i++) {
-        iot_i2s_lcd_write(i2s_lcd_handle, device->lcd_buf, x_size * device->pix);
-    }
+    iot_i2s_lcd_fill(i2s_lcd_handle, color, x_size * y_size);
 }
 
 void iot_nt35510_draw_bmp(nt35510_handle_t nt35510_handle, uint16_t *bmp, uint16_t x, uint16_t y, uint16_t x_size, uint16_t y_size)
@@ -133,26 +119,70 @@ void iot_nt35510_draw_bmp(nt35510_handle_t nt35510_handle, uint16_t *bmp, uint16
     iot_i2s_lcd_write(i2s_lcd_handle, bmp, x_size * y_size * device->pix);
 }
 
-void iot_nt35510_put_char(nt35510_handle_t nt35510_handle, uint8_t *str, uint16_t x, uint16_t y, uint16_t x_size, uint16_t y_size, uint16_t wcolor, uint16_t bcolor)
+typedef struct {
+    const uint8_t *bits;    /*!< 1 bit per pixel, rows of w / 8 bytes, MSB first */
+    uint16_t wcolor;
+    uint16_t bcolor;
+} nt35510_glyph_t;
+
+static void nt35510_glyph_render(uint16_t *buf, uint16_t w, uint16_t h, void *arg)
 {
-    uint16_t *pbuf;
-    uint8_t *pdata = str;
-    nt35510_dev_t *device = (nt35510_dev_t *)nt35510_handle;
-    for (int i = 0; i < y_size; i++) {
-        pbuf = device->lcd_buf + (x + (i + y) * device->x_size);
-        for (int j = 0; j < x_size / 8; j++) {
+    nt35510_glyph_t *glyph = (nt35510_glyph_t *)arg;
+    const uint8_t *pdata = glyph->bits;
+    for (int i = 0; i < h; i++) {
+        for (int j = 0; j < w / 8; j++) {
             for (int k = 0; k < 8; k++) {
-                if (*pdata & (0x80 >> k)) {
-                    *pbuf = wcolor;
-                } else {
-                    *pbuf = bcolor;
-                }
-                pbuf++;
+                *buf++ = (*pdata & (0x80 >> k)) ? glyph->wcolor : glyph->bcolor;
             }
             pdata++;
         }
     }
-    iot_nt35510_refresh(nt35510_handle);
+}
+
+/* Keep lcd_buf in step with the panel, so that iot_nt35510_refresh does not wipe the text */
+static void nt35510_glyph_to_buf(nt35510_dev_t *device, const uint16_t *pixels, uint16_t x, uint16_t y, uint16_t x_size, uint16_t y_size)
+{
+    if (x + x_size > device->x_size || (uint32_t)(y + y_size) * device->x_size > device->lcd_buf_len) {
+        return;
+    }
+    for (int i = 0; i < y_size; i++) {
+        memcpy(device->lcd_buf + x + (y + i) * device->x_size, pixels + i * x_size, sizeof(uint16_t) * x_size);
+    }
+}
+
+/*
+ * Send one character to its own window. Font glyphs are rendered once and then served from
+ * the glyph cache, bitmaps of the caller (font NULL) are rendered every time.
+ */
+static void nt35510_draw_glyph(nt35510_handle_t nt35510_handle, const void *font, uint32_t ch, const uint8_t *bits, uint16_t x, uint16_t y,
+                               uint16_t x_size, uint16_t y_size, uint16_t wcolor, uint16_t bcolor)
+{
+    nt35510_dev_t *device = (nt35510_dev_t *)nt35510_handle;
+    nt35510_glyph_t glyph = { bits, wcolor, bcolor };
+    const uint16_t *pixels = NULL;
+    if (font != NULL) {
+        pixels = iot_glyph_cache_get(device->glyph_cache, font, ch,
+                                     wcolor, bcolor, x_size, y_size, nt35510_glyph_render, &glyph);
+    }
+    if (pixels != NULL) {
+        iot_nt35510_draw_bmp(nt35510_handle, (uint16_t *)pixels, x, y, x_size, y_size);
+        nt35510_glyph_to_buf(device, pixels, x, y, x_size, y_size);
+        return;
+    }
+    uint16_t *buf = malloc(sizeof(uint16_t) * x_size * y_size);
+    if (buf == NULL) {
+        LCD_LOG("malloc fail\n");
+        return;
+    }
+    nt35510_glyph_render(buf, x_size, y_size, &glyph);
+    iot_nt35510_draw_bmp(nt35510_handle, buf, x, y, x_size, y_size);
+    nt35510_glyph_to_buf(device, buf, x, y, x_size, y_size);
+    free(buf);
+}
+
+void iot_nt35510_put_char(nt35510_handle_t nt35510_handle, uint8_t *str, uint16_t x, uint16_t y, uint16_t x_size, uint16_t y_size, uint16_t wcolor, uint16_t bcolor)
+{
+    nt35510_draw_glyph(nt35510_handle, NULL, 0, str, x, y, x_size, y_size, wcolor, bcolor);
 }
 
 void iot_nt35510_asc8x16_to_men(nt35510_handle_t nt35510_handle, char str, uint16_t x, uint16_t y, uint16_t wcolor, uint16_t bcolor)
@@ -160,6 +190,9 @@ void iot_nt35510_asc8x16_to_men(nt35510_handle_t nt35510_handle, char str, uint1
     uint16_t *pbuf;
     uint8_t *pdata = (uint8_t *)(font_asc8x16 + (str - ' ') * 16);
     nt35510_dev_t *device = (nt35510_dev_t *)nt35510_handle;
+    if (x + 8 > device->x_size || (uint32_t)(y + 16) * device->x_size > device->lcd_buf_len) {
+        return;
+    }
     for (int i = 0; i < 16; i++) {
         pbuf = device->lcd_buf + (x + (i + y) * device->x_size);
         for (int k = 0; k < 8; k++) {
@@ -176,8 +209,7 @@ void iot_nt35510_asc8x16_to_men(nt35510_handle_t nt35510_handle, char str, uint1
 
 void iot_nt35510_put_asc8x16(nt35510_handle_t nt35510_handle, char str, uint16_t x, uint16_t y, uint16_t wcolor, uint16_t bcolor)
 {
-    iot_nt35510_asc8x16_to_men(nt35510_handle, str, x, y, wcolor, bcolor);
-    iot_nt35510_refresh(nt35510_handle);
+    nt35510_draw_glyph(nt35510_handle, font_asc8x16, str, font_asc8x16 + (str - ' ') * 16, x, y, 8, 16, wcolor, bcolor);
 }
 
 void iot_nt35510_put_string8x16(nt35510_handle_t nt35510_handle, char *str, uint16_t x, uint16_t y, uint16_t wcolor, uint16_t bcolor)
@@ -186,7 +218,7 @@ void iot_nt35510_put_string8x16(nt35510_handle_t nt35510_handle, char *str, uint
     uint32_t y_offset = 0;
     nt35510_dev_t *device = (nt35510_dev_t *)nt35510_handle;
     while (*str != '\0') {
-        iot_nt35510_asc8x16_to_men(nt35510_handle, *str, x + x_ofsset, y + y_offset, wcolor, bcolor);
+        iot_nt35510_put_asc8x16(nt35510_handle, *str, x + x_ofsset, y + y_offset, wcolor, bcolor);
         x_ofsset = x_ofsset + 8;
         if (x_ofsset > device->x_size - 8) {
             y_offset += 16;
@@ -197,7 +229,6 @@ void iot_nt35510_put_string8x16(nt35510_handle_t nt35510_handle, char *str, uint
         }
         str++;
     }
-    iot_nt35510_refresh(nt35510_handle);
 }
 
 void iot_nt35510_init(nt35510_handle_t nt35510_handle)
@@ -603,12 +634,22 @@ nt35510_handle_t iot_nt35510_create(uint16_t x_size, uint16_t y_size, i2s_port_t
     device->xset_cmd = NT35510_CASET;
     device->yset_cmd = NT35510_RASET;
     device->pix = sizeof(uint16_t);
-    uint16_t *p = malloc(sizeof(uint16_t) * y_size);
+    // one line, long enough for either orientation, unless a whole frame is asked for
+    uint32_t len = x_size > y_size ? x_size : y_size;
+#ifdef CONFIG_NT35510_FRAME_BUFFER
+    len = (uint32_t)x_size * y_size;
+#endif
+    uint16_t *p = malloc(sizeof(uint16_t) * len);
     if (p == NULL) {
         LCD_LOG("malloc fail\n");
         goto error;
     }
     device->lcd_buf = p;
+    device->lcd_buf_len = len;
+    device->glyph_cache = iot_glyph_cache_create(NT35510_GLYPH_CACHE_NUM, NT35510_GLYPH_MAX_PIXELS);
+    if (device->glyph_cache == NULL) {
+        LCD_LOG("glyph cache create fail\n");
+    }
     device->i2s_lcd_handle = iot_i2s_lcd_pin_cfg(i2s_port, pin_conf);
     iot_nt35510_init((nt35510_handle_t)device);
     return (nt35510_handle_t)device;
@@ -618,4 +659,18 @@ error:
         free(device);
     }
     return NULL;
-}
\ No newline at end of file
+}
+
+esp_err_t iot_nt35510_delete(nt35510_handle_t nt35510_handle)
+{
+    nt35510_dev_t *device = (nt35510_dev_t *)nt35510_handle;
+    if (device == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (device->glyph_cache) {
+        iot_glyph_cache_delete(device->glyph_cache);
+    }
+    free(device->lcd_buf);
+    free(device);
+    return ESP_OK;
+}
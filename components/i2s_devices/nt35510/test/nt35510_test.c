@@ -15,6 +15,7 @@
 #include <string.h>
 #include "unity.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "driver/i2c.h"
 #include "iot_ft5x06.h"
 #include "iot_i2c_bus.h"
@@ -49,6 +50,7 @@
 #define LCD_WR_PIN        (18)
 #define LCD_RS_PIN        (5)
 
+static const char *TAG = "NT35510";
 static nt35510_handle_t nt35510_handle;
 
 //Store the touch information
@@ -80,23 +82,8 @@ static void touch_task(void *param)
     }
 }
 
-static void pic_slide_tset(void)
+static nt35510_handle_t nt35510_test_create(void)
 {
-    uint16_t *raw = NULL;
-    uint16_t *buf = NULL;
-    uint16_t pox = 0;
-    float stepx = 1.0;
-    float stepy = 1.0;
-    float k = 1.0;
-    float m = 1.0;
-    uint16_t lenx = 0;
-    uint16_t leny = 0;
-    uint16_t len = 0;
-    uint16_t offsetx = 0;
-    uint16_t i, j;
-    uint16_t idx = 0;
-    uint16_t idy = 0;
-    int cnt = 0;
     i2s_lcd_config_t i2s_lcd_pin_conf = {
 #ifdef CONFIG_BIT_MODE_8BIT
         .data_width = 8,
@@ -116,7 +103,27 @@ static void pic_slide_tset(void)
         .ws_io_num = LCD_WR_PIN,
         .rs_io_num = LCD_RS_PIN,
     };
-    nt35510_handle = iot_nt35510_create(480, 800, I2S_PORT_NUM, &i2s_lcd_pin_conf);
+    return iot_nt35510_create(480, 800, I2S_PORT_NUM, &i2s_lcd_pin_conf);
+}
+
+static void pic_slide_tset(void)
+{
+    uint16_t *raw = NULL;
+    uint16_t *buf = NULL;
+    uint16_t pox = 0;
+    float stepx = 1.0;
+    float stepy = 1.0;
+    float k = 1.0;
+    float m = 1.0;
+    uint16_t lenx = 0;
+    uint16_t leny = 0;
+    uint16_t len = 0;
+    uint16_t offsetx = 0;
+    uint16_t i, j;
+    uint16_t idx = 0;
+    uint16_t idy = 0;
+    int cnt = 0;
+    nt35510_handle = nt35510_test_create();
     nt35510_dev_t *device = (nt35510_dev_t *)nt35510_handle;
     if (nt35510_handle == NULL) {
         LCD_LOG("nt35510 create fail!\n");
@@ -199,3 +206,38 @@ TEST_CASE("Cap picture slide test", "[Cap TFT test][iot][device]")
 {
     pic_slide_tset();
 }
+
+
+TEST_CASE("NT35510 fill test", "[Cap TFT test][iot][device]")
+{
+    const uint16_t colors[] = { 0xf800, 0x07e0, 0x001f, 0xffff, 0x0000 };
+    if (nt35510_handle == NULL) {
+        nt35510_handle = nt35510_test_create();
+    }
+    TEST_ASSERT(nt35510_handle != NULL);
+    nt35510_dev_t *device = (nt35510_dev_t *)nt35510_handle;
+    iot_nt35510_set_orientation(nt35510_handle, LCD_DISP_ROTATE_270);
+
+    // The per-row loop fill_screen used before the repeat fill
+    int64_t t0 = esp_timer_get_time();
+    iot_nt35510_set_box(nt35510_handle, 0, 0, device->x_size, device->y_size);
+    for (int i = 0; i < device->x_size; i++) {
+        device->lcd_buf[i] = colors[0];
+    }
+    for (int i = 0; i < device->y_size; i++) {
+        iot_i2s_lcd_write(device->i2s_lcd_handle, device->lcd_buf, device->x_size * device->pix);
+    }
+    int64_t row_us = esp_timer_get_time() - t0;
+
+    t0 = esp_timer_get_time();
+    for (int i = 0; i < sizeof(colors) / sizeof(colors[0]); i++) {
+        iot_nt35510_fill_screen(nt35510_handle, colors[i]);
+    }
+    int64_t fill_us = (esp_timer_get_time() - t0) / (sizeof(colors) / sizeof(colors[0]));
+    ESP_LOGI(TAG, "%dx%d clear: per-row %lld us, repeat fill %lld us", device->x_size, device->y_size, row_us, fill_us);
+
+    for (int i = 0; i < 8; i++) {
+        iot_nt35510_fill_rect(nt35510_handle, colors[i % 3], i * 50, i * 30, 200, 120);
+    }
+    vTaskDelay(1000 / portTICK_PERIOD_MS);
+}
@@ -27,6 +27,7 @@
 #include "freertos/ringbuf.h"
 #include "epaper.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
 
 static const char* TAG = "epaper";
 
@@ -34,6 +35,8 @@ static const char* TAG = "epaper";
 #define EPAPER_CS_HOLD_NS       60
 #define EPAPER_1S_NS            1000000000
 #define EPAPER_QUE_SIZE_DEFAULT 10
+#define EPAPER_DMA_CHUNK_DEFAULT    4000    // bytes, below the 4094 byte limit of one DMA transfer
+#define EPAPER_BUSY_RECHECK_MS      100     // re-read the busy pin in case an edge was missed
 
 const unsigned char lut_vcom_dc[] = { 0x00, 0x00, 0x00, 0x0F, 0x0F, 0x00, 0x00,
         0x05, 0x00, 0x32, 0x32, 0x00, 0x00, 0x02, 0x00, 0x0F, 0x0F, 0x00, 0x00,
@@ -61,10 +64,6 @@ const unsigned char lut_wb[] = { 0xA0, 0x0F, 0x0F, 0x00, 0x00, 0x05, 0x60, 0x32,
         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
 
-static portMUX_TYPE epaper_spinlock = portMUX_INITIALIZER_UNLOCKED;
-#define EPAPER_ENTER_CRITICAL(mux)    portENTER_CRITICAL(mux)
-#define EPAPER_EXIT_CRITICAL(mux)     portEXIT_CRITICAL(mux)
-
 // LCD data/command
 typedef struct {
     uint8_t dc_io;
@@ -77,6 +76,9 @@ typedef struct {
     epaper_paint_t paint;   /* Paint properties */
     epaper_dc_t dc;
     xSemaphoreHandle spi_mux;
+    uint8_t *dma_buf;       /* bulk data is copied here and sent dma_chunk_size bytes at a time */
+    int dma_chunk_size;
+    xSemaphoreHandle busy_sem;  /* given by the busy pin interrupt when the panel becomes idle */
 } epaper_dev_t;
 
 /*This function is called (in irq context!) just before a transmission starts.
@@ -128,11 +130,58 @@ static void iot_epaper_send_data(epaper_handle_t dev, const uint8_t *data, int l
     epaper_dev_t* device = (epaper_dev_t*) dev;
     device->dc.dc_io = device->pin.dc_pin;
     device->dc.dc_level = device->pin.dc_lev_data;
-    // This SPI slave only support slow write mode
-    // We can just send data byte by byte.
-    int idx = 0;
-    while(idx < length) {
-        iot_epaper_send_byte(dev, data[idx++]);
+    // Source data may sit in flash, stage it in the DMA buffer one chunk at a time
+    while (length > 0) {
+        int len = length > device->dma_chunk_size ? device->dma_chunk_size : length;
+        memcpy(device->dma_buf, data, len);
+        iot_epaper_send(device->bus, device->dma_buf, len, &device->dc);
+        data += len;
+        length -= len;
+    }
+}
+
+/* Send a w x h window of a full frame, w and x are in bytes, rows are packed into DMA chunks */
+static void iot_epaper_send_window(epaper_handle_t dev, const uint8_t *frame, int x, int y, int w, int h)
+{
+    epaper_dev_t* device = (epaper_dev_t*) dev;
+    int stride = device->paint.width / 8;
+    int rows_per_chunk = device->dma_chunk_size / w;
+    device->dc.dc_io = device->pin.dc_pin;
+    device->dc.dc_level = device->pin.dc_lev_data;
+    if (rows_per_chunk == 0) {
+        for (int row = 0; row < h; row++) {
+            iot_epaper_send_data(dev, frame + (y + row) * stride + x, w);
+        }
+        return;
+    }
+    for (int row = 0; row < h; row += rows_per_chunk) {
+        int rows = h - row > rows_per_chunk ? rows_per_chunk : h - row;
+        for (int i = 0; i < rows; i++) {
+            memcpy(device->dma_buf + i * w, frame + (y + row + i) * stride + x, w);
+        }
+        iot_epaper_send(device->bus, device->dma_buf, rows * w, &device->dc);
+    }
+}
+
+static void iot_epaper_send_window_pos(epaper_handle_t dev, int x, int y, int w, int h)
+{
+    iot_epaper_send_byte(dev, x >> 8);
+    iot_epaper_send_byte(dev, x & 0xf8);    // x and w must be multiples of 8
+    iot_epaper_send_byte(dev, y >> 8);
+    iot_epaper_send_byte(dev, y & 0xff);
+    iot_epaper_send_byte(dev, w >> 8);
+    iot_epaper_send_byte(dev, w & 0xf8);
+    iot_epaper_send_byte(dev, h >> 8);
+    iot_epaper_send_byte(dev, h & 0xff);
+}
+
+static void IRAM_ATTR iot_epaper_busy_isr(void *arg)
+{
+    epaper_dev_t* device = (epaper_dev_t*) arg;
+    portBASE_TYPE task_woken = pdFALSE;
+    xSemaphoreGiveFromISR(device->busy_sem, &task_woken);
+    if (task_woken == pdTRUE) {
+        portYIELD_FROM_ISR();
     }
 }
 
@@ -161,6 +210,22 @@ static void iot_epaper_gpio_init(epaper_conf_t * pin)
     gpio_set_pull_mode(pin->busy_pin, GPIO_PULLUP_ONLY);
 }
 
+static esp_err_t iot_epaper_busy_intr_init(epaper_dev_t* dev, epaper_conf_t *pin)
+{
+    dev->busy_sem = xSemaphoreCreateBinary();
+    if (dev->busy_sem == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    // The service may already be installed by another driver
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        return ret;
+    }
+    // The busy pin goes high once the panel is idle again
+    gpio_set_intr_type(pin->busy_pin, GPIO_INTR_POSEDGE);
+    return gpio_isr_handler_add(pin->busy_pin, iot_epaper_busy_isr, dev);
+}
+
 static esp_err_t iot_epaper_spi_init(epaper_handle_t dev, spi_device_handle_t *e_spi, epaper_conf_t *pin)
 {
     esp_err_t ret;
@@ -269,15 +334,35 @@ static void iot_epaper_epd_init(epaper_handle_t dev)
 
 epaper_handle_t iot_epaper_create(spi_device_handle_t bus, epaper_conf_t *epconf)
 {
+    uint8_t* frame_buf = NULL;
     epaper_dev_t* dev = (epaper_dev_t*) calloc(1, sizeof(epaper_dev_t));
+    if (dev == NULL) {
+        ESP_LOGE(TAG, "dev malloc fail\r\n");
+        return NULL;
+    }
     dev->spi_mux = xSemaphoreCreateRecursiveMutex();
-    uint8_t* frame_buf = (unsigned char*) heap_caps_malloc(
+    if (dev->spi_mux == NULL) {
+        ESP_LOGE(TAG, "spi mutex create fail\r\n");
+        goto error;
+    }
+    frame_buf = (unsigned char*) heap_caps_malloc(
             (epconf->width * epconf->height / 8), MALLOC_CAP_8BIT);
     if (frame_buf == NULL) {
         ESP_LOGE(TAG, "frame_buffer malloc fail\r\n");
-        return NULL;
+        goto error;
+    }
+    dev->dma_chunk_size = epconf->dma_chunk_size > 0 ? epconf->dma_chunk_size : EPAPER_DMA_CHUNK_DEFAULT;
+    dev->dma_buf = (uint8_t*) heap_caps_malloc(dev->dma_chunk_size, MALLOC_CAP_DMA);
+    if (dev->dma_buf == NULL) {
+        ESP_LOGE(TAG, "dma buffer malloc fail\r\n");
+        goto error;
     }
     iot_epaper_gpio_init(epconf);
+    if (iot_epaper_busy_intr_init(dev, epconf) != ESP_OK && dev->busy_sem) {
+        ESP_LOGW(TAG, "busy pin interrupt unavailable, polling instead");
+        vSemaphoreDelete(dev->busy_sem);
+        dev->busy_sem = NULL;
+    }
     ESP_LOGD(TAG, "gpio init ok");
     if (bus) {
         dev->bus = bus;
@@ -289,12 +374,26 @@ epaper_handle_t iot_epaper_create(spi_device_handle_t bus, epaper_conf_t *epconf
     iot_epaper_epd_init(dev);
     iot_epaper_paint_init(dev, frame_buf, epconf->width, epconf->height);
     return (epaper_handle_t) dev;
+
+error:
+    free(frame_buf);
+    if (dev->spi_mux) {
+        vSemaphoreDelete(dev->spi_mux);
+    }
+    free(dev);
+    return NULL;
 }
 
 esp_err_t iot_epaper_delete(epaper_handle_t dev, bool del_bus)
 {
     epaper_dev_t* device = (epaper_dev_t*) dev;
     iot_epaper_send_command(dev, E_PAPER_POWER_OFF);
+    gpio_isr_handler_remove(device->pin.busy_pin);
+    gpio_set_intr_type(device->pin.busy_pin, GPIO_INTR_DISABLE);
+    if (device->busy_sem) {
+        vSemaphoreDelete(device->busy_sem);
+    }
+    free(device->dma_buf);
     spi_bus_remove_device(device->bus);
     if (del_bus) {
         spi_bus_free(device->pin.spi_host);
@@ -360,42 +459,212 @@ unsigned char* iot_epaper_get_image(epaper_handle_t dev)
     return device->paint.image;
 }
 
-/**
- *  @brief: this draws a pixel by absolute coordinates.
- *          this function won't be affected by the rotate parameter.
- */
-static void iot_epaper_draw_absolute_pixel(epaper_handle_t dev, int x, int y, int colored)
+/* Paint helpers below work on absolute coordinates of the frame buffer and expect the caller to hold spi_mux */
+
+static inline bool epaper_paint_bit(epaper_dev_t* device, int colored)
+{
+    return device->pin.color_inv ? (colored != 0) : (colored == 0);
+}
+
+static inline void epaper_paint_apply(uint8_t *dst, uint8_t mask, bool set)
+{
+    if (set) {
+        *dst |= mask;
+    } else {
+        *dst &= ~mask;
+    }
+}
+
+static inline void epaper_paint_abs_pixel(epaper_dev_t* device, int x, int y, bool set)
 {
-    epaper_dev_t* device = (epaper_dev_t*) dev;
     if (x < 0 || x >= device->paint.width || y < 0 || y >= device->paint.height) {
         return;
     }
-    EPAPER_ENTER_CRITICAL(&epaper_spinlock);
-    if (device->pin.color_inv) {
-        if (colored) {
-            device->paint.image[(x + y * device->paint.width) / 8] |= 0x80 >> (x % 8);
-        } else {
-            device->paint.image[(x + y * device->paint.width) / 8] &= ~(0x80 >> (x % 8));
-        }
+    epaper_paint_apply(&device->paint.image[(x + y * device->paint.width) / 8], 0x80 >> (x % 8), set);
+}
+
+/* Fill pixels x0..x1 of row y, the edge bytes are masked and the bytes between are memset */
+static void epaper_paint_abs_span(epaper_dev_t* device, int x0, int x1, int y, bool set)
+{
+    uint8_t *row = device->paint.image + y * (device->paint.width / 8);
+    int b0 = x0 / 8;
+    int b1 = x1 / 8;
+    uint8_t m0 = 0xff >> (x0 % 8);
+    uint8_t m1 = 0xff << (7 - x1 % 8);
+    if (b0 == b1) {
+        epaper_paint_apply(&row[b0], m0 & m1, set);
+        return;
+    }
+    epaper_paint_apply(&row[b0], m0, set);
+    if (b1 - b0 > 1) {
+        memset(row + b0 + 1, set ? 0xff : 0x00, b1 - b0 - 1);
+    }
+    epaper_paint_apply(&row[b1], m1, set);
+}
+
+static void epaper_paint_abs_rect(epaper_dev_t* device, int x0, int y0, int x1, int y1, bool set)
+{
+    x0 = x0 < 0 ? 0 : x0;
+    y0 = y0 < 0 ? 0 : y0;
+    x1 = x1 >= device->paint.width ? device->paint.width - 1 : x1;
+    y1 = y1 >= device->paint.height ? device->paint.height - 1 : y1;
+    for (int y = y0; y <= y1 && x0 <= x1; y++) {
+        epaper_paint_abs_span(device, x0, x1, y, set);
+    }
+}
+
+/* Size of the drawing area as seen through the rotation */
+static inline void epaper_paint_logic_size(epaper_dev_t* device, int *w, int *h)
+{
+    if (device->paint.rotate == E_PAPER_ROTATE_90 || device->paint.rotate == E_PAPER_ROTATE_270) {
+        *w = device->paint.height;
+        *h = device->paint.width;
     } else {
-        if (colored) {
-            device->paint.image[(x + y * device->paint.width) / 8] &= ~(0x80 >> (x % 8));
-        } else {
-            device->paint.image[(x + y * device->paint.width) / 8] |= 0x80 >> (x % 8);
+        *w = device->paint.width;
+        *h = device->paint.height;
+    }
+}
+
+/* Map rotated coordinates to the frame buffer */
+static inline void epaper_paint_map(epaper_dev_t* device, int *x, int *y)
+{
+    int point_temp = *x;
+    switch (device->paint.rotate) {
+        case E_PAPER_ROTATE_90:
+            *x = device->paint.width - *y;
+            *y = point_temp;
+            break;
+        case E_PAPER_ROTATE_180:
+            *x = device->paint.width - *x;
+            *y = device->paint.height - *y;
+            break;
+        case E_PAPER_ROTATE_270:
+            *x = *y;
+            *y = device->paint.height - point_temp;
+            break;
+        default:
+            break;
+    }
+}
+
+static void epaper_paint_pixel(epaper_dev_t* device, int x, int y, bool set)
+{
+    int w, h;
+    epaper_paint_logic_size(device, &w, &h);
+    if (x < 0 || x >= w || y < 0 || y >= h) {
+        return;
+    }
+    epaper_paint_map(device, &x, &y);
+    epaper_paint_abs_pixel(device, x, y, set);
+}
+
+/* A rotated rectangle is still a rectangle, so clip it, map two corners and fill spans */
+static void epaper_paint_rect(epaper_dev_t* device, int x0, int y0, int x1, int y1, bool set)
+{
+    int w, h, tmp;
+    epaper_paint_logic_size(device, &w, &h);
+    x0 = x0 < 0 ? 0 : x0;
+    y0 = y0 < 0 ? 0 : y0;
+    x1 = x1 >= w ? w - 1 : x1;
+    y1 = y1 >= h ? h - 1 : y1;
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+    epaper_paint_map(device, &x0, &y0);
+    epaper_paint_map(device, &x1, &y1);
+    if (x0 > x1) {
+        tmp = x0;
+        x0 = x1;
+        x1 = tmp;
+    }
+    if (y0 > y1) {
+        tmp = y0;
+        y0 = y1;
+        y1 = tmp;
+    }
+    epaper_paint_abs_rect(device, x0, y0, x1, y1, set);
+}
+
+/* OR or clear up to 8 bits, MSB first, into row y starting at absolute x */
+static inline void epaper_paint_abs_bits(epaper_dev_t* device, int x, int y, uint8_t bits, bool set)
+{
+    uint8_t *row = device->paint.image + y * (device->paint.width / 8);
+    if (x < 0) {
+        /* Bits left of the buffer are already masked off by the caller */
+        bits <<= -x;
+        x = 0;
+    }
+    int shift = x % 8;
+    epaper_paint_apply(&row[x / 8], bits >> shift, set);
+    if (shift && (uint8_t) (bits << (8 - shift))) {
+        epaper_paint_apply(&row[x / 8 + 1], bits << (8 - shift), set);
+    }
+}
+
+static void epaper_paint_char(epaper_dev_t* device, int x, int y, char ascii_char, epaper_font_t* font, bool set)
+{
+    int w, h;
+    int row_bytes = font->width / 8 + (font->width % 8 ? 1 : 0);
+    const unsigned char* ptr = &font->font_table[(ascii_char - ' ') * font->height * row_bytes];
+    epaper_paint_logic_size(device, &w, &h);
+    /* Clip the glyph to the drawing area once instead of testing every pixel */
+    int i0 = x < 0 ? -x : 0;
+    int j0 = y < 0 ? -y : 0;
+    int i1 = x + font->width > w ? w - x : font->width;
+    int j1 = y + font->height > h ? h - y : font->height;
+    if (i0 >= i1 || j0 >= j1) {
+        return;
+    }
+    if (device->paint.rotate == E_PAPER_ROTATE_0) {
+        /* Glyph rows line up with frame buffer rows, shift whole font bytes in */
+        for (int j = j0; j < j1; j++) {
+            for (int k = i0 / 8; k * 8 < i1; k++) {
+                int lo = i0 > k * 8 ? i0 - k * 8 : 0;
+                int hi = i1 < k * 8 + 8 ? i1 - k * 8 : 8;
+                uint8_t bits = ptr[j * row_bytes + k] & (0xff >> lo) & (uint8_t) (0xff << (8 - hi));
+                if (bits) {
+                    epaper_paint_abs_bits(device, x + k * 8, y + j, bits, set);
+                }
+            }
+        }
+        return;
+    }
+    /* Frame buffer steps for one glyph column (di) and one glyph row (dj) */
+    int dix = 0, diy = 0, djx = 0, djy = 0;
+    switch (device->paint.rotate) {
+        case E_PAPER_ROTATE_90:
+            diy = 1;
+            djx = -1;
+            break;
+        case E_PAPER_ROTATE_180:
+            dix = -1;
+            djy = -1;
+            break;
+        default:
+            diy = -1;
+            djx = 1;
+            break;
+    }
+    int ax = x, ay = y;
+    epaper_paint_map(device, &ax, &ay);
+    for (int j = j0; j < j1; j++) {
+        const unsigned char* row = ptr + j * row_bytes;
+        int px = ax + i0 * dix + j * djx;
+        int py = ay + i0 * diy + j * djy;
+        for (int i = i0; i < i1; i++, px += dix, py += diy) {
+            if (row[i / 8] & (0x80 >> (i % 8))) {
+                epaper_paint_abs_pixel(device, px, py, set);
+            }
         }
     }
-    EPAPER_EXIT_CRITICAL(&epaper_spinlock);
 }
 
 void iot_epaper_clean_paint(epaper_handle_t dev, int colored)
 {
     epaper_dev_t* device = (epaper_dev_t*) dev;
     xSemaphoreTakeRecursive(device->spi_mux, portMAX_DELAY);
-    for (int x = 0; x < device->paint.width; x++) {
-        for (int y = 0; y < device->paint.height; y++) {
-            iot_epaper_draw_absolute_pixel(dev, x, y, colored);
-        }
-    }
+    memset(device->paint.image, epaper_paint_bit(device, colored) ? 0xff : 0x00,
+            device->paint.width / 8 * device->paint.height);
     xSemaphoreGiveRecursive(device->spi_mux);
 }
 
@@ -405,19 +674,18 @@ void iot_epaper_clean_paint(epaper_handle_t dev, int colored)
 void iot_epaper_draw_string(epaper_handle_t dev, int x, int y, const char* text, epaper_font_t* font, int colored)
 {
     const char* p_text = text;
-    unsigned int counter = 0;
     int refcolumn = x;
     epaper_dev_t* device = (epaper_dev_t*) dev;
+    bool set = epaper_paint_bit(device, colored);
     xSemaphoreTakeRecursive(device->spi_mux, portMAX_DELAY);
     /* Send the string character by character on EPD */
     while (*p_text != 0) {
         /* Display one character on EPD */
-        iot_epaper_draw_char(dev, refcolumn, y, *p_text, font, colored);
+        epaper_paint_char(device, refcolumn, y, *p_text, font, set);
         /* Decrement the column position by 16 */
         refcolumn += font->width;
         /* Point on the next character */
         p_text++;
-        counter++;
     }
     xSemaphoreGiveRecursive(device->spi_mux);
 }
@@ -427,37 +695,10 @@ void iot_epaper_draw_string(epaper_handle_t dev, int x, int y, const char* text,
  */
 void iot_epaper_draw_pixel(epaper_handle_t dev, int x, int y, int colored)
 {
-    int point_temp;
     epaper_dev_t* device = (epaper_dev_t*) dev;
-    if (device->paint.rotate == E_PAPER_ROTATE_0) {
-        if (x < 0 || x >= device->paint.width || y < 0 || y >= device->paint.height) {
-            return;
-        }
-        iot_epaper_draw_absolute_pixel(dev, x, y, colored);
-    } else if (device->paint.rotate == E_PAPER_ROTATE_90) {
-        if (x < 0 || x >= device->paint.height || y < 0 || y >= device->paint.width) {
-            return;
-        }
-        point_temp = x;
-        x = device->paint.width - y;
-        y = point_temp;
-        iot_epaper_draw_absolute_pixel(dev, x, y, colored);
-    } else if (device->paint.rotate == E_PAPER_ROTATE_180) {
-        if (x < 0 || x >= device->paint.width || y < 0 || y >= device->paint.height) {
-            return;
-        }
-        x = device->paint.width - x;
-        y = device->paint.height - y;
-        iot_epaper_draw_absolute_pixel(dev, x, y, colored);
-    } else if (device->paint.rotate == E_PAPER_ROTATE_270) {
-        if (x < 0 || x >= device->paint.height || y < 0 || y >= device->paint.width) {
-            return;
-        }
-        point_temp = x;
-        x = y;
-        y = device->paint.height - point_temp;
-        iot_epaper_draw_absolute_pixel(dev, x, y, colored);
-    }
+    xSemaphoreTakeRecursive(device->spi_mux, portMAX_DELAY);
+    epaper_paint_pixel(device, x, y, epaper_paint_bit(device, colored));
+    xSemaphoreGiveRecursive(device->spi_mux);
 }
 
 /**
@@ -465,24 +706,9 @@ void iot_epaper_draw_pixel(epaper_handle_t dev, int x, int y, int colored)
  */
 void iot_epaper_draw_char(epaper_handle_t dev, int x, int y, char ascii_char, epaper_font_t* font, int colored)
 {
-    int i, j;
-    unsigned int char_offset = (ascii_char - ' ') * font->height * (font->width / 8 + (font->width % 8 ? 1 : 0));
-    const unsigned char* ptr = &font->font_table[char_offset];
     epaper_dev_t* device = (epaper_dev_t*) dev;
     xSemaphoreTakeRecursive(device->spi_mux, portMAX_DELAY);
-    for (j = 0; j < font->height; j++) {
-        for (i = 0; i < font->width; i++) {
-            if (*ptr & (0x80 >> (i % 8))) {
-                iot_epaper_draw_pixel(dev, x + i, y + j, colored);
-            }
-            if (i % 8 == 7) {
-                ptr++;
-            }
-        }
-        if (font->width % 8 != 0) {
-            ptr++;
-        }
-    }
+    epaper_paint_char(device, x, y, ascii_char, font, epaper_paint_bit(device, colored));
     xSemaphoreGiveRecursive(device->spi_mux);
 }
 
@@ -499,9 +725,10 @@ void iot_epaper_draw_line(epaper_handle_t dev, int x0, int y0, int x1, int y1,
     int sy = y0 < y1 ? 1 : -1;
     int err = dx + dy;
     epaper_dev_t* device = (epaper_dev_t*) dev;
+    bool set = epaper_paint_bit(device, colored);
     xSemaphoreTakeRecursive(device->spi_mux, portMAX_DELAY);
     while ((x0 != x1) && (y0 != y1)) {
-        iot_epaper_draw_pixel(dev, x0, y0, colored);
+        epaper_paint_pixel(device, x0, y0, set);
         if (2 * err >= dy) {
             err += dy;
             x0 += sx;
@@ -519,12 +746,9 @@ void iot_epaper_draw_line(epaper_handle_t dev, int x0, int y0, int x1, int y1,
  */
 void iot_epaper_draw_horizontal_line(epaper_handle_t dev, int x, int y, int width, int colored)
 {
-    int i;
     epaper_dev_t* device = (epaper_dev_t*) dev;
     xSemaphoreTakeRecursive(device->spi_mux, portMAX_DELAY);
-    for (i = x; i < x + width; i++) {
-        iot_epaper_draw_pixel(dev, i, y, colored);
-    }
+    epaper_paint_rect(device, x, y, x + width - 1, y, epaper_paint_bit(device, colored));
     xSemaphoreGiveRecursive(device->spi_mux);
 }
 
@@ -533,12 +757,9 @@ void iot_epaper_draw_horizontal_line(epaper_handle_t dev, int x, int y, int widt
  */
 void iot_epaper_draw_vertical_line(epaper_handle_t dev, int x, int y, int height, int colored)
 {
-    int i;
     epaper_dev_t* device = (epaper_dev_t*) dev;
     xSemaphoreTakeRecursive(device->spi_mux, portMAX_DELAY);
-    for (i = y; i < y + height; i++) {
-        iot_epaper_draw_pixel(dev, x, i, colored);
-    }
+    epaper_paint_rect(device, x, y, x, y + height - 1, epaper_paint_bit(device, colored));
     xSemaphoreGiveRecursive(device->spi_mux);
 }
 
@@ -553,11 +774,12 @@ void iot_epaper_draw_rectangle(epaper_handle_t dev, int x0, int y0, int x1, int
     min_y = y1 > y0 ? y0 : y1;
     max_y = y1 > y0 ? y1 : y0;
     epaper_dev_t* device = (epaper_dev_t*) dev;
+    bool set = epaper_paint_bit(device, colored);
     xSemaphoreTakeRecursive(device->spi_mux, portMAX_DELAY);
-    iot_epaper_draw_horizontal_line(dev, min_x, min_y, max_x - min_x + 1, colored);
-    iot_epaper_draw_horizontal_line(dev, min_x, max_y, max_x - min_x + 1, colored);
-    iot_epaper_draw_vertical_line(dev, min_x, min_y, max_y - min_y + 1, colored);
-    iot_epaper_draw_vertical_line(dev, max_x, min_y, max_y - min_y + 1, colored);
+    epaper_paint_rect(device, min_x, min_y, max_x, min_y, set);
+    epaper_paint_rect(device, min_x, max_y, max_x, max_y, set);
+    epaper_paint_rect(device, min_x, min_y, min_x, max_y, set);
+    epaper_paint_rect(device, max_x, min_y, max_x, max_y, set);
     xSemaphoreGiveRecursive(device->spi_mux);
 }
 
@@ -567,16 +789,13 @@ void iot_epaper_draw_rectangle(epaper_handle_t dev, int x0, int y0, int x1, int
 void iot_epaper_draw_filled_rectangle(epaper_handle_t dev, int x0, int y0, int x1, int y1, int colored)
 {
     int min_x, min_y, max_x, max_y;
-    int i;
     min_x = x1 > x0 ? x0 : x1;
     max_x = x1 > x0 ? x1 : x0;
     min_y = y1 > y0 ? y0 : y1;
     max_y = y1 > y0 ? y1 : y0;
     epaper_dev_t* device = (epaper_dev_t*) dev;
     xSemaphoreTakeRecursive(device->spi_mux, portMAX_DELAY);
-    for (i = min_x; i <= max_x; i++) {
-        iot_epaper_draw_vertical_line(dev, i, min_y, max_y - min_y + 1, colored);
-    }
+    epaper_paint_rect(device, min_x, min_y, max_x, max_y, epaper_paint_bit(device, colored));
     xSemaphoreGiveRecursive(device->spi_mux);
 }
 
@@ -592,12 +811,13 @@ void iot_epaper_draw_circle(epaper_handle_t dev, int x, int y, int radius,
     int err = 2 - 2 * radius;
     int e2;
     epaper_dev_t* device = (epaper_dev_t*) dev;
+    bool set = epaper_paint_bit(device, colored);
     xSemaphoreTakeRecursive(device->spi_mux, portMAX_DELAY);
     do {
-        iot_epaper_draw_pixel(dev, x - x_pos, y + y_pos, colored);
-        iot_epaper_draw_pixel(dev, x + x_pos, y + y_pos, colored);
-        iot_epaper_draw_pixel(dev, x + x_pos, y - y_pos, colored);
-        iot_epaper_draw_pixel(dev, x - x_pos, y - y_pos, colored);
+        epaper_paint_pixel(device, x - x_pos, y + y_pos, set);
+        epaper_paint_pixel(device, x + x_pos, y + y_pos, set);
+        epaper_paint_pixel(device, x + x_pos, y - y_pos, set);
+        epaper_paint_pixel(device, x - x_pos, y - y_pos, set);
         e2 = err;
         if (e2 <= y_pos) {
             err += ++y_pos * 2 + 1;
@@ -623,14 +843,12 @@ void iot_epaper_draw_filled_circle(epaper_handle_t dev, int x, int y, int radius
     int err = 2 - 2 * radius;
     int e2;
     epaper_dev_t* device = (epaper_dev_t*) dev;
+    bool set = epaper_paint_bit(device, colored);
     xSemaphoreTakeRecursive(device->spi_mux, portMAX_DELAY);
     do {
-        iot_epaper_draw_pixel(dev, x - x_pos, y + y_pos, colored);
-        iot_epaper_draw_pixel(dev, x + x_pos, y + y_pos, colored);
-        iot_epaper_draw_pixel(dev, x + x_pos, y - y_pos, colored);
-        iot_epaper_draw_pixel(dev, x - x_pos, y - y_pos, colored);
-        iot_epaper_draw_horizontal_line(dev, x + x_pos, y + y_pos, 2 * (-x_pos) + 1, colored);
-        iot_epaper_draw_horizontal_line(dev, x + x_pos, y - y_pos, 2 * (-x_pos) + 1, colored);
+        /* Each span covers the outline pixels at both of its ends */
+        epaper_paint_rect(device, x + x_pos, y + y_pos, x - x_pos, y + y_pos, set);
+        epaper_paint_rect(device, x + x_pos, y - y_pos, x - x_pos, y - y_pos, set);
         e2 = err;
         if (e2 <= y_pos) {
             err += ++y_pos * 2 + 1;
@@ -649,7 +867,12 @@ void iot_epaper_wait_idle(epaper_handle_t dev)
 {
     epaper_dev_t* device = (epaper_dev_t*) dev;
     while (gpio_get_level((gpio_num_t) device->pin.busy_pin) == 0) {      //0: busy, 1: idle
-        vTaskDelay(10 / portTICK_RATE_MS);
+        if (device->busy_sem) {
+            // Sleep until the rising edge, a stale give only costs one more level check
+            xSemaphoreTake(device->busy_sem, EPAPER_BUSY_RECHECK_MS / portTICK_RATE_MS);
+        } else {
+            vTaskDelay(10 / portTICK_RATE_MS);
+        }
     }
 }
 
@@ -682,6 +905,43 @@ void iot_epaper_display_frame(epaper_handle_t dev, const unsigned char* frame_bu
     xSemaphoreGiveRecursive(device->spi_mux);
 }
 
+void iot_epaper_display_partial(epaper_handle_t dev, const unsigned char* frame_buffer, int x, int y, int w, int h)
+{
+    epaper_dev_t* device = (epaper_dev_t*) dev;
+    if (frame_buffer == NULL) {
+        frame_buffer = device->paint.image;
+    }
+    // Widen the window to whole bytes and clip it to the panel
+    w += x % 8;
+    x -= x % 8;
+    w = (w + 7) & ~7;
+    if (x < 0) {
+        w += x;
+        x = 0;
+    }
+    if (y < 0) {
+        h += y;
+        y = 0;
+    }
+    if (x + w > device->paint.width) {
+        w = device->paint.width - x;
+    }
+    if (y + h > device->paint.height) {
+        h = device->paint.height - y;
+    }
+    if (frame_buffer == NULL || w <= 0 || h <= 0) {
+        return;
+    }
+    xSemaphoreTakeRecursive(device->spi_mux, portMAX_DELAY);
+    iot_epaper_send_command(dev, E_PAPER_PARTIAL_DATA_START_TRANSMISSION_2);
+    iot_epaper_send_window_pos(dev, x, y, w, h);
+    iot_epaper_send_window(dev, frame_buffer, x / 8, y, w / 8, h);
+    iot_epaper_send_command(dev, E_PAPER_PARTIAL_DISPLAY_REFRESH);
+    iot_epaper_send_window_pos(dev, x, y, w, h);
+    iot_epaper_wait_idle(dev);
+    xSemaphoreGiveRecursive(device->spi_mux);
+}
+
 void iot_epaper_sleep(epaper_handle_t dev)
 {
     epaper_dev_t* device = (epaper_dev_t*) dev;
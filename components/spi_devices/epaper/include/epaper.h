@@ -105,6 +105,9 @@ typedef struct {
     int width;
     int height;
     bool color_inv;
+
+    int dma_chunk_size;     /* bytes per SPI transfer of frame data, 0 for the default,
+                               keep it within the max transfer size of a bus passed to iot_epaper_create */
 } epaper_conf_t;
 
 typedef void* epaper_handle_t; /*handle of epaper*/
@@ -343,6 +346,20 @@ void iot_epaper_reset(epaper_handle_t dev);
  */
 void iot_epaper_display_frame(epaper_handle_t dev, const unsigned char* frame_buffer);
 
+/**
+ * @brief refresh only a window of the screen
+ *        The window is widened to whole bytes horizontally and taken from a full
+ *        size frame, coordinates are in frame buffer pixels and ignore the rotation.
+ *
+ * @param dev object handle of epaper
+ * @param frame_buffer full frame to take the window from, NULL for the paint buffer
+ * @param x window left
+ * @param y window top
+ * @param w window width
+ * @param h window height
+ */
+void iot_epaper_display_partial(epaper_handle_t dev, const unsigned char* frame_buffer, int x, int y, int w, int h);
+
 /**
  * @brief   After this command is transmitted, the chip would enter the deep-sleep mode to save power.
  * The deep sleep mode would return to standby by hardware reset. The only one parameter is a
@@ -15,7 +15,9 @@
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include <string.h>
+#include <stdlib.h>
 #include "unity.h"
 
 #include "imagedata.h"
@@ -38,6 +40,11 @@
 // Color inverse. 1 or 0 = set or reset a bit if set a colored pixel
 #define IF_INVERT_COLOR 1
 
+// Paint benchmark
+#define BENCH_WIDTH     400
+#define BENCH_HEIGHT    300
+#define BENCH_FRAMES    100
+
 void epaper_test()
 {
     uint32_t cnt = 0;
@@ -91,6 +98,13 @@ void epaper_test()
     printf("EPD Display Fresh. CNT:%d\r\n", cnt++);
     /* Display the frame_buffer */
     iot_epaper_display_frame(device, NULL); /* dispaly the frame buffer */
+
+    /* Update the humidity value only, the window is in frame buffer coordinates */
+    sprintf(hum_str, "%d %%", (uint8_t) esp_random());
+    iot_epaper_draw_filled_rectangle(device, 190, 90, 263, 106, UNCOLORED);
+    iot_epaper_draw_string(device, 190, 90, hum_str, &epaper_font_16, COLORED);
+    iot_epaper_display_partial(device, NULL, 88, 0, 24, 75);
+    printf("EPD Partial Fresh. CNT:%d\r\n", cnt++);
     iot_epaper_delete(device, true);
     printf("after free epaper: heap:%d\n", esp_get_free_heap_size());
 }
@@ -100,3 +114,159 @@ TEST_CASE("ePaper test", "[epaper][iot]")
 {
     epaper_test();
 }
+
+static void epaper_bench_label(epaper_handle_t device)
+{
+    iot_epaper_clean_paint(device, UNCOLORED);
+    iot_epaper_draw_string(device, 10, 8, "@espressif", &epaper_font_12, COLORED);
+    iot_epaper_draw_string(device, 10, 30, "SKU 4711-ABC", &epaper_font_24, COLORED);
+    iot_epaper_draw_string(device, 10, 90, "Price 12.99", &epaper_font_24, COLORED);
+    iot_epaper_draw_string(device, 10, 130, "Best before 2019-01-01", &epaper_font_16, COLORED);
+    iot_epaper_draw_horizontal_line(device, 10, 60, 380, COLORED);
+    iot_epaper_draw_vertical_line(device, 200, 70, 100, COLORED);
+    iot_epaper_draw_rectangle(device, 5, 5, 290, 200, COLORED);
+    iot_epaper_draw_filled_rectangle(device, 220, 120, 280, 180, COLORED);
+    iot_epaper_draw_filled_circle(device, 240, 60, 20, COLORED);
+}
+
+TEST_CASE("ePaper paint benchmark", "[epaper][iot]")
+{
+    epaper_conf_t epaper_conf = {
+        .busy_pin = BUSY_PIN,
+        .cs_pin = CS_PIN,
+        .dc_pin = DC_PIN,
+        .miso_pin = MISO_PIN,
+        .mosi_pin = MOSI_PIN,
+        .reset_pin = RST_PIN,
+        .sck_pin = SCK_PIN,
+
+        .rst_active_level = 0,
+        .dc_lev_data = 1,
+        .dc_lev_cmd = 0,
+
+        .clk_freq_hz = 20 * 1000 * 1000,
+        .spi_host = HSPI_HOST,
+
+        .width = BENCH_WIDTH,
+        .height = BENCH_HEIGHT,
+        .color_inv = 1,
+    };
+    epaper_handle_t device = iot_epaper_create(NULL, &epaper_conf);
+    TEST_ASSERT_NOT_NULL(device);
+    /* Only the paint buffer is timed, the panel is not refreshed */
+    for (int rotate = E_PAPER_ROTATE_0; rotate <= E_PAPER_ROTATE_270; rotate++) {
+        iot_epaper_set_rotate(device, rotate);
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < BENCH_FRAMES; i++) {
+            epaper_bench_label(device);
+        }
+        int64_t cost = esp_timer_get_time() - start;
+        printf("label layout %dx%d, rotate %d: %d us/frame\n", BENCH_WIDTH, BENCH_HEIGHT,
+                rotate * 90, (int) (cost / BENCH_FRAMES));
+    }
+    iot_epaper_delete(device, true);
+}
+
+/* Reference drawing, pixel by pixel through iot_epaper_draw_pixel like the old paint code */
+static void epaper_ref_rect(epaper_handle_t device, int x0, int y0, int x1, int y1, int colored)
+{
+    for (int y = y0 < y1 ? y0 : y1; y <= (y0 < y1 ? y1 : y0); y++) {
+        for (int x = x0 < x1 ? x0 : x1; x <= (x0 < x1 ? x1 : x0); x++) {
+            iot_epaper_draw_pixel(device, x, y, colored);
+        }
+    }
+}
+
+static void epaper_ref_string(epaper_handle_t device, int x, int y, const char* text, epaper_font_t* font, int colored)
+{
+    int row_bytes = font->width / 8 + (font->width % 8 ? 1 : 0);
+    for (; *text != 0; text++, x += font->width) {
+        const unsigned char* ptr = &font->font_table[(*text - ' ') * font->height * row_bytes];
+        for (int j = 0; j < font->height; j++) {
+            for (int i = 0; i < font->width; i++) {
+                if (ptr[j * row_bytes + i / 8] & (0x80 >> (i % 8))) {
+                    iot_epaper_draw_pixel(device, x + i, y + j, colored);
+                }
+            }
+        }
+    }
+}
+
+/* Shapes on the edges and across them, so that the clipping of both paths is compared too */
+static void epaper_span_draw(epaper_handle_t device, bool ref)
+{
+    static const int rects[][4] = {
+        { 0, 0, 0, 0 }, { 3, 5, 60, 9 }, { -7, -3, 12, 20 }, { 150, 250, 300, 300 },
+        { 7, 40, 8, 200 }, { 100, -20, 109, 400 }, { 170, 30, 175, 31 }, { 263, 0, 263, 175 },
+    };
+    int w = iot_epaper_get_rotate(device) % 2 ? EPD_HEIGHT : EPD_WIDTH;
+    int h = iot_epaper_get_rotate(device) % 2 ? EPD_WIDTH : EPD_HEIGHT;
+    for (int i = 0; i < sizeof(rects) / sizeof(rects[0]); i++) {
+        const int *r = rects[i];
+        if (ref) {
+            epaper_ref_rect(device, r[0], r[1], r[2], r[3], COLORED);
+            epaper_ref_rect(device, r[0] + 2, r[1] + 2, r[2] - 2, r[3] - 2, UNCOLORED);
+        } else {
+            iot_epaper_draw_filled_rectangle(device, r[0], r[1], r[2], r[3], COLORED);
+            iot_epaper_draw_filled_rectangle(device, r[0] + 2, r[1] + 2, r[2] - 2, r[3] - 2, UNCOLORED);
+        }
+    }
+    if (ref) {
+        epaper_ref_rect(device, 0, h - 1, w - 1, h - 1, COLORED);
+        epaper_ref_rect(device, w - 1, 0, w - 1, h - 1, COLORED);
+        epaper_ref_rect(device, 20, 60, 20, 60 + 33 - 1, COLORED);
+        epaper_ref_string(device, -5, 70, "Span 09", &epaper_font_24, COLORED);
+        epaper_ref_string(device, w - 40, h - 10, "@esp", &epaper_font_16, COLORED);
+        epaper_ref_string(device, 101, 0, "xyz", &epaper_font_12, UNCOLORED);
+        epaper_ref_string(device, 3, -4, "AB", &epaper_font_8, COLORED);
+    } else {
+        iot_epaper_draw_horizontal_line(device, 0, h - 1, w, COLORED);
+        iot_epaper_draw_vertical_line(device, w - 1, 0, h, COLORED);
+        iot_epaper_draw_vertical_line(device, 20, 60, 33, COLORED);
+        iot_epaper_draw_string(device, -5, 70, "Span 09", &epaper_font_24, COLORED);
+        iot_epaper_draw_string(device, w - 40, h - 10, "@esp", &epaper_font_16, COLORED);
+        iot_epaper_draw_string(device, 101, 0, "xyz", &epaper_font_12, UNCOLORED);
+        iot_epaper_draw_string(device, 3, -4, "AB", &epaper_font_8, COLORED);
+    }
+}
+
+TEST_CASE("ePaper paint span test", "[epaper][iot]")
+{
+    epaper_conf_t epaper_conf = {
+        .busy_pin = BUSY_PIN,
+        .cs_pin = CS_PIN,
+        .dc_pin = DC_PIN,
+        .miso_pin = MISO_PIN,
+        .mosi_pin = MOSI_PIN,
+        .reset_pin = RST_PIN,
+        .sck_pin = SCK_PIN,
+
+        .rst_active_level = 0,
+        .dc_lev_data = 1,
+        .dc_lev_cmd = 0,
+
+        .clk_freq_hz = 20 * 1000 * 1000,
+        .spi_host = HSPI_HOST,
+
+        .width = EPD_WIDTH,
+        .height = EPD_HEIGHT,
+        .color_inv = 1,
+    };
+    int size = EPD_WIDTH * EPD_HEIGHT / 8;
+    uint8_t *ref = malloc(size);
+    TEST_ASSERT_NOT_NULL(ref);
+    epaper_handle_t device = iot_epaper_create(NULL, &epaper_conf);
+    TEST_ASSERT_NOT_NULL(device);
+    for (int rotate = E_PAPER_ROTATE_0; rotate <= E_PAPER_ROTATE_270; rotate++) {
+        iot_epaper_set_rotate(device, rotate);
+        iot_epaper_clean_paint(device, UNCOLORED);
+        epaper_span_draw(device, true);
+        memcpy(ref, iot_epaper_get_image(device), size);
+        iot_epaper_clean_paint(device, UNCOLORED);
+        epaper_span_draw(device, false);
+        printf("span drawing, rotate %d\n", rotate * 90);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(ref, iot_epaper_get_image(device), size);
+    }
+    iot_epaper_delete(device, true);
+    free(ref);
+}
@@ -23,6 +23,7 @@
 #include "driver/spi_master.h"
 #include "esp_partition.h"
 #include "freertos/semphr.h"
+#include "iot_glyph_cache.h"
 
 #define LCD_TFTWIDTH  240
 #define LCD_TFTHEIGHT 320
@@ -35,6 +36,9 @@
 #define LCD_RAMWR   0x2C
 #define LCD_MADCTL  0x36
 
+#define LCD_GLYPH_CACHE_NUM     (48)        /*!< glyphs kept pre-rendered for drawChar */
+#define LCD_GLYPH_MAX_PIXELS    (12 * 16)   /*!< classic font up to text size 2 */
+
 // Color definitions
 #define COLOR_BLACK       0x0000      /*   0,   0,   0 */
 #define COLOR_NAVY        0x000F      /*   0,   0, 128 */
@@ -105,6 +109,49 @@ typedef struct {
     uint8_t dc_level;
 } lcd_dc_t;
 
+/**
+ * @brief pixel for CEspLcd::drawPixels
+ */
+typedef struct {
+    int16_t x;
+    int16_t y;
+    uint16_t color;
+} lcd_point_t;
+
+#define LCD_IMAGE_MAGIC         0x21474d49  /*!< "IMG!" */
+#define LCD_IMAGE_FLAG_SWAPPED  (1 << 0)    /*!< pixels are stored in wire (big endian) byte order */
+
+/**
+ * @brief header in front of an RGB565 image stored in flash, see CEspLcd::drawImageFromFlashPartition
+ */
+typedef struct {
+    uint32_t magic;     /*!< LCD_IMAGE_MAGIC */
+    uint16_t width;     /*!< image width */
+    uint16_t height;    /*!< image height */
+    uint32_t flags;     /*!< LCD_IMAGE_FLAG_xxx */
+    uint32_t reserved;  /*!< keeps the pixels that follow 16 byte aligned */
+} lcd_image_header_t;
+
+/**
+ * @brief handle of a queued LCD transfer pipeline, see lcd_trans_queue_create
+ */
+typedef struct lcd_trans_queue* lcd_trans_queue_handle_t;
+
+/**
+ * @brief completion callback of queued LCD transfers
+ */
+typedef void (*lcd_trans_done_cb_t)(void *arg);
+
+/**
+ * @brief statistics of a queued LCD transfer pipeline
+ */
+typedef struct {
+    uint32_t trans_cnt;     /*!< number of queued transactions */
+    uint32_t bytes_cnt;     /*!< number of queued bytes */
+    uint32_t stall_cnt;     /*!< times the caller had to wait for a free slot */
+    int max_depth;          /*!< maximum number of transactions in flight */
+} lcd_trans_queue_stats_t;
+
 #ifdef __cplusplus
 #include "Adafruit_GFX.h"
 
@@ -121,6 +168,24 @@ private:
     SemaphoreHandle_t spi_mux;
     gpio_num_t cmd_io = GPIO_NUM_MAX;
     lcd_dc_t dc;
+    lcd_trans_queue_handle_t trans_queue = NULL;
+    bool async_mode = false;
+    uint16_t* dma_buf[2] = {NULL, NULL};    /*!< ping-pong DMA buffers of dma_buf_size pixels */
+    uint32_t dma_buf_seq[2];                /*!< last queued transaction that uses each buffer */
+    uint8_t dma_buf_idx;
+    void _sendCmd(uint8_t cmd);
+    void _sendData(const uint8_t* data, int length);
+    void _waitBufFree();
+    bool _hasDmaBuf();
+    uint16_t* _getDmaBuf();
+    void _queueDmaBuf(int point_num, int offset = 0);
+    void _endTrans();
+    bool win_valid = false;                 /*!< cached address window, to skip unchanged CASET/PASET */
+    uint16_t win_x0, win_y0, win_x1, win_y1;
+    glyph_cache_handle_t glyph_cache = NULL; /*!< pre-rendered opaque glyphs of the classic font */
+    void _setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+    esp_err_t _drawBitmapFromFlashSerial(int16_t x, int16_t y, int16_t w, int16_t h, esp_partition_t* data_partition,
+                                         int data_offset, int malloc_pixal_size, bool swap_bytes_en);
 //protected:
 public:
     /*Below are the functions which actually send data, defined in spi_ili.c*/
@@ -146,6 +211,50 @@ public:
     void acquireBus();
     void releaseBus();
 
+    /**
+     * @brief Enable or disable the queued (non-blocking) transfer mode
+     *        In queued mode drawing calls return once their last transaction is in
+     *        the SPI queue, so the caller can render the next band while the
+     *        previous one is still on the wire. Buffers that are sent in place
+     *        must stay valid until waitTransDone returns.
+     * @param en true to enable queued mode, false to drain the queue and go back to blocking mode
+     *
+     * @return
+     *     - ESP_OK on success
+     *     - ESP_ERR_NO_MEM if the transaction ring can not be allocated
+     */
+    esp_err_t setAsyncMode(bool en);
+
+    /**
+     * @brief Wait until all queued transfers are done, no-op in blocking mode
+     * @param ticks_to_wait timeout
+     *
+     * @return
+     *     - ESP_OK on success
+     *     - ESP_ERR_TIMEOUT on timeout
+     */
+    esp_err_t waitTransDone(TickType_t ticks_to_wait = portMAX_DELAY);
+
+    /**
+     * @brief Register a callback for the transfers queued so far
+     *        The callback is called once the last transaction queued before this call
+     *        is finished, from the task context that reaps it. In blocking mode
+     *        the callback is called immediately.
+     * @param cb callback
+     * @param arg callback argument
+     *
+     * @return
+     *     - ESP_OK on success
+     *     - ESP_ERR_INVALID_STATE if a callback is already attached to that point
+     */
+    esp_err_t setTransDoneCallback(lcd_trans_done_cb_t cb, void *arg);
+
+    /**
+     * @brief Get statistics of the queued transfer mode
+     * @param stats pointer to store the statistics, zeroed in blocking mode
+     */
+    void getTransStats(lcd_trans_queue_stats_t *stats);
+
     /**
      * @brief get LCD ID
      */
@@ -164,6 +273,16 @@ public:
      * @param color New color of the pixel
      */
     void drawPixel(int16_t x, int16_t y, uint16_t color);
+
+    /**
+     * @brief Draw a batch of pixels
+     *        Consecutive points in the same row (x increasing by one) are sent
+     *        as one address window, so text or line pixels cost one window set
+     *        per run instead of one per pixel.
+     * @param points array of pixels
+     * @param num number of pixels
+     */
+    void drawPixels(const lcd_point_t *points, int num);
     
     /**
      * @brief Print an array of pixels: Used to display pictures usually
@@ -175,28 +294,72 @@ public:
      */
     void drawBitmap(int16_t x, int16_t y, const uint16_t *bitmap, int16_t w, int16_t h);
 
+    /**
+     * @brief Print an area of a larger pixel array, e.g. part of a frame buffer, in one address window
+     * @param x position X
+     * @param y position Y
+     * @param bitmap pointer to the first pixel of the area
+     * @param w width of the area
+     * @param h height of the area
+     * @param stride number of pixels in one line of the bmp array
+     */
+    void drawBitmap(int16_t x, int16_t y, const uint16_t *bitmap, int16_t w, int16_t h, int16_t stride);
+
     /**
      * @brief Load bitmap data from flash partition and fill the pixels on LCD screen
+     *        The partition is memory mapped and copied chunk by chunk into the two DMA
+     *        buffers, so the next chunk is copied while the last one is on the bus.
      * @param x Start position
      * @param y Start position
      * @param w width of image in bmp array
      * @param h height of image in bmp array
      * @param data_partition Flash storage that contains the bitmap data array.
      * @param data_offset bitmap array begin offset
-     * @param malloc_pixal_size internal buffer size that driver would allocate.
+     * @param malloc_pixal_size buffer size of the fallback path, only used without DMA buffers.
      * @param swap_bytes_en Whether to enable byte swap for each pixel word
      *
      * @return
      *     - ESP_FAIL if partition is NULL
      *     - ESP_OK on success
+     *     - ESP_ERR_NO_MEM no fallback buffer
+     *     - Others flash read error, drawing stops at the failed chunk
      */
     esp_err_t drawBitmapFromFlashPartition(int16_t x, int16_t y, int16_t w, int16_t h, esp_partition_t* data_partition,
             int data_offset = 0, int malloc_pixal_size = 1024, bool swap_bytes_en = true);
+
+    /**
+     * @brief Draw an image stored in flash behind a lcd_image_header_t
+     *        Images flagged LCD_IMAGE_FLAG_SWAPPED are sent as they are, without a byte swap.
+     * @param x Start position
+     * @param y Start position
+     * @param data_partition Flash storage that contains the image
+     * @param data_offset offset of the image header
+     *
+     * @return
+     *     - ESP_FAIL if partition is NULL
+     *     - ESP_ERR_NOT_FOUND no image header at data_offset
+     *     - ESP_OK on success
+     *     - Others flash read error
+     */
+    esp_err_t drawImageFromFlashPartition(int16_t x, int16_t y, const esp_partition_t* data_partition, int data_offset = 0);
     /**
      * @brief Avoid using it, Internal use for main class drawChar API
      */
     void drawBitmapFont(int16_t x, int16_t y, uint8_t w, uint8_t h, const uint16_t *bitmap);
 
+    using Adafruit_GFX::drawChar;
+    /**
+     * @brief Draw a character
+     *        Opaque characters of the classic font are rendered once into a glyph
+     *        cache and sent as one block, others go through Adafruit_GFX.
+     * @param x & y co-ordinates of the top left corner
+     * @param c character
+     * @param color text color
+     * @param bg background color, same as color for transparent text
+     * @param size text size
+     */
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+
 
     /**
      * @brief Draw a Vertical line
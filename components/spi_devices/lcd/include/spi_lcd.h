@@ -21,6 +21,9 @@
 extern "C" {
 #endif
 
+/** Depth of the SPI device queue, also the number of pre-allocated queued transactions */
+#define LCD_TRANS_QUEUE_SIZE  (7)
+
 /** @brief Initialize the LCD by putting some data in the graphics registers
  *
  * @param pin_conf Pointer to the struct with mandatory pins required for the LCD
@@ -55,6 +58,126 @@ void lcd_read_id(spi_device_handle_t spi, lcd_id_t *lcd_id, lcd_dc_t *dc);
  */
 uint32_t lcd_get_id(spi_device_handle_t spi, lcd_dc_t *dc);
 
+/**
+ * @brief Create a queued (non-blocking) transfer pipeline for an LCD device
+ *        The pipeline owns a ring of LCD_TRANS_QUEUE_SIZE pre-allocated transactions.
+ *        While it has transactions pending, the blocking lcd_cmd/lcd_data calls
+ *        must not be used on the same device.
+ *
+ * @param spi SPI device handle of the LCD
+ * @param dc D/C line of the LCD, only dc_io is used
+ *
+ * @return
+ *     - NULL if parameter error or out of memory
+ *     - queue handle otherwise
+ */
+lcd_trans_queue_handle_t lcd_trans_queue_create(spi_device_handle_t spi, lcd_dc_t *dc);
+
+/**
+ * @brief Wait for all pending transactions and free the queue
+ *
+ * @param q queue handle
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG q is NULL
+ */
+esp_err_t lcd_trans_queue_delete(lcd_trans_queue_handle_t q);
+
+/**
+ * @brief Queue a command byte, returns as soon as the transaction is in the driver queue
+ *
+ * @param q queue handle
+ * @param cmd command byte, copied into the transaction
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - others Fail
+ */
+esp_err_t lcd_queue_cmd(lcd_trans_queue_handle_t q, const uint8_t cmd);
+
+/**
+ * @brief Queue a block of data
+ *        Data up to 4 bytes is copied into the transaction. Longer buffers are
+ *        sent in place and must stay valid until the transaction is reaped by
+ *        lcd_trans_queue_wait.
+ *
+ * @param q queue handle
+ * @param data data to send
+ * @param len length in bytes
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - others Fail
+ */
+esp_err_t lcd_queue_data(lcd_trans_queue_handle_t q, const uint8_t *data, int len);
+
+/**
+ * @brief Reap finished transactions until at most max_pending are still in flight
+ *        Transactions finish in the order they were queued, so waiting until
+ *        N are pending means everything but the last N queued is done.
+ *
+ * @param q queue handle
+ * @param max_pending number of transactions allowed to stay in flight, 0 to drain the queue
+ * @param ticks_to_wait timeout for each reaped transaction
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_TIMEOUT timeout
+ */
+esp_err_t lcd_trans_queue_wait(lcd_trans_queue_handle_t q, int max_pending, TickType_t ticks_to_wait);
+
+/**
+ * @brief Get the sequence number of the last queued transaction
+ *        Sequence numbers increase by one for every queued transaction and can be
+ *        passed to lcd_trans_queue_wait_seq later on.
+ */
+uint32_t lcd_trans_queue_seq(lcd_trans_queue_handle_t q);
+
+/**
+ * @brief Reap finished transactions until the transaction with sequence number seq is done
+ *
+ * @param q queue handle
+ * @param seq sequence number returned by lcd_trans_queue_seq
+ * @param ticks_to_wait timeout for each reaped transaction
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_TIMEOUT timeout
+ */
+esp_err_t lcd_trans_queue_wait_seq(lcd_trans_queue_handle_t q, uint32_t seq, TickType_t ticks_to_wait);
+
+/**
+ * @brief Attach a completion callback to the last queued transaction
+ *        The callback is called from the task that reaps that transaction, i.e. from
+ *        a later lcd_queue_xxx or lcd_trans_queue_wait call, never from ISR.
+ *        If nothing is pending it is called immediately.
+ *
+ * @param q queue handle
+ * @param cb callback
+ * @param arg callback argument
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_STATE the last transaction has a callback already
+ */
+esp_err_t lcd_trans_queue_fence(lcd_trans_queue_handle_t q, lcd_trans_done_cb_t cb, void *arg);
+
+/**
+ * @brief Get number of transactions that are queued but not reaped yet
+ */
+int lcd_trans_queue_pending(lcd_trans_queue_handle_t q);
+
+/**
+ * @brief Get queue statistics
+ */
+void lcd_trans_queue_get_stats(lcd_trans_queue_handle_t q, lcd_trans_queue_stats_t *stats);
+
+/**
+ * @brief Clear queue statistics
+ */
+void lcd_trans_queue_reset_stats(lcd_trans_queue_handle_t q);
+
 #ifdef __cplusplus
 }
 #endif
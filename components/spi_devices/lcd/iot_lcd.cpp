@@ -40,9 +40,11 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "iot_lcd.h"
 #include "spi_lcd.h"
 #include "font7s.h"
+#include "glcdfont.h"
 
 #include "esp_partition.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
 #include "driver/gpio.h"
 
 #include "freertos/semphr.h"
@@ -71,10 +73,43 @@ CEspLcd::CEspLcd(lcd_conf_t* lcd_conf, int height, int width, bool dma_en, int d
     spi_mux = xSemaphoreCreateRecursiveMutex();
     m_dma_chan = dma_chan;
     setSpiBus(lcd_conf);
+
+    // Two persistent DMA buffers: the CPU fills one while the other is on the wire
+    for (int i = 0; i < 2; i++) {
+        dma_buf[i] = (uint16_t*) heap_caps_malloc(dma_buf_size * sizeof(uint16_t), MALLOC_CAP_DMA);
+        dma_buf_seq[i] = 0;
+    }
+    dma_buf_idx = 0;
+    trans_queue = lcd_trans_queue_create(spi_wr, &dc);
+    glyph_cache = iot_glyph_cache_create(LCD_GLYPH_CACHE_NUM, LCD_GLYPH_MAX_PIXELS);
+    if (dma_buf[0] == NULL || dma_buf[1] == NULL) {
+        // Drawing falls back to the serial paths that need no buffers
+        ESP_LOGE(TAG, "no mem for DMA buffers");
+        for (int i = 0; i < 2; i++) {
+            free(dma_buf[i]);
+            dma_buf[i] = NULL;
+        }
+        dma_mode = false;
+    }
+    if (trans_queue == NULL) {
+        ESP_LOGW(TAG, "no transaction queue, transfers are blocking");
+    }
 }
 
 CEspLcd::~CEspLcd()
 {
+    if (trans_queue) {
+        lcd_trans_queue_delete(trans_queue);
+        trans_queue = NULL;
+    }
+    if (glyph_cache) {
+        iot_glyph_cache_delete(glyph_cache);
+        glyph_cache = NULL;
+    }
+    for (int i = 0; i < 2; i++) {
+        free(dma_buf[i]);
+        dma_buf[i] = NULL;
+    }
     spi_bus_remove_device(spi_wr);
     vSemaphoreDelete(spi_mux);
 }
@@ -89,6 +124,146 @@ void CEspLcd::releaseBus()
     xSemaphoreGiveRecursive(spi_mux);
 }
 
+esp_err_t CEspLcd::setAsyncMode(bool en)
+{
+    if (trans_queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
+    if (!en && async_mode) {
+        ret = lcd_trans_queue_wait(trans_queue, 0, portMAX_DELAY);
+    }
+    if (en && !async_mode) {
+        lcd_trans_queue_reset_stats(trans_queue);
+    }
+    async_mode = en;
+    xSemaphoreGiveRecursive(spi_mux);
+    return ret;
+}
+
+esp_err_t CEspLcd::waitTransDone(TickType_t ticks_to_wait)
+{
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
+    if (trans_queue) {
+        ret = lcd_trans_queue_wait(trans_queue, 0, ticks_to_wait);
+    }
+    xSemaphoreGiveRecursive(spi_mux);
+    return ret;
+}
+
+esp_err_t CEspLcd::setTransDoneCallback(lcd_trans_done_cb_t cb, void *arg)
+{
+    if (cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
+    if (async_mode) {
+        ret = lcd_trans_queue_fence(trans_queue, cb, arg);
+    } else {
+        cb(arg);
+    }
+    xSemaphoreGiveRecursive(spi_mux);
+    return ret;
+}
+
+void CEspLcd::getTransStats(lcd_trans_queue_stats_t *stats)
+{
+    xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
+    if (async_mode) {
+        lcd_trans_queue_get_stats(trans_queue, stats);
+    } else {
+        memset(stats, 0, sizeof(lcd_trans_queue_stats_t));
+    }
+    xSemaphoreGiveRecursive(spi_mux);
+}
+
+/*
+ All transfers go through the transaction queue, so a window set and the pixel data
+ that follows can be queued back to back. Blocking mode drains the queue at the end of
+ every public call (_endTrans), queued mode leaves it to waitTransDone.
+ Without a queue every transfer is sent with a blocking transmit.
+*/
+void CEspLcd::_sendCmd(uint8_t cmd)
+{
+    if (trans_queue == NULL) {
+        lcd_cmd(spi_wr, cmd, &dc);
+        return;
+    }
+    lcd_queue_cmd(trans_queue, cmd);
+}
+
+void CEspLcd::_sendData(const uint8_t* data, int length)
+{
+    if (trans_queue == NULL) {
+        lcd_data(spi_wr, data, length, &dc);
+        return;
+    }
+    lcd_queue_data(trans_queue, data, length);
+}
+
+void CEspLcd::_waitBufFree()
+{
+    // A scratch buffer can only be refilled or freed after it left the bus
+    if (trans_queue) {
+        lcd_trans_queue_wait(trans_queue, 0, portMAX_DELAY);
+    }
+}
+
+void CEspLcd::_setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    // CASET/PASET are only resent when they change, runs in one row share PASET
+    if (!win_valid || x0 != win_x0 || x1 != win_x1) {
+        _sendCmd(LCD_CASET);
+        uint32_t data = MAKEWORD(x0 >> 8, x0 & 0xFF, x1 >> 8, x1 & 0xFF);
+        _sendData((uint8_t *)&data, 4);
+    }
+    if (!win_valid || y0 != win_y0 || y1 != win_y1) {
+        _sendCmd(LCD_PASET);
+        uint32_t data = MAKEWORD(y0 >> 8, y0 & 0xFF, y1 >> 8, y1 & 0xFF);
+        _sendData((uint8_t *)&data, 4);
+    }
+    _sendCmd(LCD_RAMWR); // write to RAM
+    win_x0 = x0;
+    win_x1 = x1;
+    win_y0 = y0;
+    win_y1 = y1;
+    win_valid = true;
+}
+
+bool CEspLcd::_hasDmaBuf()
+{
+    return dma_buf[0] != NULL && dma_buf[1] != NULL;
+}
+
+uint16_t* CEspLcd::_getDmaBuf()
+{
+    // Only called by the paths that checked _hasDmaBuf()
+    dma_buf_idx ^= 1;
+    if (trans_queue) {
+        lcd_trans_queue_wait_seq(trans_queue, dma_buf_seq[dma_buf_idx], portMAX_DELAY);
+    }
+    return dma_buf[dma_buf_idx];
+}
+
+void CEspLcd::_queueDmaBuf(int point_num, int offset)
+{
+    _sendData((uint8_t*) (dma_buf[dma_buf_idx] + offset), point_num * sizeof(uint16_t));
+    if (trans_queue) {
+        dma_buf_seq[dma_buf_idx] = lcd_trans_queue_seq(trans_queue);
+    }
+}
+
+void CEspLcd::_endTrans()
+{
+    // Blocking mode only returns once the data has left the bus
+    if (!async_mode && trans_queue) {
+        lcd_trans_queue_wait(trans_queue, 0, portMAX_DELAY);
+    }
+}
+
 void CEspLcd::setSpiBus(lcd_conf_t *lcd_conf)
 {
     cmd_io = (gpio_num_t) lcd_conf->pin_num_dc;
@@ -102,63 +277,73 @@ void CEspLcd::setSpiBus(lcd_conf_t *lcd_conf)
 void CEspLcd::setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
 {
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
-    transmitCmdData(LCD_CASET, MAKEWORD(x0 >> 8, x0 & 0xFF, x1 >> 8, x1 & 0xFF));
-    transmitCmdData(LCD_PASET, MAKEWORD(y0 >> 8, y0 & 0xFF, y1 >> 8, y1 & 0xFF));
-    transmitCmd(LCD_RAMWR); // write to RAM
+    _setWindow(x0, y0, x1, y1);
+    _endTrans();
     xSemaphoreGiveRecursive(spi_mux);
 }
 
 void CEspLcd::transmitData(uint16_t data)
 {
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
-    lcd_data(spi_wr, (uint8_t *)&data, 2, &dc);
+    _sendData((uint8_t *)&data, 2);
+    _endTrans();
     xSemaphoreGiveRecursive(spi_mux);
 }
 
 void CEspLcd::transmitData(uint8_t data)
 {
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
-    lcd_data(spi_wr, (uint8_t *)&data, 1, &dc);
+    _sendData((uint8_t *)&data, 1);
+    _endTrans();
     xSemaphoreGiveRecursive(spi_mux);
 }
 
 void CEspLcd::transmitCmdData(uint8_t cmd, uint32_t data)
 {
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
-    lcd_cmd(spi_wr, cmd, &dc);
-    lcd_data(spi_wr, (uint8_t *)&data, 4, &dc);
+    win_valid = false;  // the command may change the address window
+    _sendCmd(cmd);
+    _sendData((uint8_t *)&data, 4);
+    _endTrans();
     xSemaphoreGiveRecursive(spi_mux);
 }
 void CEspLcd::transmitData(uint16_t data, int32_t repeats)
 {
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
+    _waitBufFree();
     lcd_send_uint16_r(spi_wr, data, repeats, &dc);
     xSemaphoreGiveRecursive(spi_mux);
 }
 void CEspLcd::transmitData(uint8_t* data, int length)
 {
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
-    lcd_data(spi_wr, (uint8_t *)data, length, &dc);
+    _sendData((uint8_t *)data, length);
+    _endTrans();
     xSemaphoreGiveRecursive(spi_mux);
 }
 void CEspLcd::transmitCmd(uint8_t cmd)
 {
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
-    lcd_cmd(spi_wr, cmd, &dc);
+    win_valid = false;
+    _sendCmd(cmd);
+    _endTrans();
     xSemaphoreGiveRecursive(spi_mux);
 }
 
 void CEspLcd::transmitCmdData(uint8_t cmd, const uint8_t data, uint8_t numDataByte)
 {
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
-    lcd_cmd(spi_wr, (const uint8_t) cmd, &dc);
-    lcd_data(spi_wr, &data, 1, &dc);
+    win_valid = false;
+    _sendCmd((const uint8_t) cmd);
+    _sendData(&data, 1);
+    _endTrans();
     xSemaphoreGiveRecursive(spi_mux);
 }
 
 uint32_t CEspLcd::getLcdId()
 {
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
+    _waitBufFree();
     uint32_t id = lcd_get_id(spi_wr, &dc);
     xSemaphoreGiveRecursive(spi_mux);
     return id;
@@ -170,8 +355,52 @@ void CEspLcd::drawPixel(int16_t x, int16_t y, uint16_t color)
         return;
     }
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
-    setAddrWindow(x, y, x + 1, y + 1);
-    transmitData((uint16_t) SWAPBYTES(color));
+    _setWindow(x, y, x, y);
+    uint16_t data = SWAPBYTES(color);
+    _sendData((uint8_t *)&data, 2);
+    _endTrans();
+    xSemaphoreGiveRecursive(spi_mux);
+}
+
+void CEspLcd::drawPixels(const lcd_point_t *points, int num)
+{
+    xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
+    if (!_hasDmaBuf()) {
+        for (int i = 0; i < num; i++) {
+            drawPixel(points[i].x, points[i].y, points[i].color);
+        }
+        xSemaphoreGiveRecursive(spi_mux);
+        return;
+    }
+    uint16_t* data_buf = _getDmaBuf();
+    int used = 0;
+    int i = 0;
+    while (i < num) {
+        int16_t x = points[i].x;
+        int16_t y = points[i].y;
+        if ((x < 0) || (x >= _width) || (y < 0) || (y >= _height)) {
+            i++;
+            continue;
+        }
+        // Coalesce consecutive points of one row into a single window
+        int run = 1;
+        while (i + run < num && run < dma_buf_size && points[i + run].y == y
+                && points[i + run].x == x + run && x + run < _width) {
+            run++;
+        }
+        if (used + run > dma_buf_size) {
+            data_buf = _getDmaBuf();
+            used = 0;
+        }
+        for (int j = 0; j < run; j++) {
+            data_buf[used + j] = SWAPBYTES(points[i + j].color);
+        }
+        _setWindow(x, y, x + run - 1, y);
+        _queueDmaBuf(run, used);
+        used += run;
+        i += run;
+    }
+    _endTrans();
     xSemaphoreGiveRecursive(spi_mux);
 }
 
@@ -179,13 +408,13 @@ void CEspLcd::_fastSendBuf(const uint16_t* buf, int point_num, bool swap)
 {
     if ((point_num * sizeof(uint16_t)) <= (16 * sizeof(uint32_t))) {
         transmitData((uint8_t*) buf, sizeof(uint16_t) * point_num);
+        // The caller may reuse its buffer as soon as we return
+        _waitBufFree();
     } else {
-        int gap_point = dma_buf_size;
-        uint16_t* data_buf = (uint16_t*) malloc(gap_point * sizeof(uint16_t));
         int offset = 0;
         while (point_num > 0) {
-            int trans_points = point_num > gap_point ? gap_point : point_num;
-
+            int trans_points = point_num > dma_buf_size ? dma_buf_size : point_num;
+            uint16_t* data_buf = _getDmaBuf();
             if (swap) {
                 for (int i = 0; i < trans_points; i++) {
                     data_buf[i] = SWAPBYTES(buf[i + offset]);
@@ -193,40 +422,36 @@ void CEspLcd::_fastSendBuf(const uint16_t* buf, int point_num, bool swap)
             } else {
                 memcpy((uint8_t*) data_buf, (uint8_t*) (buf + offset), trans_points * sizeof(uint16_t));
             }
-            transmitData((uint8_t*) (data_buf), trans_points * sizeof(uint16_t));
+            _queueDmaBuf(trans_points);
             offset += trans_points;
             point_num -= trans_points;
         }
-        free(data_buf);
-        data_buf = NULL;
+        _endTrans();
     }
 }
 
 void CEspLcd::_fastSendRep(uint16_t val, int rep_num)
 {
     int point_num = rep_num;
-    int gap_point = dma_buf_size;
-    gap_point = (gap_point > point_num ? point_num : gap_point);
+    int gap_point = (dma_buf_size > point_num ? point_num : dma_buf_size);
 
-    uint16_t* data_buf = (uint16_t*) malloc(gap_point * sizeof(uint16_t));
-    int offset = 0;
+    // All chunks carry the same pattern, fill one buffer and queue it repeatedly
+    uint16_t* data_buf = _getDmaBuf();
+    for (int i = 0; i < gap_point; i++) {
+        data_buf[i] = val;
+    }
     while (point_num > 0) {
-        for (int i = 0; i < gap_point; i++) {
-            data_buf[i] = val;
-        }
         int trans_points = point_num > gap_point ? gap_point : point_num;
-        transmitData((uint8_t*) (data_buf), sizeof(uint16_t) * trans_points);
-        offset += trans_points;
+        _queueDmaBuf(trans_points);
         point_num -= trans_points;
     }
-    free(data_buf);
-    data_buf = NULL;
+    _endTrans();
 }
 
 void CEspLcd::drawBitmap(int16_t x, int16_t y, const uint16_t *bitmap, int16_t w, int16_t h)
 {
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
-    setAddrWindow(x, y, x + w - 1, y + h - 1);
+    _setWindow(x, y, x + w - 1, y + h - 1);
     if (dma_mode) {
         _fastSendBuf(bitmap, w * h);
     } else {
@@ -237,21 +462,141 @@ void CEspLcd::drawBitmap(int16_t x, int16_t y, const uint16_t *bitmap, int16_t w
     xSemaphoreGiveRecursive(spi_mux);
 }
 
+void CEspLcd::drawBitmap(int16_t x, int16_t y, const uint16_t *bitmap, int16_t w, int16_t h, int16_t stride)
+{
+    if (stride == w) {
+        drawBitmap(x, y, bitmap, w, h);
+        return;
+    }
+    xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
+    _setWindow(x, y, x + w - 1, y + h - 1);
+    if (dma_mode) {
+        // Gather the lines into the DMA buffers, the window wraps them on the panel
+        uint16_t* data_buf = _getDmaBuf();
+        int used = 0;
+        for (int i = 0; i < h; i++) {
+            const uint16_t* line = bitmap + i * stride;
+            int col = 0;
+            while (col < w) {
+                if (used == dma_buf_size) {
+                    _queueDmaBuf(used);
+                    data_buf = _getDmaBuf();
+                    used = 0;
+                }
+                int run = w - col < dma_buf_size - used ? w - col : dma_buf_size - used;
+                for (int j = 0; j < run; j++) {
+                    data_buf[used + j] = SWAPBYTES(line[col + j]);
+                }
+                used += run;
+                col += run;
+            }
+        }
+        _queueDmaBuf(used);
+        _endTrans();
+    } else {
+        for (int i = 0; i < h; i++) {
+            for (int j = 0; j < w; j++) {
+                transmitData(SWAPBYTES(bitmap[i * stride + j]), 1);
+            }
+        }
+    }
+    xSemaphoreGiveRecursive(spi_mux);
+}
+
 esp_err_t CEspLcd::drawBitmapFromFlashPartition(int16_t x, int16_t y, int16_t w, int16_t h, esp_partition_t* data_partition, int data_offset, int malloc_pixal_size, bool swap_bytes_en)
 {
     if (data_partition == NULL) {
         ESP_LOGE(TAG, "Partition error, null!");
         return ESP_FAIL;
     }
+    if (!_hasDmaBuf()) {
+        return _drawBitmapFromFlashSerial(x, y, w, h, data_partition, data_offset, malloc_pixal_size, swap_bytes_en);
+    }
+    int point_num = w * h;
+    // Map the pixels once, a chunk is then copied from the flash cache instead of a flash read
+    const uint16_t* src = NULL;
+    spi_flash_mmap_handle_t map_handle;
+    if (esp_partition_mmap(data_partition, data_offset, point_num * sizeof(uint16_t), SPI_FLASH_MMAP_DATA,
+                           (const void**) &src, &map_handle) != ESP_OK) {
+        src = NULL;
+    }
+    esp_err_t ret = ESP_OK;
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
+    _setWindow(x, y, x + w - 1, y + h - 1);
+    for (int offset = 0; offset < point_num && ret == ESP_OK;) {
+        int len = dma_buf_size > point_num - offset ? point_num - offset : dma_buf_size;
+        // Only waits for this buffer, the other one keeps the bus busy while it is filled
+        uint16_t* data_buf = _getDmaBuf();
+        if (src == NULL) {
+            ret = esp_partition_read(data_partition, data_offset + offset * sizeof(uint16_t), (uint8_t*) data_buf, len * sizeof(uint16_t));
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "flash image read fail at 0x%x", (int) (data_offset + offset * sizeof(uint16_t)));
+                break;
+            }
+            if (swap_bytes_en) {
+                for (int i = 0; i < len; i++) {
+                    data_buf[i] = SWAPBYTES(data_buf[i]);
+                }
+            }
+        } else if (swap_bytes_en) {
+            for (int i = 0; i < len; i++) {
+                data_buf[i] = SWAPBYTES(src[offset + i]);
+            }
+        } else {
+            memcpy(data_buf, src + offset, len * sizeof(uint16_t));
+        }
+        _queueDmaBuf(len);
+        offset += len;
+    }
+    _endTrans();
+    xSemaphoreGiveRecursive(spi_mux);
+    // The pixels were copied out, DMA never reads the mapped flash
+    if (src) {
+        spi_flash_munmap(map_handle);
+    }
+    return ret;
+}
+
+esp_err_t CEspLcd::drawImageFromFlashPartition(int16_t x, int16_t y, const esp_partition_t* data_partition, int data_offset)
+{
+    if (data_partition == NULL) {
+        ESP_LOGE(TAG, "Partition error, null!");
+        return ESP_FAIL;
+    }
+    lcd_image_header_t header;
+    esp_err_t ret = esp_partition_read(data_partition, data_offset, &header, sizeof(header));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (header.magic != LCD_IMAGE_MAGIC) {
+        ESP_LOGE(TAG, "No image at offset 0x%x", data_offset);
+        return ESP_ERR_NOT_FOUND;
+    }
+    return drawBitmapFromFlashPartition(x, y, header.width, header.height, (esp_partition_t*) data_partition,
+                                        data_offset + sizeof(header), dma_buf_size, !(header.flags & LCD_IMAGE_FLAG_SWAPPED));
+}
+
+esp_err_t CEspLcd::_drawBitmapFromFlashSerial(int16_t x, int16_t y, int16_t w, int16_t h, esp_partition_t* data_partition, int data_offset, int malloc_pixal_size, bool swap_bytes_en)
+{
     uint16_t* recv_buf = (uint16_t*) calloc(malloc_pixal_size, sizeof(uint16_t));
-    setAddrWindow(x, y, x + w - 1, y + h - 1);
+    if (recv_buf == NULL) {
+        ESP_LOGE(TAG, "flash image buffer malloc fail");
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
+    _setWindow(x, y, x + w - 1, y + h - 1);
 
     int offset = 0;
     int point_num = w * h;
     while (point_num) {
         int len = malloc_pixal_size > point_num ? point_num : malloc_pixal_size;
-        esp_partition_read(data_partition, data_offset + offset * sizeof(uint16_t), (uint8_t*) recv_buf, len * sizeof(uint16_t));
+        _waitBufFree();
+        ret = esp_partition_read(data_partition, data_offset + offset * sizeof(uint16_t), (uint8_t*) recv_buf, len * sizeof(uint16_t));
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "flash image read fail at 0x%x", (int) (data_offset + offset * sizeof(uint16_t)));
+            break;
+        }
         if (swap_bytes_en) {
             for (int i = 0; i < len; i++) {
                 recv_buf[i] = SWAPBYTES(recv_buf[i]);
@@ -261,17 +606,18 @@ esp_err_t CEspLcd::drawBitmapFromFlashPartition(int16_t x, int16_t y, int16_t w,
         offset += len;
         point_num -= len;
     }
+    _waitBufFree();
     free(recv_buf);
     recv_buf = NULL;
     xSemaphoreGiveRecursive(spi_mux);
-    return ESP_OK;
+    return ret;
 }
 
 void CEspLcd::drawBitmapFont(int16_t x, int16_t y, uint8_t w, uint8_t h, const uint16_t *bitmap)
 {
     //Saves some memory and SWAPBYTES as compared to above API
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
-    setAddrWindow(x, y, x + w - 1, y + h - 1);
+    _setWindow(x, y, x + w - 1, y + h - 1);
     if (dma_mode) {
         _fastSendBuf(bitmap, w * h, false);
     } else {
@@ -280,6 +626,52 @@ void CEspLcd::drawBitmapFont(int16_t x, int16_t y, uint8_t w, uint8_t h, const u
     xSemaphoreGiveRecursive(spi_mux);
 }
 
+typedef struct {
+    unsigned char c;
+    uint16_t color;
+    uint16_t bg;
+    uint8_t size;
+} lcd_glyph_t;
+
+/* Expand a classic font character into a 6 x 8 cell scaled by size, in wire byte order */
+static void lcd_glyph_render(uint16_t *buf, uint16_t w, uint16_t h, void *arg)
+{
+    lcd_glyph_t *glyph = (lcd_glyph_t*) arg;
+    uint16_t color = SWAPBYTES(glyph->color);
+    uint16_t bg = SWAPBYTES(glyph->bg);
+    for (int row = 0; row < h; row++) {
+        int j = row / glyph->size;
+        for (int col = 0; col < w; col++) {
+            int i = col / glyph->size;
+            bool set = (i < 5) && ((font[glyph->c * 5 + i] >> j) & 0x1);
+            *buf++ = set ? color : bg;
+        }
+    }
+}
+
+void CEspLcd::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size)
+{
+    // Only opaque classic font characters that are fully on screen can be sent as one block
+    if (gfxFont || glyph_cache == NULL || bg == color || size == 0
+            || x < 0 || y < 0 || x + 6 * size > _width || y + 8 * size > _height) {
+        Adafruit_GFX::drawChar(x, y, c, color, bg, size);
+        return;
+    }
+    lcd_glyph_t glyph = { c, color, bg, size };
+    if (!_cp437 && (c >= 176)) {
+        glyph.c++;  // Handle 'classic' charset behavior
+    }
+    xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
+    const uint16_t *pixels = iot_glyph_cache_get(glyph_cache, font, glyph.c, color, bg, 6 * size, 8 * size,
+                             lcd_glyph_render, &glyph);
+    if (pixels != NULL) {
+        drawBitmapFont(x, y, 6 * size, 8 * size, pixels);
+    } else {
+        Adafruit_GFX::drawChar(x, y, c, color, bg, size);
+    }
+    xSemaphoreGiveRecursive(spi_mux);
+}
+
 void CEspLcd::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
 {
     // Rudimentary clipping
@@ -290,7 +682,7 @@ void CEspLcd::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
         h = _height - y;
     }
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
-    setAddrWindow(x, y, x, y + h - 1);
+    _setWindow(x, y, x, y + h - 1);
     if (dma_mode) {
         _fastSendRep(SWAPBYTES(color), h);
     } else {
@@ -309,7 +701,7 @@ void CEspLcd::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
         w = _width - x;
     }
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
-    setAddrWindow(x, y, x + w - 1, y);
+    _setWindow(x, y, x + w - 1, y);
     if (dma_mode) {
         _fastSendRep(SWAPBYTES(color), w);
     } else {
@@ -336,7 +728,7 @@ void CEspLcd::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t colo
         h = _height - y;
     }
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
-    setAddrWindow(x, y, x + w - 1, y + h - 1);
+    _setWindow(x, y, x + w - 1, y + h - 1);
     if (dma_mode) {
         _fastSendRep(SWAPBYTES(color), h * w);
     } else {
@@ -459,8 +851,9 @@ int CEspLcd::drawUnicodeSevSeg(uint16_t uniCode, uint16_t x, uint16_t y, uint8_t
     uint8_t line = 0;
 
     xSemaphoreTakeRecursive(spi_mux, portMAX_DELAY);
-    setAddrWindow(x, y, x + w * 8 - 1, y + height - 1);
-    uint16_t* data_buf = (uint16_t*) malloc(dma_buf_size * sizeof(uint16_t));
+    _setWindow(x, y, x + w * 8 - 1, y + height - 1);
+    bool buffered = _hasDmaBuf();
+    uint16_t* data_buf = buffered ? _getDmaBuf() : NULL;
     int point_num = w * height * 8;
     int idx = 0;
     int trans_points = point_num > dma_buf_size ? dma_buf_size : point_num;
@@ -468,24 +861,27 @@ int CEspLcd::drawUnicodeSevSeg(uint16_t uniCode, uint16_t x, uint16_t y, uint8_t
         for (int j = 0; j < w; j++) {
             line = *(flash_address + w * i + j);
             for (int m = 0; m < 8; m++) {
-                if ((line >> (7 - m)) & 0x1) {
-                    data_buf[idx++] = SWAPBYTES(textcolor);
-                } else {
-                    data_buf[idx++] = SWAPBYTES(textbgcolor);
+                uint16_t color = ((line >> (7 - m)) & 0x1) ? textcolor : textbgcolor;
+                if (!buffered) {
+                    transmitData(SWAPBYTES(color), 1);
+                    continue;
                 }
+                data_buf[idx++] = SWAPBYTES(color);
 
                 if (idx >= trans_points) {
-                    transmitData((uint8_t*) (data_buf), trans_points * sizeof(uint16_t));
+                    _queueDmaBuf(trans_points);
                     point_num -= trans_points;
                     idx = 0;
                     trans_points = point_num > dma_buf_size ? dma_buf_size : point_num;
+                    if (point_num > 0) {
+                        data_buf = _getDmaBuf();
+                    }
                 }
 
             }
         }
     }
-    free(data_buf);
-    data_buf = NULL;
+    _endTrans();
     xSemaphoreGiveRecursive(spi_mux);
     return width + gap;
 }
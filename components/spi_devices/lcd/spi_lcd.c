@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include <sys/param.h>
+#include <stdlib.h>
 #include "spi_lcd.h"
 #include "driver/gpio.h"
 #include <string.h>
@@ -20,6 +21,7 @@
 #include "freertos/semphr.h"
 #include "freertos/xtensa_api.h"
 #include "freertos/task.h"
+#include "esp_log.h"
 #define SPIFIFOSIZE 16
 
 /*
@@ -170,7 +172,7 @@ uint32_t lcd_init(lcd_conf_t* lcd_conf, spi_device_handle_t *spi_wr_dev, lcd_dc_
         .clock_speed_hz = 1 * 1000 * 1000,     //Clock out frequency
         .mode = 0,                                //SPI mode 0
         .spics_io_num = lcd_conf->pin_num_cs,     //CS pin
-        .queue_size = 7,                          //We want to be able to queue 7 transactions at a time
+        .queue_size = LCD_TRANS_QUEUE_SIZE,       //We want to be able to queue 7 transactions at a time
         .pre_cb = lcd_spi_pre_transfer_callback,  //Specify pre-transfer callback to handle D/C line
     };
     spi_device_handle_t rd_id_handle;
@@ -256,3 +258,172 @@ uint32_t lcd_get_id(spi_device_handle_t spi, lcd_dc_t *dc)
     return *(uint32_t*) t.rx_data;
 }
 
+
+/*
+ Queued transfer pipeline. Every slot carries its own copy of the D/C state,
+ because the pre-transfer callback runs when the transaction reaches the bus,
+ long after the shared lcd_dc_t of the caller has been changed again.
+*/
+typedef struct {
+    spi_transaction_t trans;            /* must stay the first member */
+    lcd_dc_t dc;
+    lcd_trans_done_cb_t done_cb;
+    void *cb_arg;
+} lcd_trans_slot_t;
+
+typedef struct lcd_trans_queue {
+    spi_device_handle_t spi;
+    uint8_t dc_io;
+    lcd_trans_slot_t slots[LCD_TRANS_QUEUE_SIZE];
+    int head;                           /* next free slot */
+    int pending;                        /* slots on the wire or waiting in the driver queue */
+    uint32_t seq;                       /* sequence number of the last queued transaction */
+    lcd_trans_queue_stats_t stats;
+} lcd_trans_queue_t;
+
+static const char* TAG = "SPI_LCD";
+
+lcd_trans_queue_handle_t lcd_trans_queue_create(spi_device_handle_t spi, lcd_dc_t *dc)
+{
+    if (spi == NULL || dc == NULL) {
+        return NULL;
+    }
+    lcd_trans_queue_t *q = (lcd_trans_queue_t *) calloc(1, sizeof(lcd_trans_queue_t));
+    if (q == NULL) {
+        ESP_LOGE(TAG, "no mem for transaction queue");
+        return NULL;
+    }
+    q->spi = spi;
+    q->dc_io = dc->dc_io;
+    return q;
+}
+
+esp_err_t lcd_trans_queue_delete(lcd_trans_queue_handle_t q)
+{
+    if (q == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = lcd_trans_queue_wait(q, 0, portMAX_DELAY);
+    free(q);
+    return ret;
+}
+
+esp_err_t lcd_trans_queue_wait(lcd_trans_queue_handle_t q, int max_pending, TickType_t ticks_to_wait)
+{
+    spi_transaction_t *rtrans;
+    while (q->pending > max_pending) {
+        esp_err_t ret = spi_device_get_trans_result(q->spi, &rtrans, ticks_to_wait);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        lcd_trans_slot_t *slot = (lcd_trans_slot_t *) rtrans;
+        q->pending--;
+        if (slot->done_cb) {
+            lcd_trans_done_cb_t cb = slot->done_cb;
+            slot->done_cb = NULL;
+            cb(slot->cb_arg);
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t lcd_trans_queue_push(lcd_trans_queue_handle_t q, int level, const uint8_t *data, int len)
+{
+    if (len == 0) {
+        return ESP_OK;
+    }
+    if (q->pending >= LCD_TRANS_QUEUE_SIZE) {
+        q->stats.stall_cnt++;
+        esp_err_t ret = lcd_trans_queue_wait(q, LCD_TRANS_QUEUE_SIZE - 1, portMAX_DELAY);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    lcd_trans_slot_t *slot = &q->slots[q->head];
+    memset(&slot->trans, 0, sizeof(spi_transaction_t));
+    slot->dc.dc_io = q->dc_io;
+    slot->dc.dc_level = level;
+    slot->done_cb = NULL;
+    slot->trans.length = len * 8;
+    slot->trans.user = (void *) &slot->dc;
+    if (len <= (int) sizeof(slot->trans.tx_data)) {
+        // Short transfers are copied, so the caller may pass stack variables.
+        memcpy(slot->trans.tx_data, data, len);
+        slot->trans.flags = SPI_TRANS_USE_TXDATA;
+    } else {
+        slot->trans.tx_buffer = data;
+    }
+
+    xSemaphoreTake(_spi_mux, portMAX_DELAY);
+    esp_err_t ret = spi_device_queue_trans(q->spi, &slot->trans, portMAX_DELAY);
+    xSemaphoreGive(_spi_mux);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    q->head = (q->head + 1) % LCD_TRANS_QUEUE_SIZE;
+    q->pending++;
+    q->seq++;
+    q->stats.trans_cnt++;
+    q->stats.bytes_cnt += len;
+    if (q->pending > q->stats.max_depth) {
+        q->stats.max_depth = q->pending;
+    }
+    return ESP_OK;
+}
+
+esp_err_t lcd_trans_queue_wait_seq(lcd_trans_queue_handle_t q, uint32_t seq, TickType_t ticks_to_wait)
+{
+    int32_t behind = (int32_t) (q->seq - seq);
+    if (behind < 0 || behind >= q->pending) {
+        return ESP_OK;
+    }
+    return lcd_trans_queue_wait(q, behind, ticks_to_wait);
+}
+
+uint32_t lcd_trans_queue_seq(lcd_trans_queue_handle_t q)
+{
+    return q->seq;
+}
+
+esp_err_t lcd_queue_cmd(lcd_trans_queue_handle_t q, const uint8_t cmd)
+{
+    return lcd_trans_queue_push(q, LCD_CMD_LEV, &cmd, 1);
+}
+
+esp_err_t lcd_queue_data(lcd_trans_queue_handle_t q, const uint8_t *data, int len)
+{
+    return lcd_trans_queue_push(q, LCD_DATA_LEV, data, len);
+}
+
+esp_err_t lcd_trans_queue_fence(lcd_trans_queue_handle_t q, lcd_trans_done_cb_t cb, void *arg)
+{
+    if (q == NULL || cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (q->pending == 0) {
+        cb(arg);
+        return ESP_OK;
+    }
+    lcd_trans_slot_t *last = &q->slots[(q->head + LCD_TRANS_QUEUE_SIZE - 1) % LCD_TRANS_QUEUE_SIZE];
+    if (last->done_cb != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    last->cb_arg = arg;
+    last->done_cb = cb;
+    return ESP_OK;
+}
+
+int lcd_trans_queue_pending(lcd_trans_queue_handle_t q)
+{
+    return q->pending;
+}
+
+void lcd_trans_queue_get_stats(lcd_trans_queue_handle_t q, lcd_trans_queue_stats_t *stats)
+{
+    *stats = q->stats;
+}
+
+void lcd_trans_queue_reset_stats(lcd_trans_queue_handle_t q)
+{
+    memset(&q->stats, 0, sizeof(lcd_trans_queue_stats_t));
+}
@@ -0,0 +1,149 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "iot_lcd.h"
+#include "unity.h"
+
+#define BAND_LINES   (16)
+#define BAND_FRAMES  (20)
+
+static const char* TAG = "LCD_ASYNC";
+static volatile int s_frame_done = 0;
+
+static void lcd_frame_done_cb(void *arg)
+{
+    s_frame_done++;
+}
+
+/* Fake render work: a gradient that changes with the frame number */
+static void render_band(uint16_t *buf, int w, int y0, int frame)
+{
+    for (int y = 0; y < BAND_LINES; y++) {
+        for (int x = 0; x < w; x++) {
+            buf[y * w + x] = (uint16_t) ((x + y0 + y + frame) * 0x0821);
+        }
+    }
+}
+
+/* Render bands into two buffers, flushing one while rendering the other */
+static void lcd_band_bench(CEspLcd *lcd, bool async, int64_t *render_us, int64_t *total_us)
+{
+    int w = lcd->width();
+    int h = lcd->height();
+    uint16_t *band[2];
+    band[0] = (uint16_t *) heap_caps_malloc(w * BAND_LINES * sizeof(uint16_t), MALLOC_CAP_DMA);
+    band[1] = (uint16_t *) heap_caps_malloc(w * BAND_LINES * sizeof(uint16_t), MALLOC_CAP_DMA);
+    TEST_ASSERT(band[0] != NULL && band[1] != NULL);
+    TEST_ASSERT_EQUAL(ESP_OK, lcd->setAsyncMode(async));
+
+    *render_us = 0;
+    int64_t start = esp_timer_get_time();
+    for (int frame = 0; frame < BAND_FRAMES; frame++) {
+        int idx = 0;
+        for (int y = 0; y + BAND_LINES <= h; y += BAND_LINES) {
+            int64_t t0 = esp_timer_get_time();
+            render_band(band[idx], w, y, frame);
+            *render_us += esp_timer_get_time() - t0;
+            lcd->drawBitmap(0, y, band[idx], w, BAND_LINES);
+            idx ^= 1;
+        }
+        lcd->setTransDoneCallback(lcd_frame_done_cb, NULL);
+    }
+    lcd->waitTransDone();
+    *total_us = esp_timer_get_time() - start;
+
+    lcd->setAsyncMode(false);
+    free(band[0]);
+    free(band[1]);
+}
+
+static CEspLcd* lcd_async_create()
+{
+    lcd_conf_t lcd_pins = {
+        .lcd_model = LCD_MOD_AUTO_DET,
+        .pin_num_miso = CONFIG_LCD_MISO_GPIO,
+        .pin_num_mosi = CONFIG_LCD_MOSI_GPIO,
+        .pin_num_clk  = CONFIG_LCD_CLK_GPIO,
+        .pin_num_cs   = CONFIG_LCD_CS_GPIO,
+        .pin_num_dc   = CONFIG_LCD_DC_GPIO,
+        .pin_num_rst  = CONFIG_LCD_RESET_GPIO,
+        .pin_num_bckl = CONFIG_LCD_BL_GPIO,
+        .clk_freq = 40 * 1000 * 1000,
+        .rst_active_level = 0,
+        .bckl_active_level = 0,
+        .spi_host = HSPI_HOST,
+        .init_spi_bus = true,
+    };
+    CEspLcd* lcd = new CEspLcd(&lcd_pins);
+    lcd->setRotation(1);
+    return lcd;
+}
+
+TEST_CASE("LCD queued transfer test", "[lcd_async][iot]")
+{
+    CEspLcd* lcd = lcd_async_create();
+
+    int64_t render_us, total_us;
+    lcd_band_bench(lcd, false, &render_us, &total_us);
+    ESP_LOGI(TAG, "blocking: %d frames, render %lld us, total %lld us", BAND_FRAMES, render_us, total_us);
+
+    s_frame_done = 0;
+    lcd_band_bench(lcd, true, &render_us, &total_us);
+    ESP_LOGI(TAG, "queued:   %d frames, render %lld us, total %lld us", BAND_FRAMES, render_us, total_us);
+    TEST_ASSERT_EQUAL(BAND_FRAMES, s_frame_done);
+
+    TEST_ASSERT_EQUAL(ESP_OK, lcd->setAsyncMode(true));
+    lcd_trans_queue_stats_t stats;
+    lcd->fillScreen(COLOR_BLACK);
+    lcd->waitTransDone();
+    lcd->getTransStats(&stats);
+    ESP_LOGI(TAG, "fill screen: %u transactions, %u bytes, max depth %d, stalls %u",
+             stats.trans_cnt, stats.bytes_cnt, stats.max_depth, stats.stall_cnt);
+    TEST_ASSERT(stats.max_depth <= 7);
+    lcd->setAsyncMode(false);
+    delete lcd;
+}
+
+TEST_CASE("LCD draw pixels test", "[lcd_async][iot]")
+{
+    const int num = 8 * 64;
+    lcd_point_t *points = (lcd_point_t *) malloc(num * sizeof(lcd_point_t));
+    TEST_ASSERT(points != NULL);
+    /* 8 rows of dashes, like the set bits of a line of text */
+    for (int i = 0; i < num; i++) {
+        points[i].x = 20 + (i % 64) + (i % 64) / 4;
+        points[i].y = 100 + i / 64;
+        points[i].color = COLOR_YELLOW;
+    }
+    CEspLcd* lcd = lcd_async_create();
+    lcd->fillScreen(COLOR_BLACK);
+
+    int64_t t0 = esp_timer_get_time();
+    for (int i = 0; i < num; i++) {
+        lcd->drawPixel(points[i].x, points[i].y, points[i].color);
+    }
+    int64_t pixel_us = esp_timer_get_time() - t0;
+
+    t0 = esp_timer_get_time();
+    lcd->drawPixels(points, num);
+    int64_t pixels_us = esp_timer_get_time() - t0;
+    ESP_LOGI(TAG, "%d points: drawPixel %lld us, drawPixels %lld us", num, pixel_us, pixels_us);
+
+    delete lcd;
+    free(points);
+}
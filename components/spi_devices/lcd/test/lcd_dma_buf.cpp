@@ -0,0 +1,88 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "iot_lcd.h"
+#include "lcd_image.h"
+#include "unity.h"
+#if CONFIG_HEAP_TRACING
+#include "esp_heap_trace.h"
+#define HEAP_TRACE_RECORDS  (64)
+static heap_trace_record_t s_trace_record[HEAP_TRACE_RECORDS];
+#endif
+
+#define DMA_BUF_FRAMES  (20)
+
+static const char* TAG = "LCD_DMA_BUF";
+
+static void lcd_draw_frame(CEspLcd *lcd, int frame)
+{
+    lcd->fillScreen(frame & 1 ? COLOR_NAVY : COLOR_DARKGREEN);
+    for (int i = 0; i < 10; i++) {
+        lcd->fillRect(i * 24, i * 16, 80, 60, COLOR_ORANGE + i);
+    }
+    for (int i = 0; i < 20; i++) {
+        lcd->drawFastHLine(0, i * 12, lcd->width(), COLOR_WHITE);
+        lcd->drawFastVLine(i * 16, 0, lcd->height(), COLOR_RED);
+    }
+    lcd->drawBitmap(0, 0, (uint16_t *)Status_320_240, 320, 240);
+}
+
+TEST_CASE("LCD DMA buffer test", "[lcd_dma_buf][iot]")
+{
+    lcd_conf_t lcd_pins = {
+        .lcd_model = LCD_MOD_AUTO_DET,
+        .pin_num_miso = CONFIG_LCD_MISO_GPIO,
+        .pin_num_mosi = CONFIG_LCD_MOSI_GPIO,
+        .pin_num_clk  = CONFIG_LCD_CLK_GPIO,
+        .pin_num_cs   = CONFIG_LCD_CS_GPIO,
+        .pin_num_dc   = CONFIG_LCD_DC_GPIO,
+        .pin_num_rst  = CONFIG_LCD_RESET_GPIO,
+        .pin_num_bckl = CONFIG_LCD_BL_GPIO,
+        .clk_freq = 40 * 1000 * 1000,
+        .rst_active_level = 0,
+        .bckl_active_level = 0,
+        .spi_host = HSPI_HOST,
+        .init_spi_bus = true,
+    };
+    CEspLcd* lcd = new CEspLcd(&lcd_pins);
+    lcd->setRotation(1);
+    // First frame outside of the measurement, the driver may allocate lazily
+    lcd_draw_frame(lcd, 0);
+
+#if CONFIG_HEAP_TRACING
+    heap_trace_init_standalone(s_trace_record, HEAP_TRACE_RECORDS);
+    heap_trace_start(HEAP_TRACE_ALL);
+#endif
+    size_t heap_before = xPortGetFreeHeapSize();
+    int64_t start = esp_timer_get_time();
+    for (int frame = 1; frame <= DMA_BUF_FRAMES; frame++) {
+        lcd_draw_frame(lcd, frame);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+#if CONFIG_HEAP_TRACING
+    heap_trace_stop();
+    size_t allocs = heap_trace_get_count();
+    ESP_LOGI(TAG, "allocations per frame: %d", allocs / DMA_BUF_FRAMES);
+    TEST_ASSERT_EQUAL(0, allocs);
+#else
+    ESP_LOGI(TAG, "enable CONFIG_HEAP_TRACING to count allocations per frame");
+#endif
+    ESP_LOGI(TAG, "%d frames, %lld us per frame, heap delta %d", DMA_BUF_FRAMES,
+             elapsed / DMA_BUF_FRAMES, (int) (heap_before - xPortGetFreeHeapSize()));
+    TEST_ASSERT_EQUAL(heap_before, xPortGetFreeHeapSize());
+    delete lcd;
+}
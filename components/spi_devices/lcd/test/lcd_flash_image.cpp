@@ -0,0 +1,102 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "iot_lcd.h"
+#include "lcd_image.h"
+#include "unity.h"
+
+#define FLASH_IMAGE_W       (320)
+#define FLASH_IMAGE_H       (240)
+#define FLASH_IMAGE_CHUNK   (2048)      // pixels written to flash at a time
+#define FLASH_IMAGE_LOOPS   (10)
+
+static const char* TAG = "LCD_FLASH_IMAGE";
+
+/* Store a pre-swapped copy of the image behind its header, the way an asset tool would */
+static void flash_image_write(const esp_partition_t *part, const uint16_t *image)
+{
+    int size = sizeof(lcd_image_header_t) + FLASH_IMAGE_W * FLASH_IMAGE_H * sizeof(uint16_t);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_erase_range(part, 0, (size + SPI_FLASH_SEC_SIZE - 1) / SPI_FLASH_SEC_SIZE * SPI_FLASH_SEC_SIZE));
+
+    lcd_image_header_t header = {
+        .magic = LCD_IMAGE_MAGIC,
+        .width = FLASH_IMAGE_W,
+        .height = FLASH_IMAGE_H,
+        .flags = LCD_IMAGE_FLAG_SWAPPED,
+        .reserved = 0,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_write(part, 0, &header, sizeof(header)));
+
+    uint16_t *buf = (uint16_t *) malloc(FLASH_IMAGE_CHUNK * sizeof(uint16_t));
+    TEST_ASSERT_NOT_NULL(buf);
+    for (int offset = 0; offset < FLASH_IMAGE_W * FLASH_IMAGE_H; offset += FLASH_IMAGE_CHUNK) {
+        int len = FLASH_IMAGE_W * FLASH_IMAGE_H - offset;
+        len = len > FLASH_IMAGE_CHUNK ? FLASH_IMAGE_CHUNK : len;
+        for (int i = 0; i < len; i++) {
+            buf[i] = (image[offset + i] >> 8) | (image[offset + i] << 8);
+        }
+        TEST_ASSERT_EQUAL(ESP_OK, esp_partition_write(part, sizeof(header) + offset * sizeof(uint16_t), buf, len * sizeof(uint16_t)));
+    }
+    free(buf);
+}
+
+TEST_CASE("LCD flash image test", "[lcd_flash_image][iot]")
+{
+    lcd_conf_t lcd_pins = {
+        .lcd_model = LCD_MOD_AUTO_DET,
+        .pin_num_miso = CONFIG_LCD_MISO_GPIO,
+        .pin_num_mosi = CONFIG_LCD_MOSI_GPIO,
+        .pin_num_clk  = CONFIG_LCD_CLK_GPIO,
+        .pin_num_cs   = CONFIG_LCD_CS_GPIO,
+        .pin_num_dc   = CONFIG_LCD_DC_GPIO,
+        .pin_num_rst  = CONFIG_LCD_RESET_GPIO,
+        .pin_num_bckl = CONFIG_LCD_BL_GPIO,
+        .clk_freq = 40 * 1000 * 1000,
+        .rst_active_level = 0,
+        .bckl_active_level = 0,
+        .spi_host = HSPI_HOST,
+        .init_spi_bus = true,
+    };
+    // The unit test app keeps ota_1 free for tests
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_1, NULL);
+    TEST_ASSERT_NOT_NULL(part);
+    flash_image_write(part, Status_320_240);
+
+    CEspLcd* lcd = new CEspLcd(&lcd_pins);
+    lcd->setRotation(1);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, lcd->drawImageFromFlashPartition(0, 0, part, sizeof(lcd_image_header_t)));
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < FLASH_IMAGE_LOOPS; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, lcd->drawBitmapFromFlashPartition(0, 0, FLASH_IMAGE_W, FLASH_IMAGE_H, (esp_partition_t *) part,
+                    sizeof(lcd_image_header_t), 1024, true));
+    }
+    int64_t swap_us = (esp_timer_get_time() - start) / FLASH_IMAGE_LOOPS;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < FLASH_IMAGE_LOOPS; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, lcd->drawImageFromFlashPartition(0, 0, part));
+    }
+    int64_t image_us = (esp_timer_get_time() - start) / FLASH_IMAGE_LOOPS;
+
+    // 16 bits per pixel at 40 MHz
+    int64_t bus_us = (int64_t) FLASH_IMAGE_W * FLASH_IMAGE_H * 16 / 40;
+    ESP_LOGI(TAG, "swapped on the fly: %lld us, pre-swapped: %lld us, bus time: %lld us", swap_us, image_us, bus_us);
+    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    delete lcd;
+}
@@ -24,8 +24,12 @@
 
 #define TOUCH_CMD_X       0xD0
 #define TOUCH_CMD_Y       0x90
+#define TOUCH_CMD_Z1      0xB0
+#define TOUCH_CMD_Z2      0xC0
 #define XPT2046_SMPSIZE   10
 #define XPT2046_SMP_MAX   4095
+#define XPT2046_BURST_MAX 32        /*!< conversions in one burst read */
+#define XPT2046_PRESSURE_MIN 400    /*!< default pressure threshold, Z1 + 4095 - Z2 */
 
 typedef struct position {
     int x;
@@ -70,6 +74,21 @@ void iot_xpt2046_init(xpt_conf_t * xpt_conf, spi_device_handle_t * spi);
  */
 uint16_t iot_xpt2046_readdata(spi_device_handle_t spi, const uint8_t command);
 
+/**
+ * @brief   run several conversions in one SPI transaction
+ *
+ * @param   spi spi_handle_t
+ * @param   cmds commands of the conversions, in order
+ * @param   data 12 bit results, one per command
+ * @param   num number of conversions, no more than XPT2046_BURST_MAX
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG num out of range
+ *     - Others SPI error
+ */
+esp_err_t iot_xpt2046_read_burst(spi_device_handle_t spi, const uint8_t *cmds, uint16_t *data, int num);
+
 #ifdef __cplusplus
 }
 #endif
@@ -85,6 +104,8 @@ private:
     bool m_pressed;
     int m_rotation;
     int m_io_irq;
+    int m_pressure;
+    int m_pressure_min;
     SemaphoreHandle_t m_spi_mux = NULL;
 
 public:
@@ -138,8 +159,27 @@ public:
      */
     int get_sample(uint8_t command);
 
+    /**
+     * @brief   set the pressure below which the screen counts as released
+     *
+     * @param   pressure threshold of Z1 + 4095 - Z2, default XPT2046_PRESSURE_MIN
+     */
+    void set_pressure_threshold(int pressure);
+
+    /**
+     * @brief   get the pressure of the last sample
+     *
+     * @return
+     *     - Z1 + 4095 - Z2, 0 when released
+     */
+    int get_pressure(void);
+
     /**
      * @brief   sample and calculator
+     *
+     * Pressure is read first, X and Y are only sampled while it is above the threshold.
+     * XPT2046_SMPSIZE samples of each axis come from one SPI burst and are filtered
+     * with a trimmed mean.
      */
     void sample(void);
 
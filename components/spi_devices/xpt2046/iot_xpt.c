@@ -13,6 +13,9 @@
 // limitations under the License.
 #include "iot_xpt2046.h"
 #include "driver/gpio.h"
+#include "esp_attr.h"
+
+static const char* TAG = "xpt2046";
 
 void iot_xpt2046_init(xpt_conf_t *xpt_conf, spi_device_handle_t *spi)
 {
@@ -39,25 +42,47 @@ void iot_xpt2046_init(xpt_conf_t *xpt_conf, spi_device_handle_t *spi)
         .queue_size = 7,                      //We want to be able to queue 7 transactions at a time
     };
 
-    devcfg.flags = SPI_DEVICE_HALFDUPLEX;
+    // Full duplex, so the next command is clocked in while the last result is clocked out
     spi_bus_add_device((spi_host_device_t)xpt_conf->spi_host, &devcfg, spi);
 }
 
-uint16_t iot_xpt2046_readdata(spi_device_handle_t spi, const uint8_t command)
+esp_err_t iot_xpt2046_read_burst(spi_device_handle_t spi, const uint8_t *cmds, uint16_t *data, int num)
 {
+    if (num <= 0 || num > XPT2046_BURST_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
     /**
-     * Half duplex mode is not compatible with DMA when both writing and reading phases exist.
-     * try to use command and address field to replace the write phase.
-    */
-    spi_transaction_ext_t t = (spi_transaction_ext_t) {
-        .base = {
-            .flags = SPI_TRANS_VARIABLE_CMD | SPI_TRANS_USE_RXDATA,
-            .cmd = command,
-            .rxlength = 2 * 8, // Total data length received, in bits
-        },
-        .command_bits = 8,
+     * 16 clocks per conversion: command i goes out in byte 2 * i, its 12 bit result
+     * comes back in bytes 2 * i + 1 and 2 * i + 2, overlapping the next command.
+     * The buffers are rounded up to words for DMA.
+     */
+    WORD_ALIGNED_ATTR uint8_t tx[(XPT2046_BURST_MAX * 2 + 1 + 3) & ~3];
+    WORD_ALIGNED_ATTR uint8_t rx[(XPT2046_BURST_MAX * 2 + 1 + 3) & ~3];
+    int len = num * 2 + 1;
+
+    memset(tx, 0, len);
+    for (int i = 0; i < num; i++) {
+        tx[i * 2] = cmds[i];
+    }
+    spi_transaction_t t = {
+        .length = len * 8,
+        .tx_buffer = tx,
+        .rx_buffer = rx,
     };
+    esp_err_t ret = spi_device_transmit(spi, &t);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "burst read failed: %d", ret);
+        return ret;
+    }
+    for (int i = 0; i < num; i++) {
+        data[i] = (rx[i * 2 + 1] << 8 | rx[i * 2 + 2]) >> 3;
+    }
+    return ESP_OK;
+}
 
-    assert(spi_device_transmit(spi, (spi_transaction_t *)&t) == ESP_OK);
-    return (t.base.rx_data[0] << 8 | t.base.rx_data[1]) >> 3;
+uint16_t iot_xpt2046_readdata(spi_device_handle_t spi, const uint8_t command)
+{
+    uint16_t data = 0;
+    iot_xpt2046_read_burst(spi, &command, &data, 1);
+    return data;
 }
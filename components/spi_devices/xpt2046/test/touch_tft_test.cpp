@@ -18,6 +18,7 @@
 #include "iot_xpt2046.h"
 #include "iot_lcd.h"
 #include "app_touch.h"
+#include "esp_timer.h"
 #include "unity.h"
 
 static const char* TAG = "TOUCH_LCD";
@@ -87,3 +88,37 @@ TEST_CASE("TouchTFT cpp test", "[lcd][touchtft][iot]")
 {
     touch_tft_test();
 }
+
+TEST_CASE("XPT2046 burst sample test", "[touchtft][iot]")
+{
+    xpt_conf_t xpt_conf = {
+        .pin_num_cs = CONFIG_XPT2046_CS_GPIO,
+        .pin_num_irq = CONFIG_XPT2046_IRQ_GPIO,
+        .clk_freq = 1 * 1000 * 1000,
+        .spi_host = HSPI_HOST,
+        .pin_num_miso = -1,
+        .pin_num_mosi = -1,
+        .pin_num_clk = -1,
+        .dma_chan = 1,
+        .init_spi_bus = false,
+    };
+    if (xpt == NULL) {
+        xpt = new CXpt2046(&xpt_conf);
+    }
+    ESP_LOGI(TAG, "please press the screen...");
+    int pressed_cnt = 0;
+    for (int i = 0; i < 100; i++) {
+        int64_t t0 = esp_timer_get_time();
+        bool pressed = xpt->is_pressed();
+        int64_t t1 = esp_timer_get_time();
+        if (pressed) {
+            position pos = xpt->get_raw_position();
+            ESP_LOGI(TAG, "x: %d, y: %d, pressure: %d, sample: %d us", pos.x, pos.y, xpt->get_pressure(), (int) (t1 - t0));
+            pressed_cnt++;
+        } else {
+            ESP_LOGI(TAG, "released, sample: %d us", (int) (t1 - t0));
+        }
+        vTaskDelay(100 / portTICK_RATE_MS);
+    }
+    TEST_ASSERT(pressed_cnt > 0);
+}
@@ -14,25 +14,67 @@
 #include "iot_xpt2046.h"
 #include "driver/gpio.h"
 
+/* One burst: a dummy X to settle the ADC, the X/Y samples, then the pressure again */
+#define XPT2046_BURST_XY      (1)
+#define XPT2046_BURST_Z1      (XPT2046_BURST_XY + XPT2046_SMPSIZE * 2)
+#define XPT2046_BURST_Z2      (XPT2046_BURST_Z1 + 1)
+#define XPT2046_BURST_LEN     (XPT2046_BURST_Z2 + 1)
+
+static uint8_t s_burst_cmds[XPT2046_BURST_LEN];
+static const uint8_t s_pressure_cmds[] = { TOUCH_CMD_Z1, TOUCH_CMD_Z2 };
+
+static inline int xpt2046_pressure(int z1, int z2)
+{
+    return z1 + XPT2046_SMP_MAX - z2;
+}
+
+/* Sort the samples and average the middle half, spikes at both ends are dropped */
+static int xpt2046_trimmed_mean(int *val, int num)
+{
+    for (int i = 1; i < num; i++) {
+        int v = val[i];
+        int j = i - 1;
+        for (; j >= 0 && val[j] > v; j--) {
+            val[j + 1] = val[j];
+        }
+        val[j + 1] = v;
+    }
+    int sum = 0;
+    for (int i = num / 4; i < num - num / 4; i++) {
+        sum += val[i];
+    }
+    return sum / (num - num / 4 * 2);
+}
+
 CXpt2046::CXpt2046(xpt_conf_t * xpt_conf, int rotation)
 {
     iot_xpt2046_init(xpt_conf, &m_spi);
     m_pressed = false;
     m_rotation = rotation;
     m_io_irq = xpt_conf->pin_num_irq;
+    m_pressure = 0;
+    m_pressure_min = XPT2046_PRESSURE_MIN;
     if (m_spi_mux == NULL) {
         m_spi_mux = xSemaphoreCreateRecursiveMutex();
     }
+    s_burst_cmds[0] = TOUCH_CMD_X;
+    for (int i = 0; i < XPT2046_SMPSIZE; i++) {
+        s_burst_cmds[XPT2046_BURST_XY + i * 2] = TOUCH_CMD_X;
+        s_burst_cmds[XPT2046_BURST_XY + i * 2 + 1] = TOUCH_CMD_Y;
+    }
+    s_burst_cmds[XPT2046_BURST_Z1] = TOUCH_CMD_Z1;
+    s_burst_cmds[XPT2046_BURST_Z2] = TOUCH_CMD_Z2;
 }
 
 bool CXpt2046::is_pressed()
 {
-    sample();
-    if(gpio_get_level((gpio_num_t) m_io_irq) == 0){
-        m_pressed = true;
-    } else {
+    // PENIRQ stays high while released, the ADC is not woken up at all
+    if (gpio_get_level((gpio_num_t) m_io_irq) != 0) {
         m_pressed = false;
+        m_pressure = 0;
+        return m_pressed;
     }
+    sample();
     return m_pressed;
 }
 
@@ -46,6 +88,16 @@ void CXpt2046::set_rotation(int rotation)
     m_rotation = rotation % 4;
 }
 
+void CXpt2046::set_pressure_threshold(int pressure)
+{
+    m_pressure_min = pressure;
+}
+
+int CXpt2046::get_pressure()
+{
+    return m_pressure;
+}
+
 position CXpt2046::get_raw_position()
 {
     return m_pos;
@@ -61,56 +113,43 @@ int CXpt2046::get_sample(uint8_t command)
 
 void CXpt2046::sample()
 {
-    position samples[XPT2046_SMPSIZE];
-    position distances[XPT2046_SMPSIZE];
-    m_pressed = true;
-
-    int aveX = 0;
-    int aveY = 0;
+    uint16_t data[XPT2046_BURST_LEN];
+    int xs[XPT2046_SMPSIZE];
+    int ys[XPT2046_SMPSIZE];
+    esp_err_t ret;
 
-    for (int i = 0; i < XPT2046_SMPSIZE; i++) {
-        samples[i].x = get_sample(TOUCH_CMD_X);
-        samples[i].y = get_sample(TOUCH_CMD_Y);
-
-        if (samples[i].x == 0 || samples[i].x == XPT2046_SMP_MAX || samples[i].y == 0
-                || samples[i].y == XPT2046_SMP_MAX) {
-            m_pressed = false;
-        }
-        aveX += samples[i].x;
-        aveY += samples[i].y;
+    m_pressed = false;
+    xSemaphoreTakeRecursive(m_spi_mux, portMAX_DELAY);
+    // A light touch or a lifted pen costs no X/Y conversions
+    ret = iot_xpt2046_read_burst(m_spi, s_pressure_cmds, data, 2);
+    m_pressure = (ret == ESP_OK) ? xpt2046_pressure(data[0], data[1]) : 0;
+    if (m_pressure >= m_pressure_min) {
+        ret = iot_xpt2046_read_burst(m_spi, s_burst_cmds, data, XPT2046_BURST_LEN);
     }
-
-    aveX /= XPT2046_SMPSIZE;
-    aveY /= XPT2046_SMPSIZE;
-    for (int i = 0; i < XPT2046_SMPSIZE; i++) {
-        distances[i].x = i;
-        distances[i].y = ((aveX - samples[i].x) * (aveX - samples[i].x))
-                         + ((aveY - samples[i].y) * (aveY - samples[i].y));
+    xSemaphoreGiveRecursive(m_spi_mux);
+    if (ret != ESP_OK || m_pressure < m_pressure_min) {
+        m_pressure = 0;
+        return;
     }
-
-    // sort by distance
-    for (int i = 0; i < XPT2046_SMPSIZE - 1; i++) {
-        for (int j = 0; j < XPT2046_SMPSIZE - 1; j++) {
-            if (samples[j].y > samples[j + 1].y) {
-                int yy = samples[j + 1].y;
-                samples[j + 1].y = samples[j].y;
-                samples[j].y = yy;
-                int xx = samples[j + 1].x;
-                samples[j + 1].x = samples[j].x;
-                samples[j].x = xx;
-            }
-        }
+    // Drop the burst if the pen was lifted while it ran
+    int pressure = xpt2046_pressure(data[XPT2046_BURST_Z1], data[XPT2046_BURST_Z2]);
+    if (pressure < m_pressure_min) {
+        m_pressure = 0;
+        return;
     }
+    m_pressure = (m_pressure + pressure) / 2;
 
-    int tx = 0;
-    int ty = 0;
-    for (int i = 0; i < (XPT2046_SMPSIZE / 2); i++) {
-        tx += samples[distances[i].x].x;
-        ty += samples[distances[i].x].y;
+    for (int i = 0; i < XPT2046_SMPSIZE; i++) {
+        xs[i] = data[XPT2046_BURST_XY + i * 2];
+        ys[i] = data[XPT2046_BURST_XY + i * 2 + 1];
+        if (xs[i] == 0 || xs[i] == XPT2046_SMP_MAX || ys[i] == 0 || ys[i] == XPT2046_SMP_MAX) {
+            return;
+        }
     }
+    m_pressed = true;
 
-    tx = tx / (XPT2046_SMPSIZE / 2);
-    ty = ty / (XPT2046_SMPSIZE / 2);
+    int tx = xpt2046_trimmed_mean(xs, XPT2046_SMPSIZE);
+    int ty = xpt2046_trimmed_mean(ys, XPT2046_SMPSIZE);
 
     switch (m_rotation) {
         case 0: